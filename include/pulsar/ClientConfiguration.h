@@ -122,6 +122,24 @@ class PULSAR_PUBLIC ClientConfiguration {
      */
     int getMessageListenerThreads() const;
 
+    /**
+     * Set the number of threads to be used by the Pulsar client to compress and encrypt the batches of the
+     * producers. Default is 0, which means a batch is compressed and encrypted by the thread that closes it,
+     * i.e. the thread that sends a message or the IO thread that triggers the batch timer.
+     *
+     * With more than 0 threads, the batches are compressed and encrypted in parallel, while the messages of
+     * a producer are still sent in order. It only takes effect for the producers that have batching enabled
+     * and configure a compression type or an encryption key.
+     *
+     * @param threads number of threads (needs to be greater than or equal to 0)
+     */
+    ClientConfiguration& setCompressionThreads(int threads);
+
+    /**
+     * @return the number of threads to compress and encrypt the batches
+     */
+    int getCompressionThreads() const;
+
     /**
      * Number of concurrent lookup-requests allowed on each broker-connection to prevent overload on broker.
      * <i>(default: 50000)</i> It should be configured with higher value only in case of it requires to
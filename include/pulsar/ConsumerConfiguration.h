@@ -31,6 +31,7 @@
 #include <pulsar/Result.h>
 #include <pulsar/Schema.h>
 #include <pulsar/TypedMessage.h>
+#include <pulsar/ZstdDictionary.h>
 #include <pulsar/defines.h>
 
 #include <functional>
@@ -55,6 +56,9 @@ typedef std::function<void(Result result, MessageId messageId)> GetLastMessageId
 /// Callback definition for MessageListener
 typedef std::function<void(Consumer& consumer, const Message& msg)> MessageListener;
 
+/// Callback definition for BatchMessageListener
+typedef std::function<void(Consumer& consumer, const Messages& msgs)> BatchMessageListener;
+
 typedef std::shared_ptr<ConsumerEventListener> ConsumerEventListenerPtr;
 
 struct ConsumerConfigurationImpl;
@@ -150,6 +154,50 @@ class PULSAR_PUBLIC ConsumerConfiguration {
      */
     bool hasMessageListener() const;
 
+    /**
+     * A batch message listener is called with all the messages available in the receiver queue, up to an
+     * internal limit, instead of being called for each message. The messages are delivered in order.
+     *
+     * It overrides the message listener set by setMessageListener() and vice versa. If the consumer
+     * subscribes to multiple topics or a partitioned topic, the batch message listener is called for each
+     * message.
+     *
+     * Passing an empty listener unsets both the batch message listener and the message listener.
+     */
+    ConsumerConfiguration& setBatchMessageListener(BatchMessageListener batchMessageListener);
+
+    /**
+     * @return the batch message listener
+     */
+    BatchMessageListener getBatchMessageListener() const;
+
+    /**
+     * Set the number of lanes that run the message listener (or the batch message listener) in parallel.
+     *
+     * Each message is assigned to a lane by the hash of its ordering key, or of its partition key if it has
+     * no ordering key, so that the messages with the same key are still processed one by one in order, while
+     * the messages with different keys can be processed concurrently. The messages without a key are assigned
+     * to the lanes in a round-robin way. The lanes run on the listener threads of the client (see
+     * ClientConfiguration::setMessageListenerThreads), which bounds the actual parallelism.
+     *
+     * Each lane holds at most `receiverQueueSize / lanes` messages that are not processed yet. When the lane
+     * of the next message is full, the dispatching stops and no flow permits are returned to the broker until
+     * the lane catches up.
+     *
+     * It's ignored, with a warning logged when the consumer starts, if the consumer subscribes to multiple
+     * topics or a partitioned topic: the messages are then processed in order by a single listener.
+     *
+     * Default: 1, which processes all messages of the consumer in order
+     *
+     * @param messageListenerLanes the number of lanes
+     */
+    ConsumerConfiguration& setMessageListenerLanes(int messageListenerLanes);
+
+    /**
+     * @return the number of lanes that run the message listener in parallel
+     */
+    int getMessageListenerLanes() const;
+
     /**
      * A event listener enables your application to react the consumer state
      * change event (active or inactive).
@@ -209,6 +257,79 @@ class PULSAR_PUBLIC ConsumerConfiguration {
      */
     int getMaxTotalReceiverQueueSizeAcrossPartitions() const;
 
+    /**
+     * Enable the auto-scaling of the receiver queue size, i.e. the number of messages that the broker is
+     * allowed to push to the consumer ahead of the application.
+     *
+     * The receiver queue size starts at the min receiver queue size and is resized each time the consumed
+     * permits are refilled: it grows for a fast consumer so that the refilled permits arrive before the
+     * receiver queue runs out, and it shrinks for a slow consumer so that fewer messages are held in memory.
+     * The size is derived from the measured consumption rate and the round trip time of the flow permits,
+     * and it stays between the min receiver queue size and the receiver queue size set by
+     * setReceiverQueueSize(), which becomes the max size. The max receiver queue bytes, if set, caps the
+     * size by the average size of the received messages.
+     *
+     * For a partitioned topic, or multiple topics, the sizes of the internal consumers share the max total
+     * receiver queue size across partitions, so that a busy partition can grow at the expense of the idle
+     * ones.
+     *
+     * It's ignored if the receiver queue size is 0.
+     *
+     * Default: false
+     */
+    ConsumerConfiguration& setAutoScaledReceiverQueueSizeEnabled(bool enabled);
+
+    /**
+     * @return whether the receiver queue size is auto-scaled
+     */
+    bool isAutoScaledReceiverQueueSizeEnabled() const;
+
+    /**
+     * Set the min receiver queue size when it's auto-scaled, which is also the initial size.
+     *
+     * Default: 1
+     *
+     * @param minReceiverQueueSize the min receiver queue size
+     */
+    ConsumerConfiguration& setMinReceiverQueueSize(int minReceiverQueueSize);
+
+    /**
+     * @return the min receiver queue size when it's auto-scaled
+     */
+    int getMinReceiverQueueSize() const;
+
+    /**
+     * Set the max bytes of the messages in the receiver queue when its size is auto-scaled. The receiver
+     * queue size is capped by the max bytes divided by the average size of the received messages.
+     *
+     * Default: 0, which means no limit
+     *
+     * @param maxReceiverQueueBytes the max bytes of the messages in the receiver queue
+     */
+    ConsumerConfiguration& setMaxReceiverQueueBytes(long maxReceiverQueueBytes);
+
+    /**
+     * @return the max bytes of the messages in the receiver queue when its size is auto-scaled
+     */
+    long getMaxReceiverQueueBytes() const;
+
+    /**
+     * Set the time in microseconds that a blocking receive spins, checking the receiver queue, before the
+     * thread is parked until a message arrives. Spinning avoids the latency of waking up the thread when the
+     * messages arrive at a high rate, at the cost of burning CPU while the queue is empty.
+     *
+     * Default: 0, which parks the thread immediately
+     *
+     * @param receiveSpinTimeUs the spin time in microseconds
+     * @throws std::invalid_argument if `receiveSpinTimeUs` is negative
+     */
+    ConsumerConfiguration& setReceiveSpinTimeUs(long receiveSpinTimeUs);
+
+    /**
+     * @return the time in microseconds that a blocking receive spins before the thread is parked
+     */
+    long getReceiveSpinTimeUs() const;
+
     /**
      * Set the consumer name.
      *
@@ -340,6 +461,21 @@ class PULSAR_PUBLIC ConsumerConfiguration {
      */
     ConsumerConfiguration& setCryptoKeyReader(CryptoKeyReaderPtr cryptoKeyReader);
 
+    /**
+     * Add a dictionary to decompress the messages compressed by the producers with the same ZSTD dictionary,
+     * see ProducerConfiguration::setZstdDictionary.
+     *
+     * The messages compressed with a dictionary that is not added are discarded as corrupted messages.
+     *
+     * @param dictionary the dictionary, which replaces the dictionary added before with the same id
+     */
+    ConsumerConfiguration& addZstdDictionary(ZstdDictionaryPtr dictionary);
+
+    /**
+     * @return the dictionary added with the given id, or null if there is no such dictionary
+     */
+    ZstdDictionaryPtr getZstdDictionary(uint32_t id) const;
+
     /**
      * @return the ConsumerCryptoFailureAction
      */
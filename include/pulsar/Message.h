@@ -216,6 +216,7 @@ class PULSAR_PUBLIC Message {
     friend class Commands;
     friend class BatchMessageContainerBase;
     friend class BatchAcknowledgementTracker;
+    friend class BatchEntry;
     friend class PulsarWrapper;
     friend class MessageBatch;
     friend struct OpSendMsg;
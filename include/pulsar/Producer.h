@@ -24,6 +24,7 @@
 #include <stdint.h>
 
 #include <memory>
+#include <vector>
 
 namespace pulsar {
 class ProducerImplBase;
@@ -31,6 +32,7 @@ class PulsarWrapper;
 class PulsarFriend;
 
 typedef std::function<void(Result)> FlushCallback;
+typedef std::function<void(Result, const std::vector<MessageId>& messageIds)> BatchSendCallback;
 typedef std::shared_ptr<ProducerImplBase> ProducerImplBasePtr;
 
 class PULSAR_PUBLIC Producer {
@@ -99,6 +101,23 @@ class PULSAR_PUBLIC Producer {
      */
     void sendAsync(const Message& msg, const SendCallback& callback);
 
+    /**
+     * Asynchronously publish a sequence of messages on the topic associated with this Producer.
+     *
+     * It's the same as calling sendAsync(const Message&, const SendCallback&) for each message in order,
+     * except that the permits of the pending queue and the memory are reserved once for all the messages,
+     * the messages are added to the batches at once, and a single callback is triggered when all the
+     * messages have been persisted or failed.
+     *
+     * The result passed to the callback is ResultOk if all the messages were published successfully,
+     * otherwise it's the result of one of the failed messages. The message ids are in the same order as the
+     * messages, the id of a failed message is the default MessageId.
+     *
+     * @param messages the messages to publish
+     * @param callback the callback to get notification of the completion of all the messages
+     */
+    void sendAsync(std::vector<Message>&& messages, const BatchSendCallback& callback);
+
     /**
      * Flush all the messages buffered in the client and wait until all messages have been successfully
      * persisted.
@@ -26,6 +26,7 @@
 #include <pulsar/ProducerInterceptor.h>
 #include <pulsar/Result.h>
 #include <pulsar/Schema.h>
+#include <pulsar/ZstdDictionary.h>
 #include <pulsar/defines.h>
 
 #include <cstdint>
@@ -199,6 +200,72 @@ class PULSAR_PUBLIC ProducerConfiguration {
      */
     CompressionType getCompressionType() const;
 
+    /**
+     * Set the compression level of the compression type. <i>Default value: 0, which uses the default level
+     * of the codec.</i>
+     *
+     * The meaning of the level depends on the compression type:
+     * - CompressionZLib: from 1 (fastest) to 9 (best compression), the default level is 6.
+     * - CompressionZSTD: from ZSTD_minCLevel() to ZSTD_maxCLevel(), the default level is 3. The negative
+     * levels are faster but compress less.
+     * - CompressionLZ4: a negative level -N sets the acceleration to N, which is faster but compresses less.
+     * The positive levels are the same as the default level.
+     * - CompressionNone and CompressionSNAPPY: the level is ignored.
+     *
+     * The levels out of the range of the codec are clamped to the range.
+     *
+     * @param compressionLevel the compression level
+     */
+    ProducerConfiguration& setCompressionLevel(int compressionLevel);
+
+    /**
+     * The getter associated with setCompressionLevel().
+     */
+    int getCompressionLevel() const;
+
+    /**
+     * Set the CPU budget of the automatic compression, in nanoseconds per uncompressed byte. <i>Default
+     * value: 0, which disables the automatic compression.</i>
+     *
+     * When it's greater than 0, the compression type and level configured by setCompressionType and
+     * setCompressionLevel are not used for the batches. Instead, the producer periodically compresses a
+     * sample batch with each combination of codec and level that is supported by this library, and measures
+     * the compression ratio and the time spent compressing it. The following batches are compressed with the
+     * combination that produces the smallest payloads while costing no more than the budget, or not
+     * compressed if no combination fits. The messages that are not batched still use the configured
+     * compression type and level.
+     *
+     * For example, a budget of 2 nanoseconds per byte allows the codecs that compress at 500 MB/s at least.
+     * The consumer applications must support all the codecs that could be chosen. The chosen combination is
+     * reported in the producer stats.
+     *
+     * @param nanosPerByte the max time spent compressing each uncompressed byte of the batches
+     * @throws std::invalid_argument if nanosPerByte is negative
+     */
+    ProducerConfiguration& setAutoCompressionCpuBudget(double nanosPerByte);
+
+    /**
+     * The getter associated with setAutoCompressionCpuBudget().
+     */
+    double getAutoCompressionCpuBudget() const;
+
+    /**
+     * Set the dictionary to compress the batches when the compression type is CompressionZSTD. By default,
+     * no dictionary is used.
+     *
+     * The id of the dictionary is added to the metadata of each batch, the consumers must add the same
+     * dictionary by ConsumerConfiguration::addZstdDictionary. The messages that are not batched are
+     * compressed without the dictionary.
+     *
+     * @param dictionary the dictionary, or null to compress without dictionary
+     */
+    ProducerConfiguration& setZstdDictionary(ZstdDictionaryPtr dictionary);
+
+    /**
+     * The getter associated with setZstdDictionary().
+     */
+    const ZstdDictionaryPtr& getZstdDictionary() const;
+
     /**
      * Set the max size of the queue holding the messages pending to receive an acknowledgment from the
      * broker. <p> When the queue is full, by default, all calls to Producer::send and Producer::sendAsync
@@ -319,6 +386,43 @@ class PULSAR_PUBLIC ProducerConfiguration {
      */
     bool getBlockIfQueueFull() const;
 
+    /**
+     * Set the directory of the spool files, which hold the messages that are published while the producer is
+     * disconnected from the broker. <i>Default value: empty, which disables the spool.</i>
+     *
+     * While the producer is disconnected, the batches and the messages that are not batched are appended to
+     * a memory-mapped file in this directory instead of being kept in the pending queue, and their spots in
+     * the queue (see setMaxPendingMessages) and their memory are released. So the applications can keep
+     * publishing during a broker outage without blocking or failing, until the spool file is full. After the
+     * producer is reconnected, the spooled messages are sent in order, after the messages of the pending
+     * queue, as the spots in the queue become available.
+     *
+     * The spooled messages are still subject to the send timeout (see setSendTimeout) and their callbacks are
+     * still kept in memory. Each producer creates its own file when it's disconnected for the first time,
+     * the file is deleted when the producer is destroyed. The directory must exist.
+     *
+     * @param directory the directory of the spool files
+     */
+    ProducerConfiguration& setSpoolDirectory(const std::string& directory);
+
+    /**
+     * The getter associated with setSpoolDirectory().
+     */
+    const std::string& getSpoolDirectory() const;
+
+    /**
+     * Set the size of the spool file of each producer, see setSpoolDirectory. When the file is full, the
+     * messages are kept in the pending queue again. <i>Default value: 64 MB.</i>
+     *
+     * @param maxBytes the size of the spool file in bytes
+     */
+    ProducerConfiguration& setSpoolMaxBytes(uint64_t maxBytes);
+
+    /**
+     * The getter associated with setSpoolMaxBytes().
+     */
+    uint64_t getSpoolMaxBytes() const;
+
     // Zero queue size feature will not be supported on consumer end if batching is enabled
 
     /**
@@ -399,6 +503,27 @@ class PULSAR_PUBLIC ProducerConfiguration {
      */
     const unsigned long& getBatchingMaxPublishDelayMs() const;
 
+    /**
+     * Set the latency target of the adaptive batching. <i>Default value: 0, which disables it.</i>
+     *
+     * When it's greater than 0, the delay of each batch is not fixed to the batching max publish delay
+     * anymore. It's chosen from the observed publish rate and the round-trip time of the send receipts, so
+     * that the time from sendAsync to the send receipt stays close to the target:
+     * - If no message is in flight, the batch is sent immediately.
+     * - If no more message is expected before the target is reached, the batch is sent immediately.
+     * - Otherwise, the batch waits for the target minus the round-trip time, and at most the batching max
+     * publish delay.
+     *
+     * @param batchingLatencyTargetMs the latency target in milliseconds
+     * @see ProducerConfiguration::setBatchingMaxPublishDelayMs
+     */
+    ProducerConfiguration& setBatchingLatencyTargetMs(unsigned long batchingLatencyTargetMs);
+
+    /**
+     * The getter associated with setBatchingLatencyTargetMs().
+     */
+    unsigned long getBatchingLatencyTargetMs() const;
+
     /**
      * Default: DefaultBatching
      *
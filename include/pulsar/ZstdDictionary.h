@@ -0,0 +1,96 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef PULSAR_ZSTDDICTIONARY_H_
+#define PULSAR_ZSTDDICTIONARY_H_
+
+#include <pulsar/defines.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pulsar {
+
+class ZstdDictionary;
+typedef std::shared_ptr<const ZstdDictionary> ZstdDictionaryPtr;
+struct ZstdDictionaryImpl;
+
+/**
+ * A dictionary for the ZSTD compression.
+ *
+ * Small payloads, e.g. batches of a few hundreds of bytes of JSON, have few repetitions by themselves, so
+ * they are poorly compressed. A dictionary trained from typical payloads provides the common content, which
+ * improves the compression ratio a lot.
+ *
+ * The producer compresses its batches with the dictionary configured by
+ * ProducerConfiguration::setZstdDictionary and advertises the dictionary id in the message metadata. The
+ * consumer must have the dictionary with the same id, see ConsumerConfiguration::addZstdDictionary.
+ *
+ * All the factory methods throw std::runtime_error if the library is built without ZSTD.
+ */
+class PULSAR_PUBLIC ZstdDictionary {
+   public:
+    /**
+     * Train a dictionary from sampled payloads.
+     *
+     * The samples should be representative of the messages to compress. ZSTD recommends to provide about 100
+     * times as many bytes of samples as the size of the dictionary.
+     *
+     * @param samples the sampled payloads
+     * @param maxSize the max size in bytes of the dictionary
+     * @throws std::invalid_argument if the dictionary cannot be trained, e.g. there are too few samples
+     */
+    static ZstdDictionaryPtr train(const std::vector<std::string>& samples, size_t maxSize = 16 * 1024);
+
+    /**
+     * Create a dictionary from its content, e.g. the output of `zstd --train`.
+     *
+     * @throws std::invalid_argument if the content is not a ZSTD dictionary, whose id is not 0
+     */
+    static ZstdDictionaryPtr create(const std::string& content);
+
+    /**
+     * Load a dictionary from a file, e.g. the output of `zstd --train`.
+     *
+     * @throws std::invalid_argument if the file cannot be read or is not a ZSTD dictionary
+     */
+    static ZstdDictionaryPtr load(const std::string& path);
+
+    /**
+     * @return the id of the dictionary, which is used by the consumers to find the dictionary
+     */
+    uint32_t getId() const noexcept;
+
+    /**
+     * @return the content of the dictionary, which can be saved and loaded by ZstdDictionary::create
+     */
+    const std::string& getContent() const noexcept;
+
+   private:
+    std::shared_ptr<ZstdDictionaryImpl> impl_;
+
+    explicit ZstdDictionary(std::shared_ptr<ZstdDictionaryImpl> impl);
+
+    friend class CompressionCodecZstd;
+};
+
+}  // namespace pulsar
+
+#endif /* PULSAR_ZSTDDICTIONARY_H_ */
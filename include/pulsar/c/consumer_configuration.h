@@ -200,6 +200,86 @@ PULSAR_PUBLIC void pulsar_consumer_set_max_total_receiver_queue_size_across_part
 PULSAR_PUBLIC int pulsar_consumer_get_max_total_receiver_queue_size_across_partitions(
     pulsar_consumer_configuration_t *consumer_configuration);
 
+/**
+ * Enable the auto-scaling of the receiver queue size between the min receiver queue size and the receiver
+ * queue size, based on the consumption rate and the round trip time of the flow permits (default: false).
+ *
+ * @param consumer_configuration the consumer conf object
+ * @param enabled whether the receiver queue size is auto-scaled
+ */
+PULSAR_PUBLIC void pulsar_consumer_configuration_set_auto_scaled_receiver_queue_size_enabled(
+    pulsar_consumer_configuration_t *consumer_configuration, int enabled);
+
+/**
+ * @return whether the receiver queue size is auto-scaled
+ */
+PULSAR_PUBLIC int pulsar_consumer_configuration_is_auto_scaled_receiver_queue_size_enabled(
+    pulsar_consumer_configuration_t *consumer_configuration);
+
+/**
+ * Set the min receiver queue size when it's auto-scaled, which is also the initial size (default: 1).
+ *
+ * @param consumer_configuration the consumer conf object
+ * @param minReceiverQueueSize the min receiver queue size
+ */
+PULSAR_PUBLIC void pulsar_consumer_configuration_set_min_receiver_queue_size(
+    pulsar_consumer_configuration_t *consumer_configuration, int minReceiverQueueSize);
+
+/**
+ * @return the min receiver queue size when it's auto-scaled
+ */
+PULSAR_PUBLIC int pulsar_consumer_configuration_get_min_receiver_queue_size(
+    pulsar_consumer_configuration_t *consumer_configuration);
+
+/**
+ * Set the max bytes of the messages in the receiver queue when its size is auto-scaled (default: 0, which
+ * means no limit).
+ *
+ * @param consumer_configuration the consumer conf object
+ * @param maxReceiverQueueBytes the max bytes of the messages in the receiver queue
+ */
+PULSAR_PUBLIC void pulsar_consumer_configuration_set_max_receiver_queue_bytes(
+    pulsar_consumer_configuration_t *consumer_configuration, long maxReceiverQueueBytes);
+
+/**
+ * @return the max bytes of the messages in the receiver queue when its size is auto-scaled
+ */
+PULSAR_PUBLIC long pulsar_consumer_configuration_get_max_receiver_queue_bytes(
+    pulsar_consumer_configuration_t *consumer_configuration);
+
+/**
+ * Set the time in microseconds that a blocking receive spins, checking the receiver queue, before the
+ * thread is parked until a message arrives (default: 0, which parks the thread immediately).
+ *
+ * @param consumer_configuration the consumer conf object
+ * @param receiveSpinTimeUs the spin time in microseconds
+ * @return 0 on success and -1 if receiveSpinTimeUs is negative
+ */
+PULSAR_PUBLIC int pulsar_consumer_configuration_set_receive_spin_time_us(
+    pulsar_consumer_configuration_t *consumer_configuration, long receiveSpinTimeUs);
+
+/**
+ * @return the time in microseconds that a blocking receive spins before the thread is parked
+ */
+PULSAR_PUBLIC long pulsar_consumer_configuration_get_receive_spin_time_us(
+    pulsar_consumer_configuration_t *consumer_configuration);
+
+/**
+ * Set the number of lanes that run the message listener in parallel (default: 1). The messages with the same
+ * ordering key, or partition key, are processed in order by the same lane.
+ *
+ * @param consumer_configuration the consumer conf object
+ * @param messageListenerLanes the number of lanes
+ */
+PULSAR_PUBLIC void pulsar_consumer_configuration_set_message_listener_lanes(
+    pulsar_consumer_configuration_t *consumer_configuration, int messageListenerLanes);
+
+/**
+ * @return the number of lanes that run the message listener in parallel
+ */
+PULSAR_PUBLIC int pulsar_consumer_configuration_get_message_listener_lanes(
+    pulsar_consumer_configuration_t *consumer_configuration);
+
 PULSAR_PUBLIC void pulsar_consumer_set_consumer_name(pulsar_consumer_configuration_t *consumer_configuration,
                                                      const char *consumerName);
 
@@ -31,6 +31,8 @@ extern "C" {
 typedef struct _pulsar_producer pulsar_producer_t;
 
 typedef void (*pulsar_send_callback)(pulsar_result, pulsar_message_id_t *msgId, void *ctx);
+typedef void (*pulsar_send_batch_callback)(pulsar_result, pulsar_message_id_t **msgIds, int numMessages,
+                                           void *ctx);
 typedef void (*pulsar_close_callback)(pulsar_result, void *ctx);
 typedef void (*pulsar_flush_callback)(pulsar_result, void *ctx);
 
@@ -79,6 +81,24 @@ PULSAR_PUBLIC pulsar_result pulsar_producer_send(pulsar_producer_t *producer, pu
 PULSAR_PUBLIC void pulsar_producer_send_async(pulsar_producer_t *producer, pulsar_message_t *msg,
                                               pulsar_send_callback callback, void *ctx);
 
+/**
+ * Asynchronously publish multiple messages on the topic associated with this Producer.
+ *
+ * It's the same as calling pulsar_producer_send_async for each message in order, except that the callback
+ * is triggered once, when all the messages have been persisted or failed.
+ *
+ * The callback receives the message ids in the same order as the messages. The id of a failed message is
+ * NULL, the other ids must be freed by pulsar_message_id_free. The array itself is freed after the callback
+ * returns.
+ *
+ * @param msgs the messages to publish
+ * @param numMessages the number of messages
+ * @param callback the callback to get notification of the completion of all the messages
+ */
+PULSAR_PUBLIC void pulsar_producer_send_batch_async(pulsar_producer_t *producer, pulsar_message_t **msgs,
+                                                    int numMessages, pulsar_send_batch_callback callback,
+                                                    void *ctx);
+
 /**
  * Get the last sequence id that was published by this producer.
  *
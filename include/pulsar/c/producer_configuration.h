@@ -179,6 +179,18 @@ PULSAR_PUBLIC void pulsar_producer_configuration_set_block_if_queue_full(
 PULSAR_PUBLIC int pulsar_producer_configuration_get_block_if_queue_full(
     pulsar_producer_configuration_t *conf);
 
+PULSAR_PUBLIC void pulsar_producer_configuration_set_spool_directory(pulsar_producer_configuration_t *conf,
+                                                                   const char *directory);
+
+PULSAR_PUBLIC const char *pulsar_producer_configuration_get_spool_directory(
+    pulsar_producer_configuration_t *conf);
+
+PULSAR_PUBLIC void pulsar_producer_configuration_set_spool_max_bytes(pulsar_producer_configuration_t *conf,
+                                                                   uint64_t maxBytes);
+
+PULSAR_PUBLIC uint64_t
+pulsar_producer_configuration_get_spool_max_bytes(pulsar_producer_configuration_t *conf);
+
 // Zero queue size feature will not be supported on consumer end if batching is enabled
 PULSAR_PUBLIC void pulsar_producer_configuration_set_batching_enabled(pulsar_producer_configuration_t *conf,
                                                                       int batchingEnabled);
@@ -203,6 +215,23 @@ PULSAR_PUBLIC void pulsar_producer_configuration_set_batching_max_publish_delay_
 PULSAR_PUBLIC unsigned long pulsar_producer_configuration_get_batching_max_publish_delay_ms(
     pulsar_producer_configuration_t *conf);
 
+PULSAR_PUBLIC void pulsar_producer_configuration_set_compression_level(pulsar_producer_configuration_t *conf,
+                                                                     int compressionLevel);
+
+PULSAR_PUBLIC int pulsar_producer_configuration_get_compression_level(pulsar_producer_configuration_t *conf);
+
+PULSAR_PUBLIC void pulsar_producer_configuration_set_auto_compression_cpu_budget(
+    pulsar_producer_configuration_t *conf, double nanosPerByte);
+
+PULSAR_PUBLIC double pulsar_producer_configuration_get_auto_compression_cpu_budget(
+    pulsar_producer_configuration_t *conf);
+
+PULSAR_PUBLIC void pulsar_producer_configuration_set_batching_latency_target_ms(
+    pulsar_producer_configuration_t *conf, unsigned long batchingLatencyTargetMs);
+
+PULSAR_PUBLIC unsigned long pulsar_producer_configuration_get_batching_latency_target_ms(
+    pulsar_producer_configuration_t *conf);
+
 PULSAR_PUBLIC void pulsar_producer_configuration_set_property(pulsar_producer_configuration_t *conf,
                                                               const char *name, const char *value);
 
@@ -67,7 +67,8 @@ void AckGroupingTracker::doImmediateAck(const MessageId& msgId, const ResultCall
                 }
             });
     } else {
-        cnx->sendCommand(Commands::newAck(consumerId_, msgId.ledgerId(), msgId.entryId(), ackSet, ackType));
+        cnx->sendControlCommand(
+            Commands::newAck(consumerId_, msgId.ledgerId(), msgId.entryId(), ackSet, ackType));
         if (callback) {
             callback(ResultOk);
         }
@@ -120,7 +121,7 @@ void AckGroupingTracker::doImmediateAck(const std::set<MessageId>& msgIds,
                     }
                 });
         } else {
-            cnx->sendCommand(Commands::newMultiMessageAck(consumerId_, ackMsgIds));
+            cnx->sendControlCommand(Commands::newMultiMessageAck(consumerId_, ackMsgIds));
             if (callback) {
                 callback(ResultOk);
             }
@@ -119,11 +119,7 @@ void AckGroupingTrackerEnabled::addAcknowledgeCumulative(const MessageId& msgId,
 AckGroupingTrackerEnabled::~AckGroupingTrackerEnabled() {
     isClosed_ = true;
     this->flush();
-    std::lock_guard<std::mutex> lock(this->mutexTimer_);
-    if (this->timer_) {
-        ASIO_ERROR ec;
-        this->timer_->cancel(ec);
-    }
+    this->timer_.cancel();
 }
 
 void AckGroupingTrackerEnabled::flush() {
@@ -170,13 +166,11 @@ void AckGroupingTrackerEnabled::scheduleTimer() {
         return;
     }
 
-    std::lock_guard<std::mutex> lock(this->mutexTimer_);
-    this->timer_ = this->executor_->createDeadlineTimer();
-    this->timer_->expires_from_now(std::chrono::milliseconds(std::max(1L, this->ackGroupingTimeMs_)));
     std::weak_ptr<AckGroupingTracker> weakSelf = shared_from_this();
-    this->timer_->async_wait([this, weakSelf](const ASIO_ERROR& ec) -> void {
+    const auto delay = std::chrono::milliseconds(std::max(1L, this->ackGroupingTimeMs_));
+    this->timer_.expiresAfter(delay, [this, weakSelf] {
         auto self = weakSelf.lock();
-        if (self && !ec) {
+        if (self) {
             this->flush();
             this->scheduleTimer();
         }
@@ -27,14 +27,12 @@
 #include <set>
 
 #include "AckGroupingTracker.h"
-#include "AsioTimer.h"
+#include "TimingWheel.h"
 
 namespace pulsar {
 
 class ClientImpl;
 using ClientImplPtr = std::shared_ptr<ClientImpl>;
-class ExecutorService;
-using ExecutorServicePtr = std::shared_ptr<ExecutorService>;
 class HandlerBase;
 using HandlerBasePtr = std::shared_ptr<HandlerBase>;
 using HandlerBaseWeakPtr = std::weak_ptr<HandlerBase>;
@@ -52,7 +50,8 @@ class AckGroupingTrackerEnabled : public AckGroupingTracker {
         : AckGroupingTracker(connectionSupplier, requestIdSupplier, consumerId, waitResponse),
           ackGroupingTimeMs_(ackGroupingTimeMs),
           ackGroupingMaxSize_(ackGroupingMaxSize),
-          executor_(executor) {
+          executor_(executor),
+          timer_(executor) {
         pendingIndividualCallbacks_.reserve(ackGroupingMaxSize);
     }
 
@@ -93,9 +92,8 @@ class AckGroupingTrackerEnabled : public AckGroupingTracker {
     //! ACK request sender's scheduled executor.
     const ExecutorServicePtr executor_;
 
-    //! Pointer to a deadline timer.
-    DeadlineTimerPtr timer_;
-    std::mutex mutexTimer_;
+    //! Grouping timer, which is restarted after each flush.
+    WheelTimer timer_;
 };  // class AckGroupingTrackerEnabled
 
 }  // namespace pulsar
@@ -0,0 +1,62 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "AdaptiveBatchingDelay.h"
+
+#include <algorithm>
+
+namespace pulsar {
+
+// The weight of a new sample is 1/8, which is the same as TCP's smoothed RTT
+static TimeDuration smooth(TimeDuration average, TimeDuration sample) {
+    return average + (sample - average) / 8;
+}
+
+AdaptiveBatchingDelay::AdaptiveBatchingDelay(TimeDuration latencyTarget, TimeDuration maxDelay)
+    : latencyTarget_(latencyTarget), maxDelay_(maxDelay) {}
+
+void AdaptiveBatchingDelay::onMessageArrived(ptime now) noexcept {
+    if (arrived_) {
+        // An interval longer than the target has the same effect as the target itself, capping it lets the
+        // average follow a burst right after an idle period
+        const auto interval = std::min<TimeDuration>(now - lastArrival_, latencyTarget_);
+        arrivalInterval_ = (arrivalInterval_.count() < 0) ? interval : smooth(arrivalInterval_, interval);
+    }
+    arrived_ = true;
+    lastArrival_ = now;
+}
+
+void AdaptiveBatchingDelay::onAckReceived(TimeDuration roundTripTime) noexcept {
+    roundTripTime_ = (roundTripTime_.count() == 0) ? roundTripTime : smooth(roundTripTime_, roundTripTime);
+}
+
+TimeDuration AdaptiveBatchingDelay::nextDelay(bool idle) const noexcept {
+    if (idle || arrivalInterval_.count() < 0) {
+        return TimeDuration::zero();
+    }
+    // If the round-trip time already exceeds the target, keep batching a little anyway. Otherwise each
+    // message would be sent alone, which makes the broker even slower to respond.
+    const auto budget = std::max<TimeDuration>(latencyTarget_ - roundTripTime_, latencyTarget_ / 10);
+    if (arrivalInterval_ >= budget) {
+        // The next message is not expected before the budget is spent
+        return TimeDuration::zero();
+    }
+    return std::min(budget, maxDelay_);
+}
+
+}  // namespace pulsar
@@ -0,0 +1,74 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef LIB_ADAPTIVEBATCHINGDELAY_H_
+#define LIB_ADAPTIVEBATCHINGDELAY_H_
+
+#include "TimeUtils.h"
+
+namespace pulsar {
+
+/**
+ * Choose the delay of each batch from the observed message arrival rate and the round-trip time of the sent
+ * batches, so that the time from sendAsync to the send receipt stays close to a latency target.
+ *
+ * A batch is only worth waiting for if another message is expected before the latency budget, i.e. the target
+ * minus the round-trip time, is spent. Otherwise, the batch is flushed immediately. The round-trip time and
+ * the interval between two messages are exponentially weighted moving averages, like TCP's smoothed RTT.
+ *
+ * It's not thread safe, the producer calls it while its mutex is acquired.
+ */
+class AdaptiveBatchingDelay {
+   public:
+    /**
+     * @param latencyTarget the expected time from sendAsync to the send receipt
+     * @param maxDelay the upper bound of the delays
+     */
+    AdaptiveBatchingDelay(TimeDuration latencyTarget, TimeDuration maxDelay);
+
+    // Record a message added to a batch at `now`
+    void onMessageArrived(ptime now) noexcept;
+
+    // Record the time between the creation of an OpSendMsg and its send receipt
+    void onAckReceived(TimeDuration roundTripTime) noexcept;
+
+    /**
+     * Get the delay of a new batch, it's called when the first message is added to the batch.
+     *
+     * @param idle whether no message is in flight, in this case the batch is flushed immediately
+     * @return the delay before the batch is flushed, 0 if it should be flushed immediately
+     */
+    TimeDuration nextDelay(bool idle) const noexcept;
+
+    TimeDuration roundTripTime() const noexcept { return roundTripTime_; }
+    TimeDuration arrivalInterval() const noexcept { return arrivalInterval_; }
+
+   private:
+    const TimeDuration latencyTarget_;
+    const TimeDuration maxDelay_;
+
+    bool arrived_ = false;
+    ptime lastArrival_;
+    // It's negative until two messages have arrived
+    TimeDuration arrivalInterval_{-1};
+    TimeDuration roundTripTime_{0};
+};
+
+}  // namespace pulsar
+
+#endif /* LIB_ADAPTIVEBATCHINGDELAY_H_ */
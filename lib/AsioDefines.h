@@ -20,13 +20,20 @@
 #pragma once
 
 #ifdef USE_ASIO
+#include <asio/detail/config.hpp>
 #define ASIO ::asio
 #define ASIO_ERROR asio::error_code
 #define ASIO_SUCCESS (ASIO_ERROR{})
 #define ASIO_SYSTEM_ERROR asio::system_error
 #else
+#include <boost/asio/detail/config.hpp>
 #define ASIO boost::asio
 #define ASIO_ERROR boost::system::error_code
 #define ASIO_SUCCESS boost::system::errc::make_error_code(boost::system::errc::success)
 #define ASIO_SYSTEM_ERROR boost::system::system_error
 #endif
+
+// Unix domain sockets (ASIO::local::stream_protocol) are not available on all platforms
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS) || defined(ASIO_HAS_LOCAL_SOCKETS)
+#define PULSAR_HAS_UNIX_SOCKETS
+#endif
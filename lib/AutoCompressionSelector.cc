@@ -0,0 +1,141 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "AutoCompressionSelector.h"
+
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+#include <exception>
+
+#include "CompressionCodec.h"
+#include "LogUtils.h"
+#include "SharedBuffer.h"
+
+DECLARE_LOG_OBJECT()
+
+namespace pulsar {
+
+// The first candidate is not compressing, which costs nothing. The levels of each codec go from the fastest
+// one to the ones that are still fast enough to compress the batches in the producer.
+static const AutoCompressionSelector::Choice candidateChoices[] = {
+    {CompressionNone, 0}, {CompressionLZ4, 0},  {CompressionSNAPPY, 0}, {CompressionZLib, 1},
+    {CompressionZLib, 6}, {CompressionZSTD, 1}, {CompressionZSTD, 3},   {CompressionZSTD, 9}};
+
+// The weight of a new sample is 1/4, so that the averages follow a change of the payloads in a few samples
+static double smooth(double average, double sample) { return average + (sample - average) / 4; }
+
+// The CPU time of the calling thread, so that the cost of a sample does not include the time the thread is
+// preempted by the other threads, e.g. the other compression threads or the application threads
+static TimeDuration threadCpuTime() {
+#ifndef _WIN32
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+    }
+#endif
+    return TimeUtils::now().time_since_epoch();
+}
+
+AutoCompressionSelector::AutoCompressionSelector(double cpuBudget, TimeDuration sampleInterval,
+                                                 ChoiceListener listener)
+    : cpuBudget_(cpuBudget), sampleInterval_(sampleInterval), listener_(std::move(listener)) {
+    candidates_.reserve(sizeof(candidateChoices) / sizeof(candidateChoices[0]));
+    for (const auto& choice : candidateChoices) {
+        candidates_.emplace_back(choice);
+    }
+}
+
+AutoCompressionSelector::Choice AutoCompressionSelector::choose(const SharedBuffer& payload) {
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (lock.owns_lock() && payload.readableBytes() > 0) {
+        const auto now = TimeUtils::now();
+        if (!sampled_ || now - lastSampleTime_ >= sampleInterval_) {
+            sampled_ = true;
+            lastSampleTime_ = now;
+            sample(payload);
+
+            const auto previousChoice = choice_.load();
+            const auto newChoice = select();
+            if (newChoice != previousChoice) {
+                choice_ = newChoice;
+                const auto& candidate = candidates_[newChoice];
+                LOG_INFO("Choose the compression type "
+                         << CompressionCodecProvider::getName(candidate.choice.type) << " with level "
+                         << candidate.choice.level << ", ratio: " << candidate.ratio
+                         << ", cost: " << candidate.nanosPerByte << " ns/byte");
+                if (listener_) {
+                    listener_(candidate.choice);
+                }
+            }
+        }
+    }
+    return getChoice();
+}
+
+void AutoCompressionSelector::sample(const SharedBuffer& payload) {
+    const auto size = static_cast<double>(payload.readableBytes());
+    for (auto& candidate : candidates_) {
+        if (!candidate.supported || candidate.choice.type == CompressionNone) {
+            continue;
+        }
+        const auto start = threadCpuTime();
+        SharedBuffer compressed;
+        try {
+            compressed = CompressionCodecProvider::getCodec(candidate.choice.type)
+                             .encodeWithLevel(payload, candidate.choice.level);
+        } catch (const std::exception& e) {
+            LOG_DEBUG("Skip the compression type " << CompressionCodecProvider::getName(candidate.choice.type)
+                                                   << ": " << e.what());
+            candidate.supported = false;
+            continue;
+        }
+        const auto elapsed = threadCpuTime() - start;
+
+        const double ratio = compressed.readableBytes() / size;
+        const double nanosPerByte = elapsed.count() / size;
+        if (candidate.sampled) {
+            candidate.ratio = smooth(candidate.ratio, ratio);
+            candidate.nanosPerByte = smooth(candidate.nanosPerByte, nanosPerByte);
+        } else {
+            candidate.sampled = true;
+            candidate.ratio = ratio;
+            candidate.nanosPerByte = nanosPerByte;
+        }
+    }
+}
+
+size_t AutoCompressionSelector::select() const {
+    size_t best = 0;  // not compressing
+    for (size_t i = 1; i < candidates_.size(); i++) {
+        const auto& candidate = candidates_[i];
+        if (!candidate.supported || !candidate.sampled || candidate.nanosPerByte > cpuBudget_) {
+            continue;
+        }
+        // A tie is won by the cheaper candidate
+        if (candidate.ratio < candidates_[best].ratio ||
+            (candidate.ratio == candidates_[best].ratio &&
+             candidate.nanosPerByte < candidates_[best].nanosPerByte)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+}  // namespace pulsar
@@ -0,0 +1,103 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef LIB_AUTOCOMPRESSIONSELECTOR_H_
+#define LIB_AUTOCOMPRESSIONSELECTOR_H_
+
+#include <pulsar/CompressionType.h>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "TimeUtils.h"
+
+namespace pulsar {
+
+class SharedBuffer;
+
+/**
+ * Choose the compression type and level of the batches when the automatic compression is enabled, see
+ * ProducerConfiguration::setAutoCompressionCpuBudget.
+ *
+ * Once per sample interval, a batch payload is compressed with each candidate combination of codec and level.
+ * The compression ratio and the cost in nanoseconds per uncompressed byte of each candidate are averaged over
+ * the samples. The chosen candidate is the one with the smallest compressed size among the candidates whose
+ * cost is within the CPU budget. Not compressing always fits, so it's chosen if nothing compresses better.
+ * The cost is measured with the CPU time of the sampling thread, so a busy host doesn't inflate it.
+ *
+ * The candidates whose codecs are not built in this library are skipped after their first sample.
+ *
+ * It's thread safe because the batches could be compressed by multiple compression threads. Only one thread
+ * samples at a time, the batches compressed meanwhile use the previous choice.
+ */
+class AutoCompressionSelector {
+   public:
+    struct Choice {
+        CompressionType type;
+        int level;
+    };
+    using ChoiceListener = std::function<void(const Choice&)>;
+
+    /**
+     * @param cpuBudget the max cost of the chosen candidate in nanoseconds per uncompressed byte
+     * @param sampleInterval the min interval between two samples
+     * @param listener the listener called when the choice changes, it's called in the sampling thread
+     */
+    AutoCompressionSelector(double cpuBudget, TimeDuration sampleInterval,
+                            ChoiceListener listener = nullptr);
+
+    /**
+     * Get the compression type and level to compress a batch payload. If a sample is due, the payload is
+     * compressed with each candidate before the choice is made.
+     */
+    Choice choose(const SharedBuffer& payload);
+
+    Choice getChoice() const noexcept { return candidates_[choice_].choice; }
+
+   private:
+    struct Candidate {
+        const Choice choice;
+        bool supported = true;
+        bool sampled = false;
+        // The compressed size divided by the uncompressed size
+        double ratio = 1.0;
+        double nanosPerByte = 0.0;
+
+        explicit Candidate(Choice choice) : choice(choice) {}
+    };
+
+    const double cpuBudget_;
+    const TimeDuration sampleInterval_;
+    const ChoiceListener listener_;
+
+    // The choices of the candidates are immutable, the measurements are protected by mutex_
+    std::vector<Candidate> candidates_;
+    std::mutex mutex_;
+    bool sampled_ = false;
+    ptime lastSampleTime_;
+    std::atomic_size_t choice_{0};
+
+    void sample(const SharedBuffer& payload);
+    size_t select() const;
+};
+
+}  // namespace pulsar
+
+#endif /* LIB_AUTOCOMPRESSIONSELECTOR_H_ */
@@ -31,14 +31,18 @@ BatchMessageContainerBase::BatchMessageContainerBase(const ProducerImpl& produce
       producerConfig_(producer.conf_),
       producerName_(producer.producerName_),
       producerId_(producer.producerId_),
-      msgCryptoWeakPtr_(producer.msgCrypto_) {}
+      msgCryptoWeakPtr_(producer.msgCrypto_),
+      deferEncoding_(producer.compressionExecutorProvider_ != nullptr),
+      compressionSelector_(producer.autoCompressionSelector_.get()),
+      opSendMsgPool_(producer.opSendMsgPool_) {}
 
 BatchMessageContainerBase::~BatchMessageContainerBase() {}
 
 std::unique_ptr<OpSendMsg> BatchMessageContainerBase::createOpSendMsgHelper(
     MessageAndCallbackBatch& batch) const {
     auto crypto = msgCryptoWeakPtr_.lock();
-    return batch.createOpSendMsg(producerId_, producerConfig_, crypto.get());
+    return batch.createOpSendMsg(opSendMsgPool_, producerId_, producerName_, producerConfig_, crypto.get(),
+                                 compressionSelector_, !deferEncoding_);
 }
 
 }  // namespace pulsar
@@ -29,12 +29,14 @@
 #include <stdexcept>
 #include <vector>
 
+#include "OpSendMsg.h"
+
 namespace pulsar {
 
+class AutoCompressionSelector;
 class MessageCrypto;
 class ProducerImpl;
 class SharedBuffer;
-struct OpSendMsg;
 class MessageAndCallbackBatch;
 
 namespace proto {
@@ -67,7 +69,7 @@ class BatchMessageContainerBase : public boost::noncopyable {
      * @param callback message send callback
      * @return true if the batch is full, otherwise false
      */
-    virtual bool add(const Message& msg, const SendCallback& callback) = 0;
+    virtual bool add(const Message& msg, InlineSendCallback&& callback) = 0;
 
     virtual std::unique_ptr<OpSendMsg> createOpSendMsg(const FlushCallback& flushCallback = nullptr) {
         throw std::runtime_error("createOpSendMsg is not supported");
@@ -95,6 +97,10 @@ class BatchMessageContainerBase : public boost::noncopyable {
     const std::string& producerName_;
     const uint64_t& producerId_;
     const std::weak_ptr<MessageCrypto> msgCryptoWeakPtr_;
+    // Whether the batches are compressed and encrypted by the producer's compression executors
+    const bool deferEncoding_;
+    AutoCompressionSelector* const compressionSelector_;
+    OpSendMsgPool& opSendMsgPool_;
 
     unsigned int getMaxNumMessages() const noexcept { return producerConfig_.getBatchingMaxMessages(); }
     unsigned long getMaxSizeInBytes() const noexcept {
@@ -109,7 +115,7 @@ class BatchMessageContainerBase : public boost::noncopyable {
     void updateStats(const Message& msg);
     void resetStats();
 
-    std::unique_ptr<OpSendMsg> createOpSendMsgHelper(MessageAndCallbackBatch& flushCallback) const;
+    std::unique_ptr<OpSendMsg> createOpSendMsgHelper(MessageAndCallbackBatch& batch) const;
 
     virtual void clear() = 0;
 };
@@ -91,6 +91,15 @@ class BitSet {
      */
     void clear(int32_t bitIndex);
 
+    /**
+     * Returns the index of the first bit that is set to {@code true} that occurs on or after the specified
+     * starting index. If no such bit exists then {@code -1} is returned.
+     *
+     * @param  fromIndex the index to start checking from (inclusive)
+     * @return the index of the next set bit, or {@code -1} if there is no such bit
+     */
+    int32_t nextSetBit(int32_t fromIndex) const;
+
    private:
     Data words_;
     int32_t wordsInUse_ = 0;
@@ -128,6 +137,35 @@ class BitSet {
         wordsInUse_ = i + 1;
     }
 
+    static int32_t numberOfTrailingZeros(uint64_t i) {
+        auto x = static_cast<uint32_t>(i);
+        return x == 0 ? 32 + numberOfTrailingZeros(static_cast<uint32_t>(i >> 32)) : numberOfTrailingZeros(x);
+    }
+
+    static int32_t numberOfTrailingZeros(uint32_t i) {
+        if (i == 0) {
+            return 32;
+        }
+        int32_t n = 0;
+        if ((i & 0xffff) == 0) {
+            n += 16;
+            i >>= 16;
+        }
+        if ((i & 0xff) == 0) {
+            n += 8;
+            i >>= 8;
+        }
+        if ((i & 0xf) == 0) {
+            n += 4;
+            i >>= 4;
+        }
+        if ((i & 0x3) == 0) {
+            n += 2;
+            i >>= 2;
+        }
+        return n + ((i & 1) ^ 1);
+    }
+
     static int32_t numberOfLeadingZeros(uint64_t i) {
         auto x = static_cast<uint32_t>(i >> 32);
         return x == 0 ? 32 + numberOfLeadingZeros(static_cast<uint32_t>(i)) : numberOfLeadingZeros(x);
@@ -264,4 +302,24 @@ inline void BitSet::clear(int32_t bitIndex) {
     recalculateWordsInUse();
 }
 
+inline int32_t BitSet::nextSetBit(int32_t fromIndex) const {
+    assert(fromIndex >= 0);
+
+    auto u = wordIndex(fromIndex);
+    if (u >= wordsInUse_) {
+        return -1;
+    }
+
+    auto word = words_[u] & safeLeftShift(WORD_MASK, fromIndex);
+    while (true) {
+        if (word != 0) {
+            return (u * BITS_PER_WORD) + numberOfTrailingZeros(word);
+        }
+        if (++u == wordsInUse_) {
+            return -1;
+        }
+        word = words_[u];
+    }
+}
+
 }  // namespace pulsar
@@ -84,6 +84,16 @@ ClientConfiguration& ClientConfiguration::setMessageListenerThreads(int threads)
 
 int ClientConfiguration::getMessageListenerThreads() const { return impl_->messageListenerThreads; }
 
+ClientConfiguration& ClientConfiguration::setCompressionThreads(int threads) {
+    if (threads < 0) {
+        throw std::invalid_argument("compressionThreads should be greater than or equal to 0");
+    }
+    impl_->compressionThreads = threads;
+    return *this;
+}
+
+int ClientConfiguration::getCompressionThreads() const { return impl_->compressionThreads; }
+
 ClientConfiguration& ClientConfiguration::setUseTls(bool useTls) {
     impl_->useTls = useTls;
     return *this;
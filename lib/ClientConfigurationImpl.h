@@ -32,6 +32,7 @@ struct ClientConfigurationImpl {
     int connectionsPerBroker{1};
     std::chrono::nanoseconds operationTimeout{30LL * 1000 * 1000 * 1000};
     int messageListenerThreads{1};
+    int compressionThreads{0};
     int concurrentLookupRequest{50000};
     int maxLookupRedirects{20};
     int initialBackoffIntervalMs{100};
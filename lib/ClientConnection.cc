@@ -23,6 +23,7 @@
 
 #include <boost/optional.hpp>
 #include <fstream>
+#include <thread>
 
 #include "AsioDefines.h"
 #include "ClientConnectionAdaptor.h"
@@ -35,6 +36,7 @@
 #include "OpSendMsg.h"
 #include "ProducerImpl.h"
 #include "PulsarApi.pb.h"
+#include "PulsarScheme.h"
 #include "ResultUtils.h"
 #include "Url.h"
 #include "auth/AuthOauth2.h"
@@ -50,6 +52,36 @@ namespace pulsar {
 using proto::BaseCommand;
 
 static const uint32_t DefaultBufferSize = 64 * 1024;
+// The read buffers are pooled in size classes from DefaultBufferSize to MaxReadBufferSize, larger frames are
+// read into dedicated buffers
+static const uint32_t MaxReadBufferSize = 1024 * 1024;
+static const size_t MaxIdleReadBytesPerClass = 256 * 1024;
+// Size of the first block of the arena used to decode the incoming frames
+static const size_t IncomingArenaBlockSize = 16 * 1024;
+
+static google::protobuf::ArenaOptions incomingArenaOptions(char* initialBlock) {
+    google::protobuf::ArenaOptions options;
+    options.initial_block = initialBlock;
+    options.initial_block_size = IncomingArenaBlockSize;
+    options.start_block_size = IncomingArenaBlockSize;
+    return options;
+}
+
+// Bounds of a single gathered write. asio passes at most 64 buffers to one writev() call.
+static const size_t MaxWriteBatchBuffers = 64;
+static const size_t MaxWriteBatchBytes = 1024 * 1024;
+
+// The buffers of the emptied SEND lanes kept for the next lanes
+static const size_t MaxSpareSendLanes = 16;
+
+// The SEND lanes keep their capacity, so that staging the frames does not allocate once it's large enough
+template <typename T, typename Value>
+static void pushBackGrowing(boost::circular_buffer<T>& buffer, Value&& value) {
+    if (buffer.full()) {
+        buffer.set_capacity(std::max<size_t>(buffer.capacity() * 2, 16));
+    }
+    buffer.push_back(std::forward<Value>(value));
+}
 
 static MessageId toMessageId(const proto::MessageIdData& messageIdData) {
     return MessageIdBuilder::from(messageIdData).build();
@@ -180,7 +212,11 @@ ClientConnection::ClientConnection(const std::string& logicalAddress, const std:
       logicalAddress_(logicalAddress),
       physicalAddress_(physicalAddress),
       cnxString_("[<none> -> " + physicalAddress + "] "),
-      incomingBuffer_(SharedBuffer::allocate(DefaultBufferSize)),
+      readBufferPool_(
+          SharedBufferPool::create(DefaultBufferSize, MaxReadBufferSize, MaxIdleReadBytesPerClass)),
+      readBufferSize_(DefaultBufferSize, MaxReadBufferSize),
+      incomingArenaBlock_(new char[IncomingArenaBlockSize]),
+      incomingArena_(incomingArenaOptions(incomingArenaBlock_.get())),
       connectTimeoutTask_(
           std::make_shared<PeriodicTask>(*executor_, clientConfiguration.getConnectionTimeout())),
       outgoingBuffer_(SharedBuffer::allocate(DefaultBufferSize)),
@@ -191,6 +227,8 @@ ClientConnection::ClientConnection(const std::string& logicalAddress, const std:
       pool_(pool),
       poolIndex_(poolIndex) {
     LOG_INFO(cnxString_ << "Create ClientConnection, timeout=" << clientConfiguration.getConnectionTimeout());
+    incomingBuffer_ = readBufferPool_->acquire();
+    outgoingBuffers_.reserve(MaxWriteBatchBuffers);
     if (!authentication_) {
         LOG_ERROR("Invalid authentication plugin");
         throw ResultAuthenticationError;
@@ -205,6 +243,19 @@ ClientConnection::ClientConnection(const std::string& logicalAddress, const std:
         oauth2Auth->getAuthData(authData);
     }
 
+    if (scheme::isUnixSocketAddress(physicalAddress)) {
+#ifdef PULSAR_HAS_UNIX_SOCKETS
+        if (clientConfiguration.isUseTls()) {
+            LOG_ERROR(cnxString_ << "TLS is not supported over unix sockets");
+            throw ResultConnectError;
+        }
+        unixSocket_ = executor_->createUnixSocket();
+#else
+        LOG_ERROR(cnxString_ << "Unix sockets are not supported on this platform");
+        throw ResultConnectError;
+#endif
+    }
+
     if (clientConfiguration.isUseTls()) {
         ASIO::ssl::context ctx(ASIO::ssl::context::tlsv12_client);
         Url serviceUrl;
@@ -280,6 +331,10 @@ ClientConnection::ClientConnection(const std::string& logicalAddress, const std:
 
 ClientConnection::~ClientConnection() {
     LOG_INFO(cnxString_ << "Destroyed connection to " << logicalAddress_ << "-" << poolIndex_);
+    const auto readBufferStats = readBufferPool_->getStats();
+    LOG_DEBUG(cnxString_ << "Read buffer pool hits: " << readBufferStats.hits
+                         << ", misses: " << readBufferStats.misses
+                         << ", oversized: " << readBufferStats.oversized);
 }
 
 void ClientConnection::handlePulsarConnected(const proto::CommandConnected& cmdConnected) {
@@ -341,7 +396,8 @@ void ClientConnection::startConsumerStatsTimer(std::vector<uint64_t> consumerSta
             consumerStatsPromises.push_back(it->second);
             pendingConsumerStatsMap_.erase(it);
         } else {
-            LOG_DEBUG(cnxString_ << "request_id " << it->first << " already fulfilled - not removing it");
+            LOG_DEBUG(cnxString_ << "request_id " << consumerStatsRequests[i]
+                                 << " already fulfilled - not removing it");
         }
     }
 
@@ -586,6 +642,13 @@ void ClientConnection::tcpConnectAsync() {
         return;
     }
 
+#ifdef PULSAR_HAS_UNIX_SOCKETS
+    if (unixSocket_) {
+        unixConnectAsync();
+        return;
+    }
+#endif
+
     ASIO_ERROR err;
     Url service_url;
     std::string hostUrl = isSniProxy_ ? proxyServiceUrl_ : physicalAddress_;
@@ -622,6 +685,76 @@ void ClientConnection::handleResolve(const ASIO_ERROR& err, const tcp::resolver:
         return;
     }
 
+    auto weakSelf = weak_from_this();
+    LOG_DEBUG(cnxString_ << "Connecting to " << endpointIterator->endpoint() << "...");
+    startConnectTimeoutTask();
+    if (endpointIterator != tcp::resolver::iterator()) {
+        LOG_DEBUG(cnxString_ << "Resolved hostname " << endpointIterator->host_name()  //
+                             << " to " << endpointIterator->endpoint());
+        socket_->async_connect(*endpointIterator, [weakSelf, endpointIterator](const ASIO_ERROR& err) {
+            auto self = weakSelf.lock();
+            if (self) {
+                self->handleTcpConnected(err, endpointIterator);
+            }
+        });
+    } else {
+        LOG_WARN(cnxString_ << "No IP address found");
+        close();
+        return;
+    }
+}
+
+#ifdef PULSAR_HAS_UNIX_SOCKETS
+/*
+ * Async method to establish the connection with the broker or proxy through a unix socket, there is no
+ * name resolution and no TLS. Once connected, it goes on with the same Pulsar handshake as a TCP connection.
+ */
+void ClientConnection::unixConnectAsync() {
+    const auto path = scheme::getUnixSocketPath(physicalAddress_);
+    LOG_DEBUG(cnxString_ << "Connecting to unix socket " << path << "...");
+    startConnectTimeoutTask();
+    auto weakSelf = weak_from_this();
+    const ASIO::local::stream_protocol::endpoint endpoint(path);
+    unixSocket_->async_connect(endpoint, [weakSelf](const ASIO_ERROR& err) {
+        auto self = weakSelf.lock();
+        if (self) {
+            self->handleUnixConnected(err);
+        }
+    });
+}
+
+void ClientConnection::handleUnixConnected(const ASIO_ERROR& err) {
+    if (err) {
+        LOG_ERROR(cnxString_ << "Failed to establish connection: " << err.message());
+        if (err == ASIO::error::operation_aborted) {
+            // Connect timeout, which is not retryable
+            close();
+        } else {
+            close(ResultRetryable);
+        }
+        return;
+    }
+
+    cnxString_ = "[<unix> -> " + scheme::getUnixSocketPath(physicalAddress_) + "] ";
+    if (logicalAddress_ == physicalAddress_) {
+        LOG_INFO(cnxString_ << "Connected to broker");
+    } else {
+        LOG_INFO(cnxString_ << "Connected to broker through proxy. Logical broker: " << logicalAddress_);
+    }
+
+    Lock lock(mutex_);
+    if (isClosed()) {
+        LOG_INFO(cnxString_ << "Connection already closed");
+        return;
+    }
+    state_ = TcpConnected;
+    lock.unlock();
+
+    handleHandshake(ASIO_SUCCESS);
+}
+#endif
+
+void ClientConnection::startConnectTimeoutTask() {
     auto weakSelf = weak_from_this();
     connectTimeoutTask_->setCallback([weakSelf](const PeriodicTask::ErrorCode& ec) {
         ClientConnectionPtr ptr = weakSelf.lock();
@@ -634,30 +767,24 @@ void ClientConnection::handleResolve(const ASIO_ERROR& err, const tcp::resolver:
             LOG_ERROR(ptr->cnxString_ << "Connection was not established in "
                                       << ptr->connectTimeoutTask_->getPeriodMs() << " ms, close the socket");
             PeriodicTask::ErrorCode err;
-            ptr->socket_->close(err);
+            ptr->closeSocket(err);
             if (err) {
                 LOG_WARN(ptr->cnxString_ << "Failed to close socket: " << err.message());
             }
         }
         ptr->connectTimeoutTask_->stop();
     });
-
-    LOG_DEBUG(cnxString_ << "Connecting to " << endpointIterator->endpoint() << "...");
     connectTimeoutTask_->start();
-    if (endpointIterator != tcp::resolver::iterator()) {
-        LOG_DEBUG(cnxString_ << "Resolved hostname " << endpointIterator->host_name()  //
-                             << " to " << endpointIterator->endpoint());
-        socket_->async_connect(*endpointIterator, [weakSelf, endpointIterator](const ASIO_ERROR& err) {
-            auto self = weakSelf.lock();
-            if (self) {
-                self->handleTcpConnected(err, endpointIterator);
-            }
-        });
-    } else {
-        LOG_WARN(cnxString_ << "No IP address found");
-        close();
+}
+
+void ClientConnection::closeSocket(ASIO_ERROR& err) {
+#ifdef PULSAR_HAS_UNIX_SOCKETS
+    if (unixSocket_) {
+        unixSocket_->close(err);
         return;
     }
+#endif
+    socket_->close(err);
 }
 
 void ClientConnection::readNextCommand() {
@@ -674,6 +801,7 @@ void ClientConnection::handleRead(const ASIO_ERROR& err, size_t bytesTransferred
         return;
     }
     // Update buffer write idx with new data
+    readBufferSize_.record(bytesTransferred, incomingBuffer_.writableBytes());
     incomingBuffer_.bytesWritten(bytesTransferred);
 
     if (err || bytesTransferred == 0) {
@@ -702,6 +830,9 @@ void ClientConnection::handleRead(const ASIO_ERROR& err, size_t bytesTransferred
 }
 
 void ClientConnection::processIncomingBuffer() {
+    // The frames of the previous batch have been handled, release what was decoded from them
+    incomingArena_.Reset();
+
     // Process all the available frames from the incoming buffer
     while (incomingBuffer_.readableBytes() >= sizeof(uint32_t)) {
         // Extract message frames from incoming buffer
@@ -718,8 +849,10 @@ void ClientConnection::processIncomingBuffer() {
 
             if (bytesToReceive > incomingBuffer_.writableBytes()) {
                 // Need to allocate a buffer big enough for the frame
-                uint32_t newBufferSize = std::max<uint32_t>(DefaultBufferSize, frameSize + sizeof(uint32_t));
-                incomingBuffer_ = SharedBuffer::copyFrom(incomingBuffer_, newBufferSize);
+                uint32_t newBufferSize =
+                    std::max<uint32_t>(readBufferSize_.next(), frameSize + sizeof(uint32_t));
+                incomingBuffer_ = readBufferPool_->copyFrom(incomingBuffer_, newBufferSize);
+                incomingBufferShared_ = false;
             }
             auto self = shared_from_this();
             asyncReceive(incomingBuffer_.asio_buffer(),
@@ -732,7 +865,17 @@ void ClientConnection::processIncomingBuffer() {
 
         // At this point,  we have at least one complete frame available in the buffer
         uint32_t cmdSize = incomingBuffer_.readUnsignedInt();
-        proto::BaseCommand incomingCmd;
+        CommandCodec::SendReceipt sendReceipt;
+        if (state_ == Ready &&
+            CommandCodec::decodeSendReceipt(incomingBuffer_.data(), cmdSize, sendReceipt)) {
+            // Fast path of the most frequent command, which does not need a BaseCommand
+            incomingBuffer_.consume(cmdSize);
+            havePendingPingRequest_ = false;
+            handleSendReceipt(sendReceipt);
+            continue;
+        }
+
+        auto& incomingCmd = *google::protobuf::Arena::CreateMessage<proto::BaseCommand>(&incomingArena_);
         if (!incomingCmd.ParseFromArray(incomingBuffer_.data(), cmdSize)) {
             LOG_ERROR(cnxString_ << "Error parsing protocol buffer command");
             close(ResultDisconnected);
@@ -743,8 +886,10 @@ void ClientConnection::processIncomingBuffer() {
 
         if (incomingCmd.type() == BaseCommand::MESSAGE) {
             // Parse message metadata and extract payload
-            proto::MessageMetadata msgMetadata;
-            proto::BrokerEntryMetadata brokerEntryMetadata;
+            auto& msgMetadata =
+                *google::protobuf::Arena::CreateMessage<proto::MessageMetadata>(&incomingArena_);
+            auto& brokerEntryMetadata =
+                *google::protobuf::Arena::CreateMessage<proto::BrokerEntryMetadata>(&incomingArena_);
 
             // read checksum
             uint32_t remainingBytes = frameSize - (cmdSize + 4);
@@ -785,7 +930,15 @@ void ClientConnection::processIncomingBuffer() {
             remainingBytes -= (4 + metadataSize);
 
             uint32_t payloadSize = remainingBytes;
-            SharedBuffer payload = SharedBuffer::copy(incomingBuffer_.data(), payloadSize);
+            SharedBuffer payload;
+            // Only share a well filled read buffer, otherwise a small message could retain a large buffer
+            if (incomingBuffer_.writerIndex() >= incomingBuffer_.capacity() / 4) {
+                // The payload shares the read buffer, which is released when the last slice is released
+                payload = incomingBuffer_.slice(0, payloadSize);
+                incomingBufferShared_ = true;
+            } else {
+                payload = SharedBuffer::copy(incomingBuffer_.data(), payloadSize);
+            }
             incomingBuffer_.consume(payloadSize);
             handleIncomingMessage(incomingCmd.message(), isChecksumValid, brokerEntryMetadata, msgMetadata,
                                   payload);
@@ -797,8 +950,18 @@ void ClientConnection::processIncomingBuffer() {
         // We still have 1 to 3 bytes from the next frame
         assert(incomingBuffer_.readableBytes() < sizeof(uint32_t));
 
-        // Restart with a new buffer and copy the few bytes at the beginning
-        incomingBuffer_ = SharedBuffer::copyFrom(incomingBuffer_, DefaultBufferSize);
+        if (incomingBufferShared_) {
+            // Restart with a new buffer and copy the few bytes at the beginning
+            incomingBuffer_ = readBufferPool_->copyFrom(incomingBuffer_, readBufferSize_.next());
+            incomingBufferShared_ = false;
+        } else {
+            // Move the few bytes at the beginning of the same buffer
+            char remainingBytes[sizeof(uint32_t)];
+            const uint32_t numRemainingBytes = incomingBuffer_.readableBytes();
+            std::copy(incomingBuffer_.data(), incomingBuffer_.data() + numRemainingBytes, remainingBytes);
+            incomingBuffer_.reset();
+            incomingBuffer_.write(remainingBytes, numRemainingBytes);
+        }
 
         // At least we need to read 4 bytes to have the complete frame size
         uint32_t minReadSize = sizeof(uint32_t) - incomingBuffer_.readableBytes();
@@ -813,8 +976,14 @@ void ClientConnection::processIncomingBuffer() {
     }
 
     // We have read everything we had in the buffer
-    // Rollback the indexes to reuse the same buffer
-    incomingBuffer_.reset();
+    if (incomingBufferShared_ || incomingBuffer_.capacity() != readBufferSize_.next()) {
+        // The buffer is still referenced by some payloads or the read size changed, switch to another one
+        incomingBuffer_ = readBufferPool_->acquire(readBufferSize_.next());
+        incomingBufferShared_ = false;
+    } else {
+        // Rollback the indexes to reuse the same buffer
+        incomingBuffer_.reset();
+    }
 
     readNextCommand();
 }
@@ -851,16 +1020,15 @@ bool ClientConnection::verifyChecksum(SharedBuffer& incomingBuffer_, uint32_t& r
 void ClientConnection::handleActiveConsumerChange(const proto::CommandActiveConsumerChange& change) {
     LOG_DEBUG(cnxString_ << "Received notification about active consumer change, consumer_id: "
                          << change.consumer_id() << " isActive: " << change.is_active());
-    Lock lock(mutex_);
-    ConsumersMap::iterator it = consumers_.find(change.consumer_id());
-    if (it != consumers_.end()) {
+    const auto consumers = loadConsumers();
+    auto it = consumers->find(change.consumer_id());
+    if (it != consumers->end()) {
         ConsumerImplPtr consumer = it->second.lock();
 
         if (consumer) {
-            lock.unlock();
             consumer->activeConsumerChanged(change.is_active());
         } else {
-            consumers_.erase(change.consumer_id());
+            removeConsumer(change.consumer_id());
             LOG_DEBUG(cnxString_ << "Ignoring incoming message for already destroyed consumer "
                                  << change.consumer_id());
         }
@@ -875,19 +1043,16 @@ void ClientConnection::handleIncomingMessage(const proto::CommandMessage& msg, b
                                              proto::MessageMetadata& msgMetadata, SharedBuffer& payload) {
     LOG_DEBUG(cnxString_ << "Received a message from the server for consumer: " << msg.consumer_id());
 
-    Lock lock(mutex_);
-    ConsumersMap::iterator it = consumers_.find(msg.consumer_id());
-    if (it != consumers_.end()) {
+    const auto consumers = loadConsumers();
+    auto it = consumers->find(msg.consumer_id());
+    if (it != consumers->end()) {
         ConsumerImplPtr consumer = it->second.lock();
 
         if (consumer) {
-            // Unlock the mutex before notifying the consumer of the
-            // new received message
-            lock.unlock();
             consumer->messageReceived(shared_from_this(), msg, isChecksumValid, brokerEntryMetadata,
                                       msgMetadata, payload);
         } else {
-            consumers_.erase(msg.consumer_id());
+            removeConsumer(msg.consumer_id());
             LOG_DEBUG(cnxString_ << "Ignoring incoming message for already destroyed consumer "
                                  << msg.consumer_id());
         }
@@ -978,7 +1143,7 @@ void ClientConnection::handleIncomingCommand(BaseCommand& incomingCmd) {
                 case BaseCommand::PING:
                     // Respond to ping request
                     LOG_DEBUG(cnxString_ << "Replying to ping command");
-                    sendCommand(Commands::newPong());
+                    sendControlCommand(Commands::newPong());
                     break;
 
                 case BaseCommand::PONG:
@@ -1027,7 +1192,7 @@ Future<Result, BrokerConsumerStatsImpl> ClientConnection::newConsumerStats(uint6
         LOG_ERROR(cnxString_ << " Client is not connected to the broker");
         promise.setFailed(ResultNotConnected);
     }
-    pendingConsumerStatsMap_.insert(std::make_pair(requestId, promise));
+    pendingConsumerStatsMap_.emplace(requestId, promise);
     lock.unlock();
     sendCommand(Commands::newConsumerStats(consumerId, requestId));
     return promise.getFuture();
@@ -1070,122 +1235,157 @@ void ClientConnection::newLookup(const SharedBuffer& cmd, uint64_t requestId,
         }
     });
 
-    pendingLookupRequests_.insert(std::make_pair(requestId, requestData));
+    pendingLookupRequests_.emplace(requestId, requestData);
     numOfPendingLookupRequest_++;
     lock.unlock();
-    sendCommand(cmd);
+    sendControlCommand(cmd);
 }
 
 void ClientConnection::sendCommand(const SharedBuffer& cmd) {
-    Lock lock(mutex_);
-
-    if (pendingWriteOperations_++ == 0) {
-        // Write immediately to socket
-        if (tlsSocket_) {
-            auto weakSelf = weak_from_this();
-            auto callback = [weakSelf, cmd]() {
-                auto self = weakSelf.lock();
-                if (self) {
-                    self->sendCommandInternal(cmd);
-                }
-            };
-            ASIO::post(strand_, callback);
-        } else {
-            sendCommandInternal(cmd);
-        }
-    } else {
-        // Queue to send later
-        pendingWriteBuffers_.push_back(cmd);
-    }
+    pendingWriteBuffers_.push(PendingWrite{cmd, nullptr});
+    startWriteIfIdle();
 }
 
-void ClientConnection::sendCommandInternal(const SharedBuffer& cmd) {
-    auto self = shared_from_this();
-    asyncWrite(cmd.const_asio_buffer(),
-               customAllocWriteHandler([this, self, cmd](const ASIO_ERROR& err, size_t bytesTransferred) {
-                   handleSend(err, cmd);
-               }));
+void ClientConnection::sendControlCommand(const SharedBuffer& cmd) {
+    pendingControlWrites_.push(PendingWrite{cmd, nullptr});
+    startWriteIfIdle();
 }
 
 void ClientConnection::sendMessage(const std::shared_ptr<SendArguments>& args) {
-    Lock lock(mutex_);
-    if (pendingWriteOperations_++ > 0) {
-        pendingWriteBuffers_.emplace_back(args);
+    pendingWriteBuffers_.push(PendingWrite{SharedBuffer{}, args});
+    startWriteIfIdle();
+}
+
+void ClientConnection::startWriteIfIdle() {
+    // Only the thread that finds no pending write operation starts writing, the others just queue the frame
+    // to be picked up by the writer
+    if (pendingWriteOperations_.fetch_add(1, std::memory_order_acq_rel) != 0) {
         return;
     }
-    auto self = shared_from_this();
-    auto sendMessageInternal = [this, self, args] {
-        BaseCommand outgoingCmd;
-        auto buffer = Commands::newSend(outgoingBuffer_, outgoingCmd, getChecksumType(), *args);
-        // Capture the buffer because asio does not copy the buffer, if the buffer is destroyed before the
-        // callback is called, an invalid buffer range might be passed to the underlying socket send.
-        asyncWrite(buffer, customAllocWriteHandler(
-                               [this, self, buffer](const ASIO_ERROR& err, size_t bytesTransferred) {
-                                   handleSendPair(err);
-                               }));
-    };
     if (tlsSocket_) {
-        ASIO::post(strand_, sendMessageInternal);
+        auto weakSelf = weak_from_this();
+        ASIO::post(strand_, [weakSelf] {
+            auto self = weakSelf.lock();
+            if (self) {
+                self->writePendingFrames();
+            }
+        });
     } else {
-        sendMessageInternal();
+        writePendingFrames();
     }
 }
 
-void ClientConnection::handleSend(const ASIO_ERROR& err, const SharedBuffer&) {
+void ClientConnection::handleSendBatch(const ASIO_ERROR& err, size_t numFrames) {
     if (isClosed()) {
         return;
     }
     if (err) {
-        LOG_WARN(cnxString_ << "Could not send message on connection: " << err << " " << err.message());
+        LOG_WARN(cnxString_ << "Could not send " << numFrames << " frames on connection: " << err << " "
+                            << err.message());
         close(ResultDisconnected);
-    } else {
-        sendPendingCommands();
-    }
-}
-
-void ClientConnection::handleSendPair(const ASIO_ERROR& err) {
-    if (isClosed()) {
         return;
     }
-    if (err) {
-        LOG_WARN(cnxString_ << "Could not send pair message on connection: " << err << " " << err.message());
-        close(ResultDisconnected);
-    } else {
-        sendPendingCommands();
+
+    // Release the buffers of the completed write. It must be done before updating the counter because another
+    // thread might become the writer as soon as the counter drops to 0.
+    outgoingBuffers_.clear();
+    const int numFramesSent = static_cast<int>(numFrames);
+    if (pendingWriteOperations_.fetch_sub(numFramesSent, std::memory_order_acq_rel) - numFramesSent > 0) {
+        writePendingFrames();
     }
 }
 
-void ClientConnection::sendPendingCommands() {
-    Lock lock(mutex_);
+void ClientConnection::writePendingFrames() {
+    // Drain as many queued frames as possible into a single gathered write. The headers of all the SEND
+    // frames are encoded one after another in outgoingBuffer_, the payloads are referenced without copy.
+    outgoingBuffer_.reset();
+    size_t numFrames = 0;
+    auto canAdd = [this, &numFrames](size_t numBuffers) {
+        return numFrames == 0 || outgoingBuffers_.size() + numBuffers <= MaxWriteBatchBuffers;
+    };
+    while (numFrames == 0 || outgoingBuffers_.bytes() < MaxWriteBatchBytes) {
+        // 1. Control frames go first
+        if (auto pendingWrite = pendingControlWrites_.front()) {
+            if (!canAdd(1)) {
+                break;
+            }
+            outgoingBuffers_.add(pendingWrite->cmd);
+            pendingControlWrites_.pop();
+            numFrames++;
+            continue;
+        }
 
-    if (--pendingWriteOperations_ > 0) {
-        assert(!pendingWriteBuffers_.empty());
-        boost::any any = pendingWriteBuffers_.front();
-        pendingWriteBuffers_.pop_front();
+        // 2. SEND frames, one producer at a time
+        stageSendFrames();
+        if (!sendLaneOrder_.empty()) {
+            if (!canAdd(2)) {
+                break;
+            }
+            const auto producerId = sendLaneOrder_.front();
+            sendLaneOrder_.pop_front();
+            auto it = sendLanes_.find(producerId);
+            auto& lane = it->second;
+            outgoingBuffers_.add(Commands::newSend(outgoingBuffer_, getChecksumType(), *lane.front()));
+            lane.pop_front();
+            if (lane.empty()) {
+                if (spareSendLanes_.size() < MaxSpareSendLanes) {
+                    spareSendLanes_.emplace_back(std::move(lane));
+                }
+                sendLanes_.erase(it);
+            } else {
+                pushBackGrowing(sendLaneOrder_, producerId);
+            }
+            numFrames++;
+            continue;
+        }
 
-        auto self = shared_from_this();
-        if (any.type() == typeid(SharedBuffer)) {
-            SharedBuffer buffer = boost::any_cast<SharedBuffer>(any);
-            asyncWrite(buffer.const_asio_buffer(),
-                       customAllocWriteHandler(
-                           [this, self, buffer](const ASIO_ERROR& err, size_t) { handleSend(err, buffer); }));
-        } else {
-            assert(any.type() == typeid(std::shared_ptr<SendArguments>));
+        // 3. The other commands, after all the SEND frames queued before them
+        if (auto pendingWrite = pendingWriteBuffers_.front()) {
+            if (!canAdd(1)) {
+                break;
+            }
+            outgoingBuffers_.add(pendingWrite->cmd);
+            pendingWriteBuffers_.pop();
+            numFrames++;
+            continue;
+        }
 
-            auto args = boost::any_cast<std::shared_ptr<SendArguments>>(any);
-            BaseCommand outgoingCmd;
-            PairSharedBuffer buffer =
-                Commands::newSend(outgoingBuffer_, outgoingCmd, getChecksumType(), *args);
+        if (numFrames > 0) {
+            break;
+        }
+        // The counter is only incremented after the push, so the frame is there but the producer has not
+        // linked it to the queue yet
+        std::this_thread::yield();
+    }
 
-            // Capture the buffer because asio does not copy the buffer, if the buffer is destroyed before the
-            // callback is called, an invalid buffer range might be passed to the underlying socket send.
-            asyncWrite(buffer, customAllocWriteHandler([this, self, buffer](const ASIO_ERROR& err, size_t) {
-                           handleSendPair(err);
-                       }));
+    // outgoingBuffers_ keeps the buffers alive until the write is completed because it's only modified after
+    // the completion of the write in progress.
+    auto self = shared_from_this();
+    asyncWrite(outgoingBuffers_.view(),
+               customAllocWriteHandler([this, self, numFrames](const ASIO_ERROR& err, size_t) {
+                   handleSendBatch(err, numFrames);
+               }));
+}
+
+void ClientConnection::stageSendFrames() {
+    // Stop at the first command so that it's still written after the SEND frames queued before it
+    while (auto pendingWrite = pendingWriteBuffers_.front()) {
+        if (!pendingWrite->sendArgs) {
+            break;
         }
-    } else {
-        // No more pending writes
-        outgoingBuffer_.reset();
+        const auto producerId = pendingWrite->sendArgs->producerId;
+        auto it = sendLanes_.find(producerId);
+        if (it == sendLanes_.end()) {
+            if (spareSendLanes_.empty()) {
+                it = sendLanes_.emplace(producerId).first;
+            } else {
+                it = sendLanes_.emplace(producerId, std::move(spareSendLanes_.back())).first;
+                spareSendLanes_.pop_back();
+            }
+            pushBackGrowing(sendLaneOrder_, producerId);
+        }
+        pushBackGrowing(it->second, std::move(pendingWrite->sendArgs));
+        pendingWriteBuffers_.pop();
     }
 }
 
@@ -1210,7 +1410,7 @@ Future<Result, ResponseData> ClientConnection::sendRequestWithId(const SharedBuf
         }
     });
 
-    pendingRequests_.insert(std::make_pair(requestId, requestData));
+    pendingRequests_.emplace(requestId, requestData);
     lock.unlock();
 
     sendCommand(cmd);
@@ -1250,7 +1450,7 @@ void ClientConnection::handleKeepAliveTimeout() {
         // Send keep alive probe to peer
         LOG_DEBUG(cnxString_ << "Sending ping message");
         havePendingPingRequest_ = true;
-        sendCommand(Commands::newPing());
+        sendControlCommand(Commands::newPing());
 
         // If the close operation has already called the keepAliveTimer_.reset() then the use_count will
         // be zero And we do not attempt to dereference the pointer.
@@ -1293,6 +1493,16 @@ void ClientConnection::close(Result result, bool detach) {
             LOG_WARN(cnxString_ << "Failed to close socket: " << err.message());
         }
     }
+#ifdef PULSAR_HAS_UNIX_SOCKETS
+    if (unixSocket_) {
+        ASIO_ERROR err;
+        unixSocket_->shutdown(ASIO::socket_base::shutdown_both, err);
+        unixSocket_->close(err);
+        if (err) {
+            LOG_WARN(cnxString_ << "Failed to close unix socket: " << err.message());
+        }
+    }
+#endif
     if (tlsSocket_) {
         ASIO_ERROR err;
         tlsSocket_->lowest_layer().close(err);
@@ -1306,8 +1516,8 @@ void ClientConnection::close(Result result, bool detach) {
     }
 
     // Move the internal fields to process them after `mutex_` was unlocked
-    auto consumers = std::move(consumers_);
-    auto producers = std::move(producers_);
+    auto consumers = std::atomic_exchange(&consumers_, std::make_shared<const ConsumersMap>());
+    auto producers = std::atomic_exchange(&producers_, std::make_shared<const ProducersMap>());
     auto pendingRequests = std::move(pendingRequests_);
     auto pendingLookupRequests = std::move(pendingLookupRequests_);
     auto pendingConsumerStatsMap = std::move(pendingConsumerStatsMap_);
@@ -1344,14 +1554,14 @@ void ClientConnection::close(Result result, bool detach) {
     }
 
     auto self = shared_from_this();
-    for (ProducersMap::iterator it = producers.begin(); it != producers.end(); ++it) {
+    for (auto it = producers->begin(); it != producers->end(); ++it) {
         auto producer = it->second.lock();
         if (producer) {
             producer->handleDisconnection(result, self);
         }
     }
 
-    for (ConsumersMap::iterator it = consumers.begin(); it != consumers.end(); ++it) {
+    for (auto it = consumers->begin(); it != consumers->end(); ++it) {
         auto consumer = it->second.lock();
         if (consumer) {
             consumer->handleDisconnection(result, self);
@@ -1391,22 +1601,22 @@ Future<Result, ClientConnectionWeakPtr> ClientConnection::getConnectFuture() {
 
 void ClientConnection::registerProducer(int producerId, const ProducerImplPtr& producer) {
     Lock lock(mutex_);
-    producers_.insert(std::make_pair(producerId, producer));
+    unsafeUpdateProducers([&](ProducersMap& producers) { producers.emplace(producerId, producer); });
 }
 
 void ClientConnection::registerConsumer(int consumerId, const ConsumerImplPtr& consumer) {
     Lock lock(mutex_);
-    consumers_.insert(std::make_pair(consumerId, consumer));
+    unsafeUpdateConsumers([&](ConsumersMap& consumers) { consumers.emplace(consumerId, consumer); });
 }
 
 void ClientConnection::removeProducer(int producerId) {
     Lock lock(mutex_);
-    producers_.erase(producerId);
+    unsafeUpdateProducers([producerId](ProducersMap& producers) { producers.erase(producerId); });
 }
 
 void ClientConnection::removeConsumer(int consumerId) {
     Lock lock(mutex_);
-    consumers_.erase(consumerId);
+    unsafeUpdateConsumers([consumerId](ConsumersMap& consumers) { consumers.erase(consumerId); });
 }
 
 const std::string& ClientConnection::brokerAddress() const { return physicalAddress_; }
@@ -1443,7 +1653,7 @@ Future<Result, GetLastMessageIdResponse> ClientConnection::newGetLastMessageId(u
             self->handleGetLastMessageIdTimeout(ec, requestData);
         }
     });
-    pendingGetLastMessageIdRequests_.insert(std::make_pair(requestId, requestData));
+    pendingGetLastMessageIdRequests_.emplace(requestId, requestData);
     lock.unlock();
     sendCommand(Commands::newGetLastMessageId(consumerId, requestId));
     return promise->getFuture();
@@ -1460,7 +1670,7 @@ Future<Result, NamespaceTopicsPtr> ClientConnection::newGetTopicsOfNamespace(
         return promise.getFuture();
     }
 
-    pendingGetNamespaceTopicsRequests_.insert(std::make_pair(requestId, promise));
+    pendingGetNamespaceTopicsRequests_.emplace(requestId, promise);
     lock.unlock();
     sendCommand(Commands::newGetTopicsOfNamespace(nsName, mode, requestId));
     return promise.getFuture();
@@ -1508,19 +1718,29 @@ void ClientConnection::checkServerError(ServerError error, const std::string& me
 }
 
 void ClientConnection::handleSendReceipt(const proto::CommandSendReceipt& sendReceipt) {
-    int producerId = sendReceipt.producer_id();
-    uint64_t sequenceId = sendReceipt.sequence_id();
-    const proto::MessageIdData& messageIdData = sendReceipt.message_id();
-    auto messageId = toMessageId(messageIdData);
+    handleSendReceipt(sendReceipt.producer_id(), sendReceipt.sequence_id(),
+                      toMessageId(sendReceipt.message_id()));
+}
+
+void ClientConnection::handleSendReceipt(const CommandCodec::SendReceipt& sendReceipt) {
+    handleSendReceipt(sendReceipt.producerId, sendReceipt.sequenceId,
+                      MessageIdBuilder()
+                          .ledgerId(sendReceipt.ledgerId)
+                          .entryId(sendReceipt.entryId)
+                          .partition(sendReceipt.partition)
+                          .batchIndex(sendReceipt.batchIndex)
+                          .batchSize(sendReceipt.batchSize)
+                          .build());
+}
 
+void ClientConnection::handleSendReceipt(int producerId, uint64_t sequenceId, MessageId messageId) {
     LOG_DEBUG(cnxString_ << "Got receipt for producer: " << producerId << " -- msg: " << sequenceId
                          << "-- message id: " << messageId);
 
-    Lock lock(mutex_);
-    auto it = producers_.find(producerId);
-    if (it != producers_.end()) {
+    const auto producers = loadProducers();
+    auto it = producers->find(producerId);
+    if (it != producers->end()) {
         ProducerImplPtr producer = it->second.lock();
-        lock.unlock();
 
         if (producer) {
             if (!producer->ackReceived(sequenceId, messageId)) {
@@ -1540,11 +1760,10 @@ void ClientConnection::handleSendError(const proto::CommandSendError& error) {
     if (ChecksumError == error.error()) {
         long producerId = error.producer_id();
         long sequenceId = error.sequence_id();
-        Lock lock(mutex_);
-        auto it = producers_.find(producerId);
-        if (it != producers_.end()) {
+        const auto producers = loadProducers();
+        auto it = producers->find(producerId);
+        if (it != producers->end()) {
             ProducerImplPtr producer = it->second.lock();
-            lock.unlock();
 
             if (producer) {
                 if (!producer->removeCorruptMessage(sequenceId)) {
@@ -1815,8 +2034,8 @@ void ClientConnection::handleTopicMigrated(const proto::CommandTopicMigrated& co
 
     Lock lock(mutex_);
     if (commandTopicMigrated.resource_type() == proto::CommandTopicMigrated_ResourceType_Producer) {
-        auto it = producers_.find(resourceId);
-        if (it != producers_.end()) {
+        auto it = producers_->find(resourceId);
+        if (it != producers_->end()) {
             auto producer = it->second.lock();
             producer->setRedirectedClusterURI(migratedBrokerServiceUrl);
             unsafeRemovePendingRequest(producer->firstRequestIdAfterConnect());
@@ -1825,8 +2044,8 @@ void ClientConnection::handleTopicMigrated(const proto::CommandTopicMigrated& co
             LOG_WARN("Got invalid producer Id in topicMigrated command: " << resourceId);
         }
     } else {
-        auto it = consumers_.find(resourceId);
-        if (it != consumers_.end()) {
+        auto it = consumers_->find(resourceId);
+        if (it != consumers_->end()) {
             auto consumer = it->second.lock();
             consumer->setRedirectedClusterURI(migratedBrokerServiceUrl);
             unsafeRemovePendingRequest(consumer->firstRequestIdAfterConnect());
@@ -1867,10 +2086,10 @@ void ClientConnection::handleCloseProducer(const proto::CommandCloseProducer& cl
     LOG_DEBUG("Broker notification of Closed producer: " << producerId);
 
     Lock lock(mutex_);
-    auto it = producers_.find(producerId);
-    if (it != producers_.end()) {
+    auto it = producers_->find(producerId);
+    if (it != producers_->end()) {
         ProducerImplPtr producer = it->second.lock();
-        producers_.erase(it);
+        unsafeUpdateProducers([producerId](ProducersMap& producers) { producers.erase(producerId); });
         lock.unlock();
 
         if (producer) {
@@ -1888,10 +2107,10 @@ void ClientConnection::handleCloseConsumer(const proto::CommandCloseConsumer& cl
     LOG_DEBUG("Broker notification of Closed consumer: " << consumerId);
 
     Lock lock(mutex_);
-    auto it = consumers_.find(consumerId);
-    if (it != consumers_.end()) {
+    auto it = consumers_->find(consumerId);
+    if (it != consumers_->end()) {
         ConsumerImplPtr consumer = it->second.lock();
-        consumers_.erase(it);
+        unsafeUpdateConsumers([consumerId](ConsumersMap& consumers) { consumers.erase(consumerId); });
         lock.unlock();
 
         if (consumer) {
@@ -28,29 +28,35 @@
 #include <asio/bind_executor.hpp>
 #include <asio/io_service.hpp>
 #include <asio/ip/tcp.hpp>
+#include <asio/local/stream_protocol.hpp>
 #include <asio/ssl/stream.hpp>
 #include <asio/strand.hpp>
 #else
 #include <boost/asio/bind_executor.hpp>
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
 #include <boost/asio/ssl/stream.hpp>
 #include <boost/asio/strand.hpp>
 #endif
-#include <boost/any.hpp>
+#include <boost/circular_buffer.hpp>
 #include <boost/optional.hpp>
-#include <deque>
 #include <functional>
+#include <google/protobuf/arena.h>
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "AsioTimer.h"
+#include "CommandCodec.h"
 #include "Commands.h"
+#include "FlatIdMap.h"
 #include "GetLastMessageIdResponse.h"
 #include "LookupDataResult.h"
+#include "MpscQueue.h"
+#include "ObjectPool.h"
 #include "SharedBuffer.h"
+#include "SharedBufferPool.h"
 #include "TimeUtils.h"
 #include "UtilAllocator.h"
 namespace pulsar {
@@ -58,6 +64,9 @@ namespace pulsar {
 class PulsarFriend;
 
 using TcpResolverPtr = std::shared_ptr<ASIO::ip::tcp::resolver>;
+#ifdef PULSAR_HAS_UNIX_SOCKETS
+using UnixSocketPtr = std::shared_ptr<ASIO::local::stream_protocol::socket>;
+#endif
 
 class ExecutorService;
 using ExecutorServicePtr = std::shared_ptr<ExecutorService>;
@@ -174,7 +183,11 @@ class PULSAR_PUBLIC ClientConnection : public std::enable_shared_from_this<Clien
                                       const LookupDataResultPromisePtr& promise);
 
     void sendCommand(const SharedBuffer& cmd);
-    void sendCommandInternal(const SharedBuffer& cmd);
+    /**
+     * Send a small control frame (flow permits, acks, ping/pong, lookups) that does not need to be ordered
+     * with the other frames. It's written ahead of the SEND frames and commands already queued.
+     */
+    void sendControlCommand(const SharedBuffer& cmd);
     void sendMessage(const std::shared_ptr<SendArguments>& args);
 
     void registerProducer(int producerId, const ProducerImplPtr& producer);
@@ -263,9 +276,17 @@ class PULSAR_PUBLIC ClientConnection : public std::enable_shared_from_this<Clien
 
     void handleResolve(const ASIO_ERROR& err, const ASIO::ip::tcp::resolver::iterator& endpointIterator);
 
-    void handleSend(const ASIO_ERROR& err, const SharedBuffer& cmd);
-    void handleSendPair(const ASIO_ERROR& err);
-    void sendPendingCommands();
+#ifdef PULSAR_HAS_UNIX_SOCKETS
+    void unixConnectAsync();
+    void handleUnixConnected(const ASIO_ERROR& err);
+#endif
+    void startConnectTimeoutTask();
+    void closeSocket(ASIO_ERROR& err);
+
+    void handleSendBatch(const ASIO_ERROR& err, size_t numFrames);
+    void startWriteIfIdle();
+    void writePendingFrames();
+    void stageSendFrames();
     void newLookup(const SharedBuffer& cmd, uint64_t requestId, const LookupDataResultPromisePtr& promise);
 
     void handleRequestTimeout(const ASIO_ERROR& ec, const PendingRequestData& pendingRequestData);
@@ -293,6 +314,10 @@ class PULSAR_PUBLIC ClientConnection : public std::enable_shared_from_this<Clien
         }
         if (tlsSocket_) {
             ASIO::async_write(*tlsSocket_, buffers, ASIO::bind_executor(strand_, handler));
+#ifdef PULSAR_HAS_UNIX_SOCKETS
+        } else if (unixSocket_) {
+            ASIO::async_write(*unixSocket_, buffers, handler);
+#endif
         } else {
             ASIO::async_write(*socket_, buffers, handler);
         }
@@ -305,6 +330,10 @@ class PULSAR_PUBLIC ClientConnection : public std::enable_shared_from_this<Clien
         }
         if (tlsSocket_) {
             tlsSocket_->async_read_some(buffers, ASIO::bind_executor(strand_, handler));
+#ifdef PULSAR_HAS_UNIX_SOCKETS
+        } else if (unixSocket_) {
+            unixSocket_->async_receive(buffers, handler);
+#endif
         } else {
             socket_->async_receive(buffers, handler);
         }
@@ -325,6 +354,13 @@ class PULSAR_PUBLIC ClientConnection : public std::enable_shared_from_this<Clien
      */
     SocketPtr socket_;
     TlsSocketPtr tlsSocket_;
+#ifdef PULSAR_HAS_UNIX_SOCKETS
+    /*
+     *  unix domain socket to the co-located broker or proxy, it's used instead of socket_ when the physical
+     *  address is like "pulsar+unix:///path/to/socket"
+     */
+    UnixSocketPtr unixSocket_;
+#endif
     ASIO::strand<ASIO::io_service::executor_type> strand_;
 
     const std::string logicalAddress_;
@@ -346,42 +382,79 @@ class PULSAR_PUBLIC ClientConnection : public std::enable_shared_from_this<Clien
     ASIO_ERROR error_;
 
     SharedBuffer incomingBuffer_;
+    // Whether slices of incomingBuffer_ were passed to consumers, in which case it cannot be reused
+    bool incomingBufferShared_ = false;
+    SharedBufferPoolPtr readBufferPool_;
+    AdaptiveReadSize readBufferSize_;
+    // The commands and metadata of the frames of a read batch are decoded in this arena, which is reset
+    // before the next batch. The first block is owned by the connection so a small batch does not allocate.
+    std::unique_ptr<char[]> incomingArenaBlock_;
+    google::protobuf::Arena incomingArena_;
 
     Promise<Result, ClientConnectionWeakPtr> connectPromise_;
     std::shared_ptr<PeriodicTask> connectTimeoutTask_;
 
-    typedef std::map<long, PendingRequestData> PendingRequestsMap;
+    // The pending requests are keyed by request id, which is assigned sequentially by the client
+    typedef FlatIdMap<PendingRequestData> PendingRequestsMap;
     PendingRequestsMap pendingRequests_;
 
-    typedef std::map<long, LookupRequestData> PendingLookupRequestsMap;
+    typedef FlatIdMap<LookupRequestData> PendingLookupRequestsMap;
     PendingLookupRequestsMap pendingLookupRequests_;
 
-    typedef std::map<long, ProducerImplWeakPtr> ProducersMap;
-    ProducersMap producers_;
+    // The producers and consumers are looked up for every SEND_RECEIPT and MESSAGE. They are replaced by an
+    // updated copy under mutex_ when a producer or consumer is added or removed, so that the read path only
+    // needs to load the current table.
+    typedef FlatIdMap<ProducerImplWeakPtr> ProducersMap;
+    std::shared_ptr<const ProducersMap> producers_{std::make_shared<const ProducersMap>()};
 
-    typedef std::map<long, ConsumerImplWeakPtr> ConsumersMap;
-    ConsumersMap consumers_;
+    typedef FlatIdMap<ConsumerImplWeakPtr> ConsumersMap;
+    std::shared_ptr<const ConsumersMap> consumers_{std::make_shared<const ConsumersMap>()};
 
-    typedef std::map<uint64_t, Promise<Result, BrokerConsumerStatsImpl>> PendingConsumerStatsMap;
+    typedef FlatIdMap<Promise<Result, BrokerConsumerStatsImpl>> PendingConsumerStatsMap;
     PendingConsumerStatsMap pendingConsumerStatsMap_;
 
-    typedef std::map<long, LastMessageIdRequestData> PendingGetLastMessageIdRequestsMap;
+    typedef FlatIdMap<LastMessageIdRequestData> PendingGetLastMessageIdRequestsMap;
     PendingGetLastMessageIdRequestsMap pendingGetLastMessageIdRequests_;
 
-    typedef std::map<long, Promise<Result, NamespaceTopicsPtr>> PendingGetNamespaceTopicsMap;
+    typedef FlatIdMap<Promise<Result, NamespaceTopicsPtr>> PendingGetNamespaceTopicsMap;
     PendingGetNamespaceTopicsMap pendingGetNamespaceTopicsRequests_;
 
-    typedef std::unordered_map<uint64_t, GetSchemaRequest> PendingGetSchemaMap;
+    typedef FlatIdMap<GetSchemaRequest> PendingGetSchemaMap;
     PendingGetSchemaMap pendingGetSchemaRequests_;
 
     mutable std::mutex mutex_;
     typedef std::unique_lock<std::mutex> Lock;
 
-    // Pending buffers to write on the socket
-    std::deque<boost::any> pendingWriteBuffers_;
-    int pendingWriteOperations_ = 0;
+    // A frame to write on the socket: either an encoded command or, when sendArgs is set, a SEND frame that
+    // is encoded only when it's written
+    struct PendingWrite {
+        SharedBuffer cmd;
+        std::shared_ptr<SendArguments> sendArgs;
+    };
+
+    // Pending frames to write on the socket, they can be pushed from any thread without holding mutex_.
+    // Control frames are written before the frames of pendingWriteBuffers_.
+    // The nodes are pooled so that the frames are queued without heap allocations.
+    using PendingWriteQueue = MpscQueue<PendingWrite, Allocator<PendingWrite, 1000>>;
+    PendingWriteQueue pendingControlWrites_;
+    PendingWriteQueue pendingWriteBuffers_;
+    // Number of frames either queued, staged in sendLanes_ or carried by the write in progress. The thread
+    // that increments it from 0 becomes the only writer until a completed write brings it back to 0 or less.
+    std::atomic<int> pendingWriteOperations_{0};
+
+    // SEND frames moved out of pendingWriteBuffers_ by the writer, grouped by producer id and written in
+    // round-robin order so that a producer with a large backlog does not delay the others. They are only
+    // accessed by the writer.
+    using SendLane = boost::circular_buffer<std::shared_ptr<SendArguments>>;
+    FlatIdMap<SendLane> sendLanes_;
+    // The buffers of the lanes that have been emptied, they are reused by the next lanes
+    std::vector<SendLane> spareSendLanes_;
+    // The ids of the producers with staged SEND frames, the next one to write is at the front
+    boost::circular_buffer<uint64_t> sendLaneOrder_;
 
     SharedBuffer outgoingBuffer_;
+    // The frames drained from pendingWriteBuffers_ for the gathered write in progress
+    SharedBufferList outgoingBuffers_;
 
     HandlerAllocator readHandlerAllocator_;
     HandlerAllocator writeHandlerAllocator_;
@@ -411,6 +484,8 @@ class PULSAR_PUBLIC ClientConnection : public std::enable_shared_from_this<Clien
     void checkServerError(ServerError error, const std::string& message);
 
     void handleSendReceipt(const proto::CommandSendReceipt&);
+    void handleSendReceipt(const CommandCodec::SendReceipt&);
+    void handleSendReceipt(int producerId, uint64_t sequenceId, MessageId messageId);
     void handleSendError(const proto::CommandSendError&);
     void handleSuccess(const proto::CommandSuccess&);
     void handlePartitionedMetadataResponse(const proto::CommandPartitionedTopicMetadataResponse&);
@@ -431,6 +506,23 @@ class PULSAR_PUBLIC ClientConnection : public std::enable_shared_from_this<Clien
     std::string getMigratedBrokerServiceUrl(const proto::CommandTopicMigrated&);
     // This method must be called when `mutex_` is held
     void unsafeRemovePendingRequest(long requestId);
+
+    std::shared_ptr<const ProducersMap> loadProducers() const { return std::atomic_load(&producers_); }
+    std::shared_ptr<const ConsumersMap> loadConsumers() const { return std::atomic_load(&consumers_); }
+
+    // Replace the table with an updated copy, these methods must be called when `mutex_` is held
+    template <typename Update>
+    void unsafeUpdateProducers(Update&& update) {
+        auto producers = std::make_shared<ProducersMap>(*producers_);
+        update(*producers);
+        std::atomic_store(&producers_, std::shared_ptr<const ProducersMap>(std::move(producers)));
+    }
+    template <typename Update>
+    void unsafeUpdateConsumers(Update&& update) {
+        auto consumers = std::make_shared<ConsumersMap>(*consumers_);
+        update(*consumers);
+        std::atomic_store(&consumers_, std::shared_ptr<const ConsumersMap>(std::move(consumers)));
+    }
 };
 }  // namespace pulsar
 
@@ -87,6 +87,10 @@ ClientImpl::ClientImpl(const std::string& serviceUrl, const ClientConfiguration&
           std::make_shared<ExecutorServiceProvider>(clientConfiguration_.getMessageListenerThreads())),
       partitionListenerExecutorProvider_(
           std::make_shared<ExecutorServiceProvider>(clientConfiguration_.getMessageListenerThreads())),
+      compressionExecutorProvider_(
+          (clientConfiguration_.getCompressionThreads() > 0)
+              ? std::make_shared<ExecutorServiceProvider>(clientConfiguration_.getCompressionThreads())
+              : nullptr),
       pool_(clientConfiguration_, ioExecutorProvider_, clientConfiguration_.getAuthPtr(),
             ClientImpl::getClientVersion(clientConfiguration)),
       producerIdGenerator_(0),
@@ -132,6 +136,10 @@ ExecutorServiceProviderPtr ClientImpl::getPartitionListenerExecutorProvider() {
     return partitionListenerExecutorProvider_;
 }
 
+ExecutorServiceProviderPtr ClientImpl::getCompressionExecutorProvider() {
+    return compressionExecutorProvider_;
+}
+
 LookupServicePtr ClientImpl::getLookup(const std::string& redirectedClusterURI) {
     if (redirectedClusterURI.empty()) {
         return lookupServicePtr_;
@@ -783,6 +791,13 @@ void ClientImpl::shutdown() {
     partitionListenerExecutorProvider_->close(timeoutProcessor.getLeftTimeout());
     timeoutProcessor.tok();
     LOG_DEBUG("partitionListenerExecutorProvider_ is closed");
+
+    if (compressionExecutorProvider_) {
+        timeoutProcessor.tik();
+        compressionExecutorProvider_->close(timeoutProcessor.getLeftTimeout());
+        timeoutProcessor.tok();
+        LOG_DEBUG("compressionExecutorProvider_ is closed");
+    }
     lookupCount_ = 0;
 }
 
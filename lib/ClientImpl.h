@@ -121,6 +121,8 @@ class ClientImpl : public std::enable_shared_from_this<ClientImpl> {
     ExecutorServiceProviderPtr getIOExecutorProvider();
     ExecutorServiceProviderPtr getListenerExecutorProvider();
     ExecutorServiceProviderPtr getPartitionListenerExecutorProvider();
+    // It's null if ClientConfiguration::getCompressionThreads() is 0
+    ExecutorServiceProviderPtr getCompressionExecutorProvider();
     LookupServicePtr getLookup(const std::string& redirectedClusterURI = "");
 
     void cleanupProducer(ProducerImplBase* address) { producers_.remove(address); }
@@ -190,6 +192,7 @@ class ClientImpl : public std::enable_shared_from_this<ClientImpl> {
     ExecutorServiceProviderPtr ioExecutorProvider_;
     ExecutorServiceProviderPtr listenerExecutorProvider_;
     ExecutorServiceProviderPtr partitionListenerExecutorProvider_;
+    ExecutorServiceProviderPtr compressionExecutorProvider_;
 
     LookupServicePtr lookupServicePtr_;
     std::unordered_map<std::string, LookupServicePtr> redirectedClusterLookupServicePtrs_;
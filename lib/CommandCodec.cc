@@ -0,0 +1,322 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "CommandCodec.h"
+
+#include "BitSet.h"
+
+namespace pulsar {
+
+// See https://protobuf.dev/programming-guides/encoding/. All the field numbers used here are less than 16,
+// so each tag is encoded in a single byte.
+static constexpr uint8_t WireVarint = 0;
+static constexpr uint8_t WireLengthDelimited = 2;
+
+static constexpr uint8_t tag(uint8_t field, uint8_t wireType) { return (field << 3) | wireType; }
+
+// Field numbers and values from PulsarApi.proto
+static constexpr uint8_t BaseCommandType = 1;
+static constexpr uint8_t BaseCommandSend = 6;
+static constexpr uint8_t BaseCommandSendReceipt = 7;
+static constexpr uint8_t BaseCommandAck = 10;
+static constexpr uint8_t BaseCommandFlow = 11;
+
+static constexpr uint64_t TypeSend = 6;
+static constexpr uint64_t TypeSendReceipt = 7;
+static constexpr uint64_t TypeAck = 10;
+static constexpr uint64_t TypeFlow = 11;
+
+static inline size_t varintSize(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+// int32 and enum values are sign extended to 64 bits, a negative value always takes 10 bytes
+static inline uint64_t fromInt32(int32_t value) { return static_cast<uint64_t>(static_cast<int64_t>(value)); }
+
+static inline char* writeVarint(char* dst, uint64_t value) {
+    while (value >= 0x80) {
+        *dst++ = static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    *dst++ = static_cast<char>(value);
+    return dst;
+}
+
+static inline char* writeTag(char* dst, uint8_t field, uint8_t wireType) {
+    *dst++ = static_cast<char>(tag(field, wireType));
+    return dst;
+}
+
+// Size of a varint field, including its tag
+static inline size_t varintFieldSize(uint64_t value) { return 1 + varintSize(value); }
+
+// Size of a length-delimited field, including its tag and its length
+static inline size_t messageFieldSize(size_t size) { return 1 + varintSize(size) + size; }
+
+static inline size_t baseCommandSize(uint64_t type, size_t commandSize) {
+    return varintFieldSize(type) + messageFieldSize(commandSize);
+}
+
+static inline char* writeBaseCommandHeader(char* dst, uint64_t type, uint8_t field, size_t commandSize) {
+    dst = writeVarint(writeTag(dst, BaseCommandType, WireVarint), type);
+    return writeVarint(writeTag(dst, field, WireLengthDelimited), commandSize);
+}
+
+static size_t sendCommandSize(const CommandCodec::SendFields& fields) {
+    size_t size = varintFieldSize(fields.producerId) + varintFieldSize(fields.sequenceId);
+    if (fields.hasNumMessages) {
+        size += varintFieldSize(fromInt32(fields.numMessages));
+    }
+    if (fields.isChunk) {
+        size += 2;
+    }
+    return size;
+}
+
+size_t CommandCodec::sendSize(const SendFields& fields) {
+    return baseCommandSize(TypeSend, sendCommandSize(fields));
+}
+
+char* CommandCodec::encodeSend(char* dst, const SendFields& fields) {
+    dst = writeBaseCommandHeader(dst, TypeSend, BaseCommandSend, sendCommandSize(fields));
+    dst = writeVarint(writeTag(dst, 1, WireVarint), fields.producerId);
+    dst = writeVarint(writeTag(dst, 2, WireVarint), fields.sequenceId);
+    if (fields.hasNumMessages) {
+        dst = writeVarint(writeTag(dst, 3, WireVarint), fromInt32(fields.numMessages));
+    }
+    if (fields.isChunk) {
+        dst = writeVarint(writeTag(dst, 7, WireVarint), 1);
+    }
+    return dst;
+}
+
+static size_t ackMessageIdSize(const CommandCodec::AckFields& fields) {
+    size_t size = varintFieldSize(static_cast<uint64_t>(fields.ledgerId)) +
+                  varintFieldSize(static_cast<uint64_t>(fields.entryId));
+    for (auto word : *fields.ackSet) {
+        size += varintFieldSize(word);
+    }
+    return size;
+}
+
+static size_t ackCommandSize(const CommandCodec::AckFields& fields, size_t messageIdSize) {
+    size_t size = varintFieldSize(fields.consumerId) + varintFieldSize(fromInt32(fields.ackType)) +
+                  messageFieldSize(messageIdSize);
+    if (fields.validationError >= 0) {
+        size += varintFieldSize(fromInt32(fields.validationError));
+    }
+    if (fields.hasRequestId) {
+        size += varintFieldSize(fields.requestId);
+    }
+    return size;
+}
+
+size_t CommandCodec::ackSize(const AckFields& fields) {
+    return baseCommandSize(TypeAck, ackCommandSize(fields, ackMessageIdSize(fields)));
+}
+
+char* CommandCodec::encodeAck(char* dst, const AckFields& fields) {
+    const size_t messageIdSize = ackMessageIdSize(fields);
+    dst = writeBaseCommandHeader(dst, TypeAck, BaseCommandAck, ackCommandSize(fields, messageIdSize));
+    dst = writeVarint(writeTag(dst, 1, WireVarint), fields.consumerId);
+    dst = writeVarint(writeTag(dst, 2, WireVarint), fromInt32(fields.ackType));
+
+    // A single MessageIdData, the ack set is a non packed repeated field
+    dst = writeVarint(writeTag(dst, 3, WireLengthDelimited), messageIdSize);
+    dst = writeVarint(writeTag(dst, 1, WireVarint), static_cast<uint64_t>(fields.ledgerId));
+    dst = writeVarint(writeTag(dst, 2, WireVarint), static_cast<uint64_t>(fields.entryId));
+    for (auto word : *fields.ackSet) {
+        dst = writeVarint(writeTag(dst, 5, WireVarint), word);
+    }
+
+    if (fields.validationError >= 0) {
+        dst = writeVarint(writeTag(dst, 4, WireVarint), fromInt32(fields.validationError));
+    }
+    if (fields.hasRequestId) {
+        dst = writeVarint(writeTag(dst, 8, WireVarint), fields.requestId);
+    }
+    return dst;
+}
+
+static size_t flowCommandSize(uint64_t consumerId, uint32_t messagePermits) {
+    return varintFieldSize(consumerId) + varintFieldSize(messagePermits);
+}
+
+size_t CommandCodec::flowSize(uint64_t consumerId, uint32_t messagePermits) {
+    return baseCommandSize(TypeFlow, flowCommandSize(consumerId, messagePermits));
+}
+
+char* CommandCodec::encodeFlow(char* dst, uint64_t consumerId, uint32_t messagePermits) {
+    dst = writeBaseCommandHeader(dst, TypeFlow, BaseCommandFlow, flowCommandSize(consumerId, messagePermits));
+    dst = writeVarint(writeTag(dst, 1, WireVarint), consumerId);
+    return writeVarint(writeTag(dst, 2, WireVarint), messagePermits);
+}
+
+namespace {
+
+// Read the fields of a message in [data, end), any error makes the caller fall back to protobuf
+class FieldReader {
+   public:
+    FieldReader(const char* data, size_t size)
+        : pos_(reinterpret_cast<const uint8_t*>(data)), end_(pos_ + size) {}
+
+    bool atEnd() const noexcept { return pos_ == end_; }
+
+    bool readVarint(uint64_t& value) noexcept {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos_ != end_; shift += 7) {
+            const uint8_t byte = *pos_++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readTag(uint32_t& field, uint32_t& wireType) noexcept {
+        uint64_t tag;
+        if (!readVarint(tag) || tag > UINT32_MAX) {
+            return false;
+        }
+        field = static_cast<uint32_t>(tag >> 3);
+        wireType = static_cast<uint32_t>(tag & 7);
+        return true;
+    }
+
+    // Read the length of a length-delimited field and return a reader of its content
+    bool readMessage(FieldReader& message) noexcept {
+        uint64_t size;
+        if (!readVarint(size) || size > static_cast<uint64_t>(end_ - pos_)) {
+            return false;
+        }
+        message.pos_ = pos_;
+        message.end_ = pos_ + size;
+        pos_ += size;
+        return true;
+    }
+
+   private:
+    const uint8_t* pos_;
+    const uint8_t* end_;
+};
+
+}  // namespace
+
+static bool decodeMessageIdData(FieldReader& reader, CommandCodec::SendReceipt& receipt) {
+    bool hasLedgerId = false;
+    bool hasEntryId = false;
+    while (!reader.atEnd()) {
+        uint32_t field;
+        uint32_t wireType;
+        uint64_t value;
+        if (!reader.readTag(field, wireType) || wireType != WireVarint || !reader.readVarint(value)) {
+            return false;
+        }
+        switch (field) {
+            case 1:
+                receipt.ledgerId = static_cast<int64_t>(value);
+                hasLedgerId = true;
+                break;
+            case 2:
+                receipt.entryId = static_cast<int64_t>(value);
+                hasEntryId = true;
+                break;
+            case 3:
+                receipt.partition = static_cast<int32_t>(value);
+                break;
+            case 4:
+                receipt.batchIndex = static_cast<int32_t>(value);
+                break;
+            case 6:
+                receipt.batchSize = static_cast<int32_t>(value);
+                break;
+            default:
+                // The ack set or the first chunk message id, which are not expected in a receipt
+                return false;
+        }
+    }
+    return hasLedgerId && hasEntryId;
+}
+
+static bool decodeCommandSendReceipt(FieldReader& reader, CommandCodec::SendReceipt& receipt) {
+    bool hasProducerId = false;
+    bool hasSequenceId = false;
+    while (!reader.atEnd()) {
+        uint32_t field;
+        uint32_t wireType;
+        if (!reader.readTag(field, wireType)) {
+            return false;
+        }
+        uint64_t value;
+        if (field == 3 && wireType == WireLengthDelimited) {
+            FieldReader messageId{nullptr, 0};
+            if (!reader.readMessage(messageId) || !decodeMessageIdData(messageId, receipt)) {
+                return false;
+            }
+        } else if (wireType != WireVarint || !reader.readVarint(value)) {
+            return false;
+        } else if (field == 1) {
+            receipt.producerId = value;
+            hasProducerId = true;
+        } else if (field == 2) {
+            receipt.sequenceId = value;
+            hasSequenceId = true;
+        } else if (field != 4) {
+            // highest_sequence_id (4) is not used by the client, the other fields are unknown
+            return false;
+        }
+    }
+    return hasProducerId && hasSequenceId;
+}
+
+bool CommandCodec::decodeSendReceipt(const char* data, size_t size, SendReceipt& receipt) {
+    FieldReader reader{data, size};
+    bool isSendReceipt = false;
+    bool hasSendReceipt = false;
+    while (!reader.atEnd()) {
+        uint32_t field;
+        uint32_t wireType;
+        if (!reader.readTag(field, wireType)) {
+            return false;
+        }
+        if (field == BaseCommandType && wireType == WireVarint) {
+            uint64_t type;
+            if (!reader.readVarint(type) || type != TypeSendReceipt) {
+                return false;
+            }
+            isSendReceipt = true;
+        } else if (field == BaseCommandSendReceipt && wireType == WireLengthDelimited) {
+            FieldReader sendReceipt{nullptr, 0};
+            if (!reader.readMessage(sendReceipt) || !decodeCommandSendReceipt(sendReceipt, receipt)) {
+                return false;
+            }
+            hasSendReceipt = true;
+        } else {
+            return false;
+        }
+    }
+    return isSendReceipt && hasSendReceipt;
+}
+
+}  // namespace pulsar
@@ -0,0 +1,101 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef LIB_COMMANDCODEC_H_
+#define LIB_COMMANDCODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pulsar {
+
+class BitSet;
+
+/**
+ * Encoder and decoder of the commands sent or received for every message: SEND, ACK and FLOW are encoded
+ * and SEND_RECEIPT is decoded without going through a protobuf BaseCommand.
+ *
+ * The encoded bytes are exactly what protobuf would serialize for the same fields, so the broker does not
+ * see any difference. The other commands, and the rare fields of these ones, still go through protobuf.
+ */
+class CommandCodec {
+   public:
+    struct SendFields {
+        uint64_t producerId;
+        uint64_t sequenceId;
+        // Only encoded when hasNumMessages is true
+        bool hasNumMessages;
+        int32_t numMessages;
+        bool isChunk;
+    };
+
+    struct AckFields {
+        uint64_t consumerId;
+        // CommandAck::AckType
+        int ackType;
+        int64_t ledgerId;
+        int64_t entryId;
+        const BitSet* ackSet;
+        // CommandAck::ValidationError, only encoded when it's not negative
+        int validationError;
+        // Only encoded when hasRequestId is true
+        bool hasRequestId;
+        uint64_t requestId;
+    };
+
+    struct SendReceipt {
+        uint64_t producerId = 0;
+        uint64_t sequenceId = 0;
+        // The defaults of MessageIdData
+        int64_t ledgerId = 0;
+        int64_t entryId = 0;
+        int32_t partition = -1;
+        int32_t batchIndex = -1;
+        int32_t batchSize = 0;
+    };
+
+    /**
+     * @return the size of the BaseCommand of a SEND command
+     */
+    static size_t sendSize(const SendFields& fields);
+
+    /**
+     * Encode the BaseCommand of a SEND command, `dst` must have at least sendSize() writable bytes.
+     *
+     * @return the pointer after the last written byte
+     */
+    static char* encodeSend(char* dst, const SendFields& fields);
+
+    static size_t ackSize(const AckFields& fields);
+    static char* encodeAck(char* dst, const AckFields& fields);
+
+    static size_t flowSize(uint64_t consumerId, uint32_t messagePermits);
+    static char* encodeFlow(char* dst, uint64_t consumerId, uint32_t messagePermits);
+
+    /**
+     * Decode a BaseCommand if it's a SEND_RECEIPT whose fields are all known by this decoder.
+     *
+     * @return false if the command must be parsed by protobuf: it's another command, it's malformed or it
+     * contains fields not handled here
+     */
+    static bool decodeSendReceipt(const char* data, size_t size, SendReceipt& receipt);
+};
+
+}  // namespace pulsar
+
+#endif /* LIB_COMMANDCODEC_H_ */
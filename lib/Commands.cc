@@ -23,6 +23,9 @@
 #include <pulsar/Schema.h>
 #include <pulsar/Version.h>
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+
 #include <algorithm>
 #include <mutex>
 
@@ -30,9 +33,11 @@
 #include "BatchedMessageIdImpl.h"
 #include "BitSet.h"
 #include "ChunkMessageIdImpl.h"
+#include "CommandCodec.h"
 #include "MessageImpl.h"
 #include "OpSendMsg.h"
 #include "PulsarApi.pb.h"
+#include "SharedBufferPool.h"
 #include "Url.h"
 #include "checksum/ChecksumProvider.h"
 
@@ -116,6 +121,17 @@ static proto::Schema* getSchema(const SchemaInfo& schemaInfo) {
     return schema;
 }
 
+// Same as Commands::writeMessageWithSize() for a command encoded by CommandCodec
+template <typename Encode>
+static SharedBuffer writeEncodedCommandWithSize(size_t cmdSize, Encode&& encode) {
+    SharedBuffer buffer = SharedBuffer::allocate(4 + 4 + cmdSize);
+    buffer.writeUnsignedInt(4 + cmdSize);
+    buffer.writeUnsignedInt(cmdSize);
+    encode(buffer.mutableData());
+    buffer.bytesWritten(cmdSize);
+    return buffer;
+}
+
 SharedBuffer Commands::writeMessageWithSize(const BaseCommand& cmd) {
     size_t cmdSize = cmd.ByteSize();
     size_t frameSize = 4 + cmdSize;
@@ -191,24 +207,20 @@ SharedBuffer Commands::newConsumerStats(uint64_t consumerId, uint64_t requestId)
     return buffer;
 }
 
-PairSharedBuffer Commands::newSend(SharedBuffer& originalHeaders, BaseCommand& cmd, ChecksumType checksumType,
+PairSharedBuffer Commands::newSend(SharedBuffer& originalHeaders, ChecksumType checksumType,
                                    const SendArguments& args) {
-    cmd.set_type(BaseCommand::SEND);
-    CommandSend* send = cmd.mutable_send();
-    send->set_producer_id(args.producerId);
-    send->set_sequence_id(args.sequenceId);
     const auto& metadata = args.metadata;
-    if (metadata.has_num_messages_in_batch()) {
-        send->set_num_messages(metadata.num_messages_in_batch());
-    }
-    if (metadata.has_chunk_id()) {
-        send->set_is_chunk(true);
-    }
+    CommandCodec::SendFields sendFields;
+    sendFields.producerId = args.producerId;
+    sendFields.sequenceId = args.sequenceId;
+    sendFields.hasNumMessages = metadata.has_num_messages_in_batch();
+    sendFields.numMessages = metadata.num_messages_in_batch();
+    sendFields.isChunk = metadata.has_chunk_id();
 
     // / Wire format
     // [TOTAL_SIZE] [CMD_SIZE][CMD] [MAGIC_NUMBER][CHECKSUM] [METADATA_SIZE][METADATA] [PAYLOAD]
 
-    int cmdSize = cmd.ByteSizeLong();
+    int cmdSize = CommandCodec::sendSize(sendFields);
     int msgMetadataSize = metadata.ByteSizeLong();
     const auto& payload = args.payload;
     int payloadSize = payload.readableBytes();
@@ -224,9 +236,12 @@ PairSharedBuffer Commands::newSend(SharedBuffer& originalHeaders, BaseCommand& c
     // By default, headers refers a static buffer whose capacity is 64KB, which can be reused for headers to
     // avoid frequent memory allocation. However, if users configure many properties, the size could be great
     // that results a buffer overflow. In this case, we can only allocate a new larger buffer.
-    originalHeaders.reset();
+    // The new headers are appended after the bytes already written into `originalHeaders`, so that the
+    // headers of multiple frames written by the same gathered write can share it.
     auto headers = originalHeaders;
-    if (headers.writableBytes() < (4 /* header length */ + headerContentSize)) {
+    headers.setReaderIndex(headers.writerIndex());
+    const bool sharedHeaders = (headers.writableBytes() >= (4 /* header length */ + headerContentSize));
+    if (!sharedHeaders) {
         headers = SharedBuffer::allocate(4 + headerContentSize);
     }
 
@@ -234,7 +249,7 @@ PairSharedBuffer Commands::newSend(SharedBuffer& originalHeaders, BaseCommand& c
 
     // Write cmd
     headers.writeUnsignedInt(cmdSize);
-    cmd.SerializeToArray(headers.mutableData(), cmdSize);
+    CommandCodec::encodeSend(headers.mutableData(), sendFields);
     headers.bytesWritten(cmdSize);
 
     // Create checksum placeholder
@@ -258,16 +273,22 @@ PairSharedBuffer Commands::newSend(SharedBuffer& originalHeaders, BaseCommand& c
         int writeIndex = headers.writerIndex();
         int metadataStartIndex = checksumReaderIndex + checksumSize;
         uint32_t metadataChecksum =
-            computeChecksum(0, headers.data() + metadataStartIndex, (writeIndex - metadataStartIndex));
+            computeChecksum(0, headers.data() + (metadataStartIndex - headers.readerIndex()),
+                            (writeIndex - metadataStartIndex));
+        // The checksum of the payload might have been computed when it was written
         uint32_t computedChecksum =
-            computeChecksum(metadataChecksum, payload.data(), payload.readableBytes());
+            args.payloadChecksum
+                ? combineChecksums(metadataChecksum, *args.payloadChecksum, payload.readableBytes())
+                : computeChecksum(metadataChecksum, payload.data(), payload.readableBytes());
         // set computed checksum
         headers.setWriterIndex(checksumReaderIndex);
         headers.writeUnsignedInt(computedChecksum);
         headers.setWriterIndex(writeIndex);
     }
+    if (sharedHeaders) {
+        originalHeaders.setWriterIndex(headers.writerIndex());
+    }
 
-    cmd.clear_send();
     return composite;
 }
 
@@ -454,44 +475,43 @@ SharedBuffer Commands::newProducer(const std::string& topic, uint64_t producerId
     return writeMessageWithSize(cmd);
 }
 
-static void configureCommandAck(CommandAck* ack, uint64_t consumerId, int64_t ledgerId, int64_t entryId,
-                                const BitSet& ackSet, CommandAck_AckType ackType) {
-    ack->set_consumer_id(consumerId);
-    ack->set_ack_type(static_cast<proto::CommandAck_AckType>(ackType));
-    auto* msgId = ack->add_message_id();
-    msgId->set_ledgerid(ledgerId);
-    msgId->set_entryid(entryId);
-    for (auto x : ackSet) {
-        msgId->add_ack_set(x);
-    }
+static SharedBuffer writeAckWithSize(const CommandCodec::AckFields& fields) {
+    return writeEncodedCommandWithSize(CommandCodec::ackSize(fields),
+                                       [&fields](char* dst) { CommandCodec::encodeAck(dst, fields); });
+}
+
+static CommandCodec::AckFields ackFields(uint64_t consumerId, int64_t ledgerId, int64_t entryId,
+                                         const BitSet& ackSet, CommandAck_AckType ackType) {
+    CommandCodec::AckFields fields;
+    fields.consumerId = consumerId;
+    fields.ackType = static_cast<int>(ackType);
+    fields.ledgerId = ledgerId;
+    fields.entryId = entryId;
+    fields.ackSet = &ackSet;
+    fields.validationError = -1;
+    fields.hasRequestId = false;
+    fields.requestId = 0;
+    return fields;
 }
 
 SharedBuffer Commands::newAck(uint64_t consumerId, int64_t ledgerId, int64_t entryId, const BitSet& ackSet,
                               CommandAck_AckType ackType) {
-    BaseCommand cmd;
-    cmd.set_type(BaseCommand::ACK);
-    configureCommandAck(cmd.mutable_ack(), consumerId, ledgerId, entryId, ackSet, ackType);
-    return writeMessageWithSize(cmd);
+    return writeAckWithSize(ackFields(consumerId, ledgerId, entryId, ackSet, ackType));
 }
 
 SharedBuffer Commands::newAck(uint64_t consumerId, int64_t ledgerId, int64_t entryId, const BitSet& ackSet,
                               CommandAck_AckType ackType, CommandAck_ValidationError validationError) {
-    BaseCommand cmd;
-    cmd.set_type(BaseCommand::ACK);
-    CommandAck* ack = cmd.mutable_ack();
-    ack->set_validation_error((proto::CommandAck_ValidationError)validationError);
-    configureCommandAck(ack, consumerId, ledgerId, entryId, ackSet, ackType);
-    return writeMessageWithSize(cmd);
+    auto fields = ackFields(consumerId, ledgerId, entryId, ackSet, ackType);
+    fields.validationError = static_cast<int>(validationError);
+    return writeAckWithSize(fields);
 }
 
 SharedBuffer Commands::newAck(uint64_t consumerId, int64_t ledgerId, int64_t entryId, const BitSet& ackSet,
                               CommandAck_AckType ackType, uint64_t requestId) {
-    BaseCommand cmd;
-    cmd.set_type(BaseCommand::ACK);
-    CommandAck* ack = cmd.mutable_ack();
-    ack->set_request_id(requestId);
-    configureCommandAck(ack, consumerId, ledgerId, entryId, ackSet, ackType);
-    return writeMessageWithSize(cmd);
+    auto fields = ackFields(consumerId, ledgerId, entryId, ackSet, ackType);
+    fields.hasRequestId = true;
+    fields.requestId = requestId;
+    return writeAckWithSize(fields);
 }
 
 static void configureCommandAck(CommandAck* ack, uint64_t consumerId, const std::set<MessageId>& msgIds) {
@@ -525,12 +545,10 @@ SharedBuffer Commands::newMultiMessageAck(uint64_t consumerId, const std::set<Me
 }
 
 SharedBuffer Commands::newFlow(uint64_t consumerId, uint32_t messagePermits) {
-    BaseCommand cmd;
-    cmd.set_type(BaseCommand::FLOW);
-    CommandFlow* flow = cmd.mutable_flow();
-    flow->set_consumer_id(consumerId);
-    flow->set_messagepermits(messagePermits);
-    return writeMessageWithSize(cmd);
+    return writeEncodedCommandWithSize(CommandCodec::flowSize(consumerId, messagePermits),
+                                       [consumerId, messagePermits](char* dst) {
+                                           CommandCodec::encodeFlow(dst, consumerId, messagePermits);
+                                       });
 }
 
 SharedBuffer Commands::newCloseProducer(uint64_t producerId, uint64_t requestId) {
@@ -815,8 +833,7 @@ void Commands::initBatchMessageMetadata(const Message& msg, pulsar::proto::Messa
     // metadata has already been set in ProducerImpl::setMessageMetadata
     const proto::MessageMetadata& metadata = msg.impl_->metadata;
 
-    // required fields
-    batchMetadata.set_producer_name(metadata.producer_name());
+    // required fields, except the producer name that is set when the batch is sent
     batchMetadata.set_sequence_id(metadata.sequence_id());
     batchMetadata.set_publish_time(metadata.publish_time());
 
@@ -840,11 +857,10 @@ void Commands::initBatchMessageMetadata(const Message& msg, pulsar::proto::Messa
     }
 }
 
-// The overhead of constructing and destructing a SingleMessageMetadata is higher than allocating and
-// deallocating memory for a byte array, so use a thread local SingleMessageMetadata and serialize it to a
-// byte array.
-static std::pair<std::unique_ptr<char[]>, size_t> serializeSingleMessageMetadata(
-    const proto::MessageMetadata& msgMetadata, size_t payloadSize) {
+// The overhead of constructing and destructing a SingleMessageMetadata is high, so use a thread local
+// SingleMessageMetadata. Its size is computed and cached before it's returned.
+static const SingleMessageMetadata& fillSingleMessageMetadata(const proto::MessageMetadata& msgMetadata,
+                                                              size_t payloadSize) {
     thread_local SingleMessageMetadata metadata;
     metadata.Clear();
     metadata.set_payload_size(payloadSize);
@@ -870,35 +886,64 @@ static std::pair<std::unique_ptr<char[]>, size_t> serializeSingleMessageMetadata
         metadata.set_sequence_id(msgMetadata.sequence_id());
     }
 
-    size_t size = metadata.ByteSizeLong();
-    std::unique_ptr<char[]> data{new char[size]};
-    metadata.SerializeToArray(data.get(), size);
-    return std::make_pair(std::move(data), size);
+    metadata.ByteSizeLong();
+    return metadata;
 }
 
+// Enough for the payload size, the sequence id and the event time. The properties and the keys are rarely
+// used with batching.
+static constexpr uint32_t EstimatedSingleMessageMetadataSize = 32;
+
+static constexpr uint32_t ChecksumChunkSize = 4096;
+
 uint64_t Commands::serializeSingleMessagesToBatchPayload(SharedBuffer& batchPayload,
-                                                         const std::vector<Message>& messages) {
+                                                         const std::vector<Message>& messages,
+                                                         SharedBufferPool* pool, uint32_t* payloadChecksum) {
     assert(!messages.empty());
-    size_t size = sizeof(uint32_t) * messages.size();
+    auto allocate = [pool](const SharedBuffer& written, uint32_t capacity) {
+        return pool ? pool->copyFrom(written, capacity) : SharedBuffer::copyFrom(written, capacity);
+    };
 
-    std::vector<std::pair<std::unique_ptr<char[]>, size_t>> singleMetadataBuffers(messages.size());
-    for (size_t i = 0; i < messages.size(); i++) {
-        const auto& impl = messages[i].impl_;
-        singleMetadataBuffers[i] =
-            serializeSingleMessageMetadata(impl->metadata, impl->payload.readableBytes());
-        size += singleMetadataBuffers[i].second;
-        size += messages[i].getLength();
+    // The metadata of each message is serialized in place, so the size of the batch is only estimated here.
+    // The buffer is grown in the rare case that the metadata are larger than the estimation.
+    uint64_t estimatedSize = 0;
+    for (const auto& msg : messages) {
+        estimatedSize += sizeof(uint32_t) + EstimatedSingleMessageMetadataSize + msg.getLength();
     }
+    batchPayload = allocate(SharedBuffer{}, static_cast<uint32_t>(estimatedSize));
 
     // Format of batch message
     // Each Message = [METADATA_SIZE][METADATA] [PAYLOAD]
-    batchPayload = SharedBuffer::allocate(size);
-    for (size_t i = 0; i < messages.size(); i++) {
-        auto msgMetadataSize = singleMetadataBuffers[i].second;
-        batchPayload.writeUnsignedInt(msgMetadataSize);
-        batchPayload.write(singleMetadataBuffers[i].first.get(), msgMetadataSize);
-        const auto& payload = messages[i].impl_->payload;
+    uint32_t checksum = 0;
+    uint32_t checksumEndIndex = 0;
+    // Compute the checksum of the bytes written since the last call while they are still in the cache. The
+    // bytes are accumulated into chunks of `minBytes` because computing small chunks is slower.
+    auto updateChecksum = [&](uint32_t minBytes) {
+        const auto numBytes = batchPayload.writerIndex() - checksumEndIndex;
+        if (payloadChecksum && numBytes >= minBytes) {
+            checksum = computeChecksum(checksum, batchPayload.data() + checksumEndIndex, numBytes);
+            checksumEndIndex += numBytes;
+        }
+    };
+    for (const auto& msg : messages) {
+        const auto& payload = msg.impl_->payload;
+        const auto& metadata = fillSingleMessageMetadata(msg.impl_->metadata, payload.readableBytes());
+        const uint32_t metadataSize = metadata.GetCachedSize();
+        const uint32_t size = sizeof(uint32_t) + metadataSize + payload.readableBytes();
+        if (batchPayload.writableBytes() < size) {
+            batchPayload = allocate(batchPayload, std::max(batchPayload.capacity() * 2,
+                                                           batchPayload.writerIndex() + size));
+        }
+
+        batchPayload.writeUnsignedInt(metadataSize);
+        metadata.SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t*>(batchPayload.mutableData()));
+        batchPayload.bytesWritten(metadataSize);
         batchPayload.write(payload.data(), payload.readableBytes());
+        updateChecksum(ChecksumChunkSize);
+    }
+    if (payloadChecksum) {
+        updateChecksum(0);
+        *payloadChecksum = checksum;
     }
 
     return messages.back().impl_->metadata.sequence_id();
@@ -906,8 +951,13 @@ uint64_t Commands::serializeSingleMessagesToBatchPayload(SharedBuffer& batchPayl
 
 Message Commands::deSerializeSingleMessageInBatch(Message& batchedMessage, int32_t batchIndex,
                                                   int32_t batchSize, const BatchMessageAckerPtr& acker) {
-    SharedBuffer& uncompressedPayload = batchedMessage.impl_->payload;
+    return deSerializeSingleMessageInBatch(batchedMessage, batchedMessage.impl_->payload, batchIndex,
+                                           batchSize, acker);
+}
 
+Message Commands::deSerializeSingleMessageInBatch(const Message& batchedMessage,
+                                                  SharedBuffer& uncompressedPayload, int32_t batchIndex,
+                                                  int32_t batchSize, const BatchMessageAckerPtr& acker) {
     // Format of batch message
     // Each Message = [METADATA_SIZE][METADATA] [PAYLOAD]
 
@@ -933,6 +983,28 @@ Message Commands::deSerializeSingleMessageInBatch(Message& batchedMessage, int32
     return singleMessage;
 }
 
+void Commands::skipSingleMessageInBatch(SharedBuffer& uncompressedPayload) {
+    const uint32_t singleMetaSize = uncompressedPayload.readUnsignedInt();
+    google::protobuf::io::CodedInputStream input(
+        reinterpret_cast<const uint8_t*>(uncompressedPayload.data()), static_cast<int>(singleMetaSize));
+    constexpr auto payloadSizeTag = google::protobuf::internal::WireFormatLite::MakeTag(
+        SingleMessageMetadata::kPayloadSizeFieldNumber,
+        google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT);
+
+    uint32_t payloadSize = 0;
+    for (uint32_t tag = input.ReadTag(); tag != 0; tag = input.ReadTag()) {
+        if (tag == payloadSizeTag) {
+            input.ReadVarint32(&payloadSize);
+            break;
+        }
+        if (!google::protobuf::internal::WireFormatLite::SkipField(&input, tag)) {
+            break;
+        }
+    }
+    uncompressedPayload.consume(singleMetaSize);
+    uncompressedPayload.consume(payloadSize);
+}
+
 MessageIdImplPtr Commands::getMessageIdImpl(const MessageId& messageId) { return messageId.impl_; }
 
 bool Commands::peerSupportsGetLastMessageId(int32_t peerVersion) { return peerVersion >= proto::v12; }
@@ -40,6 +40,7 @@ using BatchMessageAckerPtr = std::shared_ptr<BatchMessageAcker>;
 class MessageIdImpl;
 using MessageIdImplPtr = std::shared_ptr<MessageIdImpl>;
 class BitSet;
+class SharedBufferPool;
 struct SendArguments;
 
 namespace proto {
@@ -99,7 +100,11 @@ class Commands {
     static SharedBuffer newGetSchema(const std::string& topic, const std::string& version,
                                      uint64_t requestId);
 
-    static PairSharedBuffer newSend(SharedBuffer& headers, proto::BaseCommand& cmd, ChecksumType checksumType,
+    /**
+     * Encode the headers of a SEND frame after the bytes already written into `headers` and return them
+     * with the payload. If `headers` does not have enough writable space, a new buffer is allocated.
+     */
+    static PairSharedBuffer newSend(SharedBuffer& headers, ChecksumType checksumType,
                                     const SendArguments& args);
 
     static SharedBuffer newSubscribe(
@@ -148,12 +153,36 @@ class Commands {
 
     static void initBatchMessageMetadata(const Message& msg, pulsar::proto::MessageMetadata& batchMetadata);
 
+    /**
+     * Serialize the messages into a single batch payload, whose buffer is acquired from `pool` if it's not
+     * null. The buffer could have more capacity than the size of the payload.
+     *
+     * If `payloadChecksum` is not null, the crc32c checksum of the payload is computed while it's written.
+     *
+     * @return the sequence id of the last message
+     */
     static uint64_t serializeSingleMessagesToBatchPayload(SharedBuffer& batchPayload,
-                                                          const std::vector<Message>& messages);
+                                                          const std::vector<Message>& messages,
+                                                          SharedBufferPool* pool = nullptr,
+                                                          uint32_t* payloadChecksum = nullptr);
 
     static Message deSerializeSingleMessageInBatch(Message& batchedMessage, int32_t batchIndex,
                                                    int32_t batchSize, const BatchMessageAckerPtr& acker);
 
+    /**
+     * Deserialize the single message at the reader index of `payload`, which is a view of the payload of
+     * `batchedMessage`, and move the reader index to the next single message.
+     */
+    static Message deSerializeSingleMessageInBatch(const Message& batchedMessage, SharedBuffer& payload,
+                                                   int32_t batchIndex, int32_t batchSize,
+                                                   const BatchMessageAckerPtr& acker);
+
+    /**
+     * Move the reader index of the batch payload to the next single message. Only the payload size is read
+     * from the single message metadata, which is much cheaper than deserializing the message.
+     */
+    static void skipSingleMessageInBatch(SharedBuffer& payload);
+
     static MessageIdImplPtr getMessageIdImpl(const MessageId& messageId);
 
     static SharedBuffer newConsumerStats(uint64_t consumerId, uint64_t requestId);
@@ -47,6 +47,23 @@ CompressionCodec& CompressionCodecProvider::getCodec(CompressionType compression
     }
 }
 
+const char* CompressionCodecProvider::getName(CompressionType compressionType) {
+    switch (compressionType) {
+        case CompressionNone:
+            return "None";
+        case CompressionLZ4:
+            return "LZ4";
+        case CompressionZLib:
+            return "ZLib";
+        case CompressionZSTD:
+            return "ZSTD";
+        case CompressionSNAPPY:
+            return "SNAPPY";
+        default:
+            return "Unknown";
+    }
+}
+
 SharedBuffer CompressionCodecNone::encode(const SharedBuffer& raw) { return raw; }
 
 bool CompressionCodecNone::decode(const SharedBuffer& encoded, uint32_t uncompressedSize,
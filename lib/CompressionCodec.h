@@ -39,6 +39,8 @@ class PULSAR_PUBLIC CompressionCodecProvider {
    public:
     static CompressionCodec& getCodec(CompressionType compressionType);
 
+    static const char* getName(CompressionType compressionType);
+
    private:
     static CompressionCodecNone compressionCodecNone_;
     static CompressionCodecLZ4 compressionCodecLZ4_;
@@ -60,6 +62,18 @@ class PULSAR_PUBLIC CompressionCodec {
      */
     virtual SharedBuffer encode(const SharedBuffer& raw) = 0;
 
+    /**
+     * Compress a buffer with a compression level, see ProducerConfiguration::setCompressionLevel for the
+     * meaning of the level. The codecs without levels ignore it.
+     *
+     * @param raw
+     *            a buffer with the uncompressed content. The reader/writer indexes will not be modified
+     * @param level
+     *            the compression level, 0 is the default level of the codec
+     * @return a buffer with the compressed content.
+     */
+    virtual SharedBuffer encodeWithLevel(const SharedBuffer& raw, int level) { return encode(raw); }
+
     /**
      * Decompress a buffer.
      *
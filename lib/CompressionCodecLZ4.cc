@@ -24,13 +24,21 @@
 
 namespace pulsar {
 
-SharedBuffer CompressionCodecLZ4::encode(const SharedBuffer& raw) {
+// The acceleration is capped like the later versions of LZ4 do
+static constexpr int MaxAcceleration = 65537;
+
+SharedBuffer CompressionCodecLZ4::encode(const SharedBuffer& raw) { return encodeWithLevel(raw, 0); }
+
+SharedBuffer CompressionCodecLZ4::encodeWithLevel(const SharedBuffer& raw, int level) {
+    // The negative levels are the accelerations, the acceleration 1 is the same as LZ4_compress_default
+    const int acceleration = (level >= 0) ? 1 : ((level < -MaxAcceleration) ? MaxAcceleration : -level);
+
     // Get the max size of the compressed data and allocate a buffer to hold it
     int maxCompressedSize = LZ4_compressBound(raw.readableBytes());
     SharedBuffer compressed = SharedBuffer::allocate(maxCompressedSize);
 
-    int compressedSize =
-        LZ4_compress_default(raw.data(), compressed.mutableData(), raw.readableBytes(), maxCompressedSize);
+    int compressedSize = LZ4_compress_fast(raw.data(), compressed.mutableData(), raw.readableBytes(),
+                                           maxCompressedSize, acceleration);
     assert(compressedSize > 0);
     compressed.bytesWritten(compressedSize);
 
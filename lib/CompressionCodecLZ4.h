@@ -27,6 +27,8 @@ class CompressionCodecLZ4 : public CompressionCodec {
    public:
     SharedBuffer encode(const SharedBuffer& raw);
 
+    SharedBuffer encodeWithLevel(const SharedBuffer& raw, int level);
+
     bool decode(const SharedBuffer& encoded, uint32_t uncompressedSize, SharedBuffer& decoded);
 };
 }  // namespace pulsar
@@ -20,20 +20,31 @@
 
 #include <zlib.h>
 
+#include <algorithm>
+
 #include "LogUtils.h"
 
 DECLARE_LOG_OBJECT()
 
 namespace pulsar {
 
-SharedBuffer CompressionCodecZLib::encode(const SharedBuffer &raw) {
+SharedBuffer CompressionCodecZLib::encode(const SharedBuffer &raw) { return encodeWithLevel(raw, 0); }
+
+SharedBuffer CompressionCodecZLib::encodeWithLevel(const SharedBuffer &raw, int level) {
+    // The level 0 of zlib means no compression, which is not what the default level 0 means here
+    if (level == 0) {
+        level = Z_DEFAULT_COMPRESSION;
+    } else {
+        level = std::max(Z_BEST_SPEED, std::min(level, Z_BEST_COMPRESSION));
+    }
+
     // Get the max size of the compressed data and allocate a buffer to hold it
     int maxCompressedSize = compressBound(raw.readableBytes());
     SharedBuffer compressed = SharedBuffer::allocate(maxCompressedSize);
 
     unsigned long bytesWritten = maxCompressedSize;
-    int res = compress((Bytef *)compressed.mutableData(), &bytesWritten, (const Bytef *)raw.data(),
-                       raw.readableBytes());
+    int res = compress2((Bytef *)compressed.mutableData(), &bytesWritten, (const Bytef *)raw.data(),
+                        raw.readableBytes(), level);
     if (res != Z_OK) {
         LOG_ERROR("Failed to compress buffer. res=" << res);
         abort();
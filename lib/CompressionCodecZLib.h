@@ -29,6 +29,8 @@ class PULSAR_PUBLIC CompressionCodecZLib : public CompressionCodec {
    public:
     SharedBuffer encode(const SharedBuffer& raw);
 
+    SharedBuffer encodeWithLevel(const SharedBuffer& raw, int level);
+
     bool decode(const SharedBuffer& encoded, uint32_t uncompressedSize, SharedBuffer& decoded);
 };
 
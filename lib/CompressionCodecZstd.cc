@@ -18,31 +18,50 @@
  */
 #include "CompressionCodecZstd.h"
 
+#include "ZstdDictionaryImpl.h"
+
 #if HAS_ZSTD
 #include <zstd.h>
 
+#include <memory>
+
 namespace pulsar {
 
-static const int COMPRESSION_LEVEL = 3;
+struct CompressionContextDeleter {
+    void operator()(ZSTD_CCtx* context) const { ZSTD_freeCCtx(context); }
+};
 
-SharedBuffer CompressionCodecZstd::encode(const SharedBuffer& raw) {
+struct DecompressionContextDeleter {
+    void operator()(ZSTD_DCtx* context) const { ZSTD_freeDCtx(context); }
+};
+
+static ZSTD_CCtx* threadCompressionContext() {
+    thread_local std::unique_ptr<ZSTD_CCtx, CompressionContextDeleter> context{ZSTD_createCCtx()};
+    return context.get();
+}
+
+static ZSTD_DCtx* threadDecompressionContext() {
+    thread_local std::unique_ptr<ZSTD_DCtx, DecompressionContextDeleter> context{ZSTD_createDCtx()};
+    return context.get();
+}
+
+template <typename Compress>
+static SharedBuffer compress(const SharedBuffer& raw, Compress&& compressFunction) {
     // Get the max size of the compressed data and allocate a buffer to hold it
     size_t maxCompressedSize = ZSTD_compressBound(raw.readableBytes());
     SharedBuffer compressed = SharedBuffer::allocate(maxCompressedSize);
 
-    int compressedSize = ZSTD_compress(compressed.mutableData(), maxCompressedSize, raw.data(),
-                                       raw.readableBytes(), COMPRESSION_LEVEL);
+    size_t compressedSize = compressFunction(compressed.mutableData(), maxCompressedSize);
     compressed.bytesWritten(compressedSize);
 
     return compressed;
 }
 
-bool CompressionCodecZstd::decode(const SharedBuffer& encoded, uint32_t uncompressedSize,
-                                  SharedBuffer& decoded) {
+template <typename Decompress>
+static bool decompress(uint32_t uncompressedSize, SharedBuffer& decoded, Decompress&& decompressFunction) {
     SharedBuffer decompressed = SharedBuffer::allocate(uncompressedSize);
 
-    size_t result = ZSTD_decompress(decompressed.mutableData(), uncompressedSize, encoded.data(),
-                                    encoded.readableBytes());
+    size_t result = decompressFunction(decompressed.mutableData(), uncompressedSize);
     if (result == uncompressedSize) {
         decompressed.bytesWritten(uncompressedSize);
         decoded = decompressed;
@@ -52,6 +71,50 @@ bool CompressionCodecZstd::decode(const SharedBuffer& encoded, uint32_t uncompre
         return false;
     }
 }
+
+SharedBuffer CompressionCodecZstd::encode(const SharedBuffer& raw) { return encodeWithLevel(raw, 0); }
+
+SharedBuffer CompressionCodecZstd::encodeWithLevel(const SharedBuffer& raw, int level) {
+    // ZSTD clamps the levels out of its range by itself
+    if (level == 0) {
+        level = CompressionLevel;
+    }
+    return compress(raw, [&raw, level](char* dst, size_t capacity) {
+        return ZSTD_compressCCtx(threadCompressionContext(), dst, capacity, raw.data(), raw.readableBytes(),
+                                 level);
+    });
+}
+
+bool CompressionCodecZstd::decode(const SharedBuffer& encoded, uint32_t uncompressedSize,
+                                  SharedBuffer& decoded) {
+    return decompress(uncompressedSize, decoded, [&encoded](char* dst, size_t capacity) {
+        return ZSTD_decompressDCtx(threadDecompressionContext(), dst, capacity, encoded.data(),
+                                   encoded.readableBytes());
+    });
+}
+
+SharedBuffer CompressionCodecZstd::encodeWithDictionary(const SharedBuffer& raw,
+                                                        const ZstdDictionary& dictionary, int level) {
+    if (level == 0 || level == CompressionLevel) {
+        return compress(raw, [&raw, &dictionary](char* dst, size_t capacity) {
+            return ZSTD_compress_usingCDict(threadCompressionContext(), dst, capacity, raw.data(),
+                                            raw.readableBytes(), dictionary.impl_->cdict);
+        });
+    }
+    const auto& content = dictionary.impl_->content;
+    return compress(raw, [&raw, &content, level](char* dst, size_t capacity) {
+        return ZSTD_compress_usingDict(threadCompressionContext(), dst, capacity, raw.data(),
+                                       raw.readableBytes(), content.data(), content.size(), level);
+    });
+}
+
+bool CompressionCodecZstd::decodeWithDictionary(const SharedBuffer& encoded, uint32_t uncompressedSize,
+                                                SharedBuffer& decoded, const ZstdDictionary& dictionary) {
+    return decompress(uncompressedSize, decoded, [&encoded, &dictionary](char* dst, size_t capacity) {
+        return ZSTD_decompress_usingDDict(threadDecompressionContext(), dst, capacity, encoded.data(),
+                                          encoded.readableBytes(), dictionary.impl_->ddict);
+    });
+}
 }  // namespace pulsar
 
 #else  // No ZSTD
@@ -64,10 +127,24 @@ SharedBuffer CompressionCodecZstd::encode(const SharedBuffer& raw) {
     throw std::runtime_error("ZStd compression not supported");
 }
 
+SharedBuffer CompressionCodecZstd::encodeWithLevel(const SharedBuffer& raw, int level) {
+    throw std::runtime_error("ZStd compression not supported");
+}
+
 bool CompressionCodecZstd::decode(const SharedBuffer& encoded, uint32_t uncompressedSize,
                                   SharedBuffer& decoded) {
     throw std::runtime_error("ZStd compression not supported");
 }
+
+SharedBuffer CompressionCodecZstd::encodeWithDictionary(const SharedBuffer& raw,
+                                                        const ZstdDictionary& dictionary, int level) {
+    throw std::runtime_error("ZStd compression not supported");
+}
+
+bool CompressionCodecZstd::decodeWithDictionary(const SharedBuffer& encoded, uint32_t uncompressedSize,
+                                                SharedBuffer& decoded, const ZstdDictionary& dictionary) {
+    throw std::runtime_error("ZStd compression not supported");
+}
 }  // namespace pulsar
 
 #endif  // HAS_ZSTD
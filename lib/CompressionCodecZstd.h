@@ -18,14 +18,36 @@
  */
 #pragma once
 
+#include <pulsar/ZstdDictionary.h>
+
 #include "CompressionCodec.h"
 
 namespace pulsar {
 
+/**
+ * The codec of ZSTD. Each thread reuses its own compression and decompression contexts, instead of allocating
+ * new contexts for each payload.
+ */
 class CompressionCodecZstd : public CompressionCodec {
    public:
+    static constexpr int CompressionLevel = 3;
+
+    // The key of the message metadata property whose value is the id of the dictionary used to compress the
+    // payload
+    static constexpr const char* DictionaryIdProperty = "__zstd_dict_id";
+
     SharedBuffer encode(const SharedBuffer& raw);
 
+    SharedBuffer encodeWithLevel(const SharedBuffer& raw, int level);
+
     bool decode(const SharedBuffer& encoded, uint32_t uncompressedSize, SharedBuffer& decoded);
+
+    // The dictionary is digested once for the default level, the other levels load the dictionary for each
+    // payload, which is slower
+    static SharedBuffer encodeWithDictionary(const SharedBuffer& raw, const ZstdDictionary& dictionary,
+                                             int level = 0);
+
+    static bool decodeWithDictionary(const SharedBuffer& encoded, uint32_t uncompressedSize,
+                                     SharedBuffer& decoded, const ZstdDictionary& dictionary);
 };
 }  // namespace pulsar
@@ -67,6 +67,7 @@ ConsumerType ConsumerConfiguration::getConsumerType() const { return impl_->cons
 
 ConsumerConfiguration& ConsumerConfiguration::setMessageListener(MessageListener messageListener) {
     impl_->messageListener = std::move(messageListener);
+    impl_->batchMessageListener = nullptr;
     impl_->hasMessageListener = true;
     return *this;
 }
@@ -75,6 +76,36 @@ MessageListener ConsumerConfiguration::getMessageListener() const { return impl_
 
 bool ConsumerConfiguration::hasMessageListener() const { return impl_->hasMessageListener; }
 
+ConsumerConfiguration& ConsumerConfiguration::setBatchMessageListener(
+    BatchMessageListener batchMessageListener) {
+    if (!batchMessageListener) {
+        // The wrapper below would call the empty listener, so an empty listener unsets both listeners
+        impl_->messageListener = nullptr;
+        impl_->batchMessageListener = nullptr;
+        impl_->hasMessageListener = false;
+        return *this;
+    }
+    // The message listener delivers a single message to the batch message listener, so that the consumers
+    // that only support the message listener can still work
+    impl_->messageListener = [batchMessageListener](Consumer& consumer, const Message& msg) {
+        batchMessageListener(consumer, Messages{msg});
+    };
+    impl_->batchMessageListener = std::move(batchMessageListener);
+    impl_->hasMessageListener = true;
+    return *this;
+}
+
+BatchMessageListener ConsumerConfiguration::getBatchMessageListener() const {
+    return impl_->batchMessageListener;
+}
+
+ConsumerConfiguration& ConsumerConfiguration::setMessageListenerLanes(int messageListenerLanes) {
+    impl_->messageListenerLanes = messageListenerLanes;
+    return *this;
+}
+
+int ConsumerConfiguration::getMessageListenerLanes() const { return impl_->messageListenerLanes; }
+
 ConsumerConfiguration& ConsumerConfiguration::setConsumerEventListener(
     ConsumerEventListenerPtr eventListener) {
     impl_->eventListener = std::move(eventListener);
@@ -100,6 +131,40 @@ int ConsumerConfiguration::getMaxTotalReceiverQueueSizeAcrossPartitions() const
     return impl_->maxTotalReceiverQueueSizeAcrossPartitions;
 }
 
+ConsumerConfiguration& ConsumerConfiguration::setAutoScaledReceiverQueueSizeEnabled(bool enabled) {
+    impl_->autoScaledReceiverQueueSizeEnabled = enabled;
+    return *this;
+}
+
+bool ConsumerConfiguration::isAutoScaledReceiverQueueSizeEnabled() const {
+    return impl_->autoScaledReceiverQueueSizeEnabled;
+}
+
+ConsumerConfiguration& ConsumerConfiguration::setMinReceiverQueueSize(int minReceiverQueueSize) {
+    impl_->minReceiverQueueSize = minReceiverQueueSize;
+    return *this;
+}
+
+int ConsumerConfiguration::getMinReceiverQueueSize() const { return impl_->minReceiverQueueSize; }
+
+ConsumerConfiguration& ConsumerConfiguration::setMaxReceiverQueueBytes(long maxReceiverQueueBytes) {
+    impl_->maxReceiverQueueBytes = maxReceiverQueueBytes;
+    return *this;
+}
+
+long ConsumerConfiguration::getMaxReceiverQueueBytes() const { return impl_->maxReceiverQueueBytes; }
+
+ConsumerConfiguration& ConsumerConfiguration::setReceiveSpinTimeUs(long receiveSpinTimeUs) {
+    if (receiveSpinTimeUs < 0) {
+        throw std::invalid_argument("receiveSpinTimeUs must be non-negative: " +
+                                    std::to_string(receiveSpinTimeUs));
+    }
+    impl_->receiveSpinTimeUs = receiveSpinTimeUs;
+    return *this;
+}
+
+long ConsumerConfiguration::getReceiveSpinTimeUs() const { return impl_->receiveSpinTimeUs; }
+
 const std::string& ConsumerConfiguration::getConsumerName() const { return impl_->consumerName; }
 
 void ConsumerConfiguration::setConsumerName(const std::string& consumerName) {
@@ -151,6 +216,19 @@ ConsumerConfiguration& ConsumerConfiguration::setCryptoKeyReader(CryptoKeyReader
     return *this;
 }
 
+ConsumerConfiguration& ConsumerConfiguration::addZstdDictionary(ZstdDictionaryPtr dictionary) {
+    if (!dictionary) {
+        throw std::invalid_argument("The ZSTD dictionary is null");
+    }
+    impl_->zstdDictionaries[dictionary->getId()] = std::move(dictionary);
+    return *this;
+}
+
+ZstdDictionaryPtr ConsumerConfiguration::getZstdDictionary(uint32_t id) const {
+    auto it = impl_->zstdDictionaries.find(id);
+    return (it != impl_->zstdDictionaries.end()) ? it->second : nullptr;
+}
+
 ConsumerCryptoFailureAction ConsumerConfiguration::getCryptoFailureAction() const {
     return impl_->cryptoFailureAction;
 }
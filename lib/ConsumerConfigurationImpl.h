@@ -21,6 +21,8 @@
 
 #include <pulsar/ConsumerConfiguration.h>
 
+#include <map>
+
 namespace pulsar {
 struct ConsumerConfigurationImpl {
     long unAckedMessagesTimeoutMs{0};
@@ -33,6 +35,7 @@ struct ConsumerConfigurationImpl {
     SchemaInfo schemaInfo;
     ConsumerEventListenerPtr eventListener;
     CryptoKeyReaderPtr cryptoKeyReader;
+    std::map<uint32_t, ZstdDictionaryPtr> zstdDictionaries;
     InitialPosition subscriptionInitialPosition{InitialPosition::InitialPositionLatest};
     int patternAutoDiscoveryPeriod{60};
     RegexSubscriptionMode regexSubscriptionMode{RegexSubscriptionMode::PersistentOnly};
@@ -50,8 +53,14 @@ struct ConsumerConfigurationImpl {
     size_t maxPendingChunkedMessage{10};
     ConsumerType consumerType{ConsumerExclusive};
     MessageListener messageListener;
+    BatchMessageListener batchMessageListener;
+    int messageListenerLanes{1};
     int receiverQueueSize{1000};
     int maxTotalReceiverQueueSizeAcrossPartitions{50000};
+    bool autoScaledReceiverQueueSizeEnabled{false};
+    int minReceiverQueueSize{1};
+    long maxReceiverQueueBytes{0};
+    long receiveSpinTimeUs{0};
     std::string consumerName;
     ConsumerCryptoFailureAction cryptoFailureAction{ConsumerCryptoFailureAction::FAIL};
     BatchReceivePolicy batchReceivePolicy{};
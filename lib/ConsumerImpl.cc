@@ -22,6 +22,7 @@
 #include <pulsar/MessageIdBuilder.h>
 
 #include <algorithm>
+#include <cstdlib>
 
 #include "AckGroupingTracker.h"
 #include "AckGroupingTrackerDisabled.h"
@@ -34,6 +35,7 @@
 #include "ClientConnection.h"
 #include "ClientImpl.h"
 #include "Commands.h"
+#include "CompressionCodecZstd.h"
 #include "ExecutorService.h"
 #include "GetLastMessageIdResponse.h"
 #include "LogUtils.h"
@@ -43,6 +45,7 @@
 #include "MessagesImpl.h"
 #include "ProducerConfigurationImpl.h"
 #include "PulsarApi.pb.h"
+#include "ReceiverQueue.h"
 #include "ResultUtils.h"
 #include "TimeUtils.h"
 #include "TopicName.h"
@@ -59,6 +62,9 @@ DECLARE_LOG_OBJECT()
 using std::chrono::milliseconds;
 using std::chrono::seconds;
 
+// The max number of messages delivered to the listener by a task of the listener executor
+static constexpr int ListenerDispatchBudget = 100;
+
 static boost::optional<MessageId> getStartMessageId(const boost::optional<MessageId>& startMessageId,
                                                     bool inclusive) {
     if (!inclusive || !startMessageId) {
@@ -93,12 +99,12 @@ ConsumerImpl::ConsumerImpl(const ClientImplPtr& client, const std::string& topic
       originalSubscriptionName_(subscriptionName),
       isPersistent_(isPersistent),
       messageListener_(config_.getMessageListener()),
+      batchMessageListener_(config_.getBatchMessageListener()),
       eventListener_(config_.getConsumerEventListener()),
       hasParent_(hasParent),
       consumerTopicType_(consumerTopicType),
       subscriptionMode_(subscriptionMode),
-      // This is the initial capacity of the queue
-      incomingMessages_(std::max(config_.getReceiverQueueSize(), 1)),
+      incomingMessages_(std::chrono::microseconds(config_.getReceiveSpinTimeUs())),
       availablePermits_(0),
       receiverQueueRefillThreshold_(config_.getReceiverQueueSize() / 2),
       consumerId_(client->newConsumerId()),
@@ -184,6 +190,12 @@ ConsumerImpl::~ConsumerImpl() {
 
 void ConsumerImpl::setPartitionIndex(int partitionIndex) { partitionIndex_ = partitionIndex; }
 
+void ConsumerImpl::setReceiverQueueSizeBudget(const std::shared_ptr<ReceiverQueueSizeTuner::Budget>& budget,
+                                              std::function<bool()> isParentQueueEmpty) {
+    receiverQueueSizeBudget_ = budget;
+    isParentQueueEmpty_ = std::move(isParentQueueEmpty);
+}
+
 int ConsumerImpl::getPartitionIndex() { return partitionIndex_; }
 
 uint64_t ConsumerImpl::getConsumerId() { return consumerId_; }
@@ -197,9 +209,44 @@ const std::string& ConsumerImpl::getSubscriptionName() const { return originalSu
 const std::string& ConsumerImpl::getTopic() const { return topic(); }
 
 void ConsumerImpl::start() {
-    HandlerBase::start();
+    // The tuner must exist before the connection is opened, which could happen as soon as the handler starts
+    if (config_.isAutoScaledReceiverQueueSizeEnabled() && config_.getReceiverQueueSize() > 0) {
+        receiverQueueSizeTuner_.reset(new ReceiverQueueSizeTuner(
+            config_.getMinReceiverQueueSize(), config_.getReceiverQueueSize(),
+            config_.getMaxReceiverQueueBytes(),
+            std::chrono::seconds(client_.lock()->conf().getOperationTimeoutSeconds()),
+            receiverQueueSizeBudget_));
+    }
 
     std::weak_ptr<ConsumerImpl> weakSelf{get_shared_this_ptr()};
+    // The lanes must exist before the messages could be received, for the same reason
+    const int numListenerLanes = config_.getMessageListenerLanes();
+    if (messageListener_ && numListenerLanes > 1 && !hasParent_) {
+        // The first lane runs on the listener executor of the consumer, the others are spread over the
+        // listener executors of the client
+        auto client = client_.lock();
+        std::vector<ExecutorServicePtr> executors{listenerExecutor_};
+        for (int i = 1; i < numListenerLanes; i++) {
+            executors.emplace_back(client->getListenerExecutorProvider()->get());
+        }
+        const auto capacity = std::max(1, config_.getReceiverQueueSize() / numListenerLanes);
+        listenerLanes_.reset(new ListenerLanes(
+            executors, static_cast<size_t>(capacity),
+            [weakSelf](std::vector<Message>& msgs) {
+                if (auto self = weakSelf.lock()) {
+                    self->callMessageListener(msgs);
+                }
+            },
+            [weakSelf] {
+                auto self = weakSelf.lock();
+                if (self && self->messageListenerRunning_ && !self->incomingMessages_.empty()) {
+                    self->scheduleListener();
+                }
+            }));
+    }
+
+    HandlerBase::start();
+
     auto connectionSupplier = [weakSelf]() -> ClientConnectionPtr {
         auto self = weakSelf.lock();
         if (!self) {
@@ -301,7 +348,7 @@ void ConsumerImpl::sendFlowPermitsToBroker(const ClientConnectionPtr& cnx, int n
     if (cnx && numMessages > 0) {
         LOG_DEBUG(getName() << "Send more permits: " << numMessages);
         SharedBuffer cmd = Commands::newFlow(consumerId_, static_cast<unsigned int>(numMessages));
-        cnx->sendCommand(cmd);
+        cnx->sendControlCommand(cmd);
     }
 }
 
@@ -332,9 +379,11 @@ Result ConsumerImpl::handleCreateConsumer(const ClientConnectionPtr& cnx, Result
             availablePermits_ = 0;
         }
 
-        LOG_DEBUG(getName() << "Send initial flow permits: " << config_.getReceiverQueueSize());
-        if (config_.getReceiverQueueSize() != 0) {
-            sendFlowPermitsToBroker(cnx, config_.getReceiverQueueSize());
+        const int initialPermits = receiverQueueSizeTuner_ ? receiverQueueSizeTuner_->onConnected()
+                                                           : config_.getReceiverQueueSize();
+        LOG_DEBUG(getName() << "Send initial flow permits: " << initialPermits);
+        if (initialPermits != 0) {
+            sendFlowPermitsToBroker(cnx, initialPermits);
         } else if (messageListener_) {
             sendFlowPermitsToBroker(cnx, 1);
         }
@@ -540,6 +589,11 @@ void ConsumerImpl::messageReceived(const ClientConnectionPtr& cnx, const proto::
                                    bool& isChecksumValid, proto::BrokerEntryMetadata& brokerEntryMetadata,
                                    proto::MessageMetadata& metadata, SharedBuffer& payload) {
     LOG_DEBUG(getName() << "Received Message -- Size: " << payload.readableBytes());
+    if (receiverQueueSizeTuner_) {
+        receiverQueueSizeTuner_->onMessageReceived(
+            metadata.has_num_messages_in_batch() ? metadata.num_messages_in_batch() : 1,
+            metadata.has_uncompressed_size() ? metadata.uncompressed_size() : payload.readableBytes());
+    }
 
     if (!decryptMessageIfNeeded(cnx, msg, metadata, payload)) {
         // Message was discarded or not consumed due to decryption failure
@@ -640,8 +694,8 @@ void ConsumerImpl::messageReceived(const ClientConnectionPtr& cnx, const proto::
             return;
         }
         // Trigger message listener callback in a separate thread
-        while (numOfMessageReceived--) {
-            listenerExecutor_->postWork(std::bind(&ConsumerImpl::internalListener, get_shared_this_ptr()));
+        if (numOfMessageReceived > 0) {
+            scheduleListener();
         }
     }
 }
@@ -671,35 +725,83 @@ void ConsumerImpl::failPendingReceiveCallback() {
     while (!pendingReceives_.empty()) {
         ReceiveCallback callback = pendingReceives_.front();
         pendingReceives_.pop();
+        numPendingReceives_--;
         listenerExecutor_->postWork(std::bind(&ConsumerImpl::notifyPendingReceivedCallback,
                                               get_shared_this_ptr(), ResultAlreadyClosed, msg, callback));
     }
     lock.unlock();
 }
 
-void ConsumerImpl::executeNotifyCallback(Message& msg) {
+void ConsumerImpl::notifyPendingReceivesFromQueue() {
     Lock lock(pendingReceiveMutex_);
-    // if asyncReceive is waiting then notify callback without adding to incomingMessages queue
-    bool asyncReceivedWaiting = !pendingReceives_.empty();
-    ReceiveCallback callback;
-    if (asyncReceivedWaiting) {
-        callback = pendingReceives_.front();
+    Message msg;
+    while (!pendingReceives_.empty() && incomingMessages_.pop(msg, std::chrono::milliseconds(0))) {
+        ReceiveCallback callback = pendingReceives_.front();
         pendingReceives_.pop();
-    }
-    lock.unlock();
-
-    // has pending receive, direct callback.
-    if (asyncReceivedWaiting) {
+        numPendingReceives_--;
         listenerExecutor_->postWork(std::bind(&ConsumerImpl::notifyPendingReceivedCallback,
                                               get_shared_this_ptr(), ResultOk, msg, callback));
-        return;
+    }
+}
+
+void ConsumerImpl::executeNotifyCallback(Message& msg) {
+    // if asyncReceive is waiting then notify callback without adding to incomingMessages queue. The
+    // pendingReceiveMutex_ is only acquired when it's likely, so that the IO thread does not lock it for each
+    // message.
+    if (numPendingReceives_.load() > 0) {
+        Lock lock(pendingReceiveMutex_);
+        if (!pendingReceives_.empty()) {
+            ReceiveCallback callback = pendingReceives_.front();
+            pendingReceives_.pop();
+            numPendingReceives_--;
+            lock.unlock();
+
+            // has pending receive, direct callback.
+            listenerExecutor_->postWork(std::bind(&ConsumerImpl::notifyPendingReceivedCallback,
+                                                  get_shared_this_ptr(), ResultOk, msg, callback));
+            return;
+        }
     }
 
     // try to add incoming messages.
     // config_.getReceiverQueueSize() != 0 or waiting For ZeroQueueSize Message`
     if (messageListener_ || config_.getReceiverQueueSize() != 0 || waitingForZeroQueueSizeMessage) {
         incomingMessages_.push(msg);
-        incomingMessagesSize_.fetch_add(msg.getLength());
+        // It pairs with the increment of numPendingReceives_ before receiveAsync checks the queue again, so
+        // a concurrent receiveAsync either pops the message or is notified here
+        if (numPendingReceives_.load() > 0) {
+            notifyPendingReceivesFromQueue();
+        }
+    }
+
+    // try trigger pending batch messages
+    Lock batchOptionLock(batchReceiveOptionMutex_);
+    if (hasEnoughMessagesForBatchReceive()) {
+        ConsumerImplBase::notifyBatchPendingReceivedCallback();
+    }
+}
+
+void ConsumerImpl::executeNotifyCallback(std::unique_ptr<BatchEntry>&& batch) {
+    // if asyncReceive is waiting then notify callbacks with the first messages of the batch
+    if (numPendingReceives_.load() > 0) {
+        Lock lock(pendingReceiveMutex_);
+        while (!pendingReceives_.empty() && !batch->empty()) {
+            ReceiveCallback callback = pendingReceives_.front();
+            pendingReceives_.pop();
+            numPendingReceives_--;
+            listenerExecutor_->postWork(std::bind(&ConsumerImpl::notifyPendingReceivedCallback,
+                                                  get_shared_this_ptr(), ResultOk, batch->pop(), callback));
+        }
+    }
+
+    if (batch->empty()) {
+        return;
+    }
+    if (messageListener_ || config_.getReceiverQueueSize() != 0 || waitingForZeroQueueSizeMessage) {
+        incomingMessages_.push(std::move(batch));
+        if (numPendingReceives_.load() > 0) {
+            notifyPendingReceivesFromQueue();
+        }
     }
 
     // try trigger pending batch messages
@@ -741,68 +843,66 @@ uint32_t ConsumerImpl::receiveIndividualMessagesFromBatch(const ClientConnection
     auto batchSize = batchedMessage.impl_->metadata.num_messages_in_batch();
     LOG_DEBUG("Received Batch messages of size - " << batchSize
                                                    << " -- msgId: " << batchedMessage.getMessageId());
-    const auto startMessageId = startMessageId_.get();
-
-    int skippedMessages = 0;
-
-    auto acker = BatchMessageAckerImpl::create(batchSize);
-    std::vector<Message> possibleToDeadLetter;
-    for (int i = 0; i < batchSize; i++) {
-        // This is a cheap copy since message contains only one shared pointer (impl_)
-        Message msg = Commands::deSerializeSingleMessageInBatch(batchedMessage, i, batchSize, acker);
-        msg.impl_->setRedeliveryCount(redeliveryCount);
-        msg.impl_->setTopicName(batchedMessage.impl_->topicName_);
-        msg.impl_->convertPayloadToKeyValue(config_.getSchema());
-        if (msg.impl_->brokerEntryMetadata.has_index()) {
-            msg.impl_->brokerEntryMetadata.set_index(msg.impl_->brokerEntryMetadata.index() - batchSize + i +
-                                                     1);
-        }
-
-        if (redeliveryCount >= deadLetterPolicy_.getMaxRedeliverCount()) {
-            possibleToDeadLetter.emplace_back(msg);
-            if (redeliveryCount > deadLetterPolicy_.getMaxRedeliverCount()) {
-                skippedMessages++;
-                continue;
-            }
-        }
 
-        if (startMessageId) {
-            const MessageId& msgId = msg.getMessageId();
-
-            // If we are receiving a batch message, we need to discard messages that were prior
-            // to the startMessageId
-            if (isPersistent_ && msgId.ledgerId() == startMessageId.value().ledgerId() &&
-                msgId.entryId() == startMessageId.value().entryId() &&
-                isPriorBatchIndex(msgId.batchIndex())) {
-                LOG_DEBUG(getName() << "Ignoring message from before the startMessageId"
-                                    << msg.getMessageId());
-                ++skippedMessages;
-                continue;
-            }
+    // Filter the single messages by their indexes so that the skipped ones are never deserialized
+    BitSet deliverable = ackSet;
+    if (ackSet.isEmpty()) {
+        deliverable = BitSet(batchSize);
+        deliverable.set(0, batchSize);
+    }
+    const auto startMessageId = startMessageId_.get();
+    const auto& batchedMessageId = batchedMessage.getMessageId();
+    if (isPersistent_ && startMessageId &&
+        batchedMessageId.ledgerId() == startMessageId.value().ledgerId() &&
+        batchedMessageId.entryId() == startMessageId.value().entryId()) {
+        // If we are receiving a batch message, we need to discard messages that were prior
+        // to the startMessageId
+        int32_t numPriorMessages = 0;
+        while (numPriorMessages < batchSize && isPriorBatchIndex(numPriorMessages)) {
+            numPriorMessages++;
         }
-
-        if (!ackSet.isEmpty() && !ackSet.get(i)) {
-            LOG_DEBUG(getName() << "Ignoring message from " << i
-                                << "th message, which has been acknowledged");
-            ++skippedMessages;
-            continue;
+        if (numPriorMessages > 0) {
+            LOG_DEBUG(getName() << "Ignoring " << numPriorMessages
+                                << " messages from before the startMessageId" << startMessageId.value());
+            deliverable.clear(0, numPriorMessages);
         }
-
-        executeNotifyCallback(msg);
     }
 
-    if (!possibleToDeadLetter.empty()) {
-        possibleSendToDeadLetterTopicMessages_.put(batchedMessage.getMessageId(), possibleToDeadLetter);
+    auto acker = BatchMessageAckerImpl::create(batchSize);
+    std::unique_ptr<BatchEntry> batch{
+        new BatchEntry(batchedMessage, std::move(deliverable), redeliveryCount, config_.getSchema(), acker)};
+    const int32_t numMessages = batch->size();
+    if (numMessages < batchSize) {
+        LOG_DEBUG(getName() << "Ignoring " << (batchSize - numMessages)
+                            << " messages that have been acknowledged or are before the startMessageId");
+    }
+
+    if (redeliveryCount >= deadLetterPolicy_.getMaxRedeliverCount()) {
+        // All messages of the batch might be sent to the dead letter topic, so deserialize them eagerly
+        BitSet all(batchSize);
+        all.set(0, batchSize);
+        BatchEntry entry(batchedMessage, std::move(all), redeliveryCount, config_.getSchema(), acker);
+        std::vector<Message> possibleToDeadLetter;
+        possibleToDeadLetter.reserve(batchSize);
+        while (!entry.empty()) {
+            possibleToDeadLetter.emplace_back(entry.pop());
+        }
+        possibleSendToDeadLetterTopicMessages_.put(batchedMessageId, possibleToDeadLetter);
         if (redeliveryCount > deadLetterPolicy_.getMaxRedeliverCount()) {
-            redeliverUnacknowledgedMessages({batchedMessage.getMessageId()});
+            redeliverUnacknowledgedMessages({batchedMessageId});
+            increaseAvailablePermits(cnx, batchSize);
+            return 0;
         }
     }
 
-    if (skippedMessages > 0) {
-        increaseAvailablePermits(cnx, skippedMessages);
+    if (numMessages > 0) {
+        executeNotifyCallback(std::move(batch));
+    }
+    if (numMessages < batchSize) {
+        increaseAvailablePermits(cnx, batchSize - numMessages);
     }
 
-    return batchSize - skippedMessages;
+    return numMessages;
 }
 
 bool ConsumerImpl::decryptMessageIfNeeded(const ClientConnectionPtr& cnx, const proto::CommandMessage& msg,
@@ -877,6 +977,23 @@ bool ConsumerImpl::uncompressMessageIfNeeded(const ClientConnectionPtr& cnx,
         return false;
     }
 
+    if (compressionType == CompressionZSTD) {
+        uint32_t dictionaryId;
+        if (getZstdDictionaryId(metadata, dictionaryId)) {
+            auto dictionary = config_.getZstdDictionary(dictionaryId);
+            if (!dictionary || !CompressionCodecZstd::decodeWithDictionary(payload, uncompressedSize,
+                                                                           payload, *dictionary)) {
+                LOG_ERROR(getName() << "Failed to decompress message with " << uncompressedSize  //
+                                    << " and the ZSTD dictionary " << dictionaryId
+                                    << (dictionary ? "" : " that is not added")  //
+                                    << " at  " << messageIdData.ledgerid() << ":" << messageIdData.entryid());
+                discardCorruptedMessage(cnx, messageIdData, CommandAck_ValidationError_DecompressionError);
+                return false;
+            }
+            return true;
+        }
+    }
+
     if (!CompressionCodecProvider::getCodec(compressionType).decode(payload, uncompressedSize, payload)) {
         LOG_ERROR(getName() << "Failed to decompress message with " << uncompressedSize  //
                             << " at  " << messageIdData.ledgerid() << ":" << messageIdData.entryid());
@@ -887,6 +1004,16 @@ bool ConsumerImpl::uncompressMessageIfNeeded(const ClientConnectionPtr& cnx,
     return true;
 }
 
+bool ConsumerImpl::getZstdDictionaryId(const proto::MessageMetadata& metadata, uint32_t& dictionaryId) {
+    for (const auto& property : metadata.properties()) {
+        if (property.key() == CompressionCodecZstd::DictionaryIdProperty) {
+            dictionaryId = static_cast<uint32_t>(std::strtoul(property.value().c_str(), nullptr, 10));
+            return true;
+        }
+    }
+    return false;
+}
+
 void ConsumerImpl::discardCorruptedMessage(const ClientConnectionPtr& cnx,
                                            const proto::MessageIdData& messageId,
                                            CommandAck_ValidationError validationError) {
@@ -896,30 +1023,90 @@ void ConsumerImpl::discardCorruptedMessage(const ClientConnectionPtr& cnx,
     SharedBuffer cmd = Commands::newAck(consumerId_, messageId.ledgerid(), messageId.entryid(), {},
                                         CommandAck_AckType_Individual, validationError);
 
-    cnx->sendCommand(cmd);
+    cnx->sendControlCommand(cmd);
     increaseAvailablePermits(cnx);
 }
 
-void ConsumerImpl::internalListener() {
-    if (!messageListenerRunning_) {
-        return;
+void ConsumerImpl::scheduleListener() {
+    if (!listenerScheduled_.exchange(true)) {
+        listenerExecutor_->postWork(std::bind(&ConsumerImpl::internalListener, get_shared_this_ptr()));
     }
+}
+
+void ConsumerImpl::internalListener() {
+    // Deliver the available messages up to the budget, then yield the listener executor to the other
+    // consumers that share it
     Message msg;
-    if (!incomingMessages_.pop(msg, std::chrono::milliseconds(0))) {
-        // This will only happen when the connection got reset and we cleared the queue
-        return;
+    bool blocked = false;
+    size_t lane = 0;
+    if (listenerLanes_) {
+        // Dispatch the messages to their lanes in order. If the lane of the first message is full, stop until
+        // the lane has processed some messages, so that the flow permits are held back by the slowest lane
+        const std::function<bool(const Message&)> hasRoom = [this, &blocked, &lane](const Message& front) {
+            lane = listenerLanes_->laneOf(front);
+            blocked = listenerLanes_->isFull(lane);
+            return !blocked;
+        };
+        for (int i = 0; i < ListenerDispatchBudget && messageListenerRunning_ &&
+                        incomingMessages_.popIf(msg, hasRoom);
+             i++) {
+            trackMessage(msg.getMessageId());
+            listenerLanes_->push(lane, msg);
+        }
+    } else {
+        std::vector<Message> msgs;
+        for (int i = 0; i < ListenerDispatchBudget && messageListenerRunning_ &&
+                        incomingMessages_.pop(msg, std::chrono::milliseconds(0));
+             i++) {
+            trackMessage(msg.getMessageId());
+            msgs.emplace_back(std::move(msg));
+        }
+        callMessageListener(msgs);
     }
-    trackMessage(msg.getMessageId());
-    try {
-        consumerStatsBasePtr_->receivedMessage(msg, ResultOk);
-        lastDequedMessageId_ = msg.getMessageId();
-        Consumer consumer{get_shared_this_ptr()};
-        Message interceptMsg = interceptors_->beforeConsume(Consumer(shared_from_this()), msg);
-        messageListener_(consumer, interceptMsg);
-    } catch (const std::exception& e) {
-        LOG_ERROR(getName() << "Exception thrown from listener" << e.what());
+
+    listenerScheduled_ = false;
+    // It pairs with scheduleListener() after a message is pushed or a lane has processed some messages, so
+    // the messages that were pushed after the queue was found empty, or that are left by the budget or by a
+    // full lane, are delivered by a next task
+    if (messageListenerRunning_ && !incomingMessages_.empty() && !(blocked && listenerLanes_->isFull(lane))) {
+        scheduleListener();
+    }
+}
+
+void ConsumerImpl::callMessageListener(std::vector<Message>& msgs) {
+    Consumer consumer{get_shared_this_ptr()};
+    std::vector<Message> receivedMessages;
+    Messages messages;
+    for (auto& msg : msgs) {
+        try {
+            consumerStatsBasePtr_->receivedMessage(msg, ResultOk);
+            {
+                Lock lock(mutexForMessageId_);
+                lastDequedMessageId_ = msg.getMessageId();
+            }
+            Message interceptMsg = interceptors_->beforeConsume(consumer, msg);
+            if (batchMessageListener_) {
+                receivedMessages.emplace_back(msg);
+                messages.emplace_back(std::move(interceptMsg));
+                continue;
+            }
+            messageListener_(consumer, interceptMsg);
+        } catch (const std::exception& e) {
+            LOG_ERROR(getName() << "Exception thrown from listener" << e.what());
+        }
+        messageProcessed(msg, false);
+    }
+
+    if (!messages.empty()) {
+        try {
+            batchMessageListener_(consumer, messages);
+        } catch (const std::exception& e) {
+            LOG_ERROR(getName() << "Exception thrown from batch listener" << e.what());
+        }
+        for (auto& receivedMessage : receivedMessages) {
+            messageProcessed(receivedMessage, false);
+        }
     }
-    messageProcessed(msg, false);
 }
 
 Result ConsumerImpl::fetchSingleMessageFromBroker(Message& msg) {
@@ -1016,6 +1203,7 @@ void ConsumerImpl::receiveAsync(const ReceiveCallback& callback) {
         callback(ResultOk, msg);
     } else if (config_.getReceiverQueueSize() == 0) {
         pendingReceives_.push(callback);
+        numPendingReceives_++;
         // If connection_ is nullptr, sendFlowPermitsToBroker does nothing.
         // In other words, a flow permit will not be sent until setCnx(cnx) is executed in
         // handleCreateConsumer.
@@ -1024,7 +1212,12 @@ void ConsumerImpl::receiveAsync(const ReceiveCallback& callback) {
         mutexlock.unlock();
     } else {
         pendingReceives_.push(callback);
+        numPendingReceives_++;
         pendingReceiveMutexLock.unlock();
+        // The IO thread might have pushed a message before it saw the pending receive
+        if (!incomingMessages_.empty()) {
+            notifyPendingReceivesFromQueue();
+        }
     }
 }
 
@@ -1089,8 +1282,6 @@ void ConsumerImpl::messageProcessed(Message& msg, bool track) {
     lastDequedMessageId_ = msg.getMessageId();
     lock.unlock();
 
-    incomingMessagesSize_.fetch_sub(msg.getLength());
-
     ClientConnectionPtr currentCnx = getCnx().lock();
     if (currentCnx && msg.impl_->cnx_ != currentCnx.get()) {
         LOG_DEBUG(getName() << "Not adding permit since connection is different.");
@@ -1152,10 +1343,20 @@ void ConsumerImpl::clearReceiveQueue() {
 
 void ConsumerImpl::increaseAvailablePermits(const ClientConnectionPtr& currentCnx, int delta) {
     int newAvailablePermits = availablePermits_.fetch_add(delta) + delta;
+    const int refillThreshold =
+        receiverQueueSizeTuner_ ? receiverQueueSizeTuner_->refillThreshold() : receiverQueueRefillThreshold_;
 
-    while (newAvailablePermits >= receiverQueueRefillThreshold_ && messageListenerRunning_) {
+    while (newAvailablePermits >= refillThreshold && messageListenerRunning_) {
         if (availablePermits_.compare_exchange_weak(newAvailablePermits, 0)) {
-            sendFlowPermitsToBroker(currentCnx, newAvailablePermits);
+            if (receiverQueueSizeTuner_) {
+                // The receiver queue size is resized with the refill
+                const bool starved =
+                    incomingMessages_.empty() && (!isParentQueueEmpty_ || isParentQueueEmpty_());
+                sendFlowPermitsToBroker(currentCnx,
+                                        receiverQueueSizeTuner_->onRefill(newAvailablePermits, starved));
+            } else {
+                sendFlowPermitsToBroker(currentCnx, newAvailablePermits);
+            }
             break;
         }
     }
@@ -1410,11 +1611,9 @@ Result ConsumerImpl::resumeMessageListener() {
         return ResultOk;
     }
     messageListenerRunning_ = true;
-    const size_t count = incomingMessages_.size();
-
-    for (size_t i = 0; i < count; i++) {
+    if (!incomingMessages_.empty()) {
         // Trigger message listener callback in a separate thread
-        listenerExecutor_->postWork(std::bind(&ConsumerImpl::internalListener, get_shared_this_ptr()));
+        scheduleListener();
     }
     // Check current permits and determine whether to send FLOW command
     this->increaseAvailablePermits(getCnx().lock(), 0);
@@ -1797,7 +1996,7 @@ bool ConsumerImpl::hasEnoughMessagesForBatchReceive() const {
     return (batchReceivePolicy_.getMaxNumMessages() > 0 &&
             incomingMessages_.size() >= batchReceivePolicy_.getMaxNumMessages()) ||
            (batchReceivePolicy_.getMaxNumBytes() > 0 &&
-            incomingMessagesSize_ >= batchReceivePolicy_.getMaxNumBytes());
+            incomingMessages_.bytes() >= batchReceivePolicy_.getMaxNumBytes());
 }
 
 std::shared_ptr<ConsumerImpl> ConsumerImpl::get_shared_this_ptr() {
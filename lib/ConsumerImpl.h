@@ -34,13 +34,15 @@
 #include "CompressionCodec.h"
 #include "ConsumerImplBase.h"
 #include "ConsumerInterceptors.h"
+#include "ListenerLanes.h"
 #include "MapCache.h"
 #include "MessageIdImpl.h"
 #include "NegativeAcksTracker.h"
+#include "ReceiverQueue.h"
+#include "ReceiverQueueSizeTuner.h"
 #include "Synchronized.h"
 #include "TestUtil.h"
 #include "TimeUtils.h"
-#include "UnboundedBlockingQueue.h"
 #include "lib/SynchronizedHashMap.h"
 
 namespace pulsar {
@@ -94,6 +96,11 @@ class ConsumerImpl : public ConsumerImplBase {
                  const boost::optional<MessageId>& startMessageId = boost::none);
     ~ConsumerImpl();
     void setPartitionIndex(int partitionIndex);
+    // Share the budget of the auto-scaled receiver queue sizes with the other consumers, before start().
+    // Since the messages are moved to the queue of the parent consumer, its emptiness tells whether this
+    // consumer is starved.
+    void setReceiverQueueSizeBudget(const std::shared_ptr<ReceiverQueueSizeTuner::Budget>& budget,
+                                    std::function<bool()> isParentQueueEmpty);
     int getPartitionIndex();
     void sendFlowPermitsToBroker(const ClientConnectionPtr& cnx, int numMessages);
     uint64_t getConsumerId();
@@ -163,7 +170,10 @@ class ConsumerImpl : public ConsumerImplBase {
 
     Result handleCreateConsumer(const ClientConnectionPtr& cnx, Result result);
 
+    void scheduleListener();
     void internalListener();
+    // Call the listener with the messages taken from the receiver queue, in order
+    void callMessageListener(std::vector<Message>& msgs);
 
     void internalConsumerChangeListener(bool isActive);
 
@@ -177,6 +187,8 @@ class ConsumerImpl : public ConsumerImplBase {
     bool uncompressMessageIfNeeded(const ClientConnectionPtr& cnx, const proto::MessageIdData& messageIdData,
                                    const proto::MessageMetadata& metadata, SharedBuffer& payload,
                                    bool checkMaxMessageSize);
+    // Return false if the payload is not compressed with a ZSTD dictionary
+    static bool getZstdDictionaryId(const proto::MessageMetadata& metadata, uint32_t& dictionaryId);
     void discardCorruptedMessage(const ClientConnectionPtr& cnx, const proto::MessageIdData& messageId,
                                  CommandAck_ValidationError validationError);
     void increaseAvailablePermits(const ClientConnectionPtr& currentCnx, int delta = 1);
@@ -195,6 +207,8 @@ class ConsumerImpl : public ConsumerImplBase {
     Result receiveHelper(Message& msg);
     Result receiveHelper(Message& msg, int timeout);
     void executeNotifyCallback(Message& msg);
+    void executeNotifyCallback(std::unique_ptr<BatchEntry>&& batch);
+    void notifyPendingReceivesFromQueue();
     void notifyPendingReceivedCallback(Result result, Message& message, const ReceiveCallback& callback);
     void failPendingReceiveCallback();
     void setNegativeAcknowledgeEnabledForTesting(bool enabled) override;
@@ -226,17 +240,27 @@ class ConsumerImpl : public ConsumerImplBase {
     std::string originalSubscriptionName_;
     const bool isPersistent_;
     MessageListener messageListener_;
+    BatchMessageListener batchMessageListener_;
+    // Whether an internalListener() task is posted to the listener executor and not finished
+    std::atomic_bool listenerScheduled_{false};
+    // The lanes that run the message listener in parallel by the message keys, if enabled
+    std::unique_ptr<ListenerLanes> listenerLanes_;
     ConsumerEventListenerPtr eventListener_;
     bool hasParent_;
     ConsumerTopicType consumerTopicType_;
 
     const Commands::SubscriptionMode subscriptionMode_;
 
-    UnboundedBlockingQueue<Message> incomingMessages_;
-    std::atomic_int incomingMessagesSize_ = {0};
+    ReceiverQueue incomingMessages_;
     std::queue<ReceiveCallback> pendingReceives_;
+    // The size of pendingReceives_, which can be read without acquiring pendingReceiveMutex_
+    std::atomic_size_t numPendingReceives_{0};
     std::atomic_int availablePermits_;
     const int receiverQueueRefillThreshold_;
+    std::shared_ptr<ReceiverQueueSizeTuner::Budget> receiverQueueSizeBudget_;
+    std::function<bool()> isParentQueueEmpty_;
+    // Auto-scales the receiver queue size, if enabled
+    std::unique_ptr<ReceiverQueueSizeTuner> receiverQueueSizeTuner_;
     uint64_t consumerId_;
     const std::string consumerStr_;
     int32_t partitionIndex_ = -1;
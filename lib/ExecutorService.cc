@@ -20,11 +20,15 @@
 
 #include "LogUtils.h"
 #include "TimeUtils.h"
+#include "TimingWheel.h"
 DECLARE_LOG_OBJECT()
 
 namespace pulsar {
 
-ExecutorService::ExecutorService() {}
+// The granularity of the WheelTimers, which are used for the timeouts and the delays of milliseconds
+static constexpr std::chrono::milliseconds TimingWheelTick{1};
+
+ExecutorService::ExecutorService() : timingWheel_(new TimingWheel(io_service_, TimingWheelTick)) {}
 
 ExecutorService::~ExecutorService() { close(0); }
 
@@ -95,6 +99,22 @@ TcpResolverPtr ExecutorService::createTcpResolver() {
     }
 }
 
+#ifdef PULSAR_HAS_UNIX_SOCKETS
+/*
+ *  factory method of ASIO::local::stream_protocol::socket associated with io_service_ instance
+ *  @ returns shared_ptr to this socket
+ */
+UnixSocketPtr ExecutorService::createUnixSocket() {
+    try {
+        return UnixSocketPtr(new ASIO::local::stream_protocol::socket(io_service_));
+    } catch (const ASIO_SYSTEM_ERROR &e) {
+        restart();
+        auto error = std::string("Failed to create unix socket: ") + e.what();
+        throw std::runtime_error(error);
+    }
+}
+#endif
+
 DeadlineTimerPtr ExecutorService::createDeadlineTimer() {
     try {
         return DeadlineTimerPtr(new ASIO::steady_timer(io_service_));
@@ -25,10 +25,12 @@
 #ifdef USE_ASIO
 #include <asio/io_service.hpp>
 #include <asio/ip/tcp.hpp>
+#include <asio/local/stream_protocol.hpp>
 #include <asio/ssl.hpp>
 #else
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
 #include <boost/asio/ssl.hpp>
 #endif
 #include <chrono>
@@ -41,9 +43,14 @@
 #include "AsioTimer.h"
 
 namespace pulsar {
+class TimingWheel;
+
 typedef std::shared_ptr<ASIO::ip::tcp::socket> SocketPtr;
 typedef std::shared_ptr<ASIO::ssl::stream<ASIO::ip::tcp::socket &> > TlsSocketPtr;
 typedef std::shared_ptr<ASIO::ip::tcp::resolver> TcpResolverPtr;
+#ifdef PULSAR_HAS_UNIX_SOCKETS
+typedef std::shared_ptr<ASIO::local::stream_protocol::socket> UnixSocketPtr;
+#endif
 class PULSAR_PUBLIC ExecutorService : public std::enable_shared_from_this<ExecutorService> {
    public:
     using IOService = ASIO::io_service;
@@ -60,8 +67,14 @@ class PULSAR_PUBLIC ExecutorService : public std::enable_shared_from_this<Execut
     static TlsSocketPtr createTlsSocket(SocketPtr &socket, ASIO::ssl::context &ctx);
     // throws std::runtime_error if failed
     TcpResolverPtr createTcpResolver();
+#ifdef PULSAR_HAS_UNIX_SOCKETS
+    // throws std::runtime_error if failed
+    UnixSocketPtr createUnixSocket();
+#endif
     // throws std::runtime_error if failed
     DeadlineTimerPtr createDeadlineTimer();
+    // The WheelTimers of this executor share the timing wheel, see TimingWheel.h
+    TimingWheel &getTimingWheel() noexcept { return *timingWheel_; }
     void postWork(std::function<void(void)> task);
 
     // See TimeoutProcessor for the semantics of the parameter.
@@ -75,6 +88,7 @@ class PULSAR_PUBLIC ExecutorService : public std::enable_shared_from_this<Execut
      * io_service is our interface to os, io object schedule async ops on this object
      */
     IOService io_service_;
+    std::unique_ptr<TimingWheel> timingWheel_;
 
     std::atomic_bool closed_{false};
     std::mutex mutex_;
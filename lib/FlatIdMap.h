@@ -0,0 +1,244 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef LIB_FLATIDMAP_H_
+#define LIB_FLATIDMAP_H_
+
+#include <boost/optional.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace pulsar {
+
+/**
+ * A map from the ids assigned by the client (request ids, producer ids and consumer ids) to values.
+ *
+ * It's an open addressing hash table with linear probing whose entries are stored inline in a single array,
+ * so inserting and erasing do not allocate unless the table grows. Erasing shifts the following entries
+ * back instead of leaving tombstones, so the lookups stay short after many insertions and removals.
+ *
+ * The interface is a subset of std::map's. Like with std::unordered_map, the iteration order is unspecified
+ * and the iterators are invalidated by insertions and removals.
+ */
+template <typename V>
+class FlatIdMap {
+   public:
+    using key_type = uint64_t;
+    using mapped_type = V;
+    using value_type = std::pair<uint64_t, V>;
+
+    template <typename Value, typename Slots>
+    class Iterator {
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FlatIdMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        Iterator(Slots* slots, size_t index) : slots_(slots), index_(index) { skipEmptySlots(); }
+
+        // Allow the conversion from iterator to const_iterator
+        template <typename OtherValue, typename OtherSlots,
+                  typename = typename std::enable_if<std::is_convertible<OtherSlots*, Slots*>::value>::type>
+        Iterator(const Iterator<OtherValue, OtherSlots>& other)
+            : slots_(other.slots_), index_(other.index_) {}
+
+        reference operator*() const { return *(*slots_)[index_]; }
+        pointer operator->() const { return &*(*slots_)[index_]; }
+
+        Iterator& operator++() {
+            index_++;
+            skipEmptySlots();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            auto it = *this;
+            ++*this;
+            return it;
+        }
+
+        template <typename OtherValue, typename OtherSlots>
+        bool operator==(const Iterator<OtherValue, OtherSlots>& rhs) const {
+            return index_ == rhs.index_;
+        }
+        template <typename OtherValue, typename OtherSlots>
+        bool operator!=(const Iterator<OtherValue, OtherSlots>& rhs) const {
+            return index_ != rhs.index_;
+        }
+
+       private:
+        Slots* slots_;
+        size_t index_;
+
+        void skipEmptySlots() {
+            while (index_ < slots_->size() && !(*slots_)[index_]) {
+                index_++;
+            }
+        }
+
+        friend class FlatIdMap;
+        template <typename, typename>
+        friend class Iterator;
+    };
+
+    using Slots = std::vector<boost::optional<value_type>>;
+    using iterator = Iterator<value_type, Slots>;
+    using const_iterator = Iterator<const value_type, const Slots>;
+
+    FlatIdMap() = default;
+    FlatIdMap(const FlatIdMap&) = default;
+    FlatIdMap& operator=(const FlatIdMap&) = default;
+
+    // The moved map is left empty so that it can still be used
+    FlatIdMap(FlatIdMap&& rhs) noexcept : slots_(std::move(rhs.slots_)), size_(rhs.size_) { rhs.clear(); }
+
+    FlatIdMap& operator=(FlatIdMap&& rhs) noexcept {
+        slots_ = std::move(rhs.slots_);
+        size_ = rhs.size_;
+        rhs.clear();
+        return *this;
+    }
+
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    iterator begin() noexcept { return iterator(&slots_, 0); }
+    iterator end() noexcept { return iterator(&slots_, slots_.size()); }
+    const_iterator begin() const noexcept { return const_iterator(&slots_, 0); }
+    const_iterator end() const noexcept { return const_iterator(&slots_, slots_.size()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    iterator find(uint64_t key) noexcept { return iterator(&slots_, findIndex(key)); }
+    const_iterator find(uint64_t key) const noexcept { return const_iterator(&slots_, findIndex(key)); }
+
+    /**
+     * Insert the value if the key does not exist.
+     *
+     * @return the iterator of the entry with the key and whether the value was inserted
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(uint64_t key, Args&&... args) {
+        const size_t existingIndex = findIndex(key);
+        if (existingIndex != slots_.size()) {
+            return std::make_pair(iterator(&slots_, existingIndex), false);
+        }
+        if ((size_ + 1) * 2 > slots_.size()) {
+            rehash(slots_.empty() ? MinCapacity : slots_.size() * 2);
+        }
+        size_t index = indexOf(key);
+        while (slots_[index]) {
+            index = nextIndex(index);
+        }
+        slots_[index].emplace(std::piecewise_construct, std::forward_as_tuple(key),
+                              std::forward_as_tuple(std::forward<Args>(args)...));
+        size_++;
+        return std::make_pair(iterator(&slots_, index), true);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& kv) { return emplace(kv.first, kv.second); }
+    std::pair<iterator, bool> insert(value_type&& kv) { return emplace(kv.first, std::move(kv.second)); }
+
+    void erase(iterator it) { eraseIndex(it.index_); }
+
+    size_t erase(uint64_t key) {
+        const size_t index = findIndex(key);
+        if (index == slots_.size()) {
+            return 0;
+        }
+        eraseIndex(index);
+        return 1;
+    }
+
+    void clear() noexcept {
+        slots_.clear();
+        size_ = 0;
+    }
+
+   private:
+    static constexpr size_t MinCapacity = 16;
+
+    // The capacity is always a power of two, it's 0 only before the first insertion
+    Slots slots_;
+    size_t size_ = 0;
+
+    size_t indexOf(uint64_t key) const noexcept {
+        // The ids are assigned sequentially, the multiplicative hash spreads them over the table
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & (slots_.size() - 1);
+    }
+
+    size_t nextIndex(size_t index) const noexcept { return (index + 1) & (slots_.size() - 1); }
+
+    // Return slots_.size() if the key does not exist
+    size_t findIndex(uint64_t key) const noexcept {
+        if (slots_.empty()) {
+            return 0;
+        }
+        for (size_t index = indexOf(key);; index = nextIndex(index)) {
+            const auto& slot = slots_[index];
+            if (!slot) {
+                return slots_.size();
+            }
+            if (slot->first == key) {
+                return index;
+            }
+        }
+    }
+
+    void eraseIndex(size_t index) {
+        slots_[index] = boost::none;
+        size_--;
+        // Move back the following entries of the same probe sequence into the hole
+        for (size_t next = nextIndex(index); slots_[next]; next = nextIndex(next)) {
+            const size_t ideal = indexOf(slots_[next]->first);
+            // The entry can be moved if the hole is between its ideal slot and its current slot, cyclically
+            const bool movable = (index <= next) ? (ideal <= index || ideal > next)
+                                                 : (ideal <= index && ideal > next);
+            if (movable) {
+                slots_[index] = std::move(slots_[next]);
+                slots_[next] = boost::none;
+                index = next;
+            }
+        }
+    }
+
+    void rehash(size_t capacity) {
+        Slots oldSlots(capacity);
+        oldSlots.swap(slots_);
+        for (auto& slot : oldSlots) {
+            if (slot) {
+                size_t index = indexOf(slot->first);
+                while (slots_[index]) {
+                    index = nextIndex(index);
+                }
+                slots_[index] = std::move(slot);
+            }
+        }
+    }
+};
+
+}  // namespace pulsar
+
+#endif /* LIB_FLATIDMAP_H_ */
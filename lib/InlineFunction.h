@@ -0,0 +1,160 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef LIB_INLINEFUNCTION_H_
+#define LIB_INLINEFUNCTION_H_
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace pulsar {
+
+template <typename Signature, size_t Capacity>
+class InlineFunction;
+
+/**
+ * A copyable wrapper of a callable like std::function, except that the callable is always stored in an inline
+ * buffer of `Capacity` bytes, so that creating, copying and moving the wrapper never allocate. Wrapping a
+ * callable that does not fit in the buffer fails to compile.
+ *
+ * Like std::function, it's empty after being constructed from nullptr, from an empty std::function or from a
+ * null function pointer, and calling an empty InlineFunction throws std::bad_function_call.
+ */
+template <typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity> {
+   public:
+    InlineFunction() noexcept = default;
+    InlineFunction(std::nullptr_t) noexcept {}
+
+    template <typename F, typename Callable = typename std::decay<F>::type,
+              typename = typename std::enable_if<!std::is_same<Callable, InlineFunction>::value>::type>
+    InlineFunction(F&& f) {
+        static_assert(sizeof(Callable) <= Capacity, "The callable does not fit in the inline buffer");
+        static_assert(alignof(Callable) <= alignof(std::max_align_t), "The callable is over-aligned");
+        static_assert(std::is_nothrow_move_constructible<Callable>::value,
+                      "The callable must be nothrow move constructible");
+        if (!isEmpty(f)) {
+            new (&storage_) Callable(std::forward<F>(f));
+            ops_ = &OpsOf<Callable>::ops;
+        }
+    }
+
+    InlineFunction(const InlineFunction& rhs) : ops_(rhs.ops_) {
+        if (ops_) {
+            ops_->copy(&storage_, &rhs.storage_);
+        }
+    }
+
+    InlineFunction(InlineFunction&& rhs) noexcept : ops_(rhs.ops_) {
+        if (ops_) {
+            ops_->move(&storage_, &rhs.storage_);
+            rhs.reset();
+        }
+    }
+
+    ~InlineFunction() { reset(); }
+
+    InlineFunction& operator=(const InlineFunction& rhs) {
+        if (this != &rhs) {
+            InlineFunction copy{rhs};
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    InlineFunction& operator=(InlineFunction&& rhs) noexcept {
+        if (this != &rhs) {
+            reset();
+            if (rhs.ops_) {
+                rhs.ops_->move(&storage_, &rhs.storage_);
+                ops_ = rhs.ops_;
+                rhs.reset();
+            }
+        }
+        return *this;
+    }
+
+    InlineFunction& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+    R operator()(Args... args) const {
+        if (!ops_) {
+            throw std::bad_function_call();
+        }
+        return ops_->invoke(&storage_, std::forward<Args>(args)...);
+    }
+
+   private:
+    struct Ops {
+        R (*invoke)(void* callable, Args&&... args);
+        void (*copy)(void* dst, const void* src);
+        void (*move)(void* dst, void* src) noexcept;
+        void (*destroy)(void* callable) noexcept;
+    };
+
+    template <typename Callable>
+    struct OpsOf {
+        static R invoke(void* callable, Args&&... args) {
+            return (*static_cast<Callable*>(callable))(std::forward<Args>(args)...);
+        }
+        static void copy(void* dst, const void* src) {
+            new (dst) Callable(*static_cast<const Callable*>(src));
+        }
+        static void move(void* dst, void* src) noexcept {
+            new (dst) Callable(std::move(*static_cast<Callable*>(src)));
+        }
+        static void destroy(void* callable) noexcept { static_cast<Callable*>(callable)->~Callable(); }
+
+        static constexpr Ops ops{&invoke, &copy, &move, &destroy};
+    };
+
+    // The callable is mutable like the target of a std::function, which can be called by a const reference
+    mutable typename std::aligned_storage<Capacity, alignof(std::max_align_t)>::type storage_;
+    const Ops* ops_ = nullptr;
+
+    template <typename F>
+    static bool isEmpty(const F&) noexcept {
+        return false;
+    }
+    template <typename Signature>
+    static bool isEmpty(const std::function<Signature>& f) noexcept {
+        return !f;
+    }
+    template <typename T>
+    static bool isEmpty(T* f) noexcept {
+        return f == nullptr;
+    }
+
+    void reset() noexcept {
+        if (ops_) {
+            ops_->destroy(&storage_);
+            ops_ = nullptr;
+        }
+    }
+};
+
+}  // namespace pulsar
+
+#endif /* LIB_INLINEFUNCTION_H_ */
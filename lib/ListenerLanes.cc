@@ -0,0 +1,80 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "ListenerLanes.h"
+
+namespace pulsar {
+
+// The max number of messages processed by a task, so that the lanes that share an executor are not starved
+static constexpr size_t LaneDispatchBudget = 100;
+
+ListenerLanes::ListenerLanes(const std::vector<ExecutorServicePtr>& executors, size_t capacity,
+                             Processor processor, std::function<void()> onProcessed)
+    : capacity_(capacity) {
+    auto callbacks = std::make_shared<Callbacks>(Callbacks{std::move(processor), std::move(onProcessed)});
+    lanes_.reserve(executors.size());
+    for (const auto& executor : executors) {
+        lanes_.emplace_back(std::make_shared<Lane>(executor, callbacks));
+    }
+}
+
+size_t ListenerLanes::laneOf(const Message& msg) {
+    if (msg.hasOrderingKey()) {
+        return static_cast<size_t>(hash_.makeHash(msg.getOrderingKey())) % lanes_.size();
+    } else if (msg.hasPartitionKey()) {
+        return static_cast<size_t>(hash_.makeHash(msg.getPartitionKey())) % lanes_.size();
+    }
+    return nextLane_++ % lanes_.size();
+}
+
+void ListenerLanes::push(size_t lane, const Message& msg) {
+    auto& target = *lanes_[lane];
+    // Count the message before pushing it so that the size never underflows in drain()
+    target.size++;
+    target.messages.push(msg);
+    target.schedule();
+}
+
+void ListenerLanes::Lane::schedule() {
+    if (!scheduled.exchange(true)) {
+        auto self = shared_from_this();
+        executor->postWork([self] { self->drain(); });
+    }
+}
+
+void ListenerLanes::Lane::drain() {
+    std::vector<Message> msgs;
+    Message msg;
+    while (msgs.size() < LaneDispatchBudget && messages.pop(msg)) {
+        msgs.emplace_back(std::move(msg));
+    }
+    if (!msgs.empty()) {
+        callbacks->processor(msgs);
+        size -= msgs.size();
+        callbacks->onProcessed();
+    }
+
+    scheduled = false;
+    // It pairs with schedule() after a message is pushed, the messages that were pushed after the queue was
+    // found empty, or that are left by the budget, are processed by a next task
+    if (size > 0) {
+        schedule();
+    }
+}
+
+}  // namespace pulsar
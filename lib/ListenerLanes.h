@@ -0,0 +1,101 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef LIB_LISTENERLANES_H_
+#define LIB_LISTENERLANES_H_
+
+#include <pulsar/Message.h>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "ExecutorService.h"
+#include "MpscQueue.h"
+#include "Murmur3_32Hash.h"
+
+namespace pulsar {
+
+/**
+ * The lanes that run a message listener in parallel while preserving the order of the messages that have the
+ * same key.
+ *
+ * Each message is assigned to a lane by the Murmur3 hash of its ordering key, or of its partition key if it
+ * has no ordering key, so that the messages with the same key are processed one by one in the order they
+ * were pushed. The messages without a key are assigned to the lanes in a round-robin way. Each lane is
+ * drained by the tasks posted to its executor, the lanes that share an executor are processed in turn.
+ *
+ * Each lane is bounded and a message keeps its slot until it has been processed, so that a slow lane stops
+ * the dispatching instead of buffering the messages.
+ *
+ * laneOf() and push() must be called from one thread at a time, while the lanes are processed concurrently.
+ */
+class ListenerLanes {
+   public:
+    // Process the messages taken from a lane, in order
+    using Processor = std::function<void(std::vector<Message>&)>;
+
+    /**
+     * @param executors the executor of each lane
+     * @param capacity the max number of messages of a lane that are not processed yet
+     * @param processor the processor of the messages, which is shared by all lanes
+     * @param onProcessed the callback after the messages taken from a lane are processed
+     */
+    ListenerLanes(const std::vector<ExecutorServicePtr>& executors, size_t capacity, Processor processor,
+                  std::function<void()> onProcessed);
+
+    size_t numLanes() const noexcept { return lanes_.size(); }
+
+    size_t laneOf(const Message& msg);
+
+    bool isFull(size_t lane) const noexcept { return lanes_[lane]->size >= capacity_; }
+
+    void push(size_t lane, const Message& msg);
+
+   private:
+    struct Callbacks {
+        Processor processor;
+        std::function<void()> onProcessed;
+    };
+
+    struct Lane : std::enable_shared_from_this<Lane> {
+        const ExecutorServicePtr executor;
+        const std::shared_ptr<Callbacks> callbacks;
+        MpscQueue<Message> messages;
+        // The number of messages that are pushed and not processed yet
+        std::atomic_size_t size{0};
+        std::atomic_bool scheduled{false};
+
+        Lane(const ExecutorServicePtr& executor, const std::shared_ptr<Callbacks>& callbacks)
+            : executor(executor), callbacks(callbacks) {}
+
+        void schedule();
+        void drain();
+    };
+
+    std::vector<std::shared_ptr<Lane>> lanes_;
+    const size_t capacity_;
+    Murmur3_32Hash hash_;
+    size_t nextLane_ = 0;
+};
+
+}  // namespace pulsar
+
+#endif /* LIB_LISTENERLANES_H_ */
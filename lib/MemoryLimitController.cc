@@ -64,6 +64,8 @@ bool MemoryLimitController::reserveMemory(uint64_t size) {
     return true;
 }
 
+void MemoryLimitController::forceReserveMemory(uint64_t size) { currentUsage_ += size; }
+
 void MemoryLimitController::releaseMemory(uint64_t size) {
     uint64_t oldUsage = currentUsage_.fetch_sub(size);
     uint64_t newUsage = oldUsage - size;
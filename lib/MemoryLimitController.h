@@ -31,6 +31,8 @@ class MemoryLimitController {
     explicit MemoryLimitController(uint64_t memoryLimit);
     bool tryReserveMemory(uint64_t size);
     bool reserveMemory(uint64_t size);
+    // Reserve the memory even if the limit is exceeded, for the memory that is already in use
+    void forceReserveMemory(uint64_t size);
     void releaseMemory(uint64_t size);
     uint64_t currentUsage() const;
 
@@ -18,67 +18,124 @@
  */
 #include "MessageAndCallbackBatch.h"
 
-#include <pulsar/MessageIdBuilder.h>
-
+#include "AutoCompressionSelector.h"
 #include "ClientConnection.h"
 #include "Commands.h"
 #include "CompressionCodec.h"
+#include "CompressionCodecZstd.h"
 #include "MessageCrypto.h"
 #include "OpSendMsg.h"
 #include "PulsarApi.pb.h"
+#include "SharedBufferPool.h"
 
 namespace pulsar {
 
+// The batch payloads of all producers are acquired from the same pool. A payload is returned to the pool when
+// the send receipt is received.
+static SharedBufferPool& batchPayloadPool() {
+    static auto pool = SharedBufferPool::create(4 * 1024, 1024 * 1024, 1024 * 1024);
+    return *pool;
+}
+
 MessageAndCallbackBatch::MessageAndCallbackBatch() {}
 
 MessageAndCallbackBatch::~MessageAndCallbackBatch() {}
 
-void MessageAndCallbackBatch::add(const Message& msg, const SendCallback& callback) {
+void MessageAndCallbackBatch::add(const Message& msg, InlineSendCallback&& callback) {
     if (callbacks_.empty()) {
-        metadata_.reset(new proto::MessageMetadata);
+        if (metadata_) {
+            metadata_->Clear();
+        } else {
+            metadata_.reset(new proto::MessageMetadata);
+        }
         Commands::initBatchMessageMetadata(msg, *metadata_);
     }
     messages_.emplace_back(msg);
-    callbacks_.emplace_back(callback);
+    callbacks_.emplace_back(std::move(callback));
     messagesSize_ += msg.getLength();
 }
 
 std::unique_ptr<OpSendMsg> MessageAndCallbackBatch::createOpSendMsg(
-    uint64_t producerId, const ProducerConfiguration& producerConfig, MessageCrypto* crypto) {
-    auto callback = createSendCallback();
+    OpSendMsgPool& pool, uint64_t producerId, const std::string& producerName,
+    const ProducerConfiguration& producerConfig, MessageCrypto* crypto,
+    AutoCompressionSelector* compressionSelector, bool encode) {
+    // The op takes the callbacks and the batch takes the empty callbacks of the op, which keep the capacity
+    // of a recycled op
+    const auto createOp = [this, &pool](auto&&... args) {
+        auto op = pool.create(std::forward<decltype(args)>(args)...);
+        op->batchCallbacks.swap(callbacks_);
+        return op;
+    };
     if (empty()) {
-        return OpSendMsg::create(ResultOperationNotSupported, std::move(callback));
+        return createOp(ResultOperationNotSupported, nullptr);
+    }
+
+    // The checksum is only useful if the payload is sent as it is
+    boost::optional<uint32_t> payloadChecksum;
+    if (producerConfig.getCompressionType() == CompressionNone && !compressionSelector &&
+        !(producerConfig.isEncryptionEnabled() && crypto)) {
+        payloadChecksum = 0u;
     }
 
-    // TODO: Store payload as a field and support shrinking
     SharedBuffer payload;
-    auto sequenceId = Commands::serializeSingleMessagesToBatchPayload(payload, messages_);
+    auto sequenceId = Commands::serializeSingleMessagesToBatchPayload(
+        payload, messages_, &batchPayloadPool(), payloadChecksum.get_ptr());
+    metadata_->set_producer_name(producerName);
     metadata_->set_sequence_id(sequenceId);
     metadata_->set_num_messages_in_batch(messages_.size());
+
+    if (encode) {
+        auto result = encodePayload(*metadata_, payload, producerConfig, crypto, compressionSelector);
+        if (result != ResultOk) {
+            return createOp(result, nullptr);
+        }
+    }
+
+    auto op = createOp(*metadata_, callbacks_.size(), messagesSize_, producerConfig.getSendTimeout(), nullptr,
+                       nullptr, producerId, payload, payloadChecksum);
+    clear();
+    return op;
+}
+
+Result MessageAndCallbackBatch::encodePayload(proto::MessageMetadata& metadata, SharedBuffer& payload,
+                                              const ProducerConfiguration& producerConfig,
+                                              MessageCrypto* crypto,
+                                              AutoCompressionSelector* compressionSelector) {
     auto compressionType = producerConfig.getCompressionType();
+    auto compressionLevel = producerConfig.getCompressionLevel();
+    if (compressionSelector) {
+        const auto choice = compressionSelector->choose(payload);
+        compressionType = choice.type;
+        compressionLevel = choice.level;
+    }
     if (compressionType != CompressionNone) {
-        metadata_->set_compression(static_cast<proto::CompressionType>(compressionType));
-        metadata_->set_uncompressed_size(payload.readableBytes());
+        metadata.set_compression(static_cast<proto::CompressionType>(compressionType));
+        metadata.set_uncompressed_size(payload.readableBytes());
+    }
+    const auto& zstdDictionary = producerConfig.getZstdDictionary();
+    if (compressionType == CompressionZSTD && zstdDictionary) {
+        auto property = metadata.add_properties();
+        property->set_key(CompressionCodecZstd::DictionaryIdProperty);
+        property->set_value(std::to_string(zstdDictionary->getId()));
+        payload = CompressionCodecZstd::encodeWithDictionary(payload, *zstdDictionary, compressionLevel);
+    } else {
+        payload =
+            CompressionCodecProvider::getCodec(compressionType).encodeWithLevel(payload, compressionLevel);
     }
-    payload = CompressionCodecProvider::getCodec(compressionType).encode(payload);
 
     if (producerConfig.isEncryptionEnabled() && crypto) {
         SharedBuffer encryptedPayload;
         if (!crypto->encrypt(producerConfig.getEncryptionKeys(), producerConfig.getCryptoKeyReader(),
-                             *metadata_, payload, encryptedPayload)) {
-            return OpSendMsg::create(ResultCryptoError, std::move(callback));
+                             metadata, payload, encryptedPayload)) {
+            return ResultCryptoError;
         }
         payload = encryptedPayload;
     }
 
     if (payload.readableBytes() > ClientConnection::getMaxMessageSize()) {
-        return OpSendMsg::create(ResultMessageTooBig, std::move(callback));
+        return ResultMessageTooBig;
     }
-
-    auto op = OpSendMsg::create(*metadata_, callbacks_.size(), messagesSize_, producerConfig.getSendTimeout(),
-                                std::move(callback), nullptr, producerId, payload);
-    clear();
-    return op;
+    return ResultOk;
 }
 
 void MessageAndCallbackBatch::clear() {
@@ -87,17 +144,4 @@ void MessageAndCallbackBatch::clear() {
     messagesSize_ = 0;
 }
 
-static void completeSendCallbacks(const std::vector<SendCallback>& callbacks, Result result,
-                                  const MessageId& id) {
-    int32_t numOfMessages = static_cast<int32_t>(callbacks.size());
-    for (int32_t i = 0; i < numOfMessages; i++) {
-        callbacks[i](result, MessageIdBuilder::from(id).batchIndex(i).batchSize(numOfMessages).build());
-    }
-}
-
-SendCallback MessageAndCallbackBatch::createSendCallback() const {
-    const auto& callbacks = callbacks_;
-    return [callbacks](Result result, const MessageId& id) { completeSendCallbacks(callbacks, result, id); };
-}
-
 }  // namespace pulsar
@@ -27,10 +27,13 @@
 #include <memory>
 #include <vector>
 
+#include "OpSendMsg.h"
+
 namespace pulsar {
 
-struct OpSendMsg;
+class AutoCompressionSelector;
 class MessageCrypto;
+class SharedBuffer;
 using FlushCallback = std::function<void(Result)>;
 
 namespace proto {
@@ -52,22 +55,47 @@ class MessageAndCallbackBatch final : public boost::noncopyable {
      * @param message
      * @callback the associated send callback
      */
-    void add(const Message& msg, const SendCallback& callback);
+    void add(const Message& msg, InlineSendCallback&& callback);
 
-    std::unique_ptr<OpSendMsg> createOpSendMsg(uint64_t producerId,
+    /**
+     * Create the OpSendMsg that sends the batch and clear the batch. The callbacks of the messages are moved
+     * to the op, which completes them with the batch indexes.
+     *
+     * @param pool the pool that the op is created from
+     * @param producerName the producer name of the batch metadata
+     * @param compressionSelector the selector of the automatic compression, or null if it's disabled
+     * @param encode whether to compress and encrypt the payload, if it's false, the payload must be encoded
+     * by encodePayload before the OpSendMsg is sent
+     */
+    std::unique_ptr<OpSendMsg> createOpSendMsg(OpSendMsgPool& pool, uint64_t producerId,
+                                               const std::string& producerName,
                                                const ProducerConfiguration& producerConfig,
-                                               MessageCrypto* crypto);
+                                               MessageCrypto* crypto,
+                                               AutoCompressionSelector* compressionSelector = nullptr,
+                                               bool encode = true);
+
+    /**
+     * Compress and encrypt the payload of a batch according to the producer configuration, the compression
+     * and encryption fields of the metadata are set accordingly.
+     *
+     * @param compressionSelector if it's not null, it chooses the compression type and level instead of the
+     * producer configuration
+     * @return ResultOk if the encoded payload could be sent, otherwise ResultCryptoError or
+     * ResultMessageTooBig
+     */
+    static Result encodePayload(proto::MessageMetadata& metadata, SharedBuffer& payload,
+                                const ProducerConfiguration& producerConfig, MessageCrypto* crypto,
+                                AutoCompressionSelector* compressionSelector = nullptr);
 
     void clear();
 
    private:
+    // It's reused by the following batches so that its string fields keep their memory
     std::unique_ptr<proto::MessageMetadata> metadata_;
     std::vector<Message> messages_;
-    std::vector<SendCallback> callbacks_;
+    std::vector<InlineSendCallback> callbacks_;
     std::atomic<uint64_t> sequenceId_{static_cast<uint64_t>(-1L)};
     uint64_t messagesSize_{0ull};
-
-    SendCallback createSendCallback() const;
 };
 
 }  // namespace pulsar
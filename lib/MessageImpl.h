@@ -22,6 +22,8 @@
 #include <pulsar/Message.h>
 #include <pulsar/MessageId.h>
 
+#include <atomic>
+
 #include "KeyValueImpl.h"
 #include "PulsarApi.pb.h"
 #include "SharedBuffer.h"
@@ -48,6 +50,8 @@ class MessageImpl {
     bool hasSchemaVersion_;
     const std::string* schemaVersion_;
     std::weak_ptr<class ConsumerImpl> consumerPtr_;
+    // Whether the message is staged by a producer whose drainer has not completed its metadata yet
+    std::atomic_bool staged{false};
 
     const std::string& getPartitionKey() const;
     bool hasPartitionKey() const;
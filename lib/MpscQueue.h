@@ -0,0 +1,135 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef LIB_MPSCQUEUE_H_
+#define LIB_MPSCQUEUE_H_
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace pulsar {
+
+/**
+ * An unbounded lock-free queue for multiple producers and a single consumer, based on the intrusive MPSC
+ * node-based queue of Dmitry Vyukov.
+ *
+ * push() is wait-free and can be called from any thread. front() and pop() must only be called from one
+ * consumer at a time. Note that front() can return nullptr while a concurrent push() is in progress, even if
+ * elements pushed later have already been completed.
+ *
+ * The nodes are allocated with `Alloc`, which is rebound to the node type. A pooling allocator like
+ * pulsar::Allocator avoids the heap allocation of each push in the steady state.
+ */
+template <typename T, typename Alloc = std::allocator<T>>
+class MpscQueue {
+   public:
+    MpscQueue() : head_(newNode()), tail_(head_.load()) {}
+
+    ~MpscQueue() {
+        while (tail_) {
+            auto next = tail_->next.load();
+            deleteNode(tail_);
+            tail_ = next;
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T&& value) {
+        auto node = newNode(std::move(value));
+        auto prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    void push(const T& value) { push(T(value)); }
+
+    /**
+     * @return the first element or nullptr if the queue is empty
+     */
+    T* front() noexcept {
+        auto next = tail_->next.load(std::memory_order_acquire);
+        return next ? &next->value : nullptr;
+    }
+
+    /**
+     * Remove the first element, the queue must not be empty.
+     */
+    void pop() noexcept {
+        auto next = tail_->next.load(std::memory_order_acquire);
+        // The node of the first element becomes the new stub node
+        next->value = T();
+        deleteNode(tail_);
+        tail_ = next;
+    }
+
+    /**
+     * Pop the first element into `value`.
+     *
+     * @return false if the queue is empty
+     */
+    bool pop(T& value) {
+        auto element = front();
+        if (!element) {
+            return false;
+        }
+        value = std::move(*element);
+        pop();
+        return true;
+    }
+
+   private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value;
+
+        Node() = default;
+        explicit Node(T&& value) : value(std::move(value)) {}
+    };
+    using NodeAllocator = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeAllocatorTraits = std::allocator_traits<NodeAllocator>;
+
+    template <typename... Args>
+    static Node* newNode(Args&&... args) {
+        NodeAllocator allocator;
+        auto node = NodeAllocatorTraits::allocate(allocator, 1);
+        try {
+            new (node) Node(std::forward<Args>(args)...);
+        } catch (...) {
+            NodeAllocatorTraits::deallocate(allocator, node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    static void deleteNode(Node* node) noexcept {
+        NodeAllocator allocator;
+        node->~Node();
+        NodeAllocatorTraits::deallocate(allocator, node, 1);
+    }
+
+    // Producers append after head_, the consumer pops from tail_, which is a stub node whose value is unused
+    std::atomic<Node*> head_;
+    Node* tail_;
+};
+
+}  // namespace pulsar
+
+#endif /* LIB_MPSCQUEUE_H_ */
@@ -67,6 +67,10 @@ MultiTopicsConsumerImpl::MultiTopicsConsumerImpl(
       messageListener_(conf.getMessageListener()),
       lookupServicePtr_(lookupServicePtr),
       numberTopicPartitions_(std::make_shared<std::atomic<int>>(0)),
+      receiverQueueSizeBudget_(conf.isAutoScaledReceiverQueueSizeEnabled() && conf.getReceiverQueueSize() > 0
+                                   ? std::make_shared<ReceiverQueueSizeTuner::Budget>(
+                                         conf.getMaxTotalReceiverQueueSizeAcrossPartitions())
+                                   : nullptr),
       topics_(topics),
       subscriptionMode_(subscriptionMode),
       startMessageId_(startMessageId),
@@ -99,6 +103,11 @@ MultiTopicsConsumerImpl::MultiTopicsConsumerImpl(
 }
 
 void MultiTopicsConsumerImpl::start() {
+    if (messageListener_ && conf_.getMessageListenerLanes() > 1) {
+        LOG_WARN("Consumer " << consumerStr_ << " ignores the " << conf_.getMessageListenerLanes()
+                             << " message listener lanes, which are not supported by the consumers of"
+                             << " multiple topics or partitioned topics");
+    }
     if (topics_.empty()) {
         State state = Pending;
         if (state_.compare_exchange_strong(state, Ready)) {
@@ -230,10 +239,13 @@ void MultiTopicsConsumerImpl::subscribeTopicPartitions(
 
     int partitions = numPartitions == 0 ? 1 : numPartitions;
 
-    // Apply total limit of receiver queue size across partitions
-    config.setReceiverQueueSize(
-        std::min(conf_.getReceiverQueueSize(),
-                 (int)(conf_.getMaxTotalReceiverQueueSizeAcrossPartitions() / partitions)));
+    // Apply total limit of receiver queue size across partitions, the auto-scaled receiver queue sizes share
+    // the limit instead
+    if (!receiverQueueSizeBudget_) {
+        config.setReceiverQueueSize(
+            std::min(conf_.getReceiverQueueSize(),
+                     (int)(conf_.getMaxTotalReceiverQueueSizeAcrossPartitions() / partitions)));
+    }
 
     Lock lock(mutex_);
     topicsPartitions_[topicName->toString()] = partitions;
@@ -250,6 +262,7 @@ void MultiTopicsConsumerImpl::subscribeTopicPartitions(
                                                       config, topicName->isPersistent(), interceptors_,
                                                       internalListenerExecutor, true, NonPartitioned,
                                                       subscriptionMode_, startMessageId_);
+            shareReceiverQueueSizeBudget(*consumer);
         } catch (const std::runtime_error& e) {
             LOG_ERROR("Failed to create ConsumerImpl for " << topicName->toString() << ": " << e.what());
             topicSubResultPromise->setFailed(ResultConnectError);
@@ -271,6 +284,7 @@ void MultiTopicsConsumerImpl::subscribeTopicPartitions(
                                                           config, topicName->isPersistent(), interceptors_,
                                                           internalListenerExecutor, true, Partitioned,
                                                           subscriptionMode_, startMessageId_);
+                shareReceiverQueueSizeBudget(*consumer);
             } catch (const std::runtime_error& e) {
                 LOG_ERROR("Failed to create ConsumerImpl for " << topicPartitionName << ": " << e.what());
                 topicSubResultPromise->setFailed(ResultConnectError);
@@ -292,6 +306,15 @@ void MultiTopicsConsumerImpl::subscribeTopicPartitions(
     }
 }
 
+void MultiTopicsConsumerImpl::shareReceiverQueueSizeBudget(ConsumerImpl& consumer) {
+    // The internal consumers are starved when the messages they moved to this consumer are all consumed
+    auto weakSelf = weak_from_this();
+    consumer.setReceiverQueueSizeBudget(receiverQueueSizeBudget_, [weakSelf] {
+        auto self = weakSelf.lock();
+        return !self || self->incomingMessages_.empty();
+    });
+}
+
 void MultiTopicsConsumerImpl::handleSingleConsumerCreated(
     Result result, const ConsumerImplBaseWeakPtr& consumerImplBaseWeakPtr,
     const std::shared_ptr<std::atomic<int>>& partitionsNeedCreate,
@@ -1054,15 +1077,18 @@ void MultiTopicsConsumerImpl::subscribeSingleNewConsumer(
     });
 
     // Apply total limit of receiver queue size across partitions
-    config.setReceiverQueueSize(
-        std::min(conf_.getReceiverQueueSize(),
-                 (int)(conf_.getMaxTotalReceiverQueueSizeAcrossPartitions() / numPartitions)));
+    if (!receiverQueueSizeBudget_) {
+        config.setReceiverQueueSize(
+            std::min(conf_.getReceiverQueueSize(),
+                     (int)(conf_.getMaxTotalReceiverQueueSizeAcrossPartitions() / numPartitions)));
+    }
 
     std::string topicPartitionName = topicName->getTopicPartitionName(partitionIndex);
 
     auto consumer = std::make_shared<ConsumerImpl>(
         client, topicPartitionName, subscriptionName_, config, topicName->isPersistent(), interceptors_,
         internalListenerExecutor, true, Partitioned, subscriptionMode_, startMessageId_);
+    shareReceiverQueueSizeBudget(*consumer);
     consumer->getConsumerCreatedFuture().addListener(
         [this, weakSelf, partitionsNeedCreate, topicSubResultPromise](
             Result result, const ConsumerImplBaseWeakPtr& consumerImplBaseWeakPtr) {
@@ -125,6 +125,8 @@ class MultiTopicsConsumerImpl : public ConsumerImplBase {
     TimeDuration partitionsUpdateInterval_;
     LookupServicePtr lookupServicePtr_;
     std::shared_ptr<std::atomic<int>> numberTopicPartitions_;
+    // The budget shared by the auto-scaled receiver queue sizes of the internal consumers, if enabled
+    std::shared_ptr<ReceiverQueueSizeTuner::Budget> receiverQueueSizeBudget_;
     std::atomic<Result> failedResult{ResultOk};
     Promise<Result, ConsumerImplBaseWeakPtr> multiTopicsConsumerCreatedPromise_;
     UnAckedMessageTrackerPtr unAckedMessageTrackerPtr_;
@@ -167,6 +169,8 @@ class MultiTopicsConsumerImpl : public ConsumerImplBase {
     void subscribeSingleNewConsumer(int numPartitions, const TopicNamePtr& topicName, int partitionIndex,
                                     const ConsumerSubResultPromisePtr& topicSubResultPromise,
                                     const std::shared_ptr<std::atomic<int>>& partitionsNeedCreate);
+    // Share the budget of the auto-scaled receiver queue sizes with an internal consumer
+    void shareReceiverQueueSizeBudget(ConsumerImpl& consumer);
     // impl consumer base virtual method
     bool hasEnoughMessagesForBatchReceive() const override;
     void notifyBatchPendingReceivedCallback(const BatchReceiveCallback& callback) override;
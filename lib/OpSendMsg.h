@@ -20,10 +20,17 @@
 #define LIB_OPSENDMSG_H_
 
 #include <pulsar/Message.h>
+#include <pulsar/MessageIdBuilder.h>
 #include <pulsar/Producer.h>
 #include <pulsar/Result.h>
 
+#include <atomic>
+#include <boost/optional.hpp>
+#include <mutex>
+#include <vector>
+
 #include "ChunkMessageIdImpl.h"
+#include "InlineFunction.h"
 #include "PulsarApi.pb.h"
 #include "SharedBuffer.h"
 #include "TimeUtils.h"
@@ -31,42 +38,76 @@
 namespace pulsar {
 
 struct SendArguments {
-    const uint64_t producerId;
-    const uint64_t sequenceId;
-    const proto::MessageMetadata metadata;
+    uint64_t producerId;
+    uint64_t sequenceId;
+    proto::MessageMetadata metadata;
     SharedBuffer payload;
+    // The crc32c checksum of the payload if it has been computed in advance
+    boost::optional<uint32_t> payloadChecksum;
 
     SendArguments(uint64_t producerId, uint64_t sequenceId, const proto::MessageMetadata& metadata,
-                  const SharedBuffer& payload)
-        : producerId(producerId), sequenceId(sequenceId), metadata(metadata), payload(payload) {}
+                  const SharedBuffer& payload, boost::optional<uint32_t> payloadChecksum = boost::none)
+        : producerId(producerId),
+          sequenceId(sequenceId),
+          metadata(metadata),
+          payload(payload),
+          payloadChecksum(payloadChecksum) {}
     SendArguments(const SendArguments&) = delete;
     SendArguments& operator=(const SendArguments&) = delete;
+
+    // Reuse the arguments of a recycled op, the string fields of the metadata keep their memory
+    void assign(uint64_t producerId, uint64_t sequenceId, const proto::MessageMetadata& metadata,
+                const SharedBuffer& payload, boost::optional<uint32_t> payloadChecksum) {
+        this->producerId = producerId;
+        this->sequenceId = sequenceId;
+        this->metadata.CopyFrom(metadata);
+        this->payload = payload;
+        this->payloadChecksum = payloadChecksum;
+    }
 };
 
 typedef std::shared_ptr<std::vector<MessageId>> ChunkMessageIdListPtr;
 
+// The send callbacks are stored inline, the capacity fits the callback that ProducerImpl::sendAsync wraps the
+// application's callback with
+using InlineSendCallback = InlineFunction<void(Result, const MessageId&), 80>;
+
 struct OpSendMsg {
-    const Result result;
-    const int32_t chunkId;
-    const int32_t numChunks;
-    const uint32_t messagesCount;
-    const uint64_t messagesSize;
-    const ptime timeout;
-    const SendCallback sendCallback;
+    Result result = ResultOk;
+    int32_t chunkId = -1;
+    int32_t numChunks = -1;
+    uint32_t messagesCount = 0;
+    uint64_t messagesSize = 0;
+    // The op has been spooled by the producer, which released its spots in the pending queue and the
+    // memory of its payload
+    bool spooled = false;
+    ptime createdTime;
+    ptime timeout;
+    InlineSendCallback sendCallback;
+    // The callbacks of the messages of a batch, the i-th callback is completed with the batch index i
+    std::vector<InlineSendCallback> batchCallbacks;
     std::vector<std::function<void(Result)>> trackerCallbacks;
     ChunkMessageIdListPtr chunkMessageIdList;
-    // Use shared_ptr here because producer might resend the message with the same arguments
-    const std::shared_ptr<SendArguments> sendArgs;
+    // Use shared_ptr here because producer might resend the message with the same arguments. It's only
+    // replaced before the op is sent, when the batch payload is encoded by a compression executor.
+    std::shared_ptr<SendArguments> sendArgs;
 
     template <typename... Args>
     static std::unique_ptr<OpSendMsg> create(Args&&... args) {
-        return std::unique_ptr<OpSendMsg>(new OpSendMsg(std::forward<Args>(args)...));
+        std::unique_ptr<OpSendMsg> op{new OpSendMsg};
+        op->init(std::forward<Args>(args)...);
+        return op;
     }
 
     void complete(Result result, const MessageId& messageId) const {
         if (sendCallback) {
             sendCallback(result, messageId);
         }
+        const auto numMessages = static_cast<int32_t>(batchCallbacks.size());
+        for (int32_t i = 0; i < numMessages; i++) {
+            batchCallbacks[i](result,
+                              MessageIdBuilder::from(messageId).batchIndex(i).batchSize(numMessages).build());
+        }
         for (const auto& trackerCallback : trackerCallbacks) {
             trackerCallback(result);
         }
@@ -79,27 +120,103 @@ struct OpSendMsg {
     }
 
    private:
-    OpSendMsg(Result result, SendCallback&& callback)
-        : result(result),
-          chunkId(-1),
-          numChunks(-1),
-          messagesCount(0),
-          messagesSize(0),
-          sendCallback(std::move(callback)),
-          sendArgs(nullptr) {}
-
-    OpSendMsg(const proto::MessageMetadata& metadata, uint32_t messagesCount, uint64_t messagesSize,
-              int sendTimeoutMs, SendCallback&& callback, ChunkMessageIdListPtr chunkMessageIdList,
-              uint64_t producerId, SharedBuffer payload)
-        : result(ResultOk),
-          chunkId(metadata.chunk_id()),
-          numChunks(metadata.num_chunks_from_msg()),
-          messagesCount(messagesCount),
-          messagesSize(messagesSize),
-          timeout(TimeUtils::now() + std::chrono::milliseconds(sendTimeoutMs)),
-          sendCallback(std::move(callback)),
-          chunkMessageIdList(std::move(chunkMessageIdList)),
-          sendArgs(new SendArguments(producerId, metadata.sequence_id(), metadata, payload)) {}
+    OpSendMsg() = default;
+
+    void init(Result result, InlineSendCallback&& callback) {
+        this->result = result;
+        chunkId = -1;
+        numChunks = -1;
+        messagesCount = 0;
+        messagesSize = 0;
+        spooled = false;
+        sendCallback = std::move(callback);
+        sendArgs.reset();
+    }
+
+    void init(const proto::MessageMetadata& metadata, uint32_t messagesCount, uint64_t messagesSize,
+              int sendTimeoutMs, InlineSendCallback&& callback, ChunkMessageIdListPtr chunkMessageIdList,
+              uint64_t producerId, const SharedBuffer& payload,
+              boost::optional<uint32_t> payloadChecksum = boost::none) {
+        result = ResultOk;
+        chunkId = metadata.chunk_id();
+        numChunks = metadata.num_chunks_from_msg();
+        this->messagesCount = messagesCount;
+        this->messagesSize = messagesSize;
+        spooled = false;
+        createdTime = TimeUtils::now();
+        timeout = createdTime + std::chrono::milliseconds(sendTimeoutMs);
+        sendCallback = std::move(callback);
+        this->chunkMessageIdList = std::move(chunkMessageIdList);
+        if (sendArgs) {
+            sendArgs->assign(producerId, metadata.sequence_id(), metadata, payload, payloadChecksum);
+        } else {
+            sendArgs = std::make_shared<SendArguments>(producerId, metadata.sequence_id(), metadata, payload,
+                                                       payloadChecksum);
+        }
+    }
+
+    friend class OpSendMsgPool;
+};
+
+/**
+ * The ops of a producer are recycled after they are acknowledged instead of being freed, so that a new op
+ * reuses the memory of the op, of its send arguments, of the metadata fields and of the batch callbacks.
+ */
+class OpSendMsgPool {
+   public:
+    explicit OpSendMsgPool(size_t maxIdleOps) : maxIdleOps_(maxIdleOps) {}
+
+    OpSendMsgPool(const OpSendMsgPool&) = delete;
+    OpSendMsgPool& operator=(const OpSendMsgPool&) = delete;
+
+    /**
+     * Create an op with the same arguments as OpSendMsg::create, an idle op is reused if there is one.
+     */
+    template <typename... Args>
+    std::unique_ptr<OpSendMsg> create(Args&&... args) {
+        std::unique_ptr<OpSendMsg> op;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!idleOps_.empty()) {
+                op = std::move(idleOps_.back());
+                idleOps_.pop_back();
+            }
+        }
+        if (!op) {
+            op.reset(new OpSendMsg);
+        }
+        op->init(std::forward<Args>(args)...);
+        return op;
+    }
+
+    /**
+     * Return a completed op to the pool. The callbacks are released so that the op does not keep their
+     * captures alive, and the payload is released so that its buffer goes back to its pool.
+     */
+    void recycle(std::unique_ptr<OpSendMsg> op) {
+        op->sendCallback = nullptr;
+        op->batchCallbacks.clear();
+        op->trackerCallbacks.clear();
+        op->chunkMessageIdList.reset();
+        if (op->sendArgs.use_count() == 1) {
+            // The connection has released its reference after writing the frame, synchronize with its reads
+            // before reusing the arguments
+            std::atomic_thread_fence(std::memory_order_acquire);
+            op->sendArgs->payload = SharedBuffer{};
+        } else {
+            op->sendArgs.reset();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idleOps_.size() < maxIdleOps_) {
+            idleOps_.emplace_back(std::move(op));
+        }
+    }
+
+   private:
+    const size_t maxIdleOps_;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<OpSendMsg>> idleOps_;
 };
 
 }  // namespace pulsar
@@ -243,6 +243,114 @@ void PartitionedProducerImpl::sendAsync(const Message& msg, SendCallback callbac
     }
 }
 
+namespace {
+
+// Gather the results of the bulks sent to each partition in the order of the original messages
+struct PartitionedBulkSend {
+    std::vector<MessageId> messageIds;
+    BatchSendCallback callback;
+    std::atomic<size_t> numPendingPartitions{0};
+    // The result of the first failed partition
+    std::atomic<Result> result{ResultOk};
+
+    void completePartition(Result partitionResult, const std::vector<size_t>& indexes,
+                           const std::vector<MessageId>& partitionMessageIds) {
+        for (size_t i = 0; i < indexes.size() && i < partitionMessageIds.size(); i++) {
+            messageIds[indexes[i]] = partitionMessageIds[i];
+        }
+        if (partitionResult != ResultOk) {
+            auto expected = ResultOk;
+            result.compare_exchange_strong(expected, partitionResult);
+        }
+        if (numPendingPartitions.fetch_sub(1, std::memory_order_acq_rel) == 1 && callback) {
+            callback(result, messageIds);
+        }
+    }
+};
+
+}  // namespace
+
+void PartitionedProducerImpl::sendAsync(std::vector<Message>&& messages, BatchSendCallback callback) {
+    if (state_ != Ready) {
+        if (callback) {
+            callback(ResultAlreadyClosed, std::vector<MessageId>(messages.size()));
+        }
+        return;
+    }
+
+    auto bulk = std::make_shared<PartitionedBulkSend>();
+    bulk->messageIds.resize(messages.size());
+    bulk->callback = std::move(callback);
+
+    // Split the messages by partition, each partition sends its messages in the original order
+    std::vector<std::vector<Message>> partitionMessages;
+    std::vector<std::vector<size_t>> partitionIndexes;
+    std::vector<ProducerImplPtr> producers;
+    Lock producersLock(producersMutex_);
+    const auto numPartitions = std::min<size_t>(getNumPartitions(), producers_.size());
+    partitionMessages.resize(numPartitions);
+    partitionIndexes.resize(numPartitions);
+    for (size_t i = 0; i < messages.size(); i++) {
+        const auto partition = routerPolicy_->getPartition(messages[i], *topicMetadata_);
+        if (partition < 0 || static_cast<size_t>(partition) >= numPartitions) {
+            LOG_ERROR("Got Invalid Partition for message from Router Policy, Partition - " << partition);
+            auto expected = ResultOk;
+            bulk->result.compare_exchange_strong(expected, ResultUnknownError);
+            continue;
+        }
+        partitionMessages[partition].emplace_back(std::move(messages[i]));
+        partitionIndexes[partition].emplace_back(i);
+    }
+    for (size_t partition = 0; partition < numPartitions; partition++) {
+        auto& producer = producers_[partition];
+        if (!partitionMessages[partition].empty() && !producer->isStarted()) {
+            // if the producer is not started (lazy producer), then kick-off the start process
+            producer->start();
+        }
+        producers.emplace_back(producer);
+    }
+    producersLock.unlock();
+
+    // Count the partitions before sending, so that the callback is not completed before the last partition
+    size_t numPendingPartitions = 0;
+    for (const auto& indexes : partitionIndexes) {
+        numPendingPartitions += indexes.empty() ? 0 : 1;
+    }
+    if (numPendingPartitions == 0) {
+        if (bulk->callback) {
+            bulk->callback(bulk->result, bulk->messageIds);
+        }
+        return;
+    }
+    bulk->numPendingPartitions = numPendingPartitions;
+
+    for (size_t partition = 0; partition < numPartitions; partition++) {
+        if (partitionIndexes[partition].empty()) {
+            continue;
+        }
+        auto indexes = std::make_shared<std::vector<size_t>>(std::move(partitionIndexes[partition]));
+        BatchSendCallback partitionCallback = [bulk, indexes](Result result,
+                                                              const std::vector<MessageId>& messageIds) {
+            bulk->completePartition(result, *indexes, messageIds);
+        };
+
+        const auto& producer = producers[partition];
+        if (!conf_.getLazyStartPartitionedProducers() || producer->ready()) {
+            producer->sendAsync(std::move(partitionMessages[partition]), std::move(partitionCallback));
+        } else {
+            auto msgs = std::make_shared<std::vector<Message>>(std::move(partitionMessages[partition]));
+            producer->getProducerCreatedFuture().addListener(
+                [msgs, partitionCallback](Result result, const ProducerImplBaseWeakPtr& weakProducer) {
+                    if (result == ResultOk) {
+                        weakProducer.lock()->sendAsync(std::move(*msgs), partitionCallback);
+                    } else {
+                        partitionCallback(result, {});
+                    }
+                });
+        }
+    }
+}
+
 // override
 void PartitionedProducerImpl::shutdown() { internalShutdown(); }
 
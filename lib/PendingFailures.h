@@ -20,6 +20,7 @@
 #define LIB_PENDINGFAILURES_H_
 
 #include <functional>
+#include <utility>
 #include <vector>
 
 namespace pulsar {
@@ -28,6 +29,12 @@ class PendingFailures {
    public:
     void add(const std::function<void()>& failure) { failures.emplace_back(failure); }
 
+    void add(PendingFailures&& other) {
+        for (auto& failure : other.failures) {
+            failures.emplace_back(std::move(failure));
+        }
+    }
+
     bool empty() const noexcept { return failures.empty(); }
 
     void complete() {
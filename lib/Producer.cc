@@ -67,6 +67,17 @@ void Producer::sendAsync(const Message& msg, const SendCallback& callback) {
     impl_->sendAsync(msg, callback);
 }
 
+void Producer::sendAsync(std::vector<Message>&& messages, const BatchSendCallback& callback) {
+    if (!impl_) {
+        if (callback) {
+            callback(ResultProducerNotInitialized, std::vector<MessageId>(messages.size()));
+        }
+        return;
+    }
+
+    impl_->sendAsync(std::move(messages), callback);
+}
+
 const std::string& Producer::getProducerName() const { return impl_->getProducerName(); }
 
 int64_t Producer::getLastSequenceId() const { return impl_->getLastSequenceId(); }
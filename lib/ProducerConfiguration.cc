@@ -69,6 +69,30 @@ ProducerConfiguration& ProducerConfiguration::setCompressionType(CompressionType
 
 CompressionType ProducerConfiguration::getCompressionType() const { return impl_->compressionType; }
 
+ProducerConfiguration& ProducerConfiguration::setCompressionLevel(int compressionLevel) {
+    impl_->compressionLevel = compressionLevel;
+    return *this;
+}
+
+int ProducerConfiguration::getCompressionLevel() const { return impl_->compressionLevel; }
+
+ProducerConfiguration& ProducerConfiguration::setAutoCompressionCpuBudget(double nanosPerByte) {
+    if (!(nanosPerByte >= 0)) {
+        throw std::invalid_argument("nanosPerByte must be non-negative: " + std::to_string(nanosPerByte));
+    }
+    impl_->autoCompressionCpuBudget = nanosPerByte;
+    return *this;
+}
+
+double ProducerConfiguration::getAutoCompressionCpuBudget() const { return impl_->autoCompressionCpuBudget; }
+
+ProducerConfiguration& ProducerConfiguration::setZstdDictionary(ZstdDictionaryPtr dictionary) {
+    impl_->zstdDictionary = std::move(dictionary);
+    return *this;
+}
+
+const ZstdDictionaryPtr& ProducerConfiguration::getZstdDictionary() const { return impl_->zstdDictionary; }
+
 ProducerConfiguration& ProducerConfiguration::setMaxPendingMessages(int maxPendingMessages) {
     if (maxPendingMessages < 0) {
         throw std::invalid_argument("maxPendingMessages needs to be >= 0");
@@ -126,6 +150,20 @@ ProducerConfiguration& ProducerConfiguration::setBlockIfQueueFull(bool flag) {
 
 bool ProducerConfiguration::getBlockIfQueueFull() const { return impl_->blockIfQueueFull; }
 
+ProducerConfiguration& ProducerConfiguration::setSpoolDirectory(const std::string& directory) {
+    impl_->spoolDirectory = directory;
+    return *this;
+}
+
+const std::string& ProducerConfiguration::getSpoolDirectory() const { return impl_->spoolDirectory; }
+
+ProducerConfiguration& ProducerConfiguration::setSpoolMaxBytes(uint64_t maxBytes) {
+    impl_->spoolMaxBytes = maxBytes;
+    return *this;
+}
+
+uint64_t ProducerConfiguration::getSpoolMaxBytes() const { return impl_->spoolMaxBytes; }
+
 ProducerConfiguration& ProducerConfiguration::setBatchingEnabled(const bool& batchingEnabled) {
     impl_->batchingEnabled = batchingEnabled;
     return *this;
@@ -164,6 +202,16 @@ const unsigned long& ProducerConfiguration::getBatchingMaxPublishDelayMs() const
     return impl_->batchingMaxPublishDelayMs;
 }
 
+ProducerConfiguration& ProducerConfiguration::setBatchingLatencyTargetMs(
+    unsigned long batchingLatencyTargetMs) {
+    impl_->batchingLatencyTargetMs = batchingLatencyTargetMs;
+    return *this;
+}
+
+unsigned long ProducerConfiguration::getBatchingLatencyTargetMs() const {
+    return impl_->batchingLatencyTargetMs;
+}
+
 ProducerConfiguration& ProducerConfiguration::setBatchingType(BatchingType batchingType) {
     if (batchingType < ProducerConfiguration::DefaultBatching ||
         batchingType > ProducerConfiguration::KeyBasedBatching) {
@@ -32,6 +32,9 @@ struct ProducerConfigurationImpl {
     boost::optional<int64_t> initialSequenceId;
     int sendTimeoutMs{30000};
     CompressionType compressionType{CompressionNone};
+    int compressionLevel{0};               // the default level of the codec
+    double autoCompressionCpuBudget{0.0};  // disabled
+    ZstdDictionaryPtr zstdDictionary;
     int maxPendingMessages{1000};
     int maxPendingMessagesAcrossPartitions{50000};
     ProducerConfiguration::PartitionsRoutingMode routingMode{ProducerConfiguration::UseSinglePartition};
@@ -39,10 +42,13 @@ struct ProducerConfigurationImpl {
     ProducerConfiguration::HashingScheme hashingScheme{ProducerConfiguration::BoostHash};
     bool useLazyStartPartitionedProducers{false};
     bool blockIfQueueFull{false};
+    std::string spoolDirectory;                // disabled
+    uint64_t spoolMaxBytes{64 * 1024 * 1024};  // 64 MB
     bool batchingEnabled{true};
     unsigned int batchingMaxMessages{1000};
     unsigned long batchingMaxAllowedSizeInBytes{128 * 1024};  // 128 KB
     unsigned long batchingMaxPublishDelayMs{10};              // 10 milli seconds
+    unsigned long batchingLatencyTargetMs{0};                 // disabled
     ProducerConfiguration::BatchingType batchingType{ProducerConfiguration::DefaultBatching};
     CryptoKeyReaderPtr cryptoKeyReader;
     std::set<std::string> encryptionKeys;
@@ -21,7 +21,10 @@
 #include <pulsar/MessageIdBuilder.h>
 
 #include <chrono>
+#include <thread>
 
+#include "AdaptiveBatchingDelay.h"
+#include "AutoCompressionSelector.h"
 #include "BatchMessageContainer.h"
 #include "BatchMessageKeyBasedContainer.h"
 #include "ClientConnection.h"
@@ -31,10 +34,12 @@
 #include "ExecutorService.h"
 #include "LogUtils.h"
 #include "MemoryLimitController.h"
+#include "MessageAndCallbackBatch.h"
 #include "MessageCrypto.h"
 #include "MessageImpl.h"
 #include "OpSendMsg.h"
 #include "ProducerConfigurationImpl.h"
+#include "ProducerSpool.h"
 #include "PulsarApi.pb.h"
 #include "ResultUtils.h"
 #include "Semaphore.h"
@@ -48,6 +53,13 @@ DECLARE_LOG_OBJECT()
 
 using std::chrono::milliseconds;
 
+// The idle ops kept by a producer if the pending messages are not limited
+static constexpr int DefaultMaxIdleOpSendMsgs = 1000;
+
+// The automatic compression samples a batch at most once per interval, so that measuring all the candidates
+// costs little compared to compressing the batches
+static constexpr int AutoCompressionSampleIntervalSeconds = 10;
+
 ProducerImpl::ProducerImpl(const ClientImplPtr& client, const TopicName& topicName,
                            const ProducerConfiguration& conf, const ProducerInterceptorsPtr& interceptors,
                            int32_t partition, bool retryOnCreationError)
@@ -57,15 +69,17 @@ ProducerImpl::ProducerImpl(const ClientImplPtr& client, const TopicName& topicNa
                           milliseconds(std::max(100, conf.getSendTimeout() - 100)))),
       conf_(conf),
       semaphore_(),
+      opSendMsgPool_((conf.getMaxPendingMessages() > 0) ? conf.getMaxPendingMessages()
+                                                         : DefaultMaxIdleOpSendMsgs),
       partition_(partition),
       producerName_(conf_.getProducerName()),
       userProvidedProducerName_(false),
       producerStr_("[" + topic() + ", " + producerName_ + "] "),
       producerId_(client->newProducerId()),
-      batchTimer_(executor_->createDeadlineTimer()),
+      batchTimer_(executor_),
       lastSequenceIdPublished_(conf.getInitialSequenceId()),
       msgSequenceGenerator_(lastSequenceIdPublished_ + 1),
-      sendTimer_(executor_->createDeadlineTimer()),
+      sendTimer_(executor_),
       dataKeyRefreshTask_(*executor_, 4 * 60 * 60 * 1000),
       memoryLimitController_(client->getMemoryLimitController()),
       chunkingEnabled_(conf_.isChunkingEnabled() && topicName.isPersistent() && !conf_.getBatchingEnabled()),
@@ -80,6 +94,7 @@ ProducerImpl::ProducerImpl(const ClientImplPtr& client, const TopicName& topicNa
     if (conf.getMaxPendingMessages() > 0) {
         semaphore_ = std::unique_ptr<Semaphore>(new Semaphore(conf_.getMaxPendingMessages()));
     }
+    spoolEnabled_ = !conf_.getSpoolDirectory().empty();
 
     unsigned int statsIntervalInSeconds = client->getClientConfig().getStatsIntervalInSeconds();
     if (statsIntervalInSeconds) {
@@ -99,6 +114,24 @@ ProducerImpl::ProducerImpl(const ClientImplPtr& client, const TopicName& topicNa
     }
 
     if (conf_.getBatchingEnabled()) {
+        if (conf_.getAutoCompressionCpuBudget() > 0) {
+            auto stats = producerStatsBasePtr_;
+            autoCompressionSelector_.reset(
+                new AutoCompressionSelector(conf_.getAutoCompressionCpuBudget(),
+                                            std::chrono::seconds(AutoCompressionSampleIntervalSeconds),
+                                            [stats](const AutoCompressionSelector::Choice& choice) {
+                                                stats->compressionChosen(choice.type, choice.level);
+                                            }));
+        }
+        if (conf_.getCompressionType() != CompressionNone || autoCompressionSelector_ ||
+            conf_.isEncryptionEnabled()) {
+            compressionExecutorProvider_ = client->getCompressionExecutorProvider();
+        }
+        if (conf_.getBatchingLatencyTargetMs() > 0) {
+            adaptiveBatchingDelay_.reset(
+                new AdaptiveBatchingDelay(milliseconds(conf_.getBatchingLatencyTargetMs()),
+                                          milliseconds(conf_.getBatchingMaxPublishDelayMs())));
+        }
         switch (conf_.getBatchingType()) {
             case ProducerConfiguration::DefaultBatching:
                 batchMessageContainer_.reset(new BatchMessageContainer(*this));
@@ -314,6 +347,18 @@ auto ProducerImpl::getPendingCallbacksWhenFailed() -> decltype(pendingMessagesQu
     LOG_DEBUG(getName() << "# messages in pending queue : " << pendingMessagesQueue_.size());
 
     pendingMessages.swap(pendingMessagesQueue_);
+    for (auto& op : spooledOps_) {
+        pendingMessages.emplace_back(std::move(op));
+    }
+    spooledOps_.clear();
+    if (spool_) {
+        spool_->clear();
+    }
+    for (auto& encodingOp : encodingOps_) {
+        // The encoding result will be ignored after the op is moved
+        pendingMessages.emplace_back(std::move(encodingOp->op));
+    }
+    encodingOps_.clear();
     for (const auto& op : pendingMessages) {
         releaseSemaphoreForSendOp(*op);
     }
@@ -353,23 +398,89 @@ void ProducerImpl::failPendingMessages(Result result, bool withLock) {
 }
 
 void ProducerImpl::resendMessages(const ClientConnectionPtr& cnx) {
-    if (pendingMessagesQueue_.empty()) {
-        return;
+    if (!pendingMessagesQueue_.empty()) {
+        LOG_DEBUG(getName() << "Re-Sending " << pendingMessagesQueue_.size() << " messages to server");
+
+        for (const auto& op : pendingMessagesQueue_) {
+            LOG_DEBUG(getName() << "Re-Sending " << op->sendArgs->sequenceId);
+            cnx->sendMessage(op->sendArgs);
+        }
     }
 
-    LOG_DEBUG(getName() << "Re-Sending " << pendingMessagesQueue_.size() << " messages to server");
+    // The parked ops are sent after the pending ops
+    sendSpooledMessages(cnx);
+}
 
-    for (const auto& op : pendingMessagesQueue_) {
-        LOG_DEBUG(getName() << "Re-Sending " << op->sendArgs->sequenceId);
-        cnx->sendMessage(op->sendArgs);
+bool ProducerImpl::ensureSpool() {
+    if (spool_) {
+        return true;
+    }
+    try {
+        spool_.reset(new ProducerSpool(conf_.getSpoolDirectory(), conf_.getSpoolMaxBytes()));
+        LOG_INFO(getName() << "Created the spool file " << spool_->path());
+        return true;
+    } catch (const std::exception& e) {
+        LOG_ERROR(getName() << "Failed to create the spool, the messages are kept in memory: " << e.what());
+        spoolEnabled_ = false;
+        return false;
+    }
+}
+
+// The memory of an op whose frame is in the spool, the op and the callbacks of its messages stay in memory
+static uint64_t getSpooledOpSize(const OpSendMsg& op) {
+    return sizeof(OpSendMsg) + op.batchCallbacks.size() * sizeof(InlineSendCallback);
+}
+
+void ProducerImpl::spoolMessage(std::unique_ptr<OpSendMsg> op) {
+    if (spool_->push(op->sendArgs->metadata, op->sendArgs->payload)) {
+        LOG_DEBUG(getName() << "Spooled msg - seq: " << op->sendArgs->sequenceId);
+        releaseSemaphoreForSendOp(*op);
+        // The parked op keeps counting against the memory limit
+        memoryLimitController_.forceReserveMemory(getSpooledOpSize(*op));
+        op->spooled = true;
+        op->sendArgs.reset();
+    } else {
+        // The op keeps its spots in the queue, which could make the application wait
+        LOG_DEBUG(getName() << "Spool is full, keeping msg in memory - seq: " << op->sendArgs->sequenceId);
+    }
+    spooledOps_.emplace_back(std::move(op));
+}
+
+void ProducerImpl::sendSpooledMessages(const ClientConnectionPtr& cnx) {
+    while (!spooledOps_.empty()) {
+        auto& op = spooledOps_.front();
+        if (op->spooled) {
+            const bool reserved = tryReserveForSendOp(*op);
+            if (!reserved && !pendingMessagesQueue_.empty()) {
+                // Wait until the ops in flight are acknowledged
+                break;
+            }
+            // Without any op in flight, the op is sent even if its spots cannot be reserved. In this case, it
+            // keeps being marked as spooled so that only the memory of the parked op is released when it's
+            // completed.
+            if (reserved) {
+                memoryLimitController_.releaseMemory(getSpooledOpSize(*op));
+            }
+            op->spooled = !reserved;
+            proto::MessageMetadata metadata;
+            SharedBuffer payload;
+            spool_->pop(metadata, payload);
+            op->sendArgs = std::make_shared<SendArguments>(producerId_, metadata.sequence_id(), metadata,
+                                                           payload);
+        }
+        auto args = op->sendArgs;
+        pendingMessagesQueue_.emplace_back(std::move(op));
+        spooledOps_.pop_front();
+        LOG_DEBUG(getName() << "Sending spooled msg - seq: " << args->sequenceId);
+        cnx->sendMessage(args);
     }
 }
 
 void ProducerImpl::setMessageMetadata(const Message& msg, const uint64_t& sequenceId,
                                       const uint32_t& uncompressedSize) {
-    // Call this function after acquiring the mutex_
+    // Call this function after acquiring the mutex_. The producer name is only set for the messages that are
+    // not batched, the batch metadata has the producer name.
     proto::MessageMetadata& msgMetadata = msg.impl_->metadata;
-    msgMetadata.set_producer_name(producerName_);
     msgMetadata.set_publish_time(TimeUtils::currentTimeMillis());
     msgMetadata.set_sequence_id(sequenceId);
     if (conf_.getCompressionType() != CompressionNone) {
@@ -390,6 +501,14 @@ void ProducerImpl::flushAsync(FlushCallback callback) {
     }
 
     auto addCallbackToLastOp = [this, &callback] {
+        if (!encodingOps_.empty()) {
+            encodingOps_.back()->op->addTrackerCallback(callback);
+            return true;
+        }
+        if (!spooledOps_.empty()) {
+            spooledOps_.back()->addTrackerCallback(callback);
+            return true;
+        }
         if (pendingMessagesQueue_.empty()) {
             return false;
         }
@@ -399,16 +518,20 @@ void ProducerImpl::flushAsync(FlushCallback callback) {
 
     if (batchMessageContainer_) {
         Lock lock(mutex_);
+        PendingFailures failures;
+        unsafeDrainStagedMessages(failures, true);
 
         if (batchMessageContainer_->isEmpty()) {
-            if (!addCallbackToLastOp() && callback) {
-                lock.unlock();
+            const bool completed = !addCallbackToLastOp();
+            lock.unlock();
+            failures.complete();
+            if (completed && callback) {
                 callback(ResultOk);
             }
             return;
         }
 
-        auto failures = batchMessageAndSend(callback);
+        failures.add(batchMessageAndSend(callback));
         lock.unlock();
         failures.complete();
     } else {
@@ -424,14 +547,17 @@ void ProducerImpl::triggerFlush() {
     if (batchMessageContainer_) {
         if (state_ == Ready) {
             Lock lock(mutex_);
-            auto failures = batchMessageAndSend();
+            PendingFailures failures;
+            unsafeDrainStagedMessages(failures, true);
+            failures.add(batchMessageAndSend());
             lock.unlock();
             failures.complete();
         }
     }
 }
 
-bool ProducerImpl::isValidProducerState(const SendCallback& callback) const {
+template <typename Callback>
+bool ProducerImpl::isValidProducerState(const Callback& callback) const {
     const auto state = state_.load();
     switch (state) {
         case HandlerBase::Ready:
@@ -461,8 +587,9 @@ bool ProducerImpl::canAddToBatch(const Message& msg) const {
 }
 
 static SharedBuffer applyCompression(const SharedBuffer& uncompressedPayload,
-                                     CompressionType compressionType) {
-    return CompressionCodecProvider::getCodec(compressionType).encode(uncompressedPayload);
+                                     CompressionType compressionType, int compressionLevel) {
+    return CompressionCodecProvider::getCodec(compressionType)
+        .encodeWithLevel(uncompressedPayload, compressionLevel);
 }
 
 void ProducerImpl::sendAsync(const Message& msg, SendCallback callback) {
@@ -472,20 +599,157 @@ void ProducerImpl::sendAsync(const Message& msg, SendCallback callback) {
     auto interceptorMessage = interceptors_->beforeSend(producer, msg);
 
     const auto now = TimeUtils::now();
-    auto self = shared_from_this();
-    sendAsyncWithStatsUpdate(interceptorMessage, [this, self, now, callback, producer, interceptorMessage](
-                                                     Result result, const MessageId& messageId) {
-        producerStatsBasePtr_->messageReceived(result, now);
-
-        interceptors_->onSendAcknowledgement(producer, result, interceptorMessage, messageId);
+    // The producer keeps this producer alive until the callback is completed
+    sendAsyncWithStatsUpdate(interceptorMessage,
+                             [this, now, callback = std::move(callback), producer, interceptorMessage](
+                                 Result result, const MessageId& messageId) {
+                                 producerStatsBasePtr_->messageReceived(result, now);
+
+                                 interceptors_->onSendAcknowledgement(producer, result, interceptorMessage,
+                                                                      messageId);
+
+                                 if (callback) {
+                                     callback(result, messageId);
+                                 }
+                             });
+}
 
+void ProducerImpl::sendAsync(std::vector<Message>&& messages, BatchSendCallback callback) {
+    if (messages.empty()) {
         if (callback) {
-            callback(result, messageId);
+            callback(ResultOk, {});
         }
-    });
+        return;
+    }
+    producerStatsBasePtr_->messagesSent(messages);
+
+    auto bulk = std::make_shared<BulkSend>();
+    bulk->producer = shared_from_this();
+    if (!interceptors_->empty()) {
+        Producer producer{bulk->producer};
+        for (auto& msg : messages) {
+            msg = interceptors_->beforeSend(producer, msg);
+        }
+    }
+    bulk->messages = std::move(messages);
+    bulk->messageIds.resize(bulk->messages.size());
+    bulk->callback = std::move(callback);
+    bulk->sendTime = TimeUtils::now();
+    bulk->numPending = bulk->messages.size();
+
+    // The spots are reserved in chunks of at most a batch, or the currently free spots, so that a large bulk
+    // neither holds all the pending queue nor waits for the whole queue to drain before sending anything
+    const size_t numMessages = bulk->messages.size();
+    const size_t maxMessagesPerReservation =
+        conf_.getBatchingEnabled() ? std::max(static_cast<size_t>(conf_.getBatchingMaxMessages()), size_t(1))
+                                   : numMessages;
+    size_t begin = 0;
+    while (begin < numMessages) {
+        size_t numMessagesToReserve = std::min(numMessages - begin, maxMessagesPerReservation);
+        if (semaphore_) {
+            const auto maxPendingMessages = static_cast<uint32_t>(conf_.getMaxPendingMessages());
+            const auto currentUsage = semaphore_->currentUsage();
+            const size_t numFreeSpots =
+                (currentUsage < maxPendingMessages) ? maxPendingMessages - currentUsage : 0;
+            // Reserve at least one spot to block (or fail) when the queue is full
+            numMessagesToReserve = std::min(numMessagesToReserve, std::max(numFreeSpots, size_t(1)));
+        }
+        sendBulkMessages(bulk, begin, begin + numMessagesToReserve);
+        begin += numMessagesToReserve;
+    }
+}
+
+void ProducerImpl::sendBulkMessages(const BulkSendPtr& bulk, size_t begin, size_t end) {
+    const auto& messages = bulk->messages;
+    const auto failMessages = [this, &bulk, begin, end](Result result, const MessageId&) {
+        for (size_t i = begin; i < end; i++) {
+            completeBulkMessage(*bulk, i, result, {});
+        }
+    };
+    if (!isValidProducerState(failMessages)) {
+        return;
+    }
+
+    uint64_t totalSize = 0;
+    for (size_t i = begin; i < end; i++) {
+        // Convert the payload before sending the message.
+        messages[i].impl_->convertKeyValueToPayload(conf_.getSchema());
+        totalSize += messages[i].impl_->payload.readableBytes();
+    }
+    const auto result = canEnqueueRequest(totalSize, static_cast<int>(end - begin));
+    if (result != ResultOk) {
+        sendBatchImmediately();
+        failMessages(result, {});
+        return;
+    }
+
+    if (!batchMessageContainer_) {
+        for (size_t i = begin; i < end; i++) {
+            sendReservedMessage(messages[i], createBulkMessageCallback(bulk, i));
+        }
+        return;
+    }
+
+    Lock lock(mutex_);
+    PendingFailures failures;
+    // The messages staged before get the smaller sequence ids
+    unsafeDrainStagedMessages(failures, true);
+    for (size_t i = begin; i < end; i++) {
+        const auto& msg = messages[i];
+        if (!canAddToBatch(msg)) {
+            // It's sent after the current batch like a message that is not batched
+            lock.unlock();
+            failures.complete();
+            failures = PendingFailures{};
+            sendReservedMessage(msg, createBulkMessageCallback(bulk, i));
+            lock.lock();
+            continue;
+        }
+
+        auto& msgMetadata = msg.impl_->metadata;
+        const uint32_t uncompressedSize = msg.impl_->payload.readableBytes();
+        if (msg.impl_->staged.load(std::memory_order_acquire) ||
+            (!msgMetadata.has_replicated_from() && msgMetadata.has_publish_time())) {
+            releaseSemaphore(uncompressedSize);
+            failures.add([this, bulk, i] { completeBulkMessage(*bulk, i, ResultInvalidMessage, {}); });
+            continue;
+        }
+        const uint64_t sequenceId =
+            msgMetadata.has_sequence_id() ? msgMetadata.sequence_id() : msgSequenceGenerator_++;
+        setMessageMetadata(msg, sequenceId, uncompressedSize);
+        // The batches are split at the batch boundaries like the messages added one by one
+        unsafeAddToBatch(msg, createBulkMessageCallback(bulk, i), failures);
+    }
+    lock.unlock();
+    failures.complete();
+}
+
+InlineSendCallback ProducerImpl::createBulkMessageCallback(const BulkSendPtr& bulk, size_t index) {
+    return [bulk, index](Result result, const MessageId& messageId) {
+        bulk->producer->completeBulkMessage(*bulk, index, result, messageId);
+    };
 }
 
-void ProducerImpl::sendAsyncWithStatsUpdate(const Message& msg, SendCallback&& callback) {
+void ProducerImpl::completeBulkMessage(BulkSend& bulk, size_t index, Result result,
+                                       const MessageId& messageId) {
+    producerStatsBasePtr_->messageReceived(result, bulk.sendTime);
+    if (!interceptors_->empty()) {
+        interceptors_->onSendAcknowledgement(Producer(bulk.producer), result, bulk.messages[index],
+                                             messageId);
+    }
+
+    bulk.messageIds[index] = messageId;
+    if (result != ResultOk) {
+        auto expected = ResultOk;
+        bulk.result.compare_exchange_strong(expected, result);
+    }
+    // The last message sees the ids and the result set by the other messages
+    if (bulk.numPending.fetch_sub(1, std::memory_order_acq_rel) == 1 && bulk.callback) {
+        bulk.callback(bulk.result, bulk.messageIds);
+    }
+}
+
+void ProducerImpl::sendAsyncWithStatsUpdate(const Message& msg, InlineSendCallback&& callback) {
     if (!isValidProducerState(callback)) {
         return;
     }
@@ -496,39 +760,86 @@ void ProducerImpl::sendAsyncWithStatsUpdate(const Message& msg, SendCallback&& c
     const uint32_t uncompressedSize = uncompressedPayload.readableBytes();
     const auto result = canEnqueueRequest(uncompressedSize);
     if (result != ResultOk) {
-        // If queue is full sending the batch immediately, no point waiting till batchMessagetimeout
-        if (batchMessageContainer_) {
-            LOG_DEBUG(getName() << " - sending batch message immediately");
-            Lock lock(mutex_);
-            auto failures = batchMessageAndSend();
-            lock.unlock();
-            failures.complete();
-        }
-
+        sendBatchImmediately();
         callback(result, {});
         return;
     }
 
+    sendReservedMessage(msg, std::move(callback));
+}
+
+void ProducerImpl::sendBatchImmediately() {
+    // If queue is full sending the batch immediately, no point waiting till batchMessagetimeout
+    if (batchMessageContainer_) {
+        LOG_DEBUG(getName() << " - sending batch message immediately");
+        Lock lock(mutex_);
+        PendingFailures failures;
+        unsafeDrainStagedMessages(failures, false);
+        failures.add(batchMessageAndSend());
+        lock.unlock();
+        failures.complete();
+    }
+}
+
+void ProducerImpl::sendReservedMessage(const Message& msg, InlineSendCallback&& callback) {
+    const auto& uncompressedPayload = msg.impl_->payload;
+    const uint32_t uncompressedSize = uncompressedPayload.readableBytes();
+
     // We have already reserved a spot, so if we need to early return for failed result, we should release the
     // semaphore and memory first.
-    const auto handleFailedResult = [this, uncompressedSize, callback](Result result) {
+    const auto handleFailedResult = [this, uncompressedSize, &callback](Result result) {
         releaseSemaphore(uncompressedSize);  // it releases the memory as well
         callback(result, {});
     };
 
+    // The metadata of a staged message is completed by the thread that drains the staged messages, which
+    // might run after this method returns, so it must not be read until the drainer is done with it
+    if (msg.impl_->staged.load(std::memory_order_acquire)) {
+        handleFailedResult(ResultInvalidMessage);
+        return;
+    }
+
     auto& msgMetadata = msg.impl_->metadata;
     const bool compressed = !canAddToBatch(msg);
-    const auto payload =
-        compressed ? applyCompression(uncompressedPayload, conf_.getCompressionType()) : uncompressedPayload;
+    const auto payload = compressed ? applyCompression(uncompressedPayload, conf_.getCompressionType(),
+                                                       conf_.getCompressionLevel())
+                                    : uncompressedPayload;
     const auto compressedSize = static_cast<uint32_t>(payload.readableBytes());
     const auto maxMessageSize = static_cast<uint32_t>(ClientConnection::getMaxMessageSize());
 
-    if (!msgMetadata.has_replicated_from() && msgMetadata.has_producer_name()) {
+    // A message that has been sent or received has the publish time
+    if (!msgMetadata.has_replicated_from() && msgMetadata.has_publish_time()) {
         handleFailedResult(ResultInvalidMessage);
         return;
     }
 
+    if (!compressed) {
+        // Batching is enabled and the message is not delayed. Only one of the concurrent sends of the same
+        // message can stage it.
+        if (msg.impl_->staged.exchange(true, std::memory_order_acq_rel)) {
+            handleFailedResult(ResultInvalidMessage);
+            return;
+        }
+        stageMessage(msg, std::move(callback));
+        return;
+    }
+
     Lock lock(mutex_);
+    while (batchMessageContainer_) {
+        // The messages staged or batched before get the smaller sequence ids, so they must be sent first. The
+        // mutex is held until this message is sent, otherwise the messages staged in the meantime could be
+        // batched with smaller sequence ids and sent after it.
+        PendingFailures failures;
+        unsafeDrainStagedMessages(failures, true);
+        failures.add(batchMessageAndSend());
+        if (failures.empty()) {
+            break;
+        }
+        lock.unlock();
+        failures.complete();
+        lock.lock();
+    }
+
     uint64_t sequenceId;
     if (!msgMetadata.has_sequence_id()) {
         sequenceId = msgSequenceGenerator_++;
@@ -536,10 +847,11 @@ void ProducerImpl::sendAsyncWithStatsUpdate(const Message& msg, SendCallback&& c
         sequenceId = msgMetadata.sequence_id();
     }
     setMessageMetadata(msg, sequenceId, uncompressedSize);
+    msgMetadata.set_producer_name(producerName_);
 
     auto payloadChunkSize = maxMessageSize;
     int totalChunks;
-    if (!compressed || !chunkingEnabled_) {
+    if (!chunkingEnabled_) {
         totalChunks = 1;
     } else {
         const auto metadataSize = static_cast<uint32_t>(msgMetadata.ByteSizeLong());
@@ -562,88 +874,49 @@ void ProducerImpl::sendAsyncWithStatsUpdate(const Message& msg, SendCallback&& c
         }
     }
 
-    if (canAddToBatch(msg)) {
-        // Batching is enabled and the message is not delayed
-        if (!batchMessageContainer_->hasEnoughSpace(msg)) {
-            batchMessageAndSend().complete();
-        }
-        bool isFirstMessage = batchMessageContainer_->isFirstMessageToAdd(msg);
-        bool isFull = batchMessageContainer_->add(msg, callback);
-        if (isFirstMessage) {
-            batchTimer_->expires_from_now(milliseconds(conf_.getBatchingMaxPublishDelayMs()));
-            auto weakSelf = weak_from_this();
-            batchTimer_->async_wait([this, weakSelf](const ASIO_ERROR& ec) {
-                auto self = weakSelf.lock();
-                if (!self) {
-                    return;
-                }
-                if (ec) {
-                    LOG_DEBUG(getName() << " Ignoring timer cancelled event, code[" << ec << "]");
-                    return;
-                }
-                LOG_DEBUG(getName() << " - Batch Message Timer expired");
-
-                // ignore if the producer is already closing/closed
-                const auto state = state_.load();
-                if (state == Pending || state == Ready) {
-                    Lock lock(mutex_);
-                    auto failures = batchMessageAndSend();
-                    lock.unlock();
-                    failures.complete();
-                }
-            });
-        }
+    const bool sendChunks = (totalChunks > 1);
+    ChunkMessageIdListPtr chunkMessageIdList;
+    if (sendChunks) {
+        msgMetadata.set_uuid(producerName_ + "-" + std::to_string(sequenceId));
+        msgMetadata.set_num_chunks_from_msg(totalChunks);
+        msgMetadata.set_total_chunk_msg_size(compressedSize);
+        chunkMessageIdList = std::make_shared<std::vector<MessageId>>();
+    }
 
-        if (isFull) {
-            auto failures = batchMessageAndSend();
-            lock.unlock();
-            failures.complete();
-        }
-    } else {
-        const bool sendChunks = (totalChunks > 1);
-        ChunkMessageIdListPtr chunkMessageIdList;
+    int beginIndex = 0;
+    for (int chunkId = 0; chunkId < totalChunks; chunkId++) {
         if (sendChunks) {
-            msgMetadata.set_uuid(producerName_ + "-" + std::to_string(sequenceId));
-            msgMetadata.set_num_chunks_from_msg(totalChunks);
-            msgMetadata.set_total_chunk_msg_size(compressedSize);
-            chunkMessageIdList = std::make_shared<std::vector<MessageId>>();
+            msgMetadata.set_chunk_id(chunkId);
         }
+        const uint32_t endIndex = std::min(compressedSize, beginIndex + payloadChunkSize);
+        auto chunkedPayload = payload.slice(beginIndex, endIndex - beginIndex);
+        beginIndex = endIndex;
 
-        int beginIndex = 0;
-        for (int chunkId = 0; chunkId < totalChunks; chunkId++) {
-            if (sendChunks) {
-                msgMetadata.set_chunk_id(chunkId);
-            }
-            const uint32_t endIndex = std::min(compressedSize, beginIndex + payloadChunkSize);
-            auto chunkedPayload = payload.slice(beginIndex, endIndex - beginIndex);
-            beginIndex = endIndex;
+        SharedBuffer encryptedPayload;
+        if (!encryptMessage(msgMetadata, chunkedPayload, encryptedPayload)) {
+            handleFailedResult(ResultCryptoError);
+            return;
+        }
 
-            SharedBuffer encryptedPayload;
-            if (!encryptMessage(msgMetadata, chunkedPayload, encryptedPayload)) {
-                handleFailedResult(ResultCryptoError);
+        if (!chunkingEnabled_) {
+            const uint32_t msgMetadataSize = msgMetadata.ByteSizeLong();
+            const uint32_t payloadSize = encryptedPayload.readableBytes();
+            const uint32_t msgHeadersAndPayloadSize = msgMetadataSize + payloadSize;
+            if (msgHeadersAndPayloadSize > maxMessageSize) {
+                lock.unlock();
+                LOG_WARN(getName()
+                         << " - compressed Message size " << msgHeadersAndPayloadSize << " cannot exceed "
+                         << maxMessageSize << " bytes unless chunking is enabled");
+                handleFailedResult(ResultMessageTooBig);
                 return;
             }
-
-            auto op = OpSendMsg::create(msgMetadata, 1, uncompressedSize, conf_.getSendTimeout(),
-                                        (chunkId == totalChunks - 1) ? callback : nullptr, chunkMessageIdList,
-                                        producerId_, encryptedPayload);
-
-            if (!chunkingEnabled_) {
-                const uint32_t msgMetadataSize = op->sendArgs->metadata.ByteSizeLong();
-                const uint32_t payloadSize = op->sendArgs->payload.readableBytes();
-                const uint32_t msgHeadersAndPayloadSize = msgMetadataSize + payloadSize;
-                if (msgHeadersAndPayloadSize > maxMessageSize) {
-                    lock.unlock();
-                    LOG_WARN(getName()
-                             << " - compressed Message size " << msgHeadersAndPayloadSize << " cannot exceed "
-                             << maxMessageSize << " bytes unless chunking is enabled");
-                    handleFailedResult(ResultMessageTooBig);
-                    return;
-                }
-            }
-
-            sendMessage(std::move(op));
         }
+
+        // Only the last chunk completes the callback
+        const bool isLastChunk = (chunkId == totalChunks - 1);
+        sendMessage(opSendMsgPool_.create(msgMetadata, 1, uncompressedSize, conf_.getSendTimeout(),
+                                          isLastChunk ? std::move(callback) : InlineSendCallback{},
+                                          chunkMessageIdList, producerId_, encryptedPayload));
     }
 }
 
@@ -654,9 +927,143 @@ int ProducerImpl::getNumOfChunks(uint32_t size, uint32_t maxMessageSize) {
     return 1;
 }
 
-Result ProducerImpl::canEnqueueRequest(uint32_t payloadSize) {
+void ProducerImpl::stageMessage(const Message& msg, InlineSendCallback&& callback) {
+    const bool isOwner = (numStagedMessages_.fetch_add(1, std::memory_order_acq_rel) == 0);
+    stagedMessages_.push(StagedMessage{msg, std::move(callback)});
+    if (!isOwner) {
+        return;
+    }
+
+    Lock lock(mutex_, std::try_to_lock);
+    if (lock.owns_lock()) {
+        drainStagedMessages(lock);
+    } else {
+        auto weakSelf = weak_from_this();
+        executor_->postWork([weakSelf] {
+            auto self = weakSelf.lock();
+            if (self) {
+                Lock lock(self->mutex_);
+                self->drainStagedMessages(lock);
+            }
+        });
+    }
+}
+
+void ProducerImpl::drainStagedMessages(Lock& lock) {
+    PendingFailures failures;
+    const auto numStagedMessages = unsafeDrainStagedMessages(failures, false);
+    lock.unlock();
+    failures.complete();
+
+    if (numStagedMessages > 0) {
+        // Other threads are still staging their messages, drain them later on the executor
+        auto weakSelf = weak_from_this();
+        executor_->postWork([weakSelf] {
+            auto self = weakSelf.lock();
+            if (self) {
+                Lock lock(self->mutex_);
+                self->drainStagedMessages(lock);
+            }
+        });
+    }
+}
+
+uint64_t ProducerImpl::unsafeDrainStagedMessages(PendingFailures& failures, bool waitForStagingThreads) {
+    // The messages staged before are within the first `numToWait` elements of the queue
+    const uint64_t numToWait = waitForStagingThreads ? numStagedMessages_.load(std::memory_order_acquire) : 0;
+    uint64_t numDrained = 0;
+    StagedMessage staged;
+    while (true) {
+        if (!stagedMessages_.pop(staged)) {
+            if (numDrained >= numToWait) {
+                break;
+            }
+            // A sending thread has reserved its position but not finished the push
+            std::this_thread::yield();
+            continue;
+        }
+        numDrained++;
+
+        const auto& msg = staged.msg;
+        const uint32_t uncompressedSize = msg.impl_->payload.readableBytes();
+        auto& callback = staged.callback;
+        const auto deferCallback = [&failures, &callback](Result result, const MessageId&) {
+            failures.add([failedCallback = std::move(callback), result] { failedCallback(result, {}); });
+        };
+        if (!isValidProducerState(deferCallback)) {
+            releaseSemaphore(uncompressedSize);
+            msg.impl_->staged.store(false, std::memory_order_release);
+            continue;
+        }
+
+        auto& msgMetadata = msg.impl_->metadata;
+        const uint64_t sequenceId =
+            msgMetadata.has_sequence_id() ? msgMetadata.sequence_id() : msgSequenceGenerator_++;
+        setMessageMetadata(msg, sequenceId, uncompressedSize);
+        // The publish time is set, a later send of this message reads it and fails
+        msg.impl_->staged.store(false, std::memory_order_release);
+        unsafeAddToBatch(msg, std::move(callback), failures);
+    }
+    if (numDrained == 0) {
+        return numStagedMessages_.load(std::memory_order_acquire);
+    }
+    return numStagedMessages_.fetch_sub(numDrained, std::memory_order_acq_rel) - numDrained;
+}
+
+void ProducerImpl::unsafeAddToBatch(const Message& msg, InlineSendCallback&& callback,
+                                    PendingFailures& failures) {
+    if (!batchMessageContainer_->hasEnoughSpace(msg)) {
+        failures.add(batchMessageAndSend());
+    }
+    bool isFirstMessage = batchMessageContainer_->isFirstMessageToAdd(msg);
+    bool isFull = batchMessageContainer_->add(msg, std::move(callback));
+    TimeDuration delay = milliseconds(conf_.getBatchingMaxPublishDelayMs());
+    if (adaptiveBatchingDelay_) {
+        adaptiveBatchingDelay_->onMessageArrived(TimeUtils::now());
+        if (isFirstMessage) {
+            delay = adaptiveBatchingDelay_->nextDelay(pendingMessagesQueue_.empty() && encodingOps_.empty());
+            if (delay.count() == 0) {
+                isFull = true;
+            }
+        }
+    }
+    if (isFirstMessage && !isFull) {
+        batchDeadline_ = std::chrono::steady_clock::now() + delay;
+        auto weakSelf = weak_from_this();
+        batchTimer_.expiresAt(batchDeadline_, [this, weakSelf] {
+            auto self = weakSelf.lock();
+            if (self) {
+                handleBatchTimer();
+            }
+        });
+    }
+
+    if (isFull) {
+        failures.add(batchMessageAndSend());
+    }
+}
+
+void ProducerImpl::handleBatchTimer() {
+    LOG_DEBUG(getName() << " - Batch Message Timer expired");
+
+    // ignore if the producer is already closing/closed
+    const auto state = state_.load();
+    if (state != Pending && state != Ready) {
+        return;
+    }
+    Lock lock(mutex_);
+    if (batchMessageContainer_->isEmpty() || batchDeadline_ > std::chrono::steady_clock::now()) {
+        // The batch of the expired deadline has been sent, the timer has been restarted for the current batch
+        return;
+    }
+    auto failures = batchMessageAndSend();
+    lock.unlock();
+    failures.complete();
+}
+
+Result ProducerImpl::canEnqueueRequest(uint64_t payloadSize, int numMessages) {
     if (conf_.getBlockIfQueueFull()) {
-        if (semaphore_ && !semaphore_->acquire()) {
+        if (semaphore_ && !semaphore_->acquire(numMessages)) {
             return ResultInterrupted;
         }
         if (!memoryLimitController_.reserveMemory(payloadSize)) {
@@ -664,12 +1071,12 @@ Result ProducerImpl::canEnqueueRequest(uint32_t payloadSize) {
         }
         return ResultOk;
     } else {
-        if (semaphore_ && !semaphore_->tryAcquire()) {
+        if (semaphore_ && !semaphore_->tryAcquire(numMessages)) {
             return ResultProducerQueueIsFull;
         }
         if (!memoryLimitController_.tryReserveMemory(payloadSize)) {
             if (semaphore_) {
-                semaphore_->release(1);
+                semaphore_->release(numMessages);
             }
 
             return ResultMemoryBufferIsFull;
@@ -688,6 +1095,11 @@ void ProducerImpl::releaseSemaphore(uint32_t payloadSize) {
 }
 
 void ProducerImpl::releaseSemaphoreForSendOp(const OpSendMsg& op) {
+    if (op.spooled) {
+        // The spots and the memory of the payload have been released when the op was spooled
+        memoryLimitController_.releaseMemory(getSpooledOpSize(op));
+        return;
+    }
     if (semaphore_) {
         semaphore_->release(op.messagesCount);
     }
@@ -695,18 +1107,35 @@ void ProducerImpl::releaseSemaphoreForSendOp(const OpSendMsg& op) {
     memoryLimitController_.releaseMemory(op.messagesSize);
 }
 
+bool ProducerImpl::tryReserveForSendOp(const OpSendMsg& op) {
+    if (semaphore_ && !semaphore_->tryAcquire(op.messagesCount)) {
+        return false;
+    }
+    if (!memoryLimitController_.tryReserveMemory(op.messagesSize)) {
+        if (semaphore_) {
+            semaphore_->release(op.messagesCount);
+        }
+        return false;
+    }
+    return true;
+}
+
 // It must be called while `mutex_` is acquired
 PendingFailures ProducerImpl::batchMessageAndSend(const FlushCallback& flushCallback) {
     PendingFailures failures;
     LOG_DEBUG("batchMessageAndSend " << *batchMessageContainer_);
-    batchTimer_->cancel();
     if (batchMessageContainer_->isEmpty()) {
         return failures;
     }
+    batchTimer_.cancel();
 
     auto handleOp = [this, &failures](std::unique_ptr<OpSendMsg>&& op) {
         if (op->result == ResultOk) {
-            sendMessage(std::move(op));
+            if (compressionExecutorProvider_) {
+                encodeAndSendMessage(std::move(op));
+            } else {
+                sendMessage(std::move(op));
+            }
         } else {
             LOG_ERROR("batchMessageAndSend | Failed to createOpSendMsg: " << op->result);
             releaseSemaphoreForSendOp(*op);
@@ -733,12 +1162,33 @@ PendingFailures ProducerImpl::batchMessageAndSend(const FlushCallback& flushCall
 // a. we have a reserved spot on the queue
 // b. call this function after acquiring the ProducerImpl mutex_
 void ProducerImpl::sendMessage(std::unique_ptr<OpSendMsg> opSendMsg) {
+    if (!encodingOps_.empty()) {
+        // Wait until the ops with smaller sequence ids are encoded
+        auto encodingOp = std::make_shared<EncodingOpSendMsg>();
+        encodingOp->op = std::move(opSendMsg);
+        encodingOp->done = true;
+        encodingOps_.emplace_back(std::move(encodingOp));
+        return;
+    }
+    sendMessageImmediately(std::move(opSendMsg));
+}
+
+void ProducerImpl::sendMessageImmediately(std::unique_ptr<OpSendMsg> opSendMsg) {
+    ClientConnectionPtr cnx = getCnx().lock();
+    if (spoolEnabled_ && (!cnx || !spooledOps_.empty()) && ensureSpool()) {
+        // The op must be sent after the ops parked before it
+        spoolMessage(std::move(opSendMsg));
+        if (cnx) {
+            sendSpooledMessages(cnx);
+        }
+        return;
+    }
+
     const auto sequenceId = opSendMsg->sendArgs->sequenceId;
     LOG_DEBUG("Inserting data to pendingMessagesQueue_");
     auto args = opSendMsg->sendArgs;
     pendingMessagesQueue_.emplace_back(std::move(opSendMsg));
 
-    ClientConnectionPtr cnx = getCnx().lock();
     if (cnx) {
         // If we do have a connection, the message is sent immediately, otherwise
         // we'll try again once a new connection is established
@@ -749,6 +1199,66 @@ void ProducerImpl::sendMessage(std::unique_ptr<OpSendMsg> opSendMsg) {
     }
 }
 
+void ProducerImpl::encodeAndSendMessage(std::unique_ptr<OpSendMsg> opSendMsg) {
+    auto args = opSendMsg->sendArgs;
+    auto encodingOp = std::make_shared<EncodingOpSendMsg>();
+    encodingOp->op = std::move(opSendMsg);
+    encodingOps_.emplace_back(encodingOp);
+
+    auto weakSelf = weak_from_this();
+    compressionExecutorProvider_->get()->postWork([weakSelf, encodingOp, args] {
+        auto self = weakSelf.lock();
+        if (self) {
+            self->encodeMessage(encodingOp, *args);
+        }
+    });
+}
+
+void ProducerImpl::encodeMessage(const std::shared_ptr<EncodingOpSendMsg>& encodingOp,
+                                 const SendArguments& args) {
+    // The arguments are not modified, so they can be read without acquiring mutex_
+    proto::MessageMetadata metadata{args.metadata};
+    SharedBuffer payload = args.payload;
+    const auto result = MessageAndCallbackBatch::encodePayload(metadata, payload, conf_, msgCrypto_.get(),
+                                                               autoCompressionSelector_.get());
+
+    Lock lock(mutex_);
+    if (!encodingOp->op) {
+        return;
+    }
+    encodingOp->done = true;
+    encodingOp->result = result;
+    if (result == ResultOk) {
+        encodingOp->op->sendArgs =
+            std::make_shared<SendArguments>(args.producerId, args.sequenceId, metadata, payload);
+    }
+    auto failures = sendEncodedMessages();
+    lock.unlock();
+    failures.complete();
+}
+
+PendingFailures ProducerImpl::sendEncodedMessages() {
+    PendingFailures failures;
+    while (!encodingOps_.empty() && encodingOps_.front()->done) {
+        auto op = std::move(encodingOps_.front()->op);
+        const auto result = encodingOps_.front()->result;
+        encodingOps_.pop_front();
+        if (result == ResultOk) {
+            sendMessageImmediately(std::move(op));
+        } else {
+            LOG_ERROR(getName() << "Failed to encode the batch " << op->sendArgs->sequenceId << ": "
+                                << result);
+            releaseSemaphoreForSendOp(*op);
+            auto rawOpPtr = op.release();
+            failures.add([rawOpPtr, result] {
+                std::unique_ptr<OpSendMsg> op{rawOpPtr};
+                op->complete(result, {});
+            });
+        }
+    }
+    return failures;
+}
+
 void ProducerImpl::printStats() {
     if (batchMessageContainer_) {
         LOG_INFO("Producer - " << producerStr_ << ", [batchMessageContainer = " << *batchMessageContainer_
@@ -787,6 +1297,9 @@ void ProducerImpl::closeAsync(CloseCallback originalCallback) {
     }
 
     // ensure any remaining send callbacks are called before calling the close callback
+    PendingFailures failures;
+    unsafeDrainStagedMessages(failures, true);
+    failures.complete();
     failPendingMessages(ResultAlreadyClosed, false);
 
     // TODO  maybe we need a loop here to implement CAS for a condition,
@@ -828,30 +1341,39 @@ Future<Result, ProducerImplBaseWeakPtr> ProducerImpl::getProducerCreatedFuture()
 
 uint64_t ProducerImpl::getProducerId() const { return producerId_; }
 
-void ProducerImpl::handleSendTimeout(const ASIO_ERROR& err) {
+void ProducerImpl::handleSendTimeout() {
     const auto state = state_.load();
     if (state != Pending && state != Ready) {
         return;
     }
     Lock lock(mutex_);
 
-    if (err == ASIO::error::operation_aborted) {
-        LOG_DEBUG(getName() << "Timer cancelled: " << err.message());
-        return;
-    } else if (err) {
-        LOG_ERROR(getName() << "Timer error: " << err.message());
-        return;
-    }
-
     decltype(pendingMessagesQueue_) pendingMessages;
-    if (pendingMessagesQueue_.empty()) {
+    // The ops still being encoded are not in the pending queue yet, and the parked ops could be older than
+    // the pending ops after a reconnection, so the op that expires first is picked among the three queues
+    const OpSendMsg* oldestOp = nullptr;
+    auto updateOldestOp = [&oldestOp](const OpSendMsg* op) {
+        if (!oldestOp || op->timeout < oldestOp->timeout) {
+            oldestOp = op;
+        }
+    };
+    if (!pendingMessagesQueue_.empty()) {
+        updateOldestOp(pendingMessagesQueue_.front().get());
+    }
+    if (!spooledOps_.empty()) {
+        updateOldestOp(spooledOps_.front().get());
+    }
+    if (!encodingOps_.empty()) {
+        updateOldestOp(encodingOps_.front()->op.get());
+    }
+    if (!oldestOp) {
         // If there are no pending messages, reset the timeout to the configured value.
         LOG_DEBUG(getName() << "Producer timeout triggered on empty pending message queue");
         asyncWaitSendTimeout(milliseconds(conf_.getSendTimeout()));
     } else {
         // If there is at least one message, calculate the diff between the message timeout and
         // the current time.
-        auto diff = pendingMessagesQueue_.front()->timeout - TimeUtils::now();
+        auto diff = oldestOp->timeout - TimeUtils::now();
         if (toMillis(diff) <= 0) {
             // The diff is less than or equal to zero, meaning that the message has been expired.
             LOG_DEBUG(getName() << "Timer expired. Calling timeout callbacks.");
@@ -892,6 +1414,12 @@ bool ProducerImpl::removeCorruptMessage(uint64_t sequenceId) {
     } else {
         LOG_DEBUG(getName() << "Remove corrupt message from queue " << sequenceId);
         pendingMessagesQueue_.pop_front();
+        if (!spooledOps_.empty()) {
+            auto cnx = getCnx().lock();
+            if (cnx) {
+                sendSpooledMessages(cnx);
+            }
+        }
         lock.unlock();
         try {
             // to protect from client callback exception
@@ -950,9 +1478,19 @@ bool ProducerImpl::ackReceived(uint64_t sequenceId, MessageId& rawMessageId) {
 
     releaseSemaphoreForSendOp(op);
     lastSequenceIdPublished_ = sequenceId + op.messagesCount - 1;
+    if (adaptiveBatchingDelay_) {
+        adaptiveBatchingDelay_->onAckReceived(TimeUtils::now() - op.createdTime);
+    }
 
     std::unique_ptr<OpSendMsg> opSendMsg{pendingMessagesQueue_.front().release()};
     pendingMessagesQueue_.pop_front();
+    if (!spooledOps_.empty()) {
+        // The spots of the acknowledged op might be reserved for the spooled ops
+        auto cnx = getCnx().lock();
+        if (cnx) {
+            sendSpooledMessages(cnx);
+        }
+    }
 
     lock.unlock();
     try {
@@ -960,6 +1498,7 @@ bool ProducerImpl::ackReceived(uint64_t sequenceId, MessageId& rawMessageId) {
     } catch (const std::exception& e) {
         LOG_ERROR(getName() << "Exception thrown from callback " << e.what());
     }
+    opSendMsgPool_.recycle(std::move(opSendMsg));
     return true;
 }
 
@@ -1009,9 +1548,8 @@ void ProducerImpl::internalShutdown() {
 
 void ProducerImpl::cancelTimers() noexcept {
     dataKeyRefreshTask_.stop();
-    ASIO_ERROR ec;
-    batchTimer_->cancel(ec);
-    sendTimer_->cancel(ec);
+    batchTimer_.cancel();
+    sendTimer_.cancel();
 }
 
 bool ProducerImplCmp::operator()(const ProducerImplPtr& a, const ProducerImplPtr& b) const {
@@ -1032,13 +1570,11 @@ void ProducerImpl::startSendTimeoutTimer() {
 }
 
 void ProducerImpl::asyncWaitSendTimeout(DurationType expiryTime) {
-    sendTimer_->expires_from_now(expiryTime);
-
     auto weakSelf = weak_from_this();
-    sendTimer_->async_wait([weakSelf](const ASIO_ERROR& err) {
+    sendTimer_.expiresAfter(expiryTime, [weakSelf] {
         auto self = weakSelf.lock();
         if (self) {
-            std::static_pointer_cast<ProducerImpl>(self)->handleSendTimeout(err);
+            std::static_pointer_cast<ProducerImpl>(self)->handleSendTimeout();
         }
     });
 }
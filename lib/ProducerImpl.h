@@ -27,30 +27,36 @@
 #endif
 #include <atomic>
 #include <boost/optional.hpp>
+#include <deque>
 #include <list>
 #include <memory>
 
 #include "Future.h"
 #include "HandlerBase.h"
-// In MSVC and macOS, the value type of STL container cannot be forward declared
-#if defined(_MSC_VER) || defined(__APPLE__)
-#include "OpSendMsg.h"
-#endif
 #include "AsioDefines.h"
+#include "MpscQueue.h"
+#include "ObjectPool.h"
+#include "OpSendMsg.h"
 #include "PendingFailures.h"
 #include "PeriodicTask.h"
 #include "ProducerImplBase.h"
+#include "TimingWheel.h"
 
 namespace pulsar {
 
+class AdaptiveBatchingDelay;
+class AutoCompressionSelector;
 class BatchMessageContainerBase;
 class ClientImpl;
 using ClientImplPtr = std::shared_ptr<ClientImpl>;
 using DeadlineTimerPtr = std::shared_ptr<ASIO::steady_timer>;
+class ExecutorServiceProvider;
+using ExecutorServiceProviderPtr = std::shared_ptr<ExecutorServiceProvider>;
 class MessageCrypto;
 using MessageCryptoPtr = std::shared_ptr<MessageCrypto>;
 class ProducerImpl;
 using ProducerImplWeakPtr = std::weak_ptr<ProducerImpl>;
+class ProducerSpool;
 class ProducerStatsBase;
 using ProducerStatsBasePtr = std::shared_ptr<ProducerStatsBase>;
 struct ResponseData;
@@ -63,7 +69,6 @@ class Producer;
 class MemoryLimitController;
 class Semaphore;
 class TopicName;
-struct OpSendMsg;
 
 namespace proto {
 class MessageMetadata;
@@ -82,6 +87,7 @@ class ProducerImpl : public HandlerBase, public ProducerImplBase {
     int64_t getLastSequenceId() const override;
     const std::string& getSchemaVersion() const override;
     void sendAsync(const Message& msg, SendCallback callback) override;
+    void sendAsync(std::vector<Message>&& messages, BatchSendCallback callback) override;
     void closeAsync(CloseCallback callback) override;
     void start() override;
     void shutdown() override;
@@ -122,6 +128,7 @@ class ProducerImpl : public HandlerBase, public ProducerImplBase {
     void setMessageMetadata(const Message& msg, const uint64_t& sequenceId, const uint32_t& uncompressedSize);
 
     void sendMessage(std::unique_ptr<OpSendMsg> opSendMsg);
+    void sendMessageImmediately(std::unique_ptr<OpSendMsg> opSendMsg);
 
     void startSendTimeoutTimer();
 
@@ -146,36 +153,132 @@ class ProducerImpl : public HandlerBase, public ProducerImplBase {
 
     void resendMessages(const ClientConnectionPtr& cnx);
 
+    // Create the spool if it does not exist, return false if it cannot be created
+    bool ensureSpool();
+    // Park the op after the pending queue, its payload is moved to the spool unless the spool is full. It
+    // must be called while mutex_ is acquired.
+    void spoolMessage(std::unique_ptr<OpSendMsg> op);
+    // Move the parked ops to the pending queue and send them, as long as the spots in the queue can be
+    // reserved for the spooled ops. It must be called while mutex_ is acquired.
+    void sendSpooledMessages(const ClientConnectionPtr& cnx);
+
     void refreshEncryptionKey(const ASIO_ERROR& ec);
     bool encryptMessage(proto::MessageMetadata& metadata, SharedBuffer& payload,
                         SharedBuffer& encryptedPayload);
 
-    void sendAsyncWithStatsUpdate(const Message& msg, SendCallback&& callback);
+    void sendAsyncWithStatsUpdate(const Message& msg, InlineSendCallback&& callback);
+
+    // Send the batch without waiting for the batching delay, e.g. when the messages queue is full
+    void sendBatchImmediately();
+
+    // Send a message whose spot in the messages queue and memory have been reserved
+    void sendReservedMessage(const Message& msg, InlineSendCallback&& callback);
+
+    // The messages of a bulk sendAsync share this state, the callback is completed when the last message is
+    // persisted or failed
+    struct BulkSend {
+        ProducerImplPtr producer;
+        std::vector<Message> messages;
+        std::vector<MessageId> messageIds;
+        BatchSendCallback callback;
+        ptime sendTime;
+        std::atomic<size_t> numPending{0};
+        // The result of the first failed message
+        std::atomic<Result> result{ResultOk};
+    };
+    using BulkSendPtr = std::shared_ptr<BulkSend>;
+
+    // Send the messages in [begin, end) of a bulk, they must not exceed the max pending messages
+    void sendBulkMessages(const BulkSendPtr& bulk, size_t begin, size_t end);
+
+    static InlineSendCallback createBulkMessageCallback(const BulkSendPtr& bulk, size_t index);
+
+    void completeBulkMessage(BulkSend& bulk, size_t index, Result result, const MessageId& messageId);
 
     /**
-     * Reserve a spot in the messages queue before acquiring the ProducerImpl mutex. When the queue is full,
-     * this call will block until a spot is available if blockIfQueueIsFull is true. Otherwise, it will return
-     * ResultProducerQueueIsFull immediately.
+     * Reserve spots in the messages queue before acquiring the ProducerImpl mutex. When the queue is full,
+     * this call will block until the spots are available if blockIfQueueIsFull is true. Otherwise, it will
+     * return ResultProducerQueueIsFull immediately.
      *
      * It also checks whether the memory could reach the limit after `payloadSize` is added. If so, this call
      * will block until enough memory could be retained.
+     *
+     * @param payloadSize the total size of the messages
+     * @param numMessages the number of spots to reserve, it must not exceed the max pending messages
      */
-    Result canEnqueueRequest(uint32_t payloadSize);
+    Result canEnqueueRequest(uint64_t payloadSize, int numMessages = 1);
 
     void releaseSemaphore(uint32_t payloadSize);
     void releaseSemaphoreForSendOp(const OpSendMsg& op);
+    // Reserve the spots and the memory of an op like canEnqueueRequest without blocking
+    bool tryReserveForSendOp(const OpSendMsg& op);
 
     void cancelTimers() noexcept;
 
-    bool isValidProducerState(const SendCallback& callback) const;
+    // The callback is completed with the failed result if the state is not valid
+    template <typename Callback>
+    bool isValidProducerState(const Callback& callback) const;
     bool canAddToBatch(const Message& msg) const;
 
+    /**
+     * Stage a batched message without acquiring mutex_. The thread that stages a message into the empty queue
+     * becomes the owner of the queue: it drains the queue if mutex_ is free, otherwise the drain is scheduled
+     * on the executor.
+     */
+    void stageMessage(const Message& msg, InlineSendCallback&& callback);
+
+    // Drain the staged messages with `lock`, which must be a lock of mutex_, and release the lock
+    void drainStagedMessages(std::unique_lock<std::mutex>& lock);
+
+    /**
+     * Add the staged messages to the batch in the staging order, it must be called while mutex_ is acquired.
+     *
+     * @param failures the failed callbacks to complete after mutex_ is released
+     * @param waitForStagingThreads whether to wait for all the messages staged before this call, even if a
+     * sending thread has not finished its push yet. It must be true when the order matters, e.g. before a
+     * message that is not batched or a flush.
+     * @return the number of staged messages that are not drained yet
+     */
+    uint64_t unsafeDrainStagedMessages(PendingFailures& failures, bool waitForStagingThreads);
+
+    // It must be called while mutex_ is acquired
+    void unsafeAddToBatch(const Message& msg, InlineSendCallback&& callback, PendingFailures& failures);
+
+    void handleBatchTimer();
+
+    struct EncodingOpSendMsg {
+        std::unique_ptr<OpSendMsg> op;
+        // Whether the payload has been encoded, the op is null if it has been failed in the meantime
+        bool done = false;
+        Result result = ResultOk;
+    };
+
+    /**
+     * Compress and encrypt the batch payload of `opSendMsg` on a compression executor, the op is sent after
+     * the ops queued before it. It must be called while mutex_ is acquired.
+     */
+    void encodeAndSendMessage(std::unique_ptr<OpSendMsg> opSendMsg);
+
+    // It's called by a compression executor
+    void encodeMessage(const std::shared_ptr<EncodingOpSendMsg>& encodingOp, const SendArguments& args);
+
+    // Send the encoded ops at the front of encodingOps_, it must be called while mutex_ is acquired
+    PendingFailures sendEncodedMessages();
+
     typedef std::unique_lock<std::mutex> Lock;
 
     ProducerConfiguration conf_;
 
     std::unique_ptr<Semaphore> semaphore_;
-    std::list<std::unique_ptr<OpSendMsg>> pendingMessagesQueue_;
+    // The ops are recycled after they are completed, the list nodes are pooled as well. The pool is thread
+    // safe, the batch containers create the ops through a const reference of the producer.
+    mutable OpSendMsgPool opSendMsgPool_;
+    std::list<std::unique_ptr<OpSendMsg>, Allocator<std::unique_ptr<OpSendMsg>, 1000>> pendingMessagesQueue_;
+    // The ops parked after pendingMessagesQueue_ while the producer is disconnected, and until the ops parked
+    // before them are sent. The payloads of the spooled ops are in spool_, which is created on demand.
+    std::deque<std::unique_ptr<OpSendMsg>> spooledOps_;
+    std::unique_ptr<ProducerSpool> spool_;
+    bool spoolEnabled_ = false;
 
     const int32_t partition_;  // -1 if topic is non-partitioned
     std::string producerName_;
@@ -184,15 +287,37 @@ class ProducerImpl : public HandlerBase, public ProducerImplBase {
     uint64_t producerId_;
 
     std::unique_ptr<BatchMessageContainerBase> batchMessageContainer_;
-    DeadlineTimerPtr batchTimer_;
+
+    // It's null unless the batches are compressed or encrypted by the client's compression executors
+    ExecutorServiceProviderPtr compressionExecutorProvider_;
+    // It's null unless the automatic compression is enabled
+    std::unique_ptr<AutoCompressionSelector> autoCompressionSelector_;
+    // The ops that are being encoded and the ops that are sent after them, in the order of the sequence ids
+    std::deque<std::shared_ptr<EncodingOpSendMsg>> encodingOps_;
+
+    struct StagedMessage {
+        Message msg;
+        InlineSendCallback callback;
+    };
+    MpscQueue<StagedMessage, Allocator<StagedMessage, 10000>> stagedMessages_;
+    // It's increased before a message is staged and decreased after it's drained
+    std::atomic<uint64_t> numStagedMessages_{0};
+
+    // The batch timer is started for the first message of each batch and cancelled when the batch is sent.
+    // Since the callback might be called after the batch is sent, the deadline of the current batch is
+    // checked when the timer expires.
+    WheelTimer batchTimer_;
+    std::chrono::steady_clock::time_point batchDeadline_;
+    // It's null unless the batching latency target is configured
+    std::unique_ptr<AdaptiveBatchingDelay> adaptiveBatchingDelay_;
     PendingFailures batchMessageAndSend(const FlushCallback& flushCallback = nullptr);
 
     std::atomic<int64_t> lastSequenceIdPublished_;
     std::atomic<int64_t> msgSequenceGenerator_;
     std::string schemaVersion_;
 
-    DeadlineTimerPtr sendTimer_;
-    void handleSendTimeout(const ASIO_ERROR& err);
+    WheelTimer sendTimer_;
+    void handleSendTimeout();
     using DurationType = TimeDuration;
     void asyncWaitSendTimeout(DurationType expiryTime);
 
@@ -39,6 +39,7 @@ class ProducerImplBase {
     virtual const std::string& getSchemaVersion() const = 0;
 
     virtual void sendAsync(const Message& msg, SendCallback callback) = 0;
+    virtual void sendAsync(std::vector<Message>&& messages, BatchSendCallback callback) = 0;
     virtual void closeAsync(CloseCallback callback) = 0;
     virtual void start() = 0;
     virtual bool isClosed() = 0;
@@ -32,6 +32,8 @@ class ProducerInterceptors {
     explicit ProducerInterceptors(std::vector<ProducerInterceptorPtr> interceptors)
         : interceptors_(std::move(interceptors)) {}
 
+    bool empty() const noexcept { return interceptors_.empty(); }
+
     void onPartitionsChange(const std::string& topicName, int partitions) const;
 
     Message beforeSend(const Producer& producer, const Message& message);
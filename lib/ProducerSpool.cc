@@ -0,0 +1,160 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "ProducerSpool.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#endif
+
+#include <algorithm>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace pulsar {
+
+// The frame header has the sizes of the metadata and the payload
+static constexpr uint64_t FrameHeaderSize = 2 * sizeof(uint32_t);
+
+static std::string newSpoolFilePath(const std::string& directory) {
+    std::random_device random;
+    std::ostringstream oss;
+    oss << directory;
+    if (!directory.empty() && directory.back() != '/' && directory.back() != '\\') {
+        oss << '/';
+    }
+    oss << "pulsar-producer-" << std::hex << random() << random() << ".spool";
+    return oss.str();
+}
+
+// Allocate all the blocks of the file, a write to the mapping of a block that cannot be allocated because the
+// disk is full would raise SIGBUS
+static bool allocate(std::FILE* file, uint64_t size) {
+#ifdef __linux__
+    return posix_fallocate(fileno(file), 0, static_cast<off_t>(size)) == 0;
+#else
+    static const char zeros[4096] = {};
+    for (uint64_t written = 0; written < size;) {
+        const auto n = static_cast<size_t>(std::min<uint64_t>(sizeof(zeros), size - written));
+        if (std::fwrite(zeros, 1, n, file) != n) {
+            return false;
+        }
+        written += n;
+    }
+    return true;
+#endif
+}
+
+ProducerSpool::ProducerSpool(const std::string& directory, uint64_t capacity)
+    : path_(newSpoolFilePath(directory)), capacity_(capacity) {
+    if (capacity_ <= FrameHeaderSize || capacity_ > static_cast<uint64_t>(LONG_MAX)) {
+        throw std::runtime_error("Invalid spool size: " + std::to_string(capacity_));
+    }
+
+    std::FILE* file = std::fopen(path_.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Failed to create the spool file " + path_);
+    }
+    const bool allocated = allocate(file, capacity_);
+    if (std::fclose(file) != 0 || !allocated) {
+        std::remove(path_.c_str());
+        throw std::runtime_error("Failed to allocate " + std::to_string(capacity_) +
+                                 " bytes for the spool file " + path_);
+    }
+
+    try {
+        using namespace boost::interprocess;
+        mapping_.reset(new file_mapping(path_.c_str(), read_write));
+        region_.reset(new mapped_region(*mapping_, read_write, 0, static_cast<size_t>(capacity_)));
+    } catch (const std::exception& e) {
+        region_.reset();
+        mapping_.reset();
+        std::remove(path_.c_str());
+        throw std::runtime_error("Failed to map the spool file " + path_ + ": " + e.what());
+    }
+    data_ = static_cast<char*>(region_->get_address());
+}
+
+ProducerSpool::~ProducerSpool() {
+    // The file must be unmapped before it's removed on Windows
+    region_.reset();
+    mapping_.reset();
+    std::remove(path_.c_str());
+}
+
+bool ProducerSpool::push(const proto::MessageMetadata& metadata, const SharedBuffer& payload) {
+    const auto metadataSize = static_cast<uint32_t>(metadata.ByteSizeLong());
+    const uint32_t payloadSize = payload.readableBytes();
+    const uint64_t frameSize = FrameHeaderSize + metadataSize + payloadSize;
+    if (wrapped_) {
+        if (frameSize > readOffset_ - writeOffset_) {
+            return false;
+        }
+    } else if (frameSize > capacity_ - writeOffset_) {
+        if (frameSize > readOffset_) {
+            return false;
+        }
+        // Wrap to the space of the frames that have been read
+        wrapped_ = true;
+        endOffset_ = writeOffset_;
+        writeOffset_ = 0;
+    }
+
+    char* frame = data_ + writeOffset_;
+    std::memcpy(frame, &metadataSize, sizeof(metadataSize));
+    std::memcpy(frame + sizeof(metadataSize), &payloadSize, sizeof(payloadSize));
+    metadata.SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t*>(frame + FrameHeaderSize));
+    std::memcpy(frame + FrameHeaderSize + metadataSize, payload.data(), payloadSize);
+    writeOffset_ += frameSize;
+    numFrames_++;
+    return true;
+}
+
+void ProducerSpool::pop(proto::MessageMetadata& metadata, SharedBuffer& payload) {
+    const char* frame = data_ + readOffset_;
+    uint32_t metadataSize;
+    uint32_t payloadSize;
+    std::memcpy(&metadataSize, frame, sizeof(metadataSize));
+    std::memcpy(&payloadSize, frame + sizeof(metadataSize), sizeof(payloadSize));
+    metadata.ParseFromArray(frame + FrameHeaderSize, static_cast<int>(metadataSize));
+    payload = SharedBuffer::copy(frame + FrameHeaderSize + metadataSize, payloadSize);
+
+    readOffset_ += FrameHeaderSize + metadataSize + payloadSize;
+    if (--numFrames_ == 0) {
+        clear();
+    } else if (wrapped_ && readOffset_ == endOffset_) {
+        wrapped_ = false;
+        readOffset_ = 0;
+    }
+}
+
+void ProducerSpool::clear() noexcept {
+    readOffset_ = 0;
+    writeOffset_ = 0;
+    wrapped_ = false;
+    endOffset_ = 0;
+    numFrames_ = 0;
+}
+
+}  // namespace pulsar
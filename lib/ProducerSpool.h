@@ -0,0 +1,100 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef LIB_PRODUCERSPOOL_H_
+#define LIB_PRODUCERSPOOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "PulsarApi.pb.h"
+#include "SharedBuffer.h"
+
+namespace boost {
+namespace interprocess {
+class file_mapping;
+class mapped_region;
+}  // namespace interprocess
+}  // namespace boost
+
+namespace pulsar {
+
+/**
+ * A queue of the frames (the metadata and the payload) of the ops of a producer, stored in a memory-mapped
+ * file of a fixed size so that the ops do not hold the memory of their payloads while the producer is
+ * disconnected.
+ *
+ * The file is a ring buffer: the frames are read in the order they are appended, and a frame that does not
+ * fit before the end of the file wraps to its beginning if the frames there have been read. A frame is never
+ * split. It's not thread safe, ProducerImpl accesses it while holding its mutex.
+ */
+class ProducerSpool {
+   public:
+    /**
+     * Create, allocate and map a new file in the directory, it's removed when the spool is destroyed.
+     *
+     * @throws std::runtime_error if the file cannot be created, allocated or mapped
+     */
+    ProducerSpool(const std::string& directory, uint64_t capacity);
+
+    ~ProducerSpool();
+
+    ProducerSpool(const ProducerSpool&) = delete;
+    ProducerSpool& operator=(const ProducerSpool&) = delete;
+
+    /**
+     * Append the frame of an op.
+     *
+     * @return false if the free space of the file is not enough
+     */
+    bool push(const proto::MessageMetadata& metadata, const SharedBuffer& payload);
+
+    /**
+     * Read the first frame and remove it, the payload is copied into a new buffer. It must not be called when
+     * the spool is empty.
+     */
+    void pop(proto::MessageMetadata& metadata, SharedBuffer& payload);
+
+    // Remove all the frames
+    void clear() noexcept;
+
+    bool empty() const noexcept { return numFrames_ == 0; }
+    size_t size() const noexcept { return numFrames_; }
+    const std::string& path() const noexcept { return path_; }
+
+   private:
+    const std::string path_;
+    const uint64_t capacity_;
+    std::unique_ptr<boost::interprocess::file_mapping> mapping_;
+    std::unique_ptr<boost::interprocess::mapped_region> region_;
+    char* data_ = nullptr;
+
+    uint64_t readOffset_ = 0;
+    uint64_t writeOffset_ = 0;
+    // Whether the frames are written from the beginning of the file while the frames before endOffset_ are
+    // still to be read
+    bool wrapped_ = false;
+    uint64_t endOffset_ = 0;
+    size_t numFrames_ = 0;
+};
+
+}  // namespace pulsar
+
+#endif /* LIB_PRODUCERSPOOL_H_ */
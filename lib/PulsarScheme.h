@@ -27,6 +27,7 @@ enum PulsarScheme
 {
     PULSAR,
     PULSAR_SSL,
+    PULSAR_UNIX,
     HTTP,
     HTTPS
 };
@@ -38,6 +39,8 @@ inline PulsarScheme toScheme(const std::string& scheme) {
         return PulsarScheme::PULSAR;
     } else if (scheme == "pulsar+ssl") {
         return PulsarScheme::PULSAR_SSL;
+    } else if (scheme == "pulsar+unix") {
+        return PulsarScheme::PULSAR_UNIX;
     } else if (scheme == "http") {
         return PulsarScheme::HTTP;
     } else if (scheme == "https") {
@@ -53,6 +56,8 @@ inline const char* getSchemeString(PulsarScheme scheme) {
             return "pulsar://";
         case PulsarScheme::PULSAR_SSL:
             return "pulsar+ssl://";
+        case PulsarScheme::PULSAR_UNIX:
+            return "pulsar+unix://";
         case PulsarScheme::HTTP:
             return "http://";
         case PulsarScheme::HTTPS:
@@ -77,6 +82,20 @@ inline short getDefaultPort(PulsarScheme scheme) {
     }
 }
 
+/**
+ * Return true if the address is like "pulsar+unix:///path/to/socket", whose path is the Unix domain socket to
+ * connect with.
+ */
+inline bool isUnixSocketAddress(const std::string& address) {
+    static const std::string prefix = getSchemeString(PulsarScheme::PULSAR_UNIX);
+    return address.compare(0, prefix.size(), prefix) == 0;
+}
+
+// The caller must guarantee isUnixSocketAddress(address) is true
+inline std::string getUnixSocketPath(const std::string& address) {
+    return address.substr(std::char_traits<char>::length(getSchemeString(PulsarScheme::PULSAR_UNIX)));
+}
+
 }  // namespace scheme
 
 }  // namespace pulsar
@@ -0,0 +1,233 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "ReceiverQueue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <thread>
+
+#include "Commands.h"
+#include "MessageImpl.h"
+
+namespace pulsar {
+
+BatchEntry::BatchEntry(const Message& batchedMessage, BitSet&& deliverable, int redeliveryCount,
+                       const SchemaInfo& schema, const BatchMessageAckerPtr& acker)
+    : batchedMessage_(batchedMessage),
+      payload_(batchedMessage.impl_->payload),
+      deliverable_(std::move(deliverable)),
+      batchSize_(batchedMessage.impl_->metadata.num_messages_in_batch()),
+      redeliveryCount_(redeliveryCount),
+      schema_(schema),
+      acker_(acker),
+      length_(payload_.readableBytes()) {
+    for (int32_t i = deliverable_.nextSetBit(0); i >= 0 && i < batchSize_;
+         i = deliverable_.nextSetBit(i + 1)) {
+        size_++;
+    }
+}
+
+const Message& BatchEntry::front() {
+    if (front_) {
+        return *front_;
+    }
+    const int32_t batchIndex = deliverable_.nextSetBit(index_);
+    assert(batchIndex >= 0 && batchIndex < batchSize_);
+    for (; index_ < batchIndex; index_++) {
+        Commands::skipSingleMessageInBatch(payload_);
+    }
+
+    Message msg =
+        Commands::deSerializeSingleMessageInBatch(batchedMessage_, payload_, index_++, batchSize_, acker_);
+    msg.impl_->setRedeliveryCount(redeliveryCount_);
+    msg.impl_->setTopicName(batchedMessage_.impl_->topicName_);
+    msg.impl_->convertPayloadToKeyValue(schema_);
+    if (msg.impl_->brokerEntryMetadata.has_index()) {
+        msg.impl_->brokerEntryMetadata.set_index(msg.impl_->brokerEntryMetadata.index() - batchSize_ +
+                                                 batchIndex + 1);
+    }
+    front_ = std::move(msg);
+    return *front_;
+}
+
+Message BatchEntry::pop() {
+    front();
+    Message msg = std::move(*front_);
+    front_ = boost::none;
+    size_--;
+    return msg;
+}
+
+void ReceiverQueue::push(const Message& msg) {
+    const size_t bytes = msg.getLength();
+    pushEntry(Entry{msg, nullptr, bytes}, 1);
+}
+
+void ReceiverQueue::push(std::unique_ptr<BatchEntry>&& batch) {
+    assert(batch && !batch->empty());
+    const size_t numMessages = batch->size();
+    const size_t bytes = batch->getLength();
+    pushEntry(Entry{Message{}, std::move(batch), bytes}, numMessages);
+}
+
+void ReceiverQueue::pushEntry(Entry&& entry, size_t numMessages) {
+    numBytes_.fetch_add(entry.bytes);
+    numMessages_.fetch_add(numMessages);
+    entries_.push(std::move(entry));
+
+    // It pairs with the increment of numParkedReceivers_ before a receiver checks numMessages_, so either the
+    // receiver sees the messages or the messages are notified
+    if (numParkedReceivers_.load() > 0) {
+        Lock lock(parkMutex_);
+        lock.unlock();
+        // Each parked receiver can get a single message of a batch
+        if (numMessages > 1) {
+            parkCondition_.notify_all();
+        } else {
+            parkCondition_.notify_one();
+        }
+    }
+}
+
+bool ReceiverQueue::tryPop(Message& msg) {
+    if (empty() || closed_) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(receiverMutex_);
+    return popNoMutex(msg);
+}
+
+bool ReceiverQueue::waitAndPop(Message& msg, const Clock::time_point* deadline) {
+    if (tryPop(msg)) {
+        return true;
+    }
+
+    if (spinTime_.count() > 0) {
+        auto spinDeadline = Clock::now() + spinTime_;
+        if (deadline && *deadline < spinDeadline) {
+            spinDeadline = *deadline;
+        }
+        while (!closed_ && Clock::now() < spinDeadline) {
+            if (tryPop(msg)) {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    while (!closed_) {
+        Lock lock(parkMutex_);
+        numParkedReceivers_++;
+        auto ready = [this] { return numMessages_.load() > 0 || closed_; };
+        bool hasMessages = true;
+        if (deadline) {
+            hasMessages = parkCondition_.wait_until(lock, *deadline, ready);
+        } else {
+            parkCondition_.wait(lock, ready);
+        }
+        numParkedReceivers_--;
+        lock.unlock();
+
+        if (!hasMessages) {
+            return false;
+        }
+        if (tryPop(msg)) {
+            return true;
+        }
+        // Another receiver took the message or the entry is still being pushed
+    }
+    return false;
+}
+
+bool ReceiverQueue::popIf(Message& msg, const std::function<bool(const Message&)>& condition) {
+    if (empty() || closed_) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(receiverMutex_);
+    auto front = frontNoMutex();
+    if (!front || !condition(*front)) {
+        return false;
+    }
+    return popNoMutex(msg);
+}
+
+bool ReceiverQueue::peekAndClear(Message& msg) {
+    std::lock_guard<std::mutex> lock(receiverMutex_);
+    auto front = frontNoMutex();
+    if (!front) {
+        return false;
+    }
+    msg = *front;
+    clearNoMutex();
+    return true;
+}
+
+void ReceiverQueue::clear() {
+    std::lock_guard<std::mutex> lock(receiverMutex_);
+    clearNoMutex();
+}
+
+void ReceiverQueue::close() {
+    closed_ = true;
+    Lock lock(parkMutex_);
+    lock.unlock();
+    parkCondition_.notify_all();
+}
+
+bool ReceiverQueue::popNoMutex(Message& msg) {
+    auto entry = entries_.front();
+    if (!entry) {
+        return false;
+    }
+
+    size_t bytes;
+    if (!entry->batch) {
+        msg = std::move(entry->msg);
+        bytes = entry->bytes;
+    } else {
+        msg = entry->batch->pop();
+        // The bytes of the metadata and the skipped single messages are released with the last message
+        bytes = entry->batch->empty() ? entry->bytes : std::min<size_t>(msg.getLength(), entry->bytes);
+        entry->bytes -= bytes;
+    }
+    if (!entry->batch || entry->batch->empty()) {
+        entries_.pop();
+    }
+    numMessages_.fetch_sub(1);
+    numBytes_.fetch_sub(bytes);
+    return true;
+}
+
+const Message* ReceiverQueue::frontNoMutex() {
+    auto entry = entries_.front();
+    if (!entry) {
+        return nullptr;
+    }
+    return entry->batch ? &entry->batch->front() : &entry->msg;
+}
+
+void ReceiverQueue::clearNoMutex() {
+    Entry entry;
+    while (entries_.pop(entry)) {
+        numMessages_.fetch_sub(entry.batch ? entry.batch->size() : 1);
+        numBytes_.fetch_sub(entry.bytes);
+    }
+}
+
+}  // namespace pulsar
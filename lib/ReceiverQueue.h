@@ -0,0 +1,190 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef LIB_RECEIVERQUEUE_H_
+#define LIB_RECEIVERQUEUE_H_
+
+#include <pulsar/Message.h>
+#include <pulsar/Schema.h>
+
+#include <atomic>
+#include <boost/optional.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "BatchMessageAcker.h"
+#include "BitSet.h"
+#include "MpscQueue.h"
+#include "ObjectPool.h"
+#include "SharedBuffer.h"
+
+namespace pulsar {
+
+/**
+ * An entry of batched messages received from the broker. The single messages are only deserialized when they
+ * are taken from the entry, in order, by advancing a cursor into the uncompressed batch payload. The single
+ * messages that are not deliverable (e.g. already acknowledged) are skipped by only reading their sizes.
+ */
+class BatchEntry {
+   public:
+    /**
+     * @param batchedMessage the message of the whole entry, whose payload is the uncompressed batch payload
+     * @param deliverable the bit set of the batch indexes of the single messages to deliver
+     * @param redeliveryCount the redelivery count of the entry
+     * @param schema the schema to convert the payload of a single message to the key and the value
+     * @param acker the acker shared by the message ids of all single messages
+     */
+    BatchEntry(const Message& batchedMessage, BitSet&& deliverable, int redeliveryCount,
+               const SchemaInfo& schema, const BatchMessageAckerPtr& acker);
+
+    // The number of single messages left to deliver
+    int32_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    // The size of the uncompressed batch payload, including the metadata of all single messages
+    uint32_t getLength() const noexcept { return length_; }
+
+    /**
+     * Deserialize the next single message to deliver if it's not deserialized yet. It must not be called if
+     * the entry is empty.
+     */
+    const Message& front();
+
+    /**
+     * Take the next single message to deliver. It must not be called if the entry is empty.
+     */
+    Message pop();
+
+   private:
+    const Message batchedMessage_;
+    // The cursor into the batch payload, its reader index is the start of the single message at index_
+    SharedBuffer payload_;
+    const BitSet deliverable_;
+    const int32_t batchSize_;
+    const int redeliveryCount_;
+    const SchemaInfo schema_;
+    const BatchMessageAckerPtr acker_;
+    const uint32_t length_;
+    int32_t index_ = 0;
+    int32_t size_ = 0;
+    boost::optional<Message> front_;
+};
+
+/**
+ * The receiver queue of a consumer. Besides the single messages, it holds the batch entries as a whole, whose
+ * single messages are deserialized lazily when they are popped, so the methods behave as if each single
+ * message of a batch entry was pushed separately.
+ *
+ * The messages are pushed by the IO thread into a lock-free queue, so a push never waits for the receivers.
+ * The receivers are serialized by a mutex between themselves. When the queue is empty, a blocking pop spins
+ * for the configured time before it parks the thread, and a push only wakes up the receivers if some of them
+ * are parked.
+ */
+class ReceiverQueue {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param spinTime how long a blocking pop spins before it parks the thread if the queue is empty
+     */
+    explicit ReceiverQueue(std::chrono::microseconds spinTime = std::chrono::microseconds(0))
+        : spinTime_(spinTime) {}
+
+    void push(const Message& msg);
+
+    // The batch entry must not be empty
+    void push(std::unique_ptr<BatchEntry>&& batch);
+
+    // Wait until a message is available or the queue is closed, return false if the queue is closed
+    bool pop(Message& msg) { return waitAndPop(msg, nullptr); }
+
+    // Return false if no message is available before the timeout or the queue is closed
+    template <typename Duration>
+    bool pop(Message& msg, const Duration& timeout) {
+        if (timeout <= Duration::zero()) {
+            return tryPop(msg);
+        }
+        const auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(timeout);
+        return waitAndPop(msg, &deadline);
+    }
+
+    /**
+     * First peek the message for the condition judgment, if true then pop it.
+     *
+     * @param msg A reference to the message assigned after pop
+     * @param condition A function that returns true if the message should be popped
+     * @return true if the message was popped, false otherwise.
+     */
+    bool popIf(Message& msg, const std::function<bool(const Message&)>& condition);
+
+    // Check the 1st message and clear the queue atomically
+    bool peekAndClear(Message& msg);
+
+    void clear();
+
+    // The number of messages, a batch entry counts for its single messages left to deliver
+    size_t size() const noexcept { return numMessages_.load(); }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    // The total size of the payloads of the messages
+    size_t bytes() const noexcept { return numBytes_.load(); }
+
+    void close();
+
+   private:
+    using Lock = std::unique_lock<std::mutex>;
+
+    struct Entry {
+        Message msg;
+        std::unique_ptr<BatchEntry> batch;
+        // The bytes of the entry that are not released yet
+        size_t bytes = 0;
+    };
+
+    const std::chrono::microseconds spinTime_;
+    MpscQueue<Entry, Allocator<Entry, 1000>> entries_;
+    // They are increased before the entry is pushed so that they never underflow
+    std::atomic_size_t numMessages_{0};
+    std::atomic_size_t numBytes_{0};
+    std::atomic_bool closed_{false};
+
+    // Serialize the receivers, which are the consumers of entries_
+    std::mutex receiverMutex_;
+
+    std::mutex parkMutex_;
+    std::condition_variable parkCondition_;
+    std::atomic_int numParkedReceivers_{0};
+
+    void pushEntry(Entry&& entry, size_t numMessages);
+    bool tryPop(Message& msg);
+    bool waitAndPop(Message& msg, const Clock::time_point* deadline);
+
+    // The methods below must be called with receiverMutex_ held
+    bool popNoMutex(Message& msg);
+    const Message* frontNoMutex();
+    void clearNoMutex();
+};
+
+}  // namespace pulsar
+
+#endif /* LIB_RECEIVERQUEUE_H_ */
@@ -0,0 +1,135 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "ReceiverQueueSizeTuner.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace pulsar {
+
+// The consumption rate is smoothed over about this duration
+static constexpr double RateWindowSeconds = 0.1;
+
+ReceiverQueueSizeTuner::ReceiverQueueSizeTuner(int minSize, int maxSize, int64_t maxBytes,
+                                               std::chrono::nanoseconds maxRoundTrip,
+                                               const std::shared_ptr<Budget>& budget)
+    : minSize_(std::max(1, minSize)),
+      maxSize_(std::max(minSize_, maxSize)),
+      maxBytes_(maxBytes),
+      maxRoundTripNanos_(maxRoundTrip.count()),
+      budget_(budget),
+      size_(minSize_),
+      lastRefillTime_(Clock::now()) {
+    if (budget_) {
+        budget_->fetch_sub(minSize_);
+    }
+}
+
+ReceiverQueueSizeTuner::~ReceiverQueueSizeTuner() {
+    if (budget_) {
+        budget_->fetch_add(size_);
+    }
+}
+
+int ReceiverQueueSizeTuner::onConnected() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lastRefillTime_ = Clock::now();
+    startProbe();
+    return size_;
+}
+
+int ReceiverQueueSizeTuner::onRefill(int consumed, bool starved) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto now = Clock::now();
+    const double elapsedSeconds = std::chrono::duration<double>(now - lastRefillTime_).count();
+    lastRefillTime_ = now;
+    // Weight each sample by its duration, so that a burst of refills is not taken as a very high rate
+    consumptionRate_ += (consumed - consumptionRate_ * elapsedSeconds) / (elapsedSeconds + RateWindowSeconds);
+
+    const int size = size_;
+    int64_t target = size;
+    const int64_t roundTripNanos = roundTripNanos_;
+    if (roundTripNanos > 0 && consumptionRate_ > 0) {
+        target = static_cast<int64_t>(std::ceil(2 * consumptionRate_ * roundTripNanos / 1e9));
+    }
+    if (starved) {
+        target = std::max<int64_t>(target, 2LL * size);
+        startProbe();
+    }
+    target = std::min<int64_t>(std::max<int64_t>(target, size / 2), 2LL * size);
+    target = std::min<int64_t>(std::max<int64_t>(target, minSize_), maxSizeForBytes());
+    // The consumed permits must cover the shrinking, since the other permits are still in use
+    target = std::max<int64_t>(target, size - consumed);
+
+    int newSize = static_cast<int>(target);
+    if (newSize > size) {
+        newSize = size + acquire(newSize - size);
+    } else if (newSize < size && budget_) {
+        budget_->fetch_add(size - newSize);
+    }
+    size_ = newSize;
+    return consumed + newSize - size;
+}
+
+void ReceiverQueueSizeTuner::startProbe() noexcept {
+    probeStartNanos_ = nowNanos();
+    probing_ = true;
+}
+
+void ReceiverQueueSizeTuner::recordRoundTrip() noexcept {
+    int64_t sample = nowNanos() - probeStartNanos_;
+    if (sample > maxRoundTripNanos_) {
+        // No message was published for a while after the permits were sent
+        return;
+    }
+    const int64_t roundTripNanos = roundTripNanos_;
+    if (roundTripNanos > 0) {
+        // The message might still have been published after the permits were sent, so the estimate grows
+        // gradually. The samples are smoothed like the TCP round trip time estimation.
+        sample = std::min(sample, 2 * roundTripNanos);
+        roundTripNanos_ = (roundTripNanos * 7 + sample) / 8;
+    } else {
+        roundTripNanos_ = sample;
+    }
+}
+
+int ReceiverQueueSizeTuner::maxSizeForBytes() const noexcept {
+    const uint64_t numMessages = numReceivedMessages_.load(std::memory_order_relaxed);
+    if (maxBytes_ <= 0 || numMessages == 0) {
+        return maxSize_;
+    }
+    const uint64_t numBytes = numReceivedBytes_.load(std::memory_order_relaxed);
+    const uint64_t averageBytes = std::max<uint64_t>(1, numBytes / numMessages);
+    const auto maxSize = static_cast<uint64_t>(maxBytes_) / averageBytes;
+    return static_cast<int>(std::max<uint64_t>(minSize_, std::min<uint64_t>(maxSize, maxSize_)));
+}
+
+int ReceiverQueueSizeTuner::acquire(int permits) noexcept {
+    if (!budget_) {
+        return permits;
+    }
+    int available = budget_->load();
+    int acquired;
+    do {
+        acquired = std::min(permits, std::max(0, available));
+    } while (acquired > 0 && !budget_->compare_exchange_weak(available, available - acquired));
+    return acquired;
+}
+
+}  // namespace pulsar
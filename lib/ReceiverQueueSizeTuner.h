@@ -0,0 +1,140 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef LIB_RECEIVERQUEUESIZETUNER_H_
+#define LIB_RECEIVERQUEUESIZETUNER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace pulsar {
+
+/**
+ * Auto-scales the receiver queue size of a consumer, i.e. the window of the flow permits granted to the
+ * broker, between a min and a max size.
+ *
+ * The window targets twice the number of messages consumed during a round trip of the flow permits, so that
+ * the permits refilled when half of the window is consumed arrive before the other half runs out:
+ *
+ *   target = 2 * consumption rate * round trip time
+ *
+ * The consumption rate is measured at each refill and smoothed over time. The round trip time is measured
+ * from the permits sent while the receiver queue is empty to the arrival of the next message. Since an empty
+ * receiver queue also means that the consumer has caught up with the prefetching, the window is at least
+ * doubled at such a refill. On an idle topic, the next message arrives when it's published rather than after
+ * a round trip, so a measurement longer than the max round trip is dropped and a sample at most doubles the
+ * estimated round trip time. The window at most doubles or halves at each refill, and it's capped so that the
+ * average size of the received messages times the window does not exceed the max bytes, if set.
+ *
+ * The consumers of a partitioned topic, or of multiple topics, can share a budget so that the total of their
+ * windows does not exceed the max total receiver queue size across partitions, while a busy partition can
+ * still grow its window at the expense of the idle ones. The min size of each window is always granted.
+ */
+class ReceiverQueueSizeTuner {
+   public:
+    using Clock = std::chrono::steady_clock;
+    // The permits that are not assigned to any window
+    using Budget = std::atomic_int;
+
+    /**
+     * @param minSize the min size of the window
+     * @param maxSize the max size of the window
+     * @param maxBytes the max bytes of the messages in the window, or 0 if unlimited
+     * @param maxRoundTrip the max duration of a round trip measurement
+     * @param budget the budget shared by the windows of the consumers of a parent consumer, or nullptr
+     */
+    ReceiverQueueSizeTuner(int minSize, int maxSize, int64_t maxBytes, std::chrono::nanoseconds maxRoundTrip,
+                           const std::shared_ptr<Budget>& budget);
+
+    ~ReceiverQueueSizeTuner();
+
+    ReceiverQueueSizeTuner(const ReceiverQueueSizeTuner&) = delete;
+    ReceiverQueueSizeTuner& operator=(const ReceiverQueueSizeTuner&) = delete;
+
+    int size() const noexcept { return size_; }
+
+    // The consumed permits are refilled once half of the window is consumed
+    int refillThreshold() const noexcept { return (size_ + 1) / 2; }
+
+    /**
+     * Start a round trip measurement, called when the consumer is connected to the broker.
+     *
+     * @return the initial permits, which are the whole window
+     */
+    int onConnected();
+
+    /**
+     * Called for each entry received from the broker, which could be a batch.
+     */
+    void onMessageReceived(uint32_t numMessages, size_t numBytes) noexcept {
+        numReceivedMessages_.fetch_add(numMessages, std::memory_order_relaxed);
+        numReceivedBytes_.fetch_add(numBytes, std::memory_order_relaxed);
+        if (probing_.load(std::memory_order_relaxed) && probing_.exchange(false)) {
+            recordRoundTrip();
+        }
+    }
+
+    /**
+     * Resize the window before the consumed permits are refilled.
+     *
+     * @param consumed the number of consumed permits
+     * @param starved whether the receiver queue is empty
+     * @return the number of permits to send, which include the growth of the window or exclude its shrinking
+     */
+    int onRefill(int consumed, bool starved);
+
+    // The smoothed round trip time in nanoseconds, or 0 if not measured yet
+    int64_t roundTripNanos() const noexcept { return roundTripNanos_; }
+
+   private:
+    const int minSize_;
+    const int maxSize_;
+    const int64_t maxBytes_;
+    const int64_t maxRoundTripNanos_;
+    const std::shared_ptr<Budget> budget_;
+    std::atomic_int size_;
+
+    std::atomic<uint64_t> numReceivedMessages_{0};
+    std::atomic<uint64_t> numReceivedBytes_{0};
+    std::atomic_bool probing_{false};
+    std::atomic<int64_t> probeStartNanos_{0};
+    std::atomic<int64_t> roundTripNanos_{0};
+
+    // Guards the refills, which are concurrent when the permits are increased by different threads
+    std::mutex mutex_;
+    Clock::time_point lastRefillTime_;
+    // The smoothed consumption rate in messages per second
+    double consumptionRate_ = 0;
+
+    static int64_t nowNanos() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    void startProbe() noexcept;
+    void recordRoundTrip() noexcept;
+    int maxSizeForBytes() const noexcept;
+    int acquire(int permits) noexcept;
+};
+
+}  // namespace pulsar
+
+#endif /* LIB_RECEIVERQUEUESIZETUNER_H_ */
@@ -24,46 +24,54 @@ namespace pulsar {
 Semaphore::Semaphore(uint32_t limit) : limit_(limit), currentUsage_(0), mutex_(), condition_() {}
 
 bool Semaphore::tryAcquire(int n) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto current = currentUsage_.load();
+    do {
+        if (current + n > limit_) {
+            return false;
+        }
+    } while (!currentUsage_.compare_exchange_weak(current, current + n));
+    return true;
+}
 
-    if (currentUsage_ + n > limit_) {
-        return false;
-    } else {
-        currentUsage_ += n;
+bool Semaphore::acquire(int n) {
+    if (tryAcquire(n)) {
         return true;
     }
-}
 
-bool Semaphore::acquire(int n) {
     std::unique_lock<std::mutex> lock(mutex_);
-
-    while (currentUsage_ + n > limit_) {
+    // Register as a waiter before checking again, so that release() either makes the check succeed or
+    // notifies this thread
+    numWaiters_++;
+    const uint32_t numBulkWaiters = (n > 1) ? 1 : 0;
+    numBulkWaiters_ += numBulkWaiters;
+    bool acquired = true;
+    while (!tryAcquire(n)) {
         if (isClosed_) {
-            return false;
+            acquired = false;
+            break;
         }
         condition_.wait(lock);
     }
-
-    currentUsage_ += n;
-    return true;
+    numBulkWaiters_ -= numBulkWaiters;
+    numWaiters_--;
+    return acquired;
 }
 
 void Semaphore::release(int n) {
-    std::unique_lock<std::mutex> lock(mutex_);
     currentUsage_ -= n;
-    lock.unlock();
+    if (numWaiters_ == 0) {
+        return;
+    }
 
-    if (n == 1) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (n == 1 && numBulkWaiters_ == 0) {
         condition_.notify_one();
     } else {
         condition_.notify_all();
     }
 }
 
-uint32_t Semaphore::currentUsage() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return currentUsage_;
-}
+uint32_t Semaphore::currentUsage() const { return currentUsage_; }
 
 void Semaphore::close() {
     std::unique_lock<std::mutex> lock(mutex_);
@@ -39,9 +39,15 @@ class Semaphore {
 
    private:
     const uint32_t limit_;
-    uint32_t currentUsage_;
+    // The permits are acquired and released with atomic operations, the mutex is only used to block the
+    // threads waiting for permits in acquire()
+    std::atomic<uint32_t> currentUsage_;
+    std::atomic<uint32_t> numWaiters_{0};
     mutable std::mutex mutex_;
     std::condition_variable condition_;
+    // The number of waiters that need more than one permit, notify_one() could wake up one of them while a
+    // waiter for a single permit keeps sleeping, so all the waiters are notified while it's positive
+    uint32_t numBulkWaiters_ = 0;
     bool isClosed_ = false;
 };
 
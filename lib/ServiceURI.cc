@@ -51,6 +51,28 @@ static void processAddress(std::string& address, PulsarScheme scheme) {
     }
 }
 
+// The authority component is empty and each address is the absolute path of a Unix domain socket, e.g.
+// "pulsar+unix:///var/run/pulsar/proxy.sock"
+static std::vector<std::string> parseUnixSocketPaths(const std::string& uriString, size_t pos) {
+    std::vector<std::string> addresses;
+    while (pos < uriString.size()) {
+        size_t endPos = uriString.find(',', pos);
+        if (endPos == std::string::npos) {
+            endPos = uriString.size();
+        }
+        const auto path = uriString.substr(pos, endPos - pos);
+        if (path.size() < 2 || path[0] != '/') {
+            throw std::invalid_argument("invalid unix socket path: " + path);
+        }
+        addresses.emplace_back(scheme::getSchemeString(PulsarScheme::PULSAR_UNIX) + path);
+        pos = endPos + 1;
+    }
+    if (addresses.empty()) {
+        throw std::invalid_argument("No service url is provided yet");
+    }
+    return addresses;
+}
+
 auto ServiceURI::parse(const std::string& uriString) -> DataType {
     size_t pos = uriString.find("://");
     if (pos == std::string::npos) {
@@ -62,6 +84,9 @@ auto ServiceURI::parse(const std::string& uriString) -> DataType {
     const auto scheme = scheme::toScheme(uriString.substr(0, pos));
 
     pos += 3;  // now it points to the end of "://"
+    if (scheme == PulsarScheme::PULSAR_UNIX) {
+        return std::make_pair(scheme, parseUnixSocketPaths(uriString, pos));
+    }
     if (pos < uriString.size() && uriString[pos] == '/') {
         throw std::invalid_argument("authority component is missing in service uri: " + uriString);
     }
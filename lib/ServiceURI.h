@@ -41,7 +41,8 @@ class ServiceURI {
    private:
     // The 2 elements of the pair are:
     // 1. The Scheme of the lookup protocol
-    // 2. The available addresses, each item is like "pulsar://localhost:6650"
+    // 2. The available addresses, each item is like "pulsar://localhost:6650" or
+    //    "pulsar+unix:///path/to/socket"
     using DataType = std::pair<PulsarScheme, std::vector<std::string>>;
     const DataType data_;
 
@@ -32,6 +32,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "AsioDefines.h"
 
@@ -91,6 +92,13 @@ class SharedBuffer {
         return buf;
     }
 
+    /**
+     * Create an empty buffer on top of the given memory, whose size is the capacity of the buffer. The memory
+     * is released by the deleter of `memory` when the last buffer referencing it is destroyed, so it can be
+     * returned to a pool.
+     */
+    static SharedBuffer reuse(std::shared_ptr<std::string> memory) { return SharedBuffer(std::move(memory)); }
+
     /**
      * Create a buffer that wraps the passed pointer, without copying the memory
      */
@@ -147,6 +155,8 @@ class SharedBuffer {
 
     inline uint32_t writableBytes() const { return capacity_ - writeIdx_; }
 
+    inline uint32_t capacity() const { return capacity_; }
+
     inline bool readable() const { return readableBytes() > 0; }
 
     inline bool writable() const { return writableBytes() > 0; }
@@ -229,6 +239,13 @@ class SharedBuffer {
           writeIdx_(0),
           capacity_(size) {}
 
+    explicit SharedBuffer(std::shared_ptr<std::string>&& memory)
+        : data_(std::move(memory)),
+          ptr_(data_->empty() ? nullptr : &(*data_)[0]),
+          readIdx_(0),
+          writeIdx_(0),
+          capacity_(data_->size()) {}
+
     explicit SharedBuffer(std::string&& data)
         : data_(std::make_shared<std::string>(std::move(data))),
           ptr_(data_->empty() ? nullptr : &(*data_)[0]),
@@ -254,12 +271,80 @@ class CompositeSharedBuffer {
 
     const ASIO::const_buffer* end() const { return begin() + Size; }
 
+    const std::array<SharedBuffer, Size>& sharedBuffers() const noexcept { return sharedBuffers_; }
+
    private:
     std::array<SharedBuffer, Size> sharedBuffers_;
     std::array<ASIO::const_buffer, Size> asioBuffers_;
 };
 
 typedef CompositeSharedBuffer<2> PairSharedBuffer;
+
+/**
+ * A growable scatter/gather list of SharedBuffer, used to write multiple frames with a single socket write.
+ *
+ * The list keeps the buffers alive, while view() returns a cheap ConstBufferSequence that can be passed to
+ * asio without copying the underlying vectors. The view is only valid until the list is modified.
+ */
+class SharedBufferList {
+   public:
+    class View {
+       public:
+        // Implement the ConstBufferSequence requirements.
+        typedef ASIO::const_buffer value_type;
+        typedef const ASIO::const_buffer* iterator;
+        typedef const ASIO::const_buffer* const_iterator;
+
+        View(const ASIO::const_buffer* begin, const ASIO::const_buffer* end) : begin_(begin), end_(end) {}
+
+        const ASIO::const_buffer* begin() const { return begin_; }
+        const ASIO::const_buffer* end() const { return end_; }
+
+       private:
+        const ASIO::const_buffer* begin_;
+        const ASIO::const_buffer* end_;
+    };
+
+    void reserve(size_t capacity) {
+        sharedBuffers_.reserve(capacity);
+        asioBuffers_.reserve(capacity);
+    }
+
+    void add(const SharedBuffer& buffer) {
+        sharedBuffers_.emplace_back(buffer);
+        asioBuffers_.emplace_back(buffer.data(), buffer.readableBytes());
+        bytes_ += buffer.readableBytes();
+    }
+
+    template <int Size>
+    void add(const CompositeSharedBuffer<Size>& buffers) {
+        for (const auto& buffer : buffers.sharedBuffers()) {
+            add(buffer);
+        }
+    }
+
+    void clear() noexcept {
+        sharedBuffers_.clear();
+        asioBuffers_.clear();
+        bytes_ = 0;
+    }
+
+    size_t size() const noexcept { return asioBuffers_.size(); }
+
+    bool empty() const noexcept { return asioBuffers_.empty(); }
+
+    size_t bytes() const noexcept { return bytes_; }
+
+    View view() const noexcept {
+        const auto* begin = asioBuffers_.data();
+        return View{begin, begin + asioBuffers_.size()};
+    }
+
+   private:
+    std::vector<SharedBuffer> sharedBuffers_;
+    std::vector<ASIO::const_buffer> asioBuffers_;
+    size_t bytes_ = 0;
+};
 }  // namespace pulsar
 
 #endif /* LIB_SHARED_BUFFER_H_ */
@@ -0,0 +1,97 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "SharedBufferPool.h"
+
+#include <algorithm>
+
+#include "ObjectPool.h"
+
+namespace pulsar {
+
+// The control blocks of the acquired buffers are pooled as well, up to this number
+static constexpr int MaxIdleControlBlocks = 1000;
+
+SharedBufferPool::SharedBufferPool(uint32_t minBufferSize, uint32_t maxBufferSize,
+                                   size_t maxIdleBytesPerClass) {
+    for (uint64_t size = minBufferSize; size <= maxBufferSize; size *= 2) {
+        sizeClasses_.emplace_back(static_cast<uint32_t>(size),
+                                  std::max<size_t>(1, maxIdleBytesPerClass / static_cast<size_t>(size)));
+    }
+}
+
+SharedBuffer SharedBufferPool::acquire(uint32_t minCapacity) {
+    auto it = std::find_if(sizeClasses_.begin(), sizeClasses_.end(),
+                           [minCapacity](const SizeClass& sizeClass) {
+                               return sizeClass.bufferSize >= minCapacity;
+                           });
+    if (it == sizeClasses_.end()) {
+        oversized_++;
+        return SharedBuffer::allocate(minCapacity);
+    }
+    const size_t sizeClassIndex = it - sizeClasses_.begin();
+
+    std::unique_ptr<std::string> memory;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& idleBuffers = it->idleBuffers;
+        if (!idleBuffers.empty()) {
+            memory = std::move(idleBuffers.back());
+            idleBuffers.pop_back();
+        }
+    }
+    if (memory) {
+        hits_++;
+    } else {
+        misses_++;
+        memory.reset(new std::string(it->bufferSize, '\0'));
+    }
+
+    // The pool might be destroyed before the last slice of the buffer is released
+    std::weak_ptr<SharedBufferPool> weakSelf{shared_from_this()};
+    auto deleter = [weakSelf, sizeClassIndex](std::string* memory) {
+        auto self = weakSelf.lock();
+        if (self) {
+            self->release(sizeClassIndex, memory);
+        } else {
+            delete memory;
+        }
+    };
+    return SharedBuffer::reuse(std::shared_ptr<std::string>(memory.release(), deleter,
+                                                            Allocator<std::string, MaxIdleControlBlocks>()));
+}
+
+void SharedBufferPool::release(size_t sizeClassIndex, std::string* memory) {
+    std::unique_ptr<std::string> holder{memory};
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& sizeClass = sizeClasses_[sizeClassIndex];
+    if (sizeClass.idleBuffers.size() < sizeClass.maxIdleBuffers) {
+        sizeClass.idleBuffers.emplace_back(std::move(holder));
+    }
+}
+
+size_t SharedBufferPool::numIdleBuffers() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t numIdleBuffers = 0;
+    for (const auto& sizeClass : sizeClasses_) {
+        numIdleBuffers += sizeClass.idleBuffers.size();
+    }
+    return numIdleBuffers;
+}
+
+}  // namespace pulsar
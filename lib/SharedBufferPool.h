@@ -0,0 +1,141 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef LIB_SHAREDBUFFERPOOL_H_
+#define LIB_SHAREDBUFFERPOOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "SharedBuffer.h"
+
+namespace pulsar {
+
+class SharedBufferPool;
+using SharedBufferPoolPtr = std::shared_ptr<SharedBufferPool>;
+
+/**
+ * A pool of buffers whose sizes are powers of two between a minimum and a maximum size (the size classes).
+ *
+ * The buffers returned by acquire() can be sliced and the slices can be passed to other threads. The memory
+ * goes back to the pool only when the last slice is released. For each size class, at most
+ * `maxIdleBytesPerClass` bytes (but at least one buffer) are kept in the pool, the other buffers are freed.
+ */
+class SharedBufferPool : public std::enable_shared_from_this<SharedBufferPool> {
+   public:
+    struct Stats {
+        // A pooled buffer was reused
+        uint64_t hits;
+        // A buffer of a size class was allocated because there was no idle buffer
+        uint64_t misses;
+        // A buffer larger than the maximum size class was allocated
+        uint64_t oversized;
+    };
+
+    static SharedBufferPoolPtr create(uint32_t minBufferSize, uint32_t maxBufferSize,
+                                      size_t maxIdleBytesPerClass) {
+        return SharedBufferPoolPtr(new SharedBufferPool(minBufferSize, maxBufferSize, maxIdleBytesPerClass));
+    }
+
+    /**
+     * Get an empty buffer whose capacity is the smallest size class that is at least `minCapacity`. If
+     * `minCapacity` is greater than the maximum size class, a new buffer of exactly `minCapacity` bytes is
+     * allocated and it won't be returned to the pool.
+     */
+    SharedBuffer acquire(uint32_t minCapacity = 0);
+
+    /**
+     * Same as SharedBuffer::copyFrom, but the new buffer is acquired from the pool.
+     */
+    SharedBuffer copyFrom(const SharedBuffer& other, uint32_t capacity) {
+        assert(other.readableBytes() <= capacity);
+        auto buffer = acquire(capacity);
+        buffer.write(other.data(), other.readableBytes());
+        return buffer;
+    }
+
+    size_t numIdleBuffers() const;
+
+    Stats getStats() const noexcept { return Stats{hits_.load(), misses_.load(), oversized_.load()}; }
+
+   private:
+    struct SizeClass {
+        const uint32_t bufferSize;
+        const size_t maxIdleBuffers;
+        std::vector<std::unique_ptr<std::string>> idleBuffers;
+
+        SizeClass(uint32_t bufferSize, size_t maxIdleBuffers)
+            : bufferSize(bufferSize), maxIdleBuffers(maxIdleBuffers) {}
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<SizeClass> sizeClasses_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> oversized_{0};
+
+    SharedBufferPool(uint32_t minBufferSize, uint32_t maxBufferSize, size_t maxIdleBytesPerClass);
+
+    void release(size_t sizeClassIndex, std::string* memory);
+};
+
+/**
+ * Compute the size of the next read buffer from the number of bytes returned by the previous reads.
+ *
+ * The size is doubled as soon as a read fills the whole buffer, and halved after two consecutive reads
+ * that would have fit in a buffer of half the size.
+ */
+class AdaptiveReadSize {
+   public:
+    AdaptiveReadSize(uint32_t minSize, uint32_t maxSize)
+        : minSize_(minSize), maxSize_(maxSize), size_(minSize) {}
+
+    uint32_t next() const noexcept { return size_; }
+
+    void record(uint32_t bytesRead, uint32_t bufferSize) noexcept {
+        if (bytesRead >= bufferSize) {
+            if (size_ < maxSize_) {
+                size_ = std::min(size_ * 2, maxSize_);
+            }
+            decreaseNow_ = false;
+        } else if (bytesRead <= size_ / 2 && size_ > minSize_) {
+            if (decreaseNow_) {
+                size_ = std::max(size_ / 2, minSize_);
+                decreaseNow_ = false;
+            } else {
+                decreaseNow_ = true;
+            }
+        } else {
+            decreaseNow_ = false;
+        }
+    }
+
+   private:
+    const uint32_t minSize_;
+    const uint32_t maxSize_;
+    uint32_t size_;
+    bool decreaseNow_ = false;
+};
+
+}  // namespace pulsar
+
+#endif /* LIB_SHAREDBUFFERPOOL_H_ */
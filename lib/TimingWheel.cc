@@ -0,0 +1,226 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "TimingWheel.h"
+
+#include <algorithm>
+
+namespace pulsar {
+
+static int countTrailingZeros(uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+TimingWheel::TimingWheel(ASIO::io_service& ioService, std::chrono::nanoseconds tickDuration)
+    : start_(Clock::now()), tickDuration_(tickDuration), timer_(ioService) {}
+
+size_t TimingWheel::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+}
+
+void TimingWheel::schedule(WheelTimer& timer, Clock::time_point deadline) {
+    if (timer.level_ >= 0) {
+        unlink(timer);
+    }
+    // A deadline that has expired is handled in the next tick
+    timer.deadlineTick_ = std::max(tickOf(deadline, true), currentTick_ + 1);
+    link(timer);
+    wakeUpIfNeeded();
+}
+
+bool TimingWheel::cancel(WheelTimer& timer) noexcept {
+    timer.callback_ = nullptr;
+    if (timer.level_ < 0) {
+        return false;
+    }
+    unlink(timer);
+    return true;
+}
+
+void TimingWheel::link(WheelTimer& timer) noexcept {
+    // The timer is put in the level of the highest 6-bit group that differs from the current tick, so the
+    // slot is always after the current position of the level
+    const uint64_t diff = timer.deadlineTick_ ^ currentTick_;
+    int level = 0;
+    while (level + 1 < NumLevels && (diff >> (SlotBits * (level + 1))) != 0) {
+        level++;
+    }
+    const int slot = static_cast<int>((timer.deadlineTick_ >> (SlotBits * level)) & (NumSlots - 1));
+
+    auto& head = levels_[level].slots[slot];
+    timer.level_ = level;
+    timer.slot_ = slot;
+    timer.prev_ = nullptr;
+    timer.next_ = head;
+    if (head) {
+        head->prev_ = &timer;
+    }
+    head = &timer;
+    levels_[level].occupied |= (1ULL << slot);
+    size_++;
+}
+
+void TimingWheel::unlink(WheelTimer& timer) noexcept {
+    auto& level = levels_[timer.level_];
+    if (timer.prev_) {
+        timer.prev_->next_ = timer.next_;
+    } else {
+        level.slots[timer.slot_] = timer.next_;
+        if (!timer.next_) {
+            level.occupied &= ~(1ULL << timer.slot_);
+        }
+    }
+    if (timer.next_) {
+        timer.next_->prev_ = timer.prev_;
+    }
+    timer.prev_ = nullptr;
+    timer.next_ = nullptr;
+    timer.level_ = -1;
+    size_--;
+}
+
+void TimingWheel::expire(WheelTimer& timer) {
+    if (timer.callback_) {
+        expiredCallbacks_.emplace_back(std::move(timer.callback_));
+    }
+}
+
+void TimingWheel::advance(uint64_t tick) {
+    uint64_t eventTick;
+    while (nextEventTick(eventTick) && eventTick <= tick) {
+        currentTick_ = eventTick;
+        processTick(eventTick);
+    }
+    currentTick_ = std::max(currentTick_, tick);
+}
+
+void TimingWheel::processTick(uint64_t tick) {
+    // Move the timers of the slots that begin at this tick to the lower levels
+    for (int level = NumLevels - 1; level > 0; level--) {
+        const int shift = SlotBits * level;
+        if ((tick & ((1ULL << shift) - 1)) != 0) {
+            continue;
+        }
+        const int slot = static_cast<int>((tick >> shift) & (NumSlots - 1));
+        auto timer = levels_[level].slots[slot];
+        while (timer) {
+            auto next = timer->next_;
+            unlink(*timer);
+            if (timer->deadlineTick_ <= tick) {
+                expire(*timer);
+            } else {
+                link(*timer);
+            }
+            timer = next;
+        }
+    }
+
+    // All the timers in the current slot of the lowest level expire at this tick
+    auto timer = levels_[0].slots[tick & (NumSlots - 1)];
+    while (timer) {
+        auto next = timer->next_;
+        unlink(*timer);
+        expire(*timer);
+        timer = next;
+    }
+}
+
+bool TimingWheel::nextEventTick(uint64_t& tick) const noexcept {
+    // The events of a lower level are always earlier than the events of the higher levels
+    for (int level = 0; level < NumLevels; level++) {
+        const int shift = SlotBits * level;
+        const int current = static_cast<int>((currentTick_ >> shift) & (NumSlots - 1));
+        const uint64_t later = levels_[level].occupied & ~((2ULL << current) - 1);
+        if (later != 0) {
+            const int upperShift = shift + SlotBits;
+            const uint64_t upper = (upperShift >= 64) ? 0 : ((currentTick_ >> upperShift) << upperShift);
+            tick = upper | (static_cast<uint64_t>(countTrailingZeros(later)) << shift);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TimingWheel::wakeUpIfNeeded() {
+    uint64_t tick;
+    if (!nextEventTick(tick) || (waiting_ && wakeUpTick_ <= tick)) {
+        return;
+    }
+    // Restarting the timer aborts the previous wait
+    waiting_ = true;
+    wakeUpTick_ = tick;
+    timer_.expires_at(start_ + std::chrono::duration_cast<Clock::duration>(tickDuration_ * tick));
+    timer_.async_wait([this](const ASIO_ERROR& ec) { handleTimeout(ec); });
+}
+
+uint64_t TimingWheel::tickOf(Clock::time_point timePoint, bool roundUp) const noexcept {
+    if (timePoint <= start_) {
+        return 0;
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(timePoint - start_).count();
+    const auto tickNanos = tickDuration_.count();
+    return static_cast<uint64_t>(roundUp ? (elapsed + tickNanos - 1) / tickNanos : elapsed / tickNanos);
+}
+
+void TimingWheel::handleTimeout(const ASIO_ERROR& ec) {
+    if (ec) {
+        // The timer has been restarted for an earlier tick
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        waiting_ = false;
+        advance(tickOf(Clock::now(), false));
+        wakeUpIfNeeded();
+    }
+    for (auto& callback : expiredCallbacks_) {
+        callback();
+    }
+    expiredCallbacks_.clear();
+}
+
+WheelTimer::WheelTimer(ExecutorServicePtr executor)
+    : executor_(std::move(executor)), wheel_(executor_->getTimingWheel()) {}
+
+void WheelTimer::expiresAt(Clock::time_point deadline, Callback callback) {
+    std::lock_guard<std::mutex> lock(wheel_.mutex_);
+    callback_ = std::move(callback);
+    wheel_.schedule(*this, deadline);
+}
+
+bool WheelTimer::cancel() noexcept {
+    std::lock_guard<std::mutex> lock(wheel_.mutex_);
+    return wheel_.cancel(*this);
+}
+
+bool WheelTimer::isWaiting() const {
+    std::lock_guard<std::mutex> lock(wheel_.mutex_);
+    return level_ >= 0;
+}
+
+}  // namespace pulsar
@@ -0,0 +1,160 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef LIB_TIMINGWHEEL_H_
+#define LIB_TIMINGWHEEL_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "AsioTimer.h"
+#include "ExecutorService.h"
+#include "InlineFunction.h"
+
+namespace pulsar {
+
+class WheelTimer;
+
+/**
+ * A hierarchical timing wheel that tracks the deadlines of all the WheelTimers of an executor with a single
+ * asio timer, so that the cost of the timers does not depend on how many producers and consumers share the
+ * executor.
+ *
+ * The time is divided into ticks. Each of the levels has 64 slots, a slot of level N covers 64^N ticks. A
+ * deadline is put in the level of the highest 6-bit group in which its tick differs from the current tick, so
+ * registering and cancelling a deadline are O(1) and do not allocate. When the current tick reaches the
+ * beginning of a slot of a higher level, the deadlines of that slot are moved to the lower levels. The asio
+ * timer only waits for the next tick that has something to do, empty ticks are skipped.
+ *
+ * The callbacks are called in the thread of the executor.
+ */
+class TimingWheel {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    TimingWheel(ASIO::io_service& ioService, std::chrono::nanoseconds tickDuration);
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    // The number of the timers that are waiting for their deadlines
+    size_t size() const;
+
+   private:
+    static constexpr int SlotBits = 6;
+    static constexpr int NumSlots = 1 << SlotBits;
+    static constexpr int NumLevels = (64 + SlotBits - 1) / SlotBits;
+
+    struct Level {
+        // The heads of the doubly linked lists of the timers in each slot
+        std::array<WheelTimer*, NumSlots> slots{};
+        // The bit i is set if slots[i] is not empty
+        uint64_t occupied = 0;
+    };
+
+    const Clock::time_point start_;
+    const std::chrono::nanoseconds tickDuration_;
+
+    mutable std::mutex mutex_;
+    std::array<Level, NumLevels> levels_;
+    uint64_t currentTick_ = 0;
+    size_t size_ = 0;
+    ASIO::steady_timer timer_;
+    bool waiting_ = false;
+    uint64_t wakeUpTick_ = 0;
+
+    // The callbacks of the expired timers, which are called after the mutex is released. It's only accessed
+    // by the executor thread, the capacity is reused.
+    std::vector<InlineFunction<void(), 32>> expiredCallbacks_;
+
+    // The methods below must be called while mutex_ is acquired
+    void schedule(WheelTimer& timer, Clock::time_point deadline);
+    bool cancel(WheelTimer& timer) noexcept;
+    void link(WheelTimer& timer) noexcept;
+    void unlink(WheelTimer& timer) noexcept;
+    void expire(WheelTimer& timer);
+    void advance(uint64_t tick);
+    void processTick(uint64_t tick);
+    // Return false if there is no timer
+    bool nextEventTick(uint64_t& tick) const noexcept;
+    void wakeUpIfNeeded();
+
+    uint64_t tickOf(Clock::time_point timePoint, bool roundUp) const noexcept;
+    void handleTimeout(const ASIO_ERROR& ec);
+
+    friend class WheelTimer;
+};
+
+/**
+ * A one-shot timer of the timing wheel of an executor. It can be restarted and cancelled many times, each
+ * time in O(1) and without any allocation, unlike an asio timer whose waits are operations of the io_service.
+ *
+ * Unlike asio, the callback of a cancelled or restarted wait is discarded instead of being called with an
+ * error. The callback might still be called if the deadline has expired while the timer is cancelled, so it
+ * should check whether there is something to do. The callback must not block the executor.
+ */
+class WheelTimer {
+   public:
+    using Clock = TimingWheel::Clock;
+    using Callback = InlineFunction<void(), 32>;
+
+    explicit WheelTimer(ExecutorServicePtr executor);
+    ~WheelTimer() { cancel(); }
+
+    WheelTimer(const WheelTimer&) = delete;
+    WheelTimer& operator=(const WheelTimer&) = delete;
+
+    void expiresAt(Clock::time_point deadline, Callback callback);
+
+    template <typename Duration>
+    void expiresAfter(Duration delay, Callback callback) {
+        expiresAt(Clock::now() + std::chrono::duration_cast<Clock::duration>(delay), std::move(callback));
+    }
+
+    /**
+     * Cancel the current wait.
+     *
+     * @return true if the timer was waiting, false if there was no wait or its callback has been scheduled
+     */
+    bool cancel() noexcept;
+
+    bool isWaiting() const;
+
+   private:
+    // It keeps the timing wheel alive
+    const ExecutorServicePtr executor_;
+    TimingWheel& wheel_;
+
+    // The fields below are protected by the mutex of the wheel
+    Callback callback_;
+    WheelTimer* prev_ = nullptr;
+    WheelTimer* next_ = nullptr;
+    uint64_t deadlineTick_ = 0;
+    int level_ = -1;  // -1 if it's not in the wheel
+    int slot_ = 0;
+
+    friend class TimingWheel;
+};
+
+}  // namespace pulsar
+
+#endif /* LIB_TIMINGWHEEL_H_ */
@@ -0,0 +1,114 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <pulsar/ZstdDictionary.h>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "CompressionCodecZstd.h"
+#include "ZstdDictionaryImpl.h"
+
+#if HAS_ZSTD
+#include <zdict.h>
+#endif
+
+namespace pulsar {
+
+ZstdDictionary::ZstdDictionary(std::shared_ptr<ZstdDictionaryImpl> impl) : impl_(std::move(impl)) {}
+
+uint32_t ZstdDictionary::getId() const noexcept { return impl_->id; }
+
+const std::string& ZstdDictionary::getContent() const noexcept { return impl_->content; }
+
+ZstdDictionaryPtr ZstdDictionary::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::invalid_argument("Failed to open the ZSTD dictionary file " + path);
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    return create(content.str());
+}
+
+#if HAS_ZSTD
+
+ZstdDictionaryImpl::ZstdDictionaryImpl(const std::string& content, uint32_t id)
+    : content(content),
+      id(id),
+      cdict(ZSTD_createCDict(this->content.data(), this->content.size(),
+                             CompressionCodecZstd::CompressionLevel)),
+      ddict(ZSTD_createDDict(this->content.data(), this->content.size())) {
+    if (!cdict || !ddict) {
+        ZSTD_freeCDict(cdict);
+        ZSTD_freeDDict(ddict);
+        throw std::invalid_argument("Failed to load the ZSTD dictionary " + std::to_string(id));
+    }
+}
+
+ZstdDictionaryImpl::~ZstdDictionaryImpl() {
+    ZSTD_freeCDict(cdict);
+    ZSTD_freeDDict(ddict);
+}
+
+ZstdDictionaryPtr ZstdDictionary::create(const std::string& content) {
+    const auto id = ZDICT_getDictID(content.data(), content.size());
+    if (id == 0) {
+        throw std::invalid_argument("The content is not a ZSTD dictionary");
+    }
+    return ZstdDictionaryPtr(new ZstdDictionary(std::make_shared<ZstdDictionaryImpl>(content, id)));
+}
+
+ZstdDictionaryPtr ZstdDictionary::train(const std::vector<std::string>& samples, size_t maxSize) {
+    std::string samplesBuffer;
+    std::vector<size_t> sampleSizes;
+    sampleSizes.reserve(samples.size());
+    for (const auto& sample : samples) {
+        samplesBuffer.append(sample);
+        sampleSizes.emplace_back(sample.size());
+    }
+
+    std::string content(maxSize, '\0');
+    const size_t size = ZDICT_trainFromBuffer(&content[0], content.size(), samplesBuffer.data(),
+                                              sampleSizes.data(), static_cast<unsigned>(sampleSizes.size()));
+    if (ZDICT_isError(size)) {
+        throw std::invalid_argument(std::string("Failed to train the ZSTD dictionary: ") +
+                                    ZDICT_getErrorName(size));
+    }
+    content.resize(size);
+    return create(content);
+}
+
+#else  // No ZSTD
+
+ZstdDictionaryImpl::ZstdDictionaryImpl(const std::string& content, uint32_t id) : content(content), id(id) {}
+
+ZstdDictionaryImpl::~ZstdDictionaryImpl() {}
+
+ZstdDictionaryPtr ZstdDictionary::create(const std::string& content) {
+    throw std::runtime_error("ZStd compression not supported");
+}
+
+ZstdDictionaryPtr ZstdDictionary::train(const std::vector<std::string>& samples, size_t maxSize) {
+    throw std::runtime_error("ZStd compression not supported");
+}
+
+#endif  // HAS_ZSTD
+
+}  // namespace pulsar
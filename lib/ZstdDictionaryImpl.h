@@ -0,0 +1,46 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#pragma once
+
+#if HAS_ZSTD
+#include <zstd.h>
+#endif
+
+#include <cstdint>
+#include <string>
+
+namespace pulsar {
+
+struct ZstdDictionaryImpl {
+    const std::string content;
+    const uint32_t id;
+#if HAS_ZSTD
+    // The digested dictionaries are read-only, so they are shared by the contexts of all threads
+    ZSTD_CDict* const cdict;
+    ZSTD_DDict* const ddict;
+#endif
+
+    ZstdDictionaryImpl(const std::string& content, uint32_t id);
+    ~ZstdDictionaryImpl();
+
+    ZstdDictionaryImpl(const ZstdDictionaryImpl&) = delete;
+    ZstdDictionaryImpl& operator=(const ZstdDictionaryImpl&) = delete;
+};
+
+}  // namespace pulsar
@@ -92,6 +92,60 @@ int pulsar_consumer_get_max_total_receiver_queue_size_across_partitions(
     return consumer_configuration->consumerConfiguration.getMaxTotalReceiverQueueSizeAcrossPartitions();
 }
 
+void pulsar_consumer_configuration_set_auto_scaled_receiver_queue_size_enabled(
+    pulsar_consumer_configuration_t *consumer_configuration, int enabled) {
+    consumer_configuration->consumerConfiguration.setAutoScaledReceiverQueueSizeEnabled(enabled);
+}
+
+int pulsar_consumer_configuration_is_auto_scaled_receiver_queue_size_enabled(
+    pulsar_consumer_configuration_t *consumer_configuration) {
+    return consumer_configuration->consumerConfiguration.isAutoScaledReceiverQueueSizeEnabled();
+}
+
+void pulsar_consumer_configuration_set_min_receiver_queue_size(
+    pulsar_consumer_configuration_t *consumer_configuration, int minReceiverQueueSize) {
+    consumer_configuration->consumerConfiguration.setMinReceiverQueueSize(minReceiverQueueSize);
+}
+
+int pulsar_consumer_configuration_get_min_receiver_queue_size(
+    pulsar_consumer_configuration_t *consumer_configuration) {
+    return consumer_configuration->consumerConfiguration.getMinReceiverQueueSize();
+}
+
+void pulsar_consumer_configuration_set_max_receiver_queue_bytes(
+    pulsar_consumer_configuration_t *consumer_configuration, long maxReceiverQueueBytes) {
+    consumer_configuration->consumerConfiguration.setMaxReceiverQueueBytes(maxReceiverQueueBytes);
+}
+
+long pulsar_consumer_configuration_get_max_receiver_queue_bytes(
+    pulsar_consumer_configuration_t *consumer_configuration) {
+    return consumer_configuration->consumerConfiguration.getMaxReceiverQueueBytes();
+}
+
+int pulsar_consumer_configuration_set_receive_spin_time_us(
+    pulsar_consumer_configuration_t *consumer_configuration, long receiveSpinTimeUs) {
+    if (receiveSpinTimeUs < 0) {
+        return -1;
+    }
+    consumer_configuration->consumerConfiguration.setReceiveSpinTimeUs(receiveSpinTimeUs);
+    return 0;
+}
+
+long pulsar_consumer_configuration_get_receive_spin_time_us(
+    pulsar_consumer_configuration_t *consumer_configuration) {
+    return consumer_configuration->consumerConfiguration.getReceiveSpinTimeUs();
+}
+
+void pulsar_consumer_configuration_set_message_listener_lanes(
+    pulsar_consumer_configuration_t *consumer_configuration, int messageListenerLanes) {
+    consumer_configuration->consumerConfiguration.setMessageListenerLanes(messageListenerLanes);
+}
+
+int pulsar_consumer_configuration_get_message_listener_lanes(
+    pulsar_consumer_configuration_t *consumer_configuration) {
+    return consumer_configuration->consumerConfiguration.getMessageListenerLanes();
+}
+
 void pulsar_consumer_set_consumer_name(pulsar_consumer_configuration_t *consumer_configuration,
                                        const char *consumerName) {
     consumer_configuration->consumerConfiguration.setConsumerName(consumerName);
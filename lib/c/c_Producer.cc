@@ -54,6 +54,34 @@ void pulsar_producer_send_async(pulsar_producer_t *producer, pulsar_message_t *m
                                                          std::placeholders::_2, callback, ctx));
 }
 
+static void handle_producer_send_batch(pulsar::Result result,
+                                       const std::vector<pulsar::MessageId> &messageIds,
+                                       pulsar_send_batch_callback callback, void *ctx) {
+    std::vector<pulsar_message_id_t *> c_message_ids(messageIds.size(), nullptr);
+    for (size_t i = 0; i < messageIds.size(); i++) {
+        if (messageIds[i] != pulsar::MessageId()) {
+            c_message_ids[i] = new pulsar_message_id_t;
+            c_message_ids[i]->messageId = messageIds[i];
+        }
+    }
+    callback((pulsar_result)result, c_message_ids.data(), static_cast<int>(c_message_ids.size()), ctx);
+}
+
+void pulsar_producer_send_batch_async(pulsar_producer_t *producer, pulsar_message_t **msgs, int numMessages,
+                                      pulsar_send_batch_callback callback, void *ctx) {
+    std::vector<pulsar::Message> messages;
+    messages.reserve(numMessages);
+    for (int i = 0; i < numMessages; i++) {
+        msgs[i]->message = msgs[i]->builder.build();
+        messages.emplace_back(msgs[i]->message);
+    }
+    producer->producer.sendAsync(
+        std::move(messages),
+        [callback, ctx](pulsar::Result result, const std::vector<pulsar::MessageId> &messageIds) {
+            handle_producer_send_batch(result, messageIds, callback, ctx);
+        });
+}
+
 int64_t pulsar_producer_get_last_sequence_id(pulsar_producer_t *producer) {
     return producer->producer.getLastSequenceId();
 }
@@ -154,6 +154,24 @@ int pulsar_producer_configuration_get_block_if_queue_full(pulsar_producer_config
     return conf->conf.getBlockIfQueueFull();
 }
 
+void pulsar_producer_configuration_set_spool_directory(pulsar_producer_configuration_t *conf,
+                                                      const char *directory) {
+    conf->conf.setSpoolDirectory(directory);
+}
+
+const char *pulsar_producer_configuration_get_spool_directory(pulsar_producer_configuration_t *conf) {
+    return conf->conf.getSpoolDirectory().c_str();
+}
+
+void pulsar_producer_configuration_set_spool_max_bytes(pulsar_producer_configuration_t *conf,
+                                                      uint64_t maxBytes) {
+    conf->conf.setSpoolMaxBytes(maxBytes);
+}
+
+uint64_t pulsar_producer_configuration_get_spool_max_bytes(pulsar_producer_configuration_t *conf) {
+    return conf->conf.getSpoolMaxBytes();
+}
+
 void pulsar_producer_configuration_set_batching_enabled(pulsar_producer_configuration_t *conf,
                                                         int batchingEnabled) {
     conf->conf.setBatchingEnabled(batchingEnabled);
@@ -192,6 +210,34 @@ unsigned long pulsar_producer_configuration_get_batching_max_publish_delay_ms(
     return conf->conf.getBatchingMaxPublishDelayMs();
 }
 
+void pulsar_producer_configuration_set_compression_level(pulsar_producer_configuration_t *conf,
+                                                        int compressionLevel) {
+    conf->conf.setCompressionLevel(compressionLevel);
+}
+
+int pulsar_producer_configuration_get_compression_level(pulsar_producer_configuration_t *conf) {
+    return conf->conf.getCompressionLevel();
+}
+
+void pulsar_producer_configuration_set_auto_compression_cpu_budget(pulsar_producer_configuration_t *conf,
+                                                                   double nanosPerByte) {
+    conf->conf.setAutoCompressionCpuBudget(nanosPerByte);
+}
+
+double pulsar_producer_configuration_get_auto_compression_cpu_budget(pulsar_producer_configuration_t *conf) {
+    return conf->conf.getAutoCompressionCpuBudget();
+}
+
+void pulsar_producer_configuration_set_batching_latency_target_ms(pulsar_producer_configuration_t *conf,
+                                                                  unsigned long batchingLatencyTargetMs) {
+    conf->conf.setBatchingLatencyTargetMs(batchingLatencyTargetMs);
+}
+
+unsigned long pulsar_producer_configuration_get_batching_latency_target_ms(
+    pulsar_producer_configuration_t *conf) {
+    return conf->conf.getBatchingLatencyTargetMs();
+}
+
 void pulsar_producer_configuration_set_property(pulsar_producer_configuration_t *conf, const char *name,
                                                 const char *value) {
     conf->conf.setProperty(name, value);
@@ -72,4 +72,52 @@ uint32_t crc32cHw(uint32_t previousChecksum, const void* data, int length) {
 uint32_t crc32cSw(uint32_t previousChecksum, const void* data, int length) {
     return crc32c_sw(previousChecksum, data, length);
 }
+
+// The reflected crc32c (Castagnoli) polynomial
+static constexpr uint32_t crc32cPolynomial = 0x82F63B78;
+
+// Multiply a and b modulo the polynomial, where the bit 31 is the coefficient of x^0
+static uint32_t multiplyModulo(uint32_t a, uint32_t b) {
+    uint32_t product = 0;
+    for (uint32_t mask = 1u << 31; mask != 0; mask >>= 1) {
+        if (a & mask) {
+            product ^= b;
+            if ((a & (mask - 1)) == 0) {
+                break;
+            }
+        }
+        b = (b & 1) ? ((b >> 1) ^ crc32cPolynomial) : (b >> 1);
+    }
+    return product;
+}
+
+/**
+ * Combines the checksums like zlib's crc32_combine(): appending n bytes to a sequence multiplies its checksum
+ * by x^(8n) modulo the polynomial, so the combined checksum is firstChecksum * x^(8n) + secondChecksum. The
+ * power is computed from the precomputed x^(2^k) in O(log(n)) multiplications.
+ */
+uint32_t combineChecksums(uint32_t firstChecksum, uint32_t secondChecksum, uint32_t secondLength) {
+    struct PowerTable {
+        // powers[k] is x^(2^k) modulo the polynomial
+        uint32_t powers[36];
+
+        PowerTable() {
+            uint32_t power = 1u << 30;  // x^1
+            for (auto& p : powers) {
+                p = power;
+                power = multiplyModulo(power, power);
+            }
+        }
+    };
+    static const PowerTable table;
+
+    uint32_t factor = 1u << 31;  // x^0
+    // Start from x^8, i.e. k = 3, since the length is in bytes
+    for (uint32_t n = secondLength, k = 3; n != 0; n >>= 1, k++) {
+        if (n & 1) {
+            factor = multiplyModulo(table.powers[k], factor);
+        }
+    }
+    return multiplyModulo(factor, firstChecksum) ^ secondChecksum;
+}
 }  // namespace pulsar
@@ -28,6 +28,13 @@ PULSAR_PUBLIC bool crc32cSupported();
 PULSAR_PUBLIC uint32_t computeChecksum(uint32_t previousChecksum, const void *data, int length);
 PULSAR_PUBLIC uint32_t crc32cHw(uint32_t previousChecksum, const void *data, int length);
 PULSAR_PUBLIC uint32_t crc32cSw(uint32_t previousChecksum, const void *data, int length);
+
+/**
+ * Compute the crc32c checksum of the concatenation of two byte sequences from the checksum of each sequence
+ * and the length of the second one, without reading the bytes again.
+ */
+PULSAR_PUBLIC uint32_t combineChecksums(uint32_t firstChecksum, uint32_t secondChecksum,
+                                        uint32_t secondLength);
 }  // namespace pulsar
 
 #endif  // _CHECKSUM_PROVIDER_H_
@@ -19,9 +19,12 @@
 
 #ifndef PULSAR_PRODUCER_STATS_BASE_HEADER
 #define PULSAR_PRODUCER_STATS_BASE_HEADER
+#include <pulsar/CompressionType.h>
 #include <pulsar/Message.h>
 #include <pulsar/Result.h>
 
+#include <vector>
+
 #include "lib/TimeUtils.h"
 
 namespace pulsar {
@@ -29,7 +32,14 @@ class ProducerStatsBase {
    public:
     virtual void start() {}
     virtual void messageSent(const Message& msg) = 0;
+    virtual void messagesSent(const std::vector<Message>& msgs) {
+        for (const auto& msg : msgs) {
+            messageSent(msg);
+        }
+    }
     virtual void messageReceived(Result, const ptime&) = 0;
+    // The automatic compression chose the compression type and level of the following batches
+    virtual void compressionChosen(CompressionType, int level) {}
     virtual ~ProducerStatsBase(){};
 };
 
@@ -25,6 +25,7 @@ namespace pulsar {
 class ProducerStatsDisabled : public ProducerStatsBase {
    public:
     virtual void messageSent(const Message& msg){};
+    virtual void messagesSent(const std::vector<Message>& msgs){};
     virtual void messageReceived(Result, const ptime&){};
 };
 }  // namespace pulsar
@@ -22,6 +22,7 @@
 #include <array>
 #include <chrono>
 
+#include "lib/CompressionCodec.h"
 #include "lib/ExecutorService.h"
 #include "lib/LogUtils.h"
 #include "lib/TimeUtils.h"
@@ -63,6 +64,8 @@ ProducerStatsImpl::ProducerStatsImpl(const ProducerStatsImpl& stats)
       totalBytesSent_(stats.totalBytesSent_),
       totalSendMap_(stats.totalSendMap_),
       totalLatencyAccumulator_(stats.totalLatencyAccumulator_),
+      compressionType_(stats.compressionType_),
+      compressionLevel_(stats.compressionLevel_),
       statsIntervalInSeconds_(stats.statsIntervalInSeconds_) {}
 
 void ProducerStatsImpl::start() { scheduleTimer(); }
@@ -95,6 +98,18 @@ void ProducerStatsImpl::messageSent(const Message& msg) {
     totalBytesSent_ += msg.getLength();
 }
 
+void ProducerStatsImpl::messagesSent(const std::vector<Message>& msgs) {
+    unsigned long numBytes = 0;
+    for (const auto& msg : msgs) {
+        numBytes += msg.getLength();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    numMsgsSent_ += msgs.size();
+    totalMsgsSent_ += msgs.size();
+    numBytesSent_ += numBytes;
+    totalBytesSent_ += numBytes;
+}
+
 void ProducerStatsImpl::messageReceived(Result res, const ptime& publishTime) {
     auto currentTime = TimeUtils::now();
     double diffInMicros =
@@ -106,6 +121,12 @@ void ProducerStatsImpl::messageReceived(Result res, const ptime& publishTime) {
     totalSendMap_[res] += 1;  // Value will automatically be initialized to 0 in the constructor
 }
 
+void ProducerStatsImpl::compressionChosen(CompressionType compressionType, int level) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    compressionType_ = compressionType;
+    compressionLevel_ = level;
+}
+
 ProducerStatsImpl::~ProducerStatsImpl() { timer_->cancel(); }
 
 void ProducerStatsImpl::scheduleTimer() {
@@ -129,7 +150,8 @@ std::ostream& operator<<(std::ostream& os, const ProducerStatsImpl& obj) {
        << ", totalAcksReceived_ = "
        << ", totalSendMap_ = " << obj.totalSendMap_
        << ", totalLatencyAccumulator_ = " << ProducerStatsImpl::latencyToString(obj.totalLatencyAccumulator_)
-       << ")";
+       << ", compressionType_ = " << CompressionCodecProvider::getName(obj.compressionType_)
+       << ", compressionLevel_ = " << obj.compressionLevel_ << ")";
     return os;
 }
 }  // namespace pulsar
@@ -62,6 +62,10 @@ class ProducerStatsImpl : public std::enable_shared_from_this<ProducerStatsImpl>
     std::map<Result, unsigned long> totalSendMap_;
     LatencyAccumulator totalLatencyAccumulator_;
 
+    // The compression chosen by the automatic compression, if it's enabled
+    CompressionType compressionType_ = CompressionNone;
+    int compressionLevel_ = 0;
+
     const DeadlineTimerPtr timer_;
     std::mutex mutex_;
     unsigned int statsIntervalInSeconds_;
@@ -85,8 +89,12 @@ class ProducerStatsImpl : public std::enable_shared_from_this<ProducerStatsImpl>
 
     void messageSent(const Message&) override;
 
+    void messagesSent(const std::vector<Message>&) override;
+
     void messageReceived(Result, const ptime&) override;
 
+    void compressionChosen(CompressionType compressionType, int level) override;
+
     ~ProducerStatsImpl();
 
     inline unsigned long getNumMsgsSent() { return numMsgsSent_; }
@@ -104,6 +112,16 @@ class ProducerStatsImpl : public std::enable_shared_from_this<ProducerStatsImpl>
     inline LatencyAccumulator getLatencyAccumulator() { return latencyAccumulator_; }
 
     inline LatencyAccumulator getTotalLatencyAccumulator() { return totalLatencyAccumulator_; }
+
+    inline CompressionType getCompressionType() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return compressionType_;
+    }
+
+    inline int getCompressionLevel() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return compressionLevel_;
+    }
 };
 typedef std::shared_ptr<ProducerStatsImpl> ProducerStatsImplPtr;
 }  // namespace pulsar
@@ -0,0 +1,71 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+// Measure the encoding of a batch into a SEND frame, with and without the pooled payload buffer and the
+// checksum computed while the payload is written
+#include <benchmark/benchmark.h>
+#include <lib/Commands.h>
+#include <lib/OpSendMsg.h>
+#include <lib/PulsarApi.pb.h>
+#include <lib/SharedBufferPool.h>
+#include <pulsar/MessageBuilder.h>
+
+#include <string>
+#include <vector>
+
+using namespace pulsar;
+
+static std::vector<Message> createMessages(int numMessages, size_t messageSize) {
+    std::vector<Message> messages;
+    for (int i = 0; i < numMessages; i++) {
+        messages.emplace_back(MessageBuilder().setContent(std::string(messageSize, 'a' + i % 26)).build());
+    }
+    return messages;
+}
+
+static void encodeBatch(benchmark::State& state, SharedBufferPool* pool, bool precomputeChecksum) {
+    const auto messages = createMessages(state.range(0), state.range(1));
+    auto headers = SharedBuffer::allocate(64 * 1024);
+    proto::MessageMetadata metadata;
+    metadata.set_producer_name("producer");
+    metadata.set_publish_time(1);
+    metadata.set_num_messages_in_batch(messages.size());
+    for (auto _ : state) {
+        SharedBuffer payload;
+        uint32_t checksum;
+        const auto sequenceId = Commands::serializeSingleMessagesToBatchPayload(
+            payload, messages, pool, precomputeChecksum ? &checksum : nullptr);
+        metadata.set_sequence_id(sequenceId);
+        SendArguments args(0, sequenceId, metadata, payload,
+                           precomputeChecksum ? boost::make_optional(checksum) : boost::none);
+        headers.reset();
+        benchmark::DoNotOptimize(Commands::newSend(headers, Commands::Crc32c, args));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+
+static void BM_EncodeBatch(benchmark::State& state) { encodeBatch(state, nullptr, false); }
+BENCHMARK(BM_EncodeBatch)->Args({100, 100})->Args({100, 1000})->Args({1000, 100});
+
+static void BM_EncodeBatchPooled(benchmark::State& state) {
+    auto pool = SharedBufferPool::create(4 * 1024, 1024 * 1024, 1024 * 1024);
+    encodeBatch(state, pool.get(), true);
+}
+BENCHMARK(BM_EncodeBatchPooled)->Args({100, 100})->Args({100, 1000})->Args({1000, 100});
+
+BENCHMARK_MAIN();
@@ -22,3 +22,28 @@ target_link_libraries(perfProducer pulsarShared Boost::program_options)
 
 add_executable(perfConsumer PerfConsumer.cc)
 target_link_libraries(perfConsumer pulsarShared Boost::program_options)
+
+find_package(benchmark QUIET)
+if (benchmark_FOUND)
+    add_executable(commandCodecBenchmark CommandCodecBenchmark.cc)
+    target_include_directories(commandCodecBenchmark PRIVATE ${AUTOGEN_DIR}/lib)
+    target_link_libraries(commandCodecBenchmark pulsarStatic benchmark::benchmark)
+
+    add_executable(connectionBenchmark ConnectionBenchmark.cc)
+    target_include_directories(connectionBenchmark PRIVATE ${AUTOGEN_DIR}/lib)
+    target_link_libraries(connectionBenchmark pulsarStatic benchmark::benchmark)
+
+    add_executable(producerBenchmark ProducerBenchmark.cc)
+    target_include_directories(producerBenchmark PRIVATE ${AUTOGEN_DIR}/lib)
+    target_link_libraries(producerBenchmark pulsarStatic benchmark::benchmark)
+
+    add_executable(batchPayloadBenchmark BatchPayloadBenchmark.cc)
+    target_include_directories(batchPayloadBenchmark PRIVATE ${AUTOGEN_DIR}/lib)
+    target_link_libraries(batchPayloadBenchmark pulsarStatic benchmark::benchmark)
+
+    add_executable(zstdDictionaryBenchmark ZstdDictionaryBenchmark.cc)
+    target_include_directories(zstdDictionaryBenchmark PRIVATE ${AUTOGEN_DIR}/lib)
+    target_link_libraries(zstdDictionaryBenchmark pulsarStatic benchmark::benchmark)
+else ()
+    message(STATUS "Google Benchmark is not found, the micro benchmarks are not built")
+endif ()
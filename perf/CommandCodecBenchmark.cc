@@ -0,0 +1,157 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+// Compare the hand-written codec of the hot commands with the generic protobuf serialization
+#include <benchmark/benchmark.h>
+#include <lib/BitSet.h>
+#include <lib/CommandCodec.h>
+#include <lib/Commands.h>
+#include <lib/PulsarApi.pb.h>
+
+#include <string>
+
+using namespace pulsar;
+
+static constexpr uint64_t ProducerId = 3;
+static constexpr uint64_t ConsumerId = 5;
+
+// The protobuf path of the commands, like Commands::writeMessageWithSize()
+static SharedBuffer writeMessageWithSize(const proto::BaseCommand& cmd) {
+    const size_t cmdSize = cmd.ByteSizeLong();
+    SharedBuffer buffer = SharedBuffer::allocate(4 + 4 + cmdSize);
+    buffer.writeUnsignedInt(4 + cmdSize);
+    buffer.writeUnsignedInt(cmdSize);
+    cmd.SerializeToArray(buffer.mutableData(), cmdSize);
+    buffer.bytesWritten(cmdSize);
+    return buffer;
+}
+
+static void BM_EncodeSendProtobuf(benchmark::State& state) {
+    char buffer[64];
+    uint64_t sequenceId = 1000000;
+    proto::BaseCommand cmd;
+    for (auto _ : state) {
+        cmd.set_type(proto::BaseCommand::SEND);
+        auto send = cmd.mutable_send();
+        send->set_producer_id(ProducerId);
+        send->set_sequence_id(sequenceId++);
+        send->set_num_messages(100);
+        const auto size = cmd.ByteSizeLong();
+        cmd.SerializeToArray(buffer, size);
+        cmd.clear_send();
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+BENCHMARK(BM_EncodeSendProtobuf);
+
+static void BM_EncodeSendCodec(benchmark::State& state) {
+    char buffer[64];
+    uint64_t sequenceId = 1000000;
+    for (auto _ : state) {
+        CommandCodec::SendFields fields{ProducerId, sequenceId++, true, 100, false};
+        benchmark::DoNotOptimize(CommandCodec::sendSize(fields));
+        CommandCodec::encodeSend(buffer, fields);
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+BENCHMARK(BM_EncodeSendCodec);
+
+static void BM_NewAckProtobuf(benchmark::State& state) {
+    BitSet ackSet(100);
+    ackSet.set(0, 50);
+    int64_t entryId = 0;
+    for (auto _ : state) {
+        proto::BaseCommand cmd;
+        cmd.set_type(proto::BaseCommand::ACK);
+        auto ack = cmd.mutable_ack();
+        ack->set_consumer_id(ConsumerId);
+        ack->set_ack_type(proto::CommandAck::Individual);
+        auto msgId = ack->add_message_id();
+        msgId->set_ledgerid(1000);
+        msgId->set_entryid(entryId++);
+        for (auto x : ackSet) {
+            msgId->add_ack_set(x);
+        }
+        benchmark::DoNotOptimize(writeMessageWithSize(cmd));
+    }
+}
+BENCHMARK(BM_NewAckProtobuf);
+
+static void BM_NewAckCodec(benchmark::State& state) {
+    BitSet ackSet(100);
+    ackSet.set(0, 50);
+    int64_t entryId = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            Commands::newAck(ConsumerId, 1000, entryId++, ackSet, CommandAck_AckType_Individual));
+    }
+}
+BENCHMARK(BM_NewAckCodec);
+
+static void BM_NewFlowProtobuf(benchmark::State& state) {
+    for (auto _ : state) {
+        proto::BaseCommand cmd;
+        cmd.set_type(proto::BaseCommand::FLOW);
+        cmd.mutable_flow()->set_consumer_id(ConsumerId);
+        cmd.mutable_flow()->set_messagepermits(500);
+        benchmark::DoNotOptimize(writeMessageWithSize(cmd));
+    }
+}
+BENCHMARK(BM_NewFlowProtobuf);
+
+static void BM_NewFlowCodec(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Commands::newFlow(ConsumerId, 500));
+    }
+}
+BENCHMARK(BM_NewFlowCodec);
+
+static std::string sendReceiptBytes() {
+    proto::BaseCommand cmd;
+    cmd.set_type(proto::BaseCommand::SEND_RECEIPT);
+    auto receipt = cmd.mutable_send_receipt();
+    receipt->set_producer_id(ProducerId);
+    receipt->set_sequence_id(1000000);
+    receipt->set_highest_sequence_id(1000000);
+    auto msgId = receipt->mutable_message_id();
+    msgId->set_ledgerid(123456);
+    msgId->set_entryid(7890);
+    return cmd.SerializeAsString();
+}
+
+static void BM_DecodeSendReceiptProtobuf(benchmark::State& state) {
+    const auto bytes = sendReceiptBytes();
+    for (auto _ : state) {
+        proto::BaseCommand cmd;
+        cmd.ParseFromArray(bytes.data(), bytes.size());
+        benchmark::DoNotOptimize(cmd.send_receipt().sequence_id());
+    }
+}
+BENCHMARK(BM_DecodeSendReceiptProtobuf);
+
+static void BM_DecodeSendReceiptCodec(benchmark::State& state) {
+    const auto bytes = sendReceiptBytes();
+    for (auto _ : state) {
+        CommandCodec::SendReceipt receipt;
+        CommandCodec::decodeSendReceipt(bytes.data(), bytes.size(), receipt);
+        benchmark::DoNotOptimize(receipt.sequenceId);
+    }
+}
+BENCHMARK(BM_DecodeSendReceiptCodec);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,67 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+// Compare the round trip of a request over the loopback TCP and over a unix socket, both served by the
+// stand-in broker, so that only the transport differs
+#include <benchmark/benchmark.h>
+#include <pulsar/Client.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "tests/StandInBroker.h"
+
+using namespace pulsar;
+
+static void getPartitions(benchmark::State& state, const std::string& serviceUrl) {
+    Client client(serviceUrl);
+    std::vector<std::string> partitions;
+    // Establish the connection before the measurement
+    if (client.getPartitionsForTopic("topic", partitions) != ResultOk) {
+        state.SkipWithError("Failed to connect to the stand-in broker");
+        return;
+    }
+    for (auto _ : state) {
+        client.getPartitionsForTopic("topic", partitions);
+        benchmark::DoNotOptimize(partitions);
+    }
+    client.close();
+}
+
+static void BM_GetPartitionsTcp(benchmark::State& state) {
+    StandInBroker<ASIO::ip::tcp> broker(ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 1);
+    getPartitions(state, "pulsar://127.0.0.1:" + std::to_string(broker.endpoint().port()));
+}
+BENCHMARK(BM_GetPartitionsTcp);
+
+#ifdef PULSAR_HAS_UNIX_SOCKETS
+static void BM_GetPartitionsUnix(benchmark::State& state) {
+    const std::string path = "/tmp/pulsar-connection-benchmark-" + std::to_string(::getpid()) + ".sock";
+    std::remove(path.c_str());
+    {
+        StandInBroker<ASIO::local::stream_protocol> broker(ASIO::local::stream_protocol::endpoint(path), 1);
+        getPartitions(state, "pulsar+unix://" + path);
+    }
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_GetPartitionsUnix);
+#endif
+
+BENCHMARK_MAIN();
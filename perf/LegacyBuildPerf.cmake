@@ -35,3 +35,28 @@ set(TOOL_LIBS ${CLIENT_LIBS} ${Boost_PROGRAM_OPTIONS_LIBRARY} ${Boost_THREAD_LIB
 
 target_link_libraries(perfProducer pulsarShared ${TOOL_LIBS})
 target_link_libraries(perfConsumer pulsarShared ${TOOL_LIBS})
+
+find_package(benchmark QUIET)
+if (benchmark_FOUND)
+    add_executable(commandCodecBenchmark CommandCodecBenchmark.cc)
+    target_include_directories(commandCodecBenchmark PRIVATE ${AUTOGEN_DIR}/lib)
+    target_link_libraries(commandCodecBenchmark pulsarStatic ${CLIENT_LIBS} benchmark::benchmark)
+
+    add_executable(connectionBenchmark ConnectionBenchmark.cc)
+    target_include_directories(connectionBenchmark PRIVATE ${AUTOGEN_DIR}/lib)
+    target_link_libraries(connectionBenchmark pulsarStatic ${CLIENT_LIBS} benchmark::benchmark)
+
+    add_executable(producerBenchmark ProducerBenchmark.cc)
+    target_include_directories(producerBenchmark PRIVATE ${AUTOGEN_DIR}/lib)
+    target_link_libraries(producerBenchmark pulsarStatic ${CLIENT_LIBS} benchmark::benchmark)
+
+    add_executable(batchPayloadBenchmark BatchPayloadBenchmark.cc)
+    target_include_directories(batchPayloadBenchmark PRIVATE ${AUTOGEN_DIR}/lib)
+    target_link_libraries(batchPayloadBenchmark pulsarStatic ${CLIENT_LIBS} benchmark::benchmark)
+
+    add_executable(zstdDictionaryBenchmark ZstdDictionaryBenchmark.cc)
+    target_include_directories(zstdDictionaryBenchmark PRIVATE ${AUTOGEN_DIR}/lib)
+    target_link_libraries(zstdDictionaryBenchmark pulsarStatic ${CLIENT_LIBS} benchmark::benchmark)
+else ()
+    message(STATUS "Google Benchmark is not found, the micro benchmarks are not built")
+endif ()
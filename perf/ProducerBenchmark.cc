@@ -0,0 +1,82 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+// Publish from multiple application threads to one batching producer, the messages are acknowledged by the
+// stand-in broker so that the client side is measured
+#include <benchmark/benchmark.h>
+#include <pulsar/Client.h>
+
+#include <string>
+#include <vector>
+
+#include "tests/StandInBroker.h"
+
+using namespace pulsar;
+
+namespace {
+
+struct PublishEnvironment {
+    StandInBroker<ASIO::ip::tcp> broker{ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 0};
+    Client client{"pulsar://127.0.0.1:" + std::to_string(broker.endpoint().port())};
+    Producer producer;
+
+    PublishEnvironment() {
+        ProducerConfiguration conf;
+        conf.setBatchingMaxMessages(1000);
+        conf.setBlockIfQueueFull(true);
+        conf.setMaxPendingMessages(100000);
+        client.createProducer("topic", conf, producer);
+    }
+};
+
+}  // namespace
+
+static void BM_SendAsync(benchmark::State& state) {
+    // The environment is shared by all threads and all runs
+    static PublishEnvironment env;
+    const std::string content(100, 'a');
+    for (auto _ : state) {
+        env.producer.sendAsync(MessageBuilder().setContent(content).build(), nullptr);
+    }
+    if (state.thread_index() == 0) {
+        env.producer.flush();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SendAsync)->ThreadRange(1, 16)->UseRealTime();
+
+static void BM_SendAsyncBulk(benchmark::State& state) {
+    static PublishEnvironment env;
+    const std::string content(100, 'a');
+    const auto numMessages = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        std::vector<Message> messages;
+        messages.reserve(numMessages);
+        for (size_t i = 0; i < numMessages; i++) {
+            messages.emplace_back(MessageBuilder().setContent(content).build());
+        }
+        env.producer.sendAsync(std::move(messages), nullptr);
+    }
+    if (state.thread_index() == 0) {
+        env.producer.flush();
+    }
+    state.SetItemsProcessed(state.iterations() * numMessages);
+}
+BENCHMARK(BM_SendAsyncBulk)->Arg(10)->Arg(100)->Arg(1000)->ThreadRange(1, 16)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,135 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+// Measure the ZSTD compression of batches of small JSON events, with and without a trained dictionary. The
+// "ratio" counter is the uncompressed size divided by the compressed size.
+#include <benchmark/benchmark.h>
+#include <lib/Commands.h>
+#include <lib/CompressionCodecZstd.h>
+#include <pulsar/MessageBuilder.h>
+#include <pulsar/ZstdDictionary.h>
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace pulsar;
+
+// An event of about 200 bytes like {"id":"...","user":...,"type":"click",...}
+static std::string createEvent(std::mt19937& random) {
+    static const std::vector<std::string> types{"page_view", "click", "add_to_cart", "purchase", "search"};
+    static const std::vector<std::string> countries{"US", "DE", "FR", "CN", "BR", "IN", "JP"};
+    static const std::vector<std::string> platforms{"android", "ios", "web"};
+    std::uniform_int_distribution<uint64_t> id;
+    std::uniform_int_distribution<int> small(0, 9999);
+    return "{\"event_id\":\"" + std::to_string(id(random)) + "\",\"user_id\":" +
+           std::to_string(small(random)) + ",\"type\":\"" + types[random() % types.size()] +
+           "\",\"timestamp\":" + std::to_string(1697000000000ULL + small(random)) + ",\"country\":\"" +
+           countries[random() % countries.size()] + "\",\"device\":{\"platform\":\"" +
+           platforms[random() % platforms.size()] + "\",\"app_version\":\"5." +
+           std::to_string(random() % 10) + "\"},\"page\":\"/products/" + std::to_string(small(random)) +
+           "\",\"session_duration_ms\":" + std::to_string(small(random)) + "}";
+}
+
+static const ZstdDictionaryPtr& dictionary() {
+    static const ZstdDictionaryPtr dictionary = [] {
+        std::mt19937 random(1);
+        std::vector<std::string> samples;
+        for (int i = 0; i < 20000; i++) {
+            samples.emplace_back(createEvent(random));
+        }
+        return ZstdDictionary::train(samples);
+    }();
+    return dictionary;
+}
+
+static SharedBuffer createBatchPayload(int numMessages) {
+    // Different from the samples of the dictionary
+    std::mt19937 random(2);
+    std::vector<Message> messages;
+    for (int i = 0; i < numMessages; i++) {
+        messages.emplace_back(MessageBuilder().setContent(createEvent(random)).build());
+    }
+    SharedBuffer payload;
+    Commands::serializeSingleMessagesToBatchPayload(payload, messages);
+    return payload;
+}
+
+static void compressBatch(benchmark::State& state, bool withDictionary) {
+    const auto payload = createBatchPayload(state.range(0));
+    CompressionCodecZstd codec;
+    SharedBuffer compressed;
+    try {
+        if (withDictionary) {
+            compressed = CompressionCodecZstd::encodeWithDictionary(payload, *dictionary());
+        } else {
+            compressed = codec.encode(payload);
+        }
+    } catch (const std::runtime_error& e) {
+        state.SkipWithError(e.what());
+        return;
+    }
+    for (auto _ : state) {
+        if (withDictionary) {
+            benchmark::DoNotOptimize(CompressionCodecZstd::encodeWithDictionary(payload, *dictionary()));
+        } else {
+            benchmark::DoNotOptimize(codec.encode(payload));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * payload.readableBytes());
+    state.counters["ratio"] = static_cast<double>(payload.readableBytes()) / compressed.readableBytes();
+}
+
+static void decompressBatch(benchmark::State& state, bool withDictionary) {
+    const auto payload = createBatchPayload(state.range(0));
+    const uint32_t size = payload.readableBytes();
+    CompressionCodecZstd codec;
+    SharedBuffer compressed;
+    try {
+        compressed = withDictionary ? CompressionCodecZstd::encodeWithDictionary(payload, *dictionary())
+                                    : codec.encode(payload);
+    } catch (const std::runtime_error& e) {
+        state.SkipWithError(e.what());
+        return;
+    }
+    SharedBuffer decompressed;
+    for (auto _ : state) {
+        if (withDictionary) {
+            CompressionCodecZstd::decodeWithDictionary(compressed, size, decompressed, *dictionary());
+        } else {
+            codec.decode(compressed, size, decompressed);
+        }
+        benchmark::DoNotOptimize(decompressed);
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+}
+
+static void BM_ZstdCompress(benchmark::State& state) { compressBatch(state, false); }
+BENCHMARK(BM_ZstdCompress)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_ZstdCompressWithDictionary(benchmark::State& state) { compressBatch(state, true); }
+BENCHMARK(BM_ZstdCompressWithDictionary)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_ZstdDecompress(benchmark::State& state) { decompressBatch(state, false); }
+BENCHMARK(BM_ZstdDecompress)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_ZstdDecompressWithDictionary(benchmark::State& state) { decompressBatch(state, true); }
+BENCHMARK(BM_ZstdDecompressWithDictionary)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
+
+BENCHMARK_MAIN();
@@ -76,6 +76,9 @@ pushd $CMAKE_BUILD_DIRECTORY/tests
 # Avoid this test is still flaky, see https://github.com/apache/pulsar-client-cpp/pull/217
 ./ConnectionFailTest --gtest_repeat=20
 
+# It replaces the global allocation functions, so it runs in its own executable
+./ProducerAllocationTest
+
 export RETRY_FAILED="${RETRY_FAILED:-1}"
 
 if [ -f /gtest-parallel ]; then
@@ -0,0 +1,86 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+
+#include "lib/AdaptiveBatchingDelay.h"
+
+using namespace pulsar;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+static void sendMessages(AdaptiveBatchingDelay& delay, ptime& now, int numMessages, TimeDuration interval) {
+    for (int i = 0; i < numMessages; i++) {
+        now += interval;
+        delay.onMessageArrived(now);
+    }
+}
+
+TEST(AdaptiveBatchingDelayTest, testIdle) {
+    AdaptiveBatchingDelay delay(milliseconds(5), milliseconds(10));
+    ptime now = TimeUtils::now();
+    // No interval is known after the 1st message
+    delay.onMessageArrived(now);
+    ASSERT_EQ(delay.nextDelay(false).count(), 0);
+
+    sendMessages(delay, now, 100, microseconds(10));
+    ASSERT_EQ(delay.nextDelay(false), milliseconds(5));
+    // Nothing is in flight
+    ASSERT_EQ(delay.nextDelay(true).count(), 0);
+}
+
+TEST(AdaptiveBatchingDelayTest, testArrivalRate) {
+    AdaptiveBatchingDelay delay(milliseconds(5), milliseconds(10));
+    ptime now = TimeUtils::now();
+    delay.onMessageArrived(now);
+
+    // No more message is expected before the target
+    sendMessages(delay, now, 100, milliseconds(20));
+    ASSERT_EQ(delay.arrivalInterval(), milliseconds(5));
+    ASSERT_EQ(delay.nextDelay(false).count(), 0);
+
+    // The intervals longer than the target are capped, so that a burst is followed quickly
+    sendMessages(delay, now, 20, microseconds(100));
+    ASSERT_LT(delay.arrivalInterval(), milliseconds(1));
+    ASSERT_EQ(delay.nextDelay(false), milliseconds(5));
+}
+
+TEST(AdaptiveBatchingDelayTest, testRoundTripTime) {
+    AdaptiveBatchingDelay delay(milliseconds(5), milliseconds(3));
+    ptime now = TimeUtils::now();
+    delay.onMessageArrived(now);
+    sendMessages(delay, now, 100, microseconds(10));
+    // The delay never exceeds the max delay
+    ASSERT_EQ(delay.nextDelay(false), milliseconds(3));
+
+    delay.onAckReceived(milliseconds(4));
+    ASSERT_EQ(delay.roundTripTime(), milliseconds(4));
+    ASSERT_EQ(delay.nextDelay(false), milliseconds(1));
+
+    for (int i = 0; i < 100; i++) {
+        delay.onAckReceived(milliseconds(2));
+    }
+    ASSERT_LT(delay.roundTripTime(), milliseconds(2) + microseconds(10));
+    ASSERT_GT(delay.nextDelay(false), milliseconds(2));
+
+    // The target cannot be hit, but the messages are still batched
+    for (int i = 0; i < 100; i++) {
+        delay.onAckReceived(milliseconds(50));
+    }
+    ASSERT_EQ(delay.nextDelay(false), microseconds(500));
+}
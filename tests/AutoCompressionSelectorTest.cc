@@ -0,0 +1,89 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+#include "lib/AutoCompressionSelector.h"
+#include "lib/SharedBuffer.h"
+
+using namespace pulsar;
+
+static SharedBuffer compressiblePayload() {
+    std::string content;
+    for (int i = 0; content.size() < 64 * 1024; i++) {
+        content += "{\"id\": " + std::to_string(i) + ", \"name\": \"pulsar\", \"tags\": [\"a\", \"b\"]}";
+    }
+    return SharedBuffer::copy(content.data(), content.size());
+}
+
+static SharedBuffer randomPayload() {
+    std::mt19937 random(42);
+    std::string content(64 * 1024, '\0');
+    for (auto& c : content) {
+        c = static_cast<char>(random());
+    }
+    return SharedBuffer::copy(content.data(), content.size());
+}
+
+TEST(AutoCompressionSelectorTest, testBudget) {
+    // Any codec fits in the budget, the default choice of not compressing is replaced
+    AutoCompressionSelector unlimited(1e9, std::chrono::hours(1));
+    ASSERT_EQ(unlimited.getChoice().type, CompressionNone);
+    ASSERT_NE(unlimited.choose(compressiblePayload()).type, CompressionNone);
+
+    // No codec fits in the budget
+    AutoCompressionSelector limited(1e-9, std::chrono::hours(1));
+    ASSERT_EQ(limited.choose(compressiblePayload()).type, CompressionNone);
+}
+
+TEST(AutoCompressionSelectorTest, testNotCompressible) {
+    // The random bytes only grow when they are compressed
+    AutoCompressionSelector selector(1e9, std::chrono::hours(1));
+    ASSERT_EQ(selector.choose(randomPayload()).type, CompressionNone);
+}
+
+TEST(AutoCompressionSelectorTest, testSampleInterval) {
+    int numChanges = 0;
+    AutoCompressionSelector selector(1e9, std::chrono::hours(1),
+                                     [&numChanges](const AutoCompressionSelector::Choice&) { numChanges++; });
+    const auto choice = selector.choose(compressiblePayload());
+    ASSERT_NE(choice.type, CompressionNone);
+    ASSERT_EQ(numChanges, 1);
+
+    // The next sample is not due, so the choice is kept
+    for (int i = 0; i < 10; i++) {
+        ASSERT_EQ(selector.choose(randomPayload()).type, choice.type);
+    }
+    ASSERT_EQ(numChanges, 1);
+}
+
+TEST(AutoCompressionSelectorTest, testPayloadChange) {
+    AutoCompressionSelector selector(1e9, std::chrono::nanoseconds(0));
+    ASSERT_NE(selector.choose(compressiblePayload()).type, CompressionNone);
+
+    // The averages follow the new payloads until not compressing becomes the best choice
+    const auto payload = randomPayload();
+    bool compressed = true;
+    for (int i = 0; i < 100 && compressed; i++) {
+        compressed = (selector.choose(payload).type != CompressionNone);
+    }
+    ASSERT_FALSE(compressed);
+}
@@ -37,6 +37,7 @@
 #include "lib/LogUtils.h"
 #include "lib/ProtoApiEnums.h"
 #include "lib/Utils.h"
+#include "lib/checksum/ChecksumProvider.h"
 #include "lib/stats/ProducerStatsImpl.h"
 
 DECLARE_LOG_OBJECT();
@@ -969,8 +970,9 @@ TEST(BatchMessageTest, testParseMessageBatchEntry) {
         msgs.emplace_back(msgBuilder.setContent(x.content).setProperty(x.propKey, x.propValue).build());
     }
     SharedBuffer payload;
-    Commands::serializeSingleMessagesToBatchPayload(payload, msgs);
-    ASSERT_EQ(payload.writableBytes(), 0);
+    uint32_t checksum;
+    Commands::serializeSingleMessagesToBatchPayload(payload, msgs, nullptr, &checksum);
+    ASSERT_EQ(checksum, computeChecksum(0, payload.data(), payload.readableBytes()));
 
     MessageBatch messageBatch;
     auto fakeId = MessageIdBuilder().ledgerId(5000L).entryId(10L).partition(0).build();
@@ -107,3 +107,20 @@ TEST(BitSetTest, testSingleClear) {
     bitSet.clear(13);
     ASSERT_EQ(toLongVector(bitSet), (std::vector<uint64_t>{0xffffffffffffdfff, 0xffffffffffffffff}));
 }
+
+TEST(BitSetTest, testNextSetBit) {
+    BitSet bitSet(64 * 3);  // 3 words
+    ASSERT_EQ(bitSet.nextSetBit(0), -1);
+
+    bitSet.set(0, 64 * 3);
+    bitSet.clear(1, 70);
+    bitSet.clear(71, 64 * 2 + 63);
+    std::vector<int32_t> indexes;
+    for (int32_t i = bitSet.nextSetBit(0); i >= 0; i = bitSet.nextSetBit(i + 1)) {
+        indexes.emplace_back(i);
+    }
+    ASSERT_EQ(indexes, (std::vector<int32_t>{0, 70, 64 * 2 + 63}));
+
+    ASSERT_EQ(bitSet.nextSetBit(64 * 2 + 63), 64 * 2 + 63);
+    ASSERT_EQ(bitSet.nextSetBit(64 * 3), -1);
+}
@@ -46,6 +46,10 @@ if (UNIX)
     target_link_libraries(ConnectionFailTest pulsarStatic ${GTEST_TARGETS})
 endif ()
 
+add_executable(ProducerAllocationTest allocation/ProducerAllocationTest.cc)
+target_include_directories(ProducerAllocationTest PRIVATE ${AUTOGEN_DIR}/lib)
+target_link_libraries(ProducerAllocationTest PRIVATE pulsarStatic ${GTEST_TARGETS})
+
 add_executable(BrokerMetadataTest brokermetadata/BrokerMetadataTest.cc)
 target_link_libraries(BrokerMetadataTest pulsarStatic ${GTEST_TARGETS})
 
@@ -0,0 +1,199 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "lib/BitSet.h"
+#include "lib/CommandCodec.h"
+#include "lib/PulsarApi.pb.h"
+
+using namespace pulsar;
+
+template <typename Encode>
+static std::string encode(size_t size, Encode&& encode) {
+    std::string bytes(size, '\0');
+    char* end = encode(&bytes[0]);
+    EXPECT_EQ(end - bytes.data(), size);
+    return bytes;
+}
+
+static void verifySend(uint64_t producerId, uint64_t sequenceId, bool hasNumMessages, int32_t numMessages,
+                       bool isChunk) {
+    CommandCodec::SendFields fields{producerId, sequenceId, hasNumMessages, numMessages, isChunk};
+
+    proto::BaseCommand cmd;
+    cmd.set_type(proto::BaseCommand::SEND);
+    auto send = cmd.mutable_send();
+    send->set_producer_id(producerId);
+    send->set_sequence_id(sequenceId);
+    if (hasNumMessages) {
+        send->set_num_messages(numMessages);
+    }
+    if (isChunk) {
+        send->set_is_chunk(true);
+    }
+
+    ASSERT_EQ(CommandCodec::sendSize(fields), cmd.ByteSizeLong());
+    ASSERT_EQ(encode(CommandCodec::sendSize(fields),
+                     [&fields](char* dst) { return CommandCodec::encodeSend(dst, fields); }),
+              cmd.SerializeAsString());
+}
+
+TEST(CommandCodecTest, testEncodeSend) {
+    verifySend(0, 0, false, 0, false);
+    verifySend(1, 127, false, 0, false);
+    verifySend(128, 300, true, 100, false);
+    verifySend(UINT64_MAX, UINT64_MAX, true, -1, true);
+    verifySend(12345, 1L << 40, false, 0, true);
+}
+
+static void verifyAck(uint64_t consumerId, int64_t ledgerId, int64_t entryId, const BitSet& ackSet,
+                      int validationError, bool hasRequestId) {
+    CommandCodec::AckFields fields{consumerId, proto::CommandAck::Cumulative, ledgerId, entryId, &ackSet,
+                                   validationError, hasRequestId, 1001};
+
+    proto::BaseCommand cmd;
+    cmd.set_type(proto::BaseCommand::ACK);
+    auto ack = cmd.mutable_ack();
+    ack->set_consumer_id(consumerId);
+    ack->set_ack_type(proto::CommandAck::Cumulative);
+    auto msgId = ack->add_message_id();
+    msgId->set_ledgerid(ledgerId);
+    msgId->set_entryid(entryId);
+    for (auto x : ackSet) {
+        msgId->add_ack_set(x);
+    }
+    if (validationError >= 0) {
+        ack->set_validation_error(static_cast<proto::CommandAck_ValidationError>(validationError));
+    }
+    if (hasRequestId) {
+        ack->set_request_id(1001);
+    }
+
+    ASSERT_EQ(CommandCodec::ackSize(fields), cmd.ByteSizeLong());
+    ASSERT_EQ(encode(CommandCodec::ackSize(fields),
+                     [&fields](char* dst) { return CommandCodec::encodeAck(dst, fields); }),
+              cmd.SerializeAsString());
+}
+
+TEST(CommandCodecTest, testEncodeAck) {
+    BitSet ackSet(130);
+    ackSet.set(0, 100);
+    verifyAck(0, 0, 0, {}, -1, false);
+    verifyAck(1, -1, -1, {}, -1, false);
+    verifyAck(7, 1L << 50, 1000, ackSet, -1, false);
+    verifyAck(7, 100, 1000, ackSet, proto::CommandAck::ChecksumMismatch, false);
+    verifyAck(7, 100, 1000, {}, -1, true);
+}
+
+TEST(CommandCodecTest, testEncodeFlow) {
+    for (uint64_t consumerId : {0UL, 1UL, 1000UL, UINT64_MAX}) {
+        for (uint32_t permits : {0U, 1U, 1000U, UINT32_MAX}) {
+            proto::BaseCommand cmd;
+            cmd.set_type(proto::BaseCommand::FLOW);
+            cmd.mutable_flow()->set_consumer_id(consumerId);
+            cmd.mutable_flow()->set_messagepermits(permits);
+
+            ASSERT_EQ(CommandCodec::flowSize(consumerId, permits), cmd.ByteSizeLong());
+            ASSERT_EQ(encode(CommandCodec::flowSize(consumerId, permits),
+                             [=](char* dst) { return CommandCodec::encodeFlow(dst, consumerId, permits); }),
+                      cmd.SerializeAsString());
+        }
+    }
+}
+
+static proto::BaseCommand createSendReceipt(uint64_t producerId, uint64_t sequenceId) {
+    proto::BaseCommand cmd;
+    cmd.set_type(proto::BaseCommand::SEND_RECEIPT);
+    auto receipt = cmd.mutable_send_receipt();
+    receipt->set_producer_id(producerId);
+    receipt->set_sequence_id(sequenceId);
+    return cmd;
+}
+
+TEST(CommandCodecTest, testDecodeSendReceipt) {
+    auto cmd = createSendReceipt(3, 1L << 40);
+    auto msgId = cmd.mutable_send_receipt()->mutable_message_id();
+    msgId->set_ledgerid(100);
+    msgId->set_entryid(-1);
+    msgId->set_partition(2);
+    msgId->set_batch_index(5);
+    msgId->set_batch_size(10);
+    cmd.mutable_send_receipt()->set_highest_sequence_id(1000);
+
+    const auto bytes = cmd.SerializeAsString();
+    CommandCodec::SendReceipt receipt;
+    ASSERT_TRUE(CommandCodec::decodeSendReceipt(bytes.data(), bytes.size(), receipt));
+    ASSERT_EQ(receipt.producerId, 3);
+    ASSERT_EQ(receipt.sequenceId, 1L << 40);
+    ASSERT_EQ(receipt.ledgerId, 100);
+    ASSERT_EQ(receipt.entryId, -1);
+    ASSERT_EQ(receipt.partition, 2);
+    ASSERT_EQ(receipt.batchIndex, 5);
+    ASSERT_EQ(receipt.batchSize, 10);
+
+    // Without a message id, the defaults of MessageIdData are used like with protobuf
+    const auto noMsgIdBytes = createSendReceipt(1, 2).SerializeAsString();
+    CommandCodec::SendReceipt noMsgIdReceipt;
+    ASSERT_TRUE(CommandCodec::decodeSendReceipt(noMsgIdBytes.data(), noMsgIdBytes.size(), noMsgIdReceipt));
+    const auto& defaultMsgId = proto::MessageIdData::default_instance();
+    ASSERT_EQ(noMsgIdReceipt.ledgerId, defaultMsgId.ledgerid());
+    ASSERT_EQ(noMsgIdReceipt.entryId, defaultMsgId.entryid());
+    ASSERT_EQ(noMsgIdReceipt.partition, defaultMsgId.partition());
+    ASSERT_EQ(noMsgIdReceipt.batchIndex, defaultMsgId.batch_index());
+    ASSERT_EQ(noMsgIdReceipt.batchSize, defaultMsgId.batch_size());
+}
+
+TEST(CommandCodecTest, testDecodeSendReceiptFallback) {
+    CommandCodec::SendReceipt receipt;
+    auto decode = [&receipt](const std::string& bytes) {
+        return CommandCodec::decodeSendReceipt(bytes.data(), bytes.size(), receipt);
+    };
+
+    // Other commands
+    proto::BaseCommand ping;
+    ping.set_type(proto::BaseCommand::PING);
+    ping.mutable_ping();
+    ASSERT_FALSE(decode(ping.SerializeAsString()));
+
+    proto::BaseCommand sendError;
+    sendError.set_type(proto::BaseCommand::SEND_ERROR);
+    sendError.mutable_send_error()->set_producer_id(1);
+    sendError.mutable_send_error()->set_sequence_id(1);
+    sendError.mutable_send_error()->set_error(proto::ChecksumError);
+    sendError.mutable_send_error()->set_message("error");
+    ASSERT_FALSE(decode(sendError.SerializeAsString()));
+
+    // Fields not handled by the codec
+    auto withAckSet = createSendReceipt(1, 2);
+    auto msgId = withAckSet.mutable_send_receipt()->mutable_message_id();
+    msgId->set_ledgerid(1);
+    msgId->set_entryid(1);
+    msgId->add_ack_set(1);
+    ASSERT_FALSE(decode(withAckSet.SerializeAsString()));
+
+    // Truncated or malformed
+    const auto bytes = createSendReceipt(1000, 1000).SerializeAsString();
+    for (size_t size = 0; size < bytes.size(); size++) {
+        ASSERT_FALSE(decode(bytes.substr(0, size))) << size;
+    }
+    ASSERT_TRUE(decode(bytes));
+    ASSERT_FALSE(decode(std::string(11, '\xff')));
+}
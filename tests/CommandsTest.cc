@@ -0,0 +1,130 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "lib/Commands.h"
+#include "lib/OpSendMsg.h"
+#include "lib/PulsarApi.pb.h"
+#include "lib/SharedBuffer.h"
+#include "lib/checksum/ChecksumProvider.h"
+
+using namespace pulsar;
+
+static std::shared_ptr<SendArguments> createSendArgs(
+    uint64_t sequenceId, const std::string& value,
+    boost::optional<uint32_t> payloadChecksum = boost::none) {
+    proto::MessageMetadata metadata;
+    metadata.set_producer_name("producer");
+    metadata.set_sequence_id(sequenceId);
+    metadata.set_publish_time(1);
+    return std::make_shared<SendArguments>(0L, sequenceId, metadata,
+                                           SharedBuffer::copy(value.c_str(), value.size()), payloadChecksum);
+}
+
+static std::string toString(const SharedBufferList& buffers) {
+    std::string s;
+    for (const auto& buffer : buffers.view()) {
+        s.append(static_cast<const char*>(buffer.data()), buffer.size());
+    }
+    return s;
+}
+
+// Verify the frame at the beginning of `frame` and return its size
+static size_t verifySendFrame(const std::string& frame, uint64_t expectedSequenceId,
+                              const std::string& value) {
+    auto buffer = SharedBuffer::copy(frame.data(), frame.size());
+    const auto totalSize = buffer.readUnsignedInt();
+    EXPECT_LE(totalSize + 4, frame.size());
+
+    const auto cmdSize = buffer.readUnsignedInt();
+    proto::BaseCommand cmd;
+    EXPECT_TRUE(cmd.ParseFromArray(buffer.data(), cmdSize));
+    EXPECT_EQ(cmd.send().sequence_id(), expectedSequenceId);
+    buffer.consume(cmdSize);
+
+    const uint16_t magicCrc32c = Commands::magicCrc32c;
+    EXPECT_EQ(buffer.readUnsignedShort(), magicCrc32c);
+    const auto checksum = buffer.readUnsignedInt();
+    const auto remainingSize = totalSize - 4 - cmdSize - 2 - 4;
+    EXPECT_EQ(checksum, computeChecksum(0, buffer.data(), remainingSize));
+
+    const auto metadataSize = buffer.readUnsignedInt();
+    buffer.consume(metadataSize);
+    EXPECT_EQ(std::string(buffer.data(), remainingSize - 4 - metadataSize), value);
+    return totalSize + 4;
+}
+
+TEST(CommandsTest, testNewSendSharedHeaders) {
+    auto headers = SharedBuffer::allocate(1024);
+    SharedBufferList buffers;
+    for (int i = 0; i < 3; i++) {
+        auto args = createSendArgs(i, "msg-" + std::to_string(i));
+        buffers.add(Commands::newSend(headers, Commands::Crc32c, *args));
+    }
+    ASSERT_EQ(buffers.size(), 6);
+    // All the headers are encoded one after another in the same buffer
+    ASSERT_EQ(buffers.bytes(), headers.writerIndex() + 3 * std::string("msg-0").size());
+
+    const auto frames = toString(buffers);
+    ASSERT_EQ(frames.size(), buffers.bytes());
+    size_t offset = 0;
+    for (int i = 0; i < 3; i++) {
+        offset += verifySendFrame(frames.substr(offset), i, "msg-" + std::to_string(i));
+    }
+    ASSERT_EQ(offset, frames.size());
+
+    buffers.clear();
+    ASSERT_TRUE(buffers.empty());
+    ASSERT_EQ(buffers.bytes(), 0);
+}
+
+TEST(CommandsTest, testNewSendHeadersOverflow) {
+    // The headers buffer is too small, a new buffer is allocated and the original one is not modified
+    auto headers = SharedBuffer::allocate(16);
+    SharedBufferList buffers;
+    buffers.add(Commands::newSend(headers, Commands::Crc32c, *createSendArgs(10, "value")));
+    ASSERT_EQ(headers.writerIndex(), 0);
+    verifySendFrame(toString(buffers), 10, "value");
+}
+
+TEST(CommandsTest, testNewSendPrecomputedPayloadChecksum) {
+    const std::string value(10000, 'x');
+    const auto payloadChecksum = computeChecksum(0, value.data(), value.size());
+    auto headers = SharedBuffer::allocate(1024);
+    SharedBufferList buffers;
+    buffers.add(Commands::newSend(headers, Commands::Crc32c, *createSendArgs(0, value, payloadChecksum)));
+    verifySendFrame(toString(buffers), 0, value);
+}
+
+TEST(CommandsTest, testCombineChecksums) {
+    std::string data;
+    for (int i = 0; i < 5000; i++) {
+        data.push_back(static_cast<char>(i * 31));
+    }
+    const auto checksum = computeChecksum(0, data.data(), data.size());
+    for (size_t firstLength : {0, 1, 7, 1000, 4999, 5000}) {
+        const auto firstChecksum = computeChecksum(0, data.data(), firstLength);
+        const auto secondChecksum =
+            computeChecksum(0, data.data() + firstLength, data.size() - firstLength);
+        ASSERT_EQ(combineChecksums(firstChecksum, secondChecksum, data.size() - firstLength), checksum)
+            << firstLength;
+    }
+}
@@ -14,9 +14,14 @@
  */
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <pulsar/Client.h>
 
+#include <algorithm>
+#include <atomic>
 #include <vector>
 
+#include "StandInBroker.h"
+#include "WaitUtils.h"
 #include "lib/ClientConnection.h"
 #include "lib/ClientConnectionAdaptor.h"
 
@@ -46,3 +51,117 @@ TEST(ConnectionTest, testCheckServerError) {
         conn.checkServerError(pulsar::proto::ServiceNotReady, msg);
     }
 }
+
+using Command = std::pair<proto::BaseCommand::Type, uint64_t>;
+
+// The broker's reads are paused while the frames are queued, so that the client's writes block and the frames
+// pile up in the connection. The commands received by the broker after the reads are resumed show the order
+// the frames are written.
+class ConnectionWriteOrderTest : public ::testing::Test {
+   protected:
+    static constexpr int NumMessagesPerProducer = 400;
+
+    StandInBroker<ASIO::ip::tcp> broker_{ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 0};
+    std::atomic_int numSent_{0};
+
+    void SetUp() override { broker_.setReceiveBufferSize(64 * 1024); }
+
+    Client createClient() {
+        return Client("pulsar://127.0.0.1:" + std::to_string(broker_.endpoint().port()));
+    }
+
+    static ProducerConfiguration producerConf() {
+        // Each message is written in its own SEND frame
+        return ProducerConfiguration().setBatchingEnabled(false).setSendTimeout(0);
+    }
+
+    void sendMessages(Producer& producer) {
+        // The frames are large enough to fill the socket buffers after a few of them
+        const std::string content(64 * 1024, 'a');
+        for (int i = 0; i < NumMessagesPerProducer; i++) {
+            producer.sendAsync(MessageBuilder().setContent(content).build(),
+                               [this](Result, const MessageId&) { numSent_++; });
+        }
+    }
+
+    template <typename Iterator>
+    static long countCommands(Iterator begin, Iterator end, proto::BaseCommand::Type type) {
+        return std::count_if(begin, end, [type](const Command& command) { return command.first == type; });
+    }
+
+    std::vector<Command> waitForCommands(long numExpectedSends, long numExpectedFlows) {
+        std::vector<Command> commands;
+        EXPECT_TRUE(waitUntil(std::chrono::seconds(10), [&] {
+            commands = broker_.receivedCommands();
+            return countCommands(commands.cbegin(), commands.cend(), proto::BaseCommand::SEND) ==
+                       numExpectedSends &&
+                   countCommands(commands.cbegin(), commands.cend(), proto::BaseCommand::FLOW) ==
+                       numExpectedFlows;
+        }));
+        return commands;
+    }
+
+    void waitForSendCallbacks(int numExpected) {
+        ASSERT_TRUE(
+            waitUntil(std::chrono::seconds(10), [this, numExpected] { return numSent_ == numExpected; }));
+    }
+};
+
+TEST_F(ConnectionWriteOrderTest, testControlFramesBeforeSendFrames) {
+    auto client = createClient();
+    Producer producer;
+    ASSERT_EQ(ResultOk, client.createProducer("topic", producerConf(), producer));
+    // A consumer without receiver queue sends a FLOW command for each receive
+    ConsumerConfiguration consumerConf;
+    consumerConf.setReceiverQueueSize(0);
+    Consumer consumer;
+    ASSERT_EQ(ResultOk, client.subscribe("flow-topic", "sub", consumerConf, consumer));
+
+    broker_.pauseReading();
+    sendMessages(producer);
+    consumer.receiveAsync([](Result, const Message&) {});
+    broker_.resumeReading();
+
+    const auto commands = waitForCommands(NumMessagesPerProducer, 1);
+    const auto flow = std::find_if(commands.cbegin(), commands.cend(), [](const Command& command) {
+        return command.first == proto::BaseCommand::FLOW;
+    });
+    ASSERT_NE(flow, commands.cend());
+    // Only the SEND frames already in the socket buffers or in the write in progress are before the FLOW
+    ASSERT_GT(countCommands(flow, commands.cend(), proto::BaseCommand::SEND), NumMessagesPerProducer / 2);
+    waitForSendCallbacks(NumMessagesPerProducer);
+    client.close();
+}
+
+TEST_F(ConnectionWriteOrderTest, testRoundRobinSendFramesOfProducers) {
+    auto client = createClient();
+    // Both producers share the only connection to the broker
+    Producer producer1;
+    ASSERT_EQ(ResultOk, client.createProducer("topic-1", producerConf(), producer1));
+    Producer producer2;
+    ASSERT_EQ(ResultOk, client.createProducer("topic-2", producerConf(), producer2));
+
+    // All the frames of the first producer are queued before the frames of the second producer
+    broker_.pauseReading();
+    sendMessages(producer1);
+    sendMessages(producer2);
+    broker_.resumeReading();
+
+    const auto commands = waitForCommands(NumMessagesPerProducer * 2, 0);
+    uint64_t lastProducerId = 0;
+    int numSends = 0;
+    int numSwitches = 0;
+    for (const auto& command : commands) {
+        if (command.first != proto::BaseCommand::SEND) {
+            continue;
+        }
+        if (numSends++ > 0 && command.second != lastProducerId) {
+            numSwitches++;
+        }
+        lastProducerId = command.second;
+    }
+    // Draining one producer at a time would switch only once, the staged frames of both producers alternate
+    ASSERT_GT(numSwitches, NumMessagesPerProducer / 2);
+    waitForSendCallbacks(NumMessagesPerProducer * 2);
+    client.close();
+}
@@ -45,9 +45,15 @@ TEST(ConsumerConfigurationTest, testDefaultConfig) {
     ASSERT_EQ(conf.getSchema().getSchemaType(), SchemaType::BYTES);
     ASSERT_EQ(conf.getConsumerType(), ConsumerExclusive);
     ASSERT_EQ(conf.hasMessageListener(), false);
+    ASSERT_FALSE(conf.getBatchMessageListener());
+    ASSERT_EQ(conf.getMessageListenerLanes(), 1);
     ASSERT_EQ(conf.hasConsumerEventListener(), false);
     ASSERT_EQ(conf.getReceiverQueueSize(), 1000);
     ASSERT_EQ(conf.getMaxTotalReceiverQueueSizeAcrossPartitions(), 50000);
+    ASSERT_EQ(conf.getReceiveSpinTimeUs(), 0);
+    ASSERT_FALSE(conf.isAutoScaledReceiverQueueSizeEnabled());
+    ASSERT_EQ(conf.getMinReceiverQueueSize(), 1);
+    ASSERT_EQ(conf.getMaxReceiverQueueBytes(), 0);
     ASSERT_EQ(conf.getConsumerName(), "");
     ASSERT_EQ(conf.getUnAckedMessagesTimeoutMs(), 0);
     ASSERT_EQ(conf.getTickDurationInMs(), 1000);
@@ -90,8 +96,24 @@ TEST(ConsumerConfigurationTest, testCustomConfig) {
     conf.setConsumerType(ConsumerKeyShared);
     ASSERT_EQ(conf.getConsumerType(), ConsumerKeyShared);
 
+    conf.setBatchMessageListener([](Consumer& consumer, const Messages& msgs) {});
+    ASSERT_EQ(conf.hasMessageListener(), true);
+    ASSERT_TRUE(conf.getBatchMessageListener());
+
+    // The message listener and the batch message listener override each other
     conf.setMessageListener([](const Consumer& consumer, const Message& msg) {});
     ASSERT_EQ(conf.hasMessageListener(), true);
+    ASSERT_FALSE(conf.getBatchMessageListener());
+
+    // An empty batch message listener unsets the listeners
+    conf.setBatchMessageListener(nullptr);
+    ASSERT_EQ(conf.hasMessageListener(), false);
+    ASSERT_FALSE(conf.getMessageListener());
+    ASSERT_FALSE(conf.getBatchMessageListener());
+    conf.setMessageListener([](const Consumer& consumer, const Message& msg) {});
+
+    conf.setMessageListenerLanes(4);
+    ASSERT_EQ(conf.getMessageListenerLanes(), 4);
 
     conf.setConsumerEventListener(std::make_shared<DummyEventListener>());
     ASSERT_EQ(conf.hasConsumerEventListener(), true);
@@ -102,6 +124,18 @@ TEST(ConsumerConfigurationTest, testCustomConfig) {
     conf.setMaxTotalReceiverQueueSizeAcrossPartitions(100000);
     ASSERT_EQ(conf.getMaxTotalReceiverQueueSizeAcrossPartitions(), 100000);
 
+    conf.setReceiveSpinTimeUs(50);
+    ASSERT_EQ(conf.getReceiveSpinTimeUs(), 50);
+    ASSERT_THROW(conf.setReceiveSpinTimeUs(-1), std::invalid_argument);
+    ASSERT_EQ(conf.getReceiveSpinTimeUs(), 50);
+
+    conf.setAutoScaledReceiverQueueSizeEnabled(true);
+    conf.setMinReceiverQueueSize(10);
+    conf.setMaxReceiverQueueBytes(1024);
+    ASSERT_TRUE(conf.isAutoScaledReceiverQueueSizeEnabled());
+    ASSERT_EQ(conf.getMinReceiverQueueSize(), 10);
+    ASSERT_EQ(conf.getMaxReceiverQueueBytes(), 1024);
+
     conf.setConsumerName("consumer");
     ASSERT_EQ(conf.getConsumerName(), "consumer");
 
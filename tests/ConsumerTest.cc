@@ -20,7 +20,9 @@
 
 #include <gtest/gtest.h>
 #include <pulsar/Client.h>
+#include <pulsar/MessageIdBuilder.h>
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <chrono>
@@ -35,6 +37,7 @@
 #include "NoOpsCryptoKeyReader.h"
 #include "PulsarAdminHelper.h"
 #include "PulsarFriend.h"
+#include "StandInBroker.h"
 #include "SynchronizedQueue.h"
 #include "WaitUtils.h"
 #include "lib/ClientConnection.h"
@@ -1499,4 +1502,253 @@ TEST(ConsumerTest, testReconnectWhenFirstConnectTimedOut) {
     client.close();
 }
 
+TEST(ConsumerTest, testReceiveBatchedMessages) {
+    StandInBroker<ASIO::ip::tcp> broker(ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 0);
+    Client client("pulsar://127.0.0.1:" + std::to_string(broker.endpoint().port()));
+    Consumer consumer;
+    ASSERT_EQ(ResultOk, client.subscribe("topic", "sub", consumer));
+    Producer producer;
+    // Only flush the batches when they are full
+    ASSERT_EQ(ResultOk, client.createProducer("topic",
+                                              ProducerConfiguration()
+                                                  .setBatchingMaxMessages(100)
+                                                  .setBatchingMaxPublishDelayMs(60 * 1000),
+                                              producer));
+
+    constexpr int numMessages = 1000;
+    for (int i = 0; i < numMessages; i++) {
+        producer.sendAsync(MessageBuilder().setContent("msg-" + std::to_string(i)).build(), nullptr);
+    }
+    ASSERT_EQ(ResultOk, producer.flush());
+
+    // The single messages of the batches are deserialized when they are received
+    for (int i = 0; i < numMessages; i++) {
+        Message msg;
+        if (i % 2 == 0) {
+            ASSERT_EQ(ResultOk, consumer.receive(msg, 3000));
+        } else {
+            Promise<Result, Message> promise;
+            consumer.receiveAsync(WaitForCallbackValue<Message>(promise));
+            ASSERT_EQ(ResultOk, promise.getFuture().get(msg));
+        }
+        ASSERT_EQ(msg.getDataAsString(), "msg-" + std::to_string(i));
+        ASSERT_EQ(msg.getMessageId().batchIndex(), i % 100);
+        ASSERT_EQ(msg.getMessageId().batchSize(), 100);
+    }
+    client.close();
+}
+
+TEST(ConsumerTest, testReceivePartiallyAcknowledgedBatch) {
+    StandInBroker<ASIO::ip::tcp> broker(ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 0);
+    Client client("pulsar://127.0.0.1:" + std::to_string(broker.endpoint().port()));
+    Consumer consumer;
+    ASSERT_EQ(ResultOk, client.subscribe("topic", "sub", consumer));
+    // The reader starts after the 5th message of the first batch, which is entry 0 of ledger 0
+    Reader reader;
+    const auto startMessageId = MessageIdBuilder().ledgerId(0).entryId(0).batchIndex(4).build();
+    ASSERT_EQ(ResultOk, client.createReader("topic", startMessageId, ReaderConfiguration(), reader));
+    Producer producer;
+    ASSERT_EQ(ResultOk, client.createProducer("topic",
+                                              ProducerConfiguration()
+                                                  .setBatchingMaxMessages(10)
+                                                  .setBatchingMaxPublishDelayMs(60 * 1000),
+                                              producer));
+
+    // Only the odd indexes are not acknowledged yet
+    broker.setAckSet({0x2AA});
+    constexpr int batchSize = 10;
+    for (int i = 0; i < batchSize; i++) {
+        producer.sendAsync(MessageBuilder().setContent("msg-" + std::to_string(i)).build(), nullptr);
+    }
+    ASSERT_EQ(ResultOk, producer.flush());
+
+    // The receiver queue only counts the single messages that are delivered
+    auto consumerImpl = PulsarFriend::getConsumerImplPtr(consumer);
+    ASSERT_TRUE(waitUntil(std::chrono::seconds(3),
+                          [&consumerImpl] { return consumerImpl->getNumOfPrefetchedMessages() == 5; }));
+    for (int i = 1; i < batchSize; i += 2) {
+        Message msg;
+        ASSERT_EQ(ResultOk, consumer.receive(msg, 3000));
+        ASSERT_EQ(msg.getDataAsString(), "msg-" + std::to_string(i));
+        ASSERT_EQ(msg.getMessageId().batchIndex(), i);
+        ASSERT_EQ(msg.getMessageId().batchSize(), batchSize);
+    }
+    Message msg;
+    ASSERT_EQ(ResultTimeout, consumer.receive(msg, 100));
+
+    // The reader skips the acknowledged messages and the ones before its start message id
+    auto readerConsumerImpl = PulsarFriend::getConsumer(reader);
+    ASSERT_TRUE(waitUntil(std::chrono::seconds(3), [&readerConsumerImpl] {
+        return readerConsumerImpl->getNumOfPrefetchedMessages() == 3;
+    }));
+    for (int i = 5; i < batchSize; i += 2) {
+        ASSERT_EQ(ResultOk, reader.readNext(msg, 3000));
+        ASSERT_EQ(msg.getDataAsString(), "msg-" + std::to_string(i));
+        ASSERT_EQ(msg.getMessageId().batchIndex(), i);
+    }
+    ASSERT_EQ(ResultTimeout, reader.readNext(msg, 100));
+    client.close();
+}
+
+TEST(ConsumerTest, testBatchMessageListener) {
+    StandInBroker<ASIO::ip::tcp> broker(ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 0);
+    Client client("pulsar://127.0.0.1:" + std::to_string(broker.endpoint().port()));
+
+    std::mutex mutex;
+    std::vector<std::string> values;
+    size_t maxNumMessages = 0;
+    ConsumerConfiguration conf;
+    conf.setBatchMessageListener([&](Consumer& consumer, const Messages& msgs) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& msg : msgs) {
+            values.emplace_back(msg.getDataAsString());
+        }
+        maxNumMessages = std::max(maxNumMessages, msgs.size());
+    });
+    Consumer consumer;
+    ASSERT_EQ(ResultOk, client.subscribe("topic", "sub", conf, consumer));
+    Producer producer;
+    ASSERT_EQ(ResultOk,
+              client.createProducer("topic", ProducerConfiguration().setBatchingMaxMessages(100), producer));
+
+    constexpr int numMessages = 1000;
+    for (int i = 0; i < numMessages; i++) {
+        producer.sendAsync(MessageBuilder().setContent("msg-" + std::to_string(i)).build(), nullptr);
+    }
+    ASSERT_EQ(ResultOk, producer.flush());
+
+    ASSERT_TRUE(waitUntil(std::chrono::seconds(3), [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return values.size() >= numMessages;
+    }));
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(values.size(), numMessages);
+    for (int i = 0; i < numMessages; i++) {
+        ASSERT_EQ(values[i], "msg-" + std::to_string(i));
+    }
+    // The messages of a batch are delivered together
+    ASSERT_GT(maxNumMessages, 1);
+    client.close();
+}
+
+TEST(ConsumerTest, testMessageListenerLanes) {
+    StandInBroker<ASIO::ip::tcp> broker(ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 0);
+    ClientConfiguration clientConf;
+    clientConf.setMessageListenerThreads(4);
+    Client client("pulsar://127.0.0.1:" + std::to_string(broker.endpoint().port()), clientConf);
+
+    std::mutex mutex;
+    std::map<std::string, std::vector<std::string>> keyToValues;
+    std::set<std::thread::id> threadIds;
+    size_t numReceived = 0;
+    ConsumerConfiguration conf;
+    conf.setReceiverQueueSize(100);
+    conf.setMessageListenerLanes(4);
+    conf.setMessageListener([&](Consumer& consumer, const Message& msg) {
+        std::lock_guard<std::mutex> lock(mutex);
+        keyToValues[msg.getPartitionKey()].emplace_back(msg.getDataAsString());
+        threadIds.emplace(std::this_thread::get_id());
+        numReceived++;
+    });
+    Consumer consumer;
+    ASSERT_EQ(ResultOk, client.subscribe("topic", "sub", conf, consumer));
+    Producer producer;
+    ASSERT_EQ(ResultOk, client.createProducer("topic", producer));
+
+    constexpr int numKeys = 16;
+    constexpr int numMessages = 800;
+    for (int i = 0; i < numMessages; i++) {
+        producer.sendAsync(MessageBuilder()
+                               .setPartitionKey("key-" + std::to_string(i % numKeys))
+                               .setContent("msg-" + std::to_string(i))
+                               .build(),
+                           nullptr);
+    }
+    ASSERT_EQ(ResultOk, producer.flush());
+
+    ASSERT_TRUE(waitUntil(std::chrono::seconds(3), [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return numReceived >= numMessages;
+    }));
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(numReceived, numMessages);
+    // The messages of each key are delivered in order, while the keys are processed by different threads
+    for (int key = 0; key < numKeys; key++) {
+        const auto& values = keyToValues["key-" + std::to_string(key)];
+        ASSERT_EQ(values.size(), numMessages / numKeys);
+        for (size_t i = 0; i < values.size(); i++) {
+            ASSERT_EQ(values[i], "msg-" + std::to_string(i * numKeys + key));
+        }
+    }
+    ASSERT_GT(threadIds.size(), 1);
+    client.close();
+}
+
+TEST(ConsumerTest, testAutoScaledReceiverQueueSize) {
+    StandInBroker<ASIO::ip::tcp> broker(ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 0);
+    Client client("pulsar://127.0.0.1:" + std::to_string(broker.endpoint().port()));
+    ConsumerConfiguration conf;
+    conf.setReceiverQueueSize(1000);
+    conf.setAutoScaledReceiverQueueSizeEnabled(true);
+    conf.setMinReceiverQueueSize(2);
+    Consumer consumer;
+    ASSERT_EQ(ResultOk, client.subscribe("topic", "sub", conf, consumer));
+    Producer producer;
+    ASSERT_EQ(ResultOk, client.createProducer("topic", producer));
+
+    // Each message is consumed as soon as it arrives, so the receiver queue is empty at each refill
+    constexpr int numMessages = 100;
+    for (int i = 0; i < numMessages; i++) {
+        ASSERT_EQ(ResultOk, producer.send(MessageBuilder().setContent("msg-" + std::to_string(i)).build()));
+        Message msg;
+        ASSERT_EQ(ResultOk, consumer.receive(msg, 3000));
+        ASSERT_EQ(msg.getDataAsString(), "msg-" + std::to_string(i));
+    }
+
+    // The window starts at the min size and doubles at each refill, the consumed permits are refilled along
+    // with the growth: 2, 1 + 2, 2 + 4, 4 + 8...
+    auto flowPermits = broker.flowPermits();
+    ASSERT_GE(flowPermits.size(), 4);
+    ASSERT_EQ(flowPermits[0], 2);
+    ASSERT_EQ(flowPermits[1], 3);
+    ASSERT_EQ(flowPermits[2], 6);
+    ASSERT_EQ(flowPermits[3], 12);
+    client.close();
+}
+
+TEST(ConsumerTest, testAutoScaledReceiverQueueSizeOfPartitionedConsumer) {
+    StandInBroker<ASIO::ip::tcp> broker(ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 2);
+    Client client("pulsar://127.0.0.1:" + std::to_string(broker.endpoint().port()));
+    ConsumerConfiguration conf;
+    conf.setReceiverQueueSize(1000);
+    conf.setAutoScaledReceiverQueueSizeEnabled(true);
+    conf.setMinReceiverQueueSize(2);
+    Consumer consumer;
+    ASSERT_EQ(ResultOk, client.subscribe("topic", "sub", conf, consumer));
+    Producer producer;
+    ProducerConfiguration producerConf;
+    producerConf.setBatchingEnabled(false);
+    ASSERT_EQ(ResultOk, client.createProducer("topic", producerConf, producer));
+
+    constexpr int numMessages = 200;
+    for (int i = 0; i < numMessages; i++) {
+        producer.sendAsync(MessageBuilder().setContent("msg-" + std::to_string(i)).build(), nullptr);
+    }
+    ASSERT_EQ(ResultOk, producer.flush());
+
+    // The messages of the partitions wait in the queue of the partitioned consumer, so the consumers of the
+    // partitions are not starved at their refills even if their own queues are empty
+    for (int i = 0; i < numMessages; i++) {
+        Message msg;
+        ASSERT_EQ(ResultOk, consumer.receive(msg, 3000));
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    // The windows would double at each refill if the consumers of the partitions were starved
+    auto flowPermits = broker.flowPermits();
+    ASSERT_GE(flowPermits.size(), 4);
+    ASSERT_LT(*std::max_element(flowPermits.begin(), flowPermits.end()), 32);
+    client.close();
+}
+
 }  // namespace pulsar
@@ -0,0 +1,116 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "lib/FlatIdMap.h"
+
+using namespace pulsar;
+
+template <typename V>
+static std::map<uint64_t, V> toMap(const FlatIdMap<V>& flatMap) {
+    std::map<uint64_t, V> map;
+    for (const auto& kv : flatMap) {
+        EXPECT_TRUE(map.emplace(kv.first, kv.second).second);
+    }
+    return map;
+}
+
+TEST(FlatIdMapTest, testBasicOperations) {
+    FlatIdMap<std::string> map;
+    ASSERT_TRUE(map.empty());
+    ASSERT_TRUE(map.find(0) == map.end());
+    ASSERT_EQ(map.erase(0), 0);
+
+    ASSERT_TRUE(map.emplace(1, "a").second);
+    ASSERT_TRUE(map.insert(std::make_pair(2, std::string("b"))).second);
+    auto result = map.emplace(1, "c");
+    ASSERT_FALSE(result.second);
+    ASSERT_EQ(result.first->second, "a");
+    ASSERT_EQ(map.size(), 2);
+
+    auto it = map.find(2);
+    ASSERT_TRUE(it != map.end());
+    it->second = "d";
+    ASSERT_EQ(map.find(2)->second, "d");
+
+    map.erase(it);
+    ASSERT_TRUE(map.find(2) == map.end());
+    ASSERT_EQ(map.erase(1), 1);
+    ASSERT_TRUE(map.empty());
+    ASSERT_TRUE(map.begin() == map.end());
+}
+
+TEST(FlatIdMapTest, testMove) {
+    FlatIdMap<std::unique_ptr<int>> map;
+    for (int i = 0; i < 100; i++) {
+        map.emplace(i, new int(i));
+    }
+    auto moved = std::move(map);
+    ASSERT_EQ(moved.size(), 100);
+    ASSERT_EQ(*moved.find(99)->second, 99);
+
+    // The moved map can still be used
+    ASSERT_TRUE(map.empty());
+    ASSERT_TRUE(map.find(99) == map.end());
+    map.emplace(1, new int(1));
+    ASSERT_EQ(*map.find(1)->second, 1);
+}
+
+TEST(FlatIdMapTest, testSequentialIds) {
+    // Like the request ids: inserted in order and mostly removed in the same order
+    FlatIdMap<uint64_t> map;
+    std::map<uint64_t, uint64_t> expected;
+    for (uint64_t id = 0; id < 10000; id++) {
+        map.emplace(id, id * 2);
+        expected.emplace(id, id * 2);
+        if (id >= 100 && id % 3 != 0) {
+            ASSERT_EQ(map.erase(id - 100), 1);
+            expected.erase(id - 100);
+        }
+    }
+    ASSERT_EQ(map.size(), expected.size());
+    ASSERT_EQ(toMap(map), expected);
+}
+
+TEST(FlatIdMapTest, testRandomOperations) {
+    FlatIdMap<int> map;
+    std::map<uint64_t, int> expected;
+    std::mt19937_64 random(42);
+    for (int i = 0; i < 100000; i++) {
+        // A small key space so that the same keys are inserted and erased many times
+        const uint64_t key = random() % 512;
+        if (random() % 2 == 0) {
+            ASSERT_EQ(map.emplace(key, i).second, expected.emplace(key, i).second);
+        } else {
+            ASSERT_EQ(map.erase(key), expected.erase(key));
+        }
+        ASSERT_EQ(map.size(), expected.size());
+    }
+    ASSERT_EQ(toMap(map), expected);
+    for (const auto& kv : expected) {
+        auto it = map.find(kv.first);
+        ASSERT_TRUE(it != map.end());
+        ASSERT_EQ(it->second, kv.second);
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "lib/InlineFunction.h"
+
+using namespace pulsar;
+
+using Function = InlineFunction<int(int), 32>;
+
+static int addOne(int x) { return x + 1; }
+
+TEST(InlineFunctionTest, testEmpty) {
+    Function empty;
+    ASSERT_FALSE(empty);
+    ASSERT_THROW(empty(0), std::bad_function_call);
+
+    ASSERT_FALSE(Function{nullptr});
+    ASSERT_FALSE(Function{std::function<int(int)>{}});
+    int (*nullFunction)(int) = nullptr;
+    ASSERT_FALSE(Function{nullFunction});
+}
+
+TEST(InlineFunctionTest, testInvoke) {
+    ASSERT_EQ(Function{&addOne}(1), 2);
+    ASSERT_EQ(Function{std::function<int(int)>(addOne)}(2), 3);
+
+    const int base = 10;
+    const Function function{[base](int x) { return base + x; }};
+    ASSERT_TRUE(function);
+    ASSERT_EQ(function(5), 15);
+
+    // The callable can modify its state like the target of a std::function
+    Function counter{[count = 0](int x) mutable { return count += x; }};
+    ASSERT_EQ(counter(1), 1);
+    ASSERT_EQ(counter(2), 3);
+}
+
+TEST(InlineFunctionTest, testCopyAndMove) {
+    auto value = std::make_shared<int>(1);
+    Function function{[value](int x) { return *value + x; }};
+    ASSERT_EQ(value.use_count(), 2);
+
+    Function copy{function};
+    ASSERT_EQ(value.use_count(), 3);
+    ASSERT_EQ(copy(1), 2);
+
+    Function moved{std::move(function)};
+    ASSERT_FALSE(function);
+    ASSERT_EQ(value.use_count(), 3);
+    ASSERT_EQ(moved(2), 3);
+
+    copy = moved;
+    ASSERT_EQ(value.use_count(), 3);
+    copy = std::move(moved);
+    ASSERT_FALSE(moved);
+    ASSERT_EQ(value.use_count(), 2);
+
+    copy = nullptr;
+    ASSERT_FALSE(copy);
+    ASSERT_EQ(value.use_count(), 1);
+
+    copy = Function{&addOne};
+    ASSERT_EQ(copy(3), 4);
+}
+
+TEST(InlineFunctionTest, testArgumentsAreForwarded) {
+    InlineFunction<size_t(const std::string&, std::unique_ptr<int>), 16> function{
+        [](const std::string& s, std::unique_ptr<int> p) { return s.size() + *p; }};
+    ASSERT_EQ(function("abc", std::unique_ptr<int>(new int(2))), 5);
+}
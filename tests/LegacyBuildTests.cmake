@@ -65,6 +65,10 @@ if (UNIX)
     target_link_libraries(ConnectionFailTest ${CLIENT_LIBS} pulsarStatic ${GTEST_LIBRARY_PATH})
 endif ()
 
+add_executable(ProducerAllocationTest allocation/ProducerAllocationTest.cc)
+target_include_directories(ProducerAllocationTest PRIVATE ${AUTOGEN_DIR}/lib)
+target_link_libraries(ProducerAllocationTest ${CLIENT_LIBS} pulsarStatic ${GTEST_LIBRARY_PATH})
+
 add_executable(BrokerMetadataTest brokermetadata/BrokerMetadataTest.cc)
 target_link_libraries(BrokerMetadataTest ${CLIENT_LIBS} pulsarStatic ${GTEST_LIBRARY_PATH})
 
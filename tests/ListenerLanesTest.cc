@@ -0,0 +1,142 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+#include <pulsar/MessageBuilder.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "WaitUtils.h"
+#include "lib/ListenerLanes.h"
+
+using namespace pulsar;
+
+static std::vector<ExecutorServicePtr> createExecutors(int numExecutors) {
+    std::vector<ExecutorServicePtr> executors;
+    for (int i = 0; i < numExecutors; i++) {
+        executors.emplace_back(ExecutorService::create());
+    }
+    return executors;
+}
+
+static void closeExecutors(const std::vector<ExecutorServicePtr>& executors) {
+    for (auto&& executor : executors) {
+        executor->close();
+    }
+}
+
+TEST(ListenerLanesTest, testKeyOrdering) {
+    auto executors = createExecutors(4);
+    std::mutex mutex;
+    std::map<std::string, std::vector<std::string>> keyToValues;
+    std::set<std::thread::id> threadIds;
+    std::atomic_int numProcessed{0};
+    ListenerLanes lanes(
+        executors, 1000,
+        [&](std::vector<Message>& msgs) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto&& msg : msgs) {
+                keyToValues[msg.getOrderingKey()].emplace_back(msg.getDataAsString());
+            }
+            threadIds.emplace(std::this_thread::get_id());
+            numProcessed += msgs.size();
+        },
+        [] {});
+
+    constexpr int numKeys = 20;
+    constexpr int numMessages = 1000;
+    for (int i = 0; i < numMessages; i++) {
+        auto msg = MessageBuilder()
+                       .setOrderingKey("key-" + std::to_string(i % numKeys))
+                       .setContent("msg-" + std::to_string(i))
+                       .build();
+        auto lane = lanes.laneOf(msg);
+        ASSERT_EQ(lane, lanes.laneOf(msg));
+        lanes.push(lane, msg);
+    }
+    ASSERT_TRUE(waitUntil(std::chrono::seconds(3), [&] { return numProcessed.load() >= numMessages; }));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(keyToValues.size(), numKeys);
+    for (int key = 0; key < numKeys; key++) {
+        const auto& values = keyToValues["key-" + std::to_string(key)];
+        ASSERT_EQ(values.size(), numMessages / numKeys);
+        for (size_t i = 0; i < values.size(); i++) {
+            ASSERT_EQ(values[i], "msg-" + std::to_string(i * numKeys + key));
+        }
+    }
+    // The keys are spread over the lanes, which run on different executors
+    ASSERT_GT(threadIds.size(), 1);
+    closeExecutors(executors);
+}
+
+TEST(ListenerLanesTest, testPartitionKeyAndRoundRobin) {
+    auto executors = createExecutors(3);
+    ListenerLanes lanes(executors, 10, [](std::vector<Message>&) {}, [] {});
+    ASSERT_EQ(lanes.numLanes(), 3);
+
+    // The ordering key takes precedence over the partition key
+    auto orderingKeyMsg = MessageBuilder().setOrderingKey("key").setPartitionKey("other").build();
+    auto partitionKeyMsg = MessageBuilder().setPartitionKey("key").build();
+    ASSERT_EQ(lanes.laneOf(orderingKeyMsg), lanes.laneOf(partitionKeyMsg));
+
+    auto msg = MessageBuilder().setContent("msg").build();
+    for (size_t i = 0; i < 6; i++) {
+        ASSERT_EQ(lanes.laneOf(msg), i % 3);
+    }
+    closeExecutors(executors);
+}
+
+TEST(ListenerLanesTest, testBoundedLane) {
+    auto executors = createExecutors(2);
+    std::promise<void> promise;
+    auto future = promise.get_future().share();
+    std::atomic_int numProcessed{0};
+    std::atomic_int numCallbacks{0};
+    ListenerLanes lanes(
+        executors, 2,
+        [future, &numProcessed](std::vector<Message>& msgs) {
+            future.wait();
+            numProcessed += msgs.size();
+        },
+        [&numCallbacks] { numCallbacks++; });
+
+    auto msg = MessageBuilder().setOrderingKey("key").build();
+    const auto lane = lanes.laneOf(msg);
+    ASSERT_FALSE(lanes.isFull(lane));
+    lanes.push(lane, msg);
+    ASSERT_FALSE(lanes.isFull(lane));
+    lanes.push(lane, msg);
+    // The slots are still held while the messages are being processed
+    ASSERT_TRUE(lanes.isFull(lane));
+    ASSERT_FALSE(lanes.isFull(1 - lane));
+
+    promise.set_value();
+    ASSERT_TRUE(waitUntil(std::chrono::seconds(3), [&] { return numProcessed.load() == 2; }));
+    ASSERT_TRUE(waitUntil(std::chrono::seconds(3), [&] { return !lanes.isFull(lane); }));
+    ASSERT_GE(numCallbacks.load(), 1);
+    closeExecutors(executors);
+}
@@ -0,0 +1,97 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "lib/MpscQueue.h"
+
+using namespace pulsar;
+
+TEST(MpscQueueTest, testQueueOperations) {
+    MpscQueue<int> queue;
+    ASSERT_EQ(queue.front(), nullptr);
+    int value;
+    ASSERT_FALSE(queue.pop(value));
+
+    for (int i = 0; i < 10; i++) {
+        queue.push(i);
+    }
+    ASSERT_EQ(*queue.front(), 0);
+    queue.pop();
+    for (int i = 1; i < 10; i++) {
+        ASSERT_TRUE(queue.pop(value));
+        ASSERT_EQ(value, i);
+    }
+    ASSERT_EQ(queue.front(), nullptr);
+
+    queue.push(10);
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(value, 10);
+}
+
+TEST(MpscQueueTest, testReleaseElements) {
+    auto element = std::make_shared<int>(0);
+    {
+        MpscQueue<std::shared_ptr<int>> queue;
+        queue.push(element);
+        queue.push(element);
+        ASSERT_EQ(element.use_count(), 3);
+
+        // The popped element must not be retained by the node that becomes the stub node
+        queue.pop();
+        ASSERT_EQ(element.use_count(), 2);
+    }
+    ASSERT_EQ(element.use_count(), 1);
+}
+
+TEST(MpscQueueTest, testMultipleProducers) {
+    constexpr int numProducers = 4;
+    constexpr int numElements = 100000;
+    MpscQueue<std::pair<int, int>> queue;
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < numProducers; i++) {
+        producers.emplace_back([&queue, i] {
+            for (int j = 0; j < numElements; j++) {
+                queue.push(std::make_pair(i, j));
+            }
+        });
+    }
+
+    // The elements of each producer must be received in order
+    std::vector<int> nextValues(numProducers, 0);
+    int received = 0;
+    while (received < numProducers * numElements) {
+        std::pair<int, int> element;
+        if (!queue.pop(element)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(element.second, nextValues[element.first]);
+        nextValues[element.first]++;
+        received++;
+    }
+    for (auto&& producer : producers) {
+        producer.join();
+    }
+    ASSERT_EQ(queue.front(), nullptr);
+}
@@ -31,16 +31,21 @@ TEST(ProducerConfigurationTest, testDefaultConfig) {
     ASSERT_EQ(conf.getSendTimeout(), 30000);
     ASSERT_EQ(conf.getInitialSequenceId(), -1ll);
     ASSERT_EQ(conf.getCompressionType(), CompressionType::CompressionNone);
+    ASSERT_EQ(conf.getCompressionLevel(), 0);
+    ASSERT_EQ(conf.getAutoCompressionCpuBudget(), 0.0);
     ASSERT_EQ(conf.getMaxPendingMessages(), 1000);
     ASSERT_EQ(conf.getMaxPendingMessagesAcrossPartitions(), 50000);
     ASSERT_EQ(conf.getPartitionsRoutingMode(), ProducerConfiguration::UseSinglePartition);
     ASSERT_EQ(conf.getMessageRouterPtr(), MessageRoutingPolicyPtr{});
     ASSERT_EQ(conf.getHashingScheme(), ProducerConfiguration::BoostHash);
     ASSERT_EQ(conf.getBlockIfQueueFull(), false);
+    ASSERT_EQ(conf.getSpoolDirectory(), "");
+    ASSERT_EQ(conf.getSpoolMaxBytes(), 64 * 1024 * 1024);
     ASSERT_EQ(conf.getBatchingEnabled(), true);
     ASSERT_EQ(conf.getBatchingMaxMessages(), 1000);
     ASSERT_EQ(conf.getBatchingMaxAllowedSizeInBytes(), 128 * 1024);
     ASSERT_EQ(conf.getBatchingMaxPublishDelayMs(), 10);
+    ASSERT_EQ(conf.getBatchingLatencyTargetMs(), 0);
     ASSERT_EQ(conf.getBatchingType(), ProducerConfiguration::DefaultBatching);
     ASSERT_EQ(conf.getCryptoKeyReader(), CryptoKeyReaderPtr{});
     ASSERT_EQ(conf.getCryptoFailureAction(), ProducerCryptoFailureAction::FAIL);
@@ -82,6 +87,13 @@ TEST(ProducerConfigurationTest, testCustomConfig) {
     conf.setCompressionType(CompressionType::CompressionLZ4);
     ASSERT_EQ(conf.getCompressionType(), CompressionType::CompressionLZ4);
 
+    conf.setCompressionLevel(-4);
+    ASSERT_EQ(conf.getCompressionLevel(), -4);
+
+    conf.setAutoCompressionCpuBudget(2.5);
+    ASSERT_EQ(conf.getAutoCompressionCpuBudget(), 2.5);
+    ASSERT_THROW(conf.setAutoCompressionCpuBudget(-1), std::invalid_argument);
+
     conf.setMaxPendingMessages(2000);
     ASSERT_EQ(conf.getMaxPendingMessages(), 2000);
 
@@ -102,6 +114,11 @@ TEST(ProducerConfigurationTest, testCustomConfig) {
     conf.setBlockIfQueueFull(true);
     ASSERT_EQ(conf.getBlockIfQueueFull(), true);
 
+    conf.setSpoolDirectory("/tmp");
+    ASSERT_EQ(conf.getSpoolDirectory(), "/tmp");
+    conf.setSpoolMaxBytes(1024);
+    ASSERT_EQ(conf.getSpoolMaxBytes(), 1024);
+
     conf.setBatchingEnabled(false);
     ASSERT_EQ(conf.getBatchingEnabled(), false);
 
@@ -114,6 +131,9 @@ TEST(ProducerConfigurationTest, testCustomConfig) {
     conf.setBatchingMaxPublishDelayMs(1);
     ASSERT_EQ(conf.getBatchingMaxPublishDelayMs(), 1);
 
+    conf.setBatchingLatencyTargetMs(5);
+    ASSERT_EQ(conf.getBatchingLatencyTargetMs(), 5);
+
     conf.setBatchingType(ProducerConfiguration::KeyBasedBatching);
     ASSERT_EQ(conf.getBatchingType(), ProducerConfiguration::KeyBasedBatching);
 
@@ -0,0 +1,84 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "TemporaryDirectory.h"
+#include "lib/ProducerSpool.h"
+
+using namespace pulsar;
+
+static bool push(ProducerSpool& spool, uint64_t sequenceId, const std::string& payload) {
+    proto::MessageMetadata metadata;
+    metadata.set_producer_name("producer");
+    metadata.set_sequence_id(sequenceId);
+    metadata.set_publish_time(0);
+    return spool.push(metadata, SharedBuffer::copy(payload.data(), payload.size()));
+}
+
+static void pop(ProducerSpool& spool, uint64_t sequenceId, const std::string& payload) {
+    proto::MessageMetadata metadata;
+    SharedBuffer buffer;
+    spool.pop(metadata, buffer);
+    ASSERT_EQ(metadata.sequence_id(), sequenceId);
+    ASSERT_EQ(std::string(buffer.data(), buffer.readableBytes()), payload);
+}
+
+TEST(ProducerSpoolTest, testWrapAround) {
+    const std::string payload(100, 'a');
+    TemporaryDirectory directory;
+    ProducerSpool spool(directory.path(), 1000);
+    uint64_t numPushed = 0;
+    while (push(spool, numPushed, payload)) {
+        numPushed++;
+    }
+    ASSERT_GT(numPushed, 1);
+    ASSERT_EQ(spool.size(), numPushed);
+
+    // The space of the frames that have been read is reused before all the frames are read
+    uint64_t numPopped = 0;
+    for (int i = 0; i < 100; i++) {
+        pop(spool, numPopped, payload);
+        numPopped++;
+        ASSERT_TRUE(push(spool, numPushed, payload));
+        numPushed++;
+        ASSERT_FALSE(push(spool, numPushed, payload));
+    }
+    while (!spool.empty()) {
+        pop(spool, numPopped, payload);
+        numPopped++;
+    }
+    ASSERT_EQ(numPopped, numPushed);
+}
+
+TEST(ProducerSpoolTest, testFrameIsNotSplit) {
+    TemporaryDirectory directory;
+    ProducerSpool spool(directory.path(), 1000);
+    ASSERT_TRUE(push(spool, 0, std::string(400, 'a')));
+    ASSERT_TRUE(push(spool, 1, std::string(400, 'b')));
+    // Neither the end of the file nor the space of the frames that have not been read is enough
+    ASSERT_FALSE(push(spool, 2, std::string(400, 'c')));
+
+    pop(spool, 0, std::string(400, 'a'));
+    ASSERT_TRUE(push(spool, 2, std::string(400, 'c')));
+    pop(spool, 1, std::string(400, 'b'));
+    pop(spool, 2, std::string(400, 'c'));
+    ASSERT_TRUE(spool.empty());
+}
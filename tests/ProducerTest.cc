@@ -23,6 +23,9 @@
 
 #include "HttpHelper.h"
 #include "PulsarFriend.h"
+#include "StandInBroker.h"
+#include "TemporaryDirectory.h"
+#include "WaitUtils.h"
 #include "lib/Future.h"
 #include "lib/Latch.h"
 #include "lib/LogUtils.h"
@@ -714,4 +717,317 @@ TEST(ProducerTest, testLargeProperties) {
     client.close();
 }
 
+TEST(ProducerTest, testConcurrentSendAsyncOrder) {
+    StandInBroker<ASIO::ip::tcp> broker(ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 0);
+    Client client("pulsar://127.0.0.1:" + std::to_string(broker.endpoint().port()));
+    Producer producer;
+    ProducerConfiguration conf;
+    conf.setBatchingMaxMessages(100);
+    conf.setBlockIfQueueFull(true);
+    conf.setMaxPendingMessages(1000);
+    ASSERT_EQ(ResultOk, client.createProducer("topic", conf, producer));
+
+    constexpr int numThreads = 8;
+    constexpr int numMessagesPerThread = 2000;
+    std::vector<std::vector<MessageId>> messageIds(numThreads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; i++) {
+        threads.emplace_back([&producer, &messageIds, i] {
+            auto& ids = messageIds[i];
+            Latch latch(numMessagesPerThread);
+            for (int j = 0; j < numMessagesPerThread; j++) {
+                auto builder = MessageBuilder().setContent("msg-" + std::to_string(j));
+                if (j % 500 == 0) {
+                    // The delayed messages are not batched
+                    builder.setDeliverAfter(std::chrono::seconds(1));
+                }
+                producer.sendAsync(builder.build(), [&ids, &latch](Result result, const MessageId& id) {
+                    if (result == ResultOk) {
+                        ids.emplace_back(id);
+                    }
+                    latch.countdown();
+                });
+            }
+            latch.wait();
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& ids : messageIds) {
+        ASSERT_EQ(ids.size(), numMessagesPerThread);
+        for (size_t i = 1; i < ids.size(); i++) {
+            ASSERT_TRUE(ids[i - 1] < ids[i]) << ids[i - 1] << " " << ids[i];
+        }
+    }
+    ASSERT_EQ(broker.numSentMessages(), numThreads * numMessagesPerThread);
+    ASSERT_TRUE(broker.isSequenceIdOrdered());
+    client.close();
+}
+
+TEST(ProducerTest, testSendSameMessageTwice) {
+    StandInBroker<ASIO::ip::tcp> broker(ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 0);
+    Client client("pulsar://127.0.0.1:" + std::to_string(broker.endpoint().port()));
+    Producer producer;
+    ProducerConfiguration conf;
+    conf.setBatchingMaxMessages(100);
+    conf.setBlockIfQueueFull(true);
+    ASSERT_EQ(ResultOk, client.createProducer("topic", conf, producer));
+
+    // The second send is issued before the first message is drained into a batch
+    constexpr int numMessages = 1000;
+    Latch latch(numMessages * 2);
+    std::atomic_int numSucceeded{0};
+    std::atomic_int numRejected{0};
+    std::vector<Message> messages;
+    for (int i = 0; i < numMessages; i++) {
+        auto msg = MessageBuilder().setContent("msg-" + std::to_string(i)).build();
+        messages.emplace_back(msg);
+        for (int j = 0; j < 2; j++) {
+            producer.sendAsync(msg, [&latch, &numSucceeded, &numRejected](Result result, const MessageId&) {
+                if (result == ResultOk) {
+                    numSucceeded++;
+                } else if (result == ResultInvalidMessage) {
+                    numRejected++;
+                }
+                latch.countdown();
+            });
+        }
+    }
+    ASSERT_TRUE(latch.wait(std::chrono::seconds(5)));
+    ASSERT_EQ(numSucceeded, numMessages);
+    ASSERT_EQ(numRejected, numMessages);
+    for (const auto& msg : messages) {
+        ASSERT_GT(msg.getPublishTimestamp(), 0);
+    }
+    ASSERT_EQ(broker.numSentMessages(), numMessages);
+    client.close();
+}
+
+TEST(ProducerTest, testParallelCompressionOrder) {
+    StandInBroker<ASIO::ip::tcp> broker(ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 0);
+    Client client("pulsar://127.0.0.1:" + std::to_string(broker.endpoint().port()),
+                  ClientConfiguration().setCompressionThreads(4));
+    Producer producer;
+    ProducerConfiguration conf;
+    conf.setCompressionType(CompressionLZ4);
+    conf.setBatchingMaxMessages(10);
+    ASSERT_EQ(ResultOk, client.createProducer("topic", conf, producer));
+
+    constexpr int numMessages = 5000;
+    std::vector<MessageId> ids;
+    Latch latch(numMessages);
+    for (int i = 0; i < numMessages; i++) {
+        // The batches have different sizes so that they are encoded in different durations
+        auto builder = MessageBuilder().setContent(std::string(1 + (i % 7) * 1000, 'a' + i % 26));
+        if (i % 100 == 0) {
+            // The non-batched messages are sent after the batches that are being encoded
+            builder.setDeliverAfter(std::chrono::seconds(1));
+        }
+        producer.sendAsync(builder.build(), [&ids, &latch](Result result, const MessageId& id) {
+            if (result == ResultOk) {
+                ids.emplace_back(id);
+            }
+            latch.countdown();
+        });
+        if (i % 1000 == 999) {
+            ASSERT_EQ(ResultOk, producer.flush());
+        }
+    }
+    latch.wait();
+
+    ASSERT_EQ(ids.size(), numMessages);
+    for (size_t i = 1; i < ids.size(); i++) {
+        ASSERT_TRUE(ids[i - 1] < ids[i]) << ids[i - 1] << " " << ids[i];
+    }
+    ASSERT_EQ(broker.numSentMessages(), numMessages);
+    ASSERT_TRUE(broker.isSequenceIdOrdered());
+    client.close();
+}
+
+TEST(ProducerTest, testAdaptiveBatchingDelay) {
+    StandInBroker<ASIO::ip::tcp> broker(ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 0);
+    Client client("pulsar://127.0.0.1:" + std::to_string(broker.endpoint().port()));
+    Producer producer;
+    ProducerConfiguration conf;
+    conf.setBatchingMaxPublishDelayMs(3000);
+    conf.setBatchingLatencyTargetMs(5);
+    ASSERT_EQ(ResultOk, client.createProducer("topic", conf, producer));
+
+    // Nothing is in flight, so each message is sent without waiting for the max publish delay
+    for (int i = 0; i < 3; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        ASSERT_EQ(ResultOk, producer.send(MessageBuilder().setContent("msg-" + std::to_string(i)).build()));
+        ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+    }
+
+    // The batches of a burst wait for the latency target rather than the max publish delay
+    constexpr int numMessages = 1000;
+    Latch latch(numMessages);
+    std::atomic_int numFailures{0};
+    for (int i = 0; i < numMessages; i++) {
+        producer.sendAsync(MessageBuilder().setContent("msg").build(),
+                           [&latch, &numFailures](Result result, const MessageId&) {
+                               if (result != ResultOk) {
+                                   numFailures++;
+                               }
+                               latch.countdown();
+                           });
+    }
+    ASSERT_TRUE(latch.wait(std::chrono::seconds(2)));
+    ASSERT_EQ(numFailures, 0);
+    ASSERT_EQ(broker.numSentMessages(), numMessages + 3);
+    client.close();
+}
+
+TEST(ProducerTest, testAutoCompression) {
+    StandInBroker<ASIO::ip::tcp> broker(ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 0);
+    Client client("pulsar://127.0.0.1:" + std::to_string(broker.endpoint().port()),
+                  ClientConfiguration().setStatsIntervalInSeconds(3600));
+    Producer producer;
+    ProducerConfiguration conf;
+    conf.setBatchingMaxMessages(100);
+    // Large enough for any codec, so the best ratio wins
+    conf.setAutoCompressionCpuBudget(1e6);
+    ASSERT_EQ(ResultOk, client.createProducer("topic", conf, producer));
+
+    constexpr int numMessages = 1000;
+    Latch latch(numMessages);
+    std::atomic_int numFailures{0};
+    for (int i = 0; i < numMessages; i++) {
+        producer.sendAsync(MessageBuilder().setContent(std::string(1000, 'a' + i % 26)).build(),
+                           [&latch, &numFailures](Result result, const MessageId&) {
+                               if (result != ResultOk) {
+                                   numFailures++;
+                               }
+                               latch.countdown();
+                           });
+    }
+    ASSERT_TRUE(latch.wait(std::chrono::seconds(5)));
+    ASSERT_EQ(numFailures, 0);
+    ASSERT_EQ(broker.numSentMessages(), numMessages);
+
+    // The repeated characters are compressed by any codec, the choice is reported in the stats
+    auto stats = PulsarFriend::getProducerStatsPtr(producer);
+    ASSERT_NE(stats->getCompressionType(), CompressionNone);
+    client.close();
+}
+
+static void testBulkSendAsync(int numPartitions, bool batchingEnabled) {
+    StandInBroker<ASIO::ip::tcp> broker(ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0),
+                                        numPartitions);
+    Client client("pulsar://127.0.0.1:" + std::to_string(broker.endpoint().port()));
+    Producer producer;
+    ProducerConfiguration conf;
+    conf.setBatchingEnabled(batchingEnabled);
+    conf.setBatchingMaxMessages(100);
+    // The bulk has more messages than the queue could hold, so the spots are reserved in chunks
+    conf.setMaxPendingMessages(1000);
+    conf.setBlockIfQueueFull(true);
+    conf.setPartitionsRoutingMode(ProducerConfiguration::RoundRobinDistribution);
+    ASSERT_EQ(ResultOk, client.createProducer("topic", conf, producer));
+
+    constexpr int numMessages = 2500;
+    std::vector<Message> messages;
+    for (int i = 0; i < numMessages; i++) {
+        MessageBuilder builder;
+        builder.setContent("msg-" + std::to_string(i));
+        if (i == 1234) {
+            // It's sent individually, after the messages before it
+            builder.setDeliverAfter(std::chrono::milliseconds(100));
+        }
+        messages.emplace_back(builder.build());
+    }
+
+    Promise<Result, std::vector<MessageId>> promise;
+    std::atomic_int numCallbacks{0};
+    producer.sendAsync(std::move(messages),
+                       [&promise, &numCallbacks](Result result, const std::vector<MessageId>& messageIds) {
+                           numCallbacks++;
+                           if (result == ResultOk) {
+                               promise.setValue(messageIds);
+                           } else {
+                               promise.setFailed(result);
+                           }
+                       });
+    std::vector<MessageId> messageIds;
+    ASSERT_EQ(ResultOk, promise.getFuture().get(messageIds));
+    ASSERT_EQ(numCallbacks, 1);
+    ASSERT_EQ(messageIds.size(), numMessages);
+    for (const auto& messageId : messageIds) {
+        ASSERT_NE(messageId, MessageId());
+    }
+    ASSERT_EQ(broker.numSentMessages(), numMessages);
+    ASSERT_TRUE(broker.isSequenceIdOrdered());
+
+    // An empty bulk is completed immediately
+    Promise<Result, std::vector<MessageId>> emptyPromise;
+    producer.sendAsync(std::vector<Message>{},
+                       [&emptyPromise](Result result, const std::vector<MessageId>& messageIds) {
+                           emptyPromise.setValue(messageIds);
+                       });
+    ASSERT_EQ(ResultOk, emptyPromise.getFuture().get(messageIds));
+    ASSERT_TRUE(messageIds.empty());
+    client.close();
+}
+
+TEST(ProducerTest, testBulkSendAsync) {
+    testBulkSendAsync(0, true);
+    testBulkSendAsync(0, false);
+    testBulkSendAsync(3, true);
+}
+
+TEST(ProducerTest, testSpoolDuringBrokerOutage) {
+    // It outlives the producer, which removes its spool file when it's destroyed
+    TemporaryDirectory spoolDirectory;
+    using Broker = StandInBroker<ASIO::ip::tcp>;
+    std::unique_ptr<Broker> broker{
+        new Broker(ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 0)};
+    const auto endpoint = broker->endpoint();
+    Client client("pulsar://127.0.0.1:" + std::to_string(endpoint.port()));
+    Producer producer;
+    ProducerConfiguration conf;
+    conf.setBatchingMaxMessages(10);
+    // The queue is much smaller than the messages published during the outage
+    conf.setMaxPendingMessages(100);
+    conf.setSpoolDirectory(spoolDirectory.path());
+    ASSERT_EQ(ResultOk, client.createProducer("topic", conf, producer));
+    ASSERT_EQ(ResultOk, producer.send(MessageBuilder().setContent("msg").build()));
+
+    // Stop the broker
+    broker.reset();
+    ASSERT_TRUE(waitUntil(std::chrono::seconds(5), [&producer] { return !producer.isConnected(); }));
+
+    constexpr int numMessages = 5000;
+    Latch latch(numMessages);
+    std::atomic_int numFailures{0};
+    for (int i = 0; i < numMessages; i++) {
+        producer.sendAsync(MessageBuilder().setContent("msg-" + std::to_string(i)).build(),
+                           [&latch, &numFailures](Result result, const MessageId&) {
+                               if (result != ResultOk) {
+                                   numFailures++;
+                               }
+                               latch.countdown();
+                           });
+    }
+    // The messages are neither failed because the queue is full nor sent
+    ASSERT_FALSE(latch.wait(std::chrono::milliseconds(100)));
+    ASSERT_EQ(numFailures, 0);
+    // The parked ops still count against the memory limit
+    auto& memoryLimitController = PulsarFriend::getClientImplPtr(client)->getMemoryLimitController();
+    ASSERT_GT(memoryLimitController.currentUsage(), 0);
+    ASSERT_FALSE(spoolDirectory.empty());
+
+    // Restart the broker, the spooled messages are sent in order after the producer is reconnected
+    broker.reset(new Broker(endpoint, 0));
+    ASSERT_TRUE(latch.wait(std::chrono::seconds(10)));
+    ASSERT_EQ(numFailures, 0);
+    ASSERT_EQ(broker->numSentMessages(), numMessages);
+    ASSERT_TRUE(broker->isSequenceIdOrdered());
+    ASSERT_TRUE(waitUntil(std::chrono::seconds(1),
+                          [&memoryLimitController] { return memoryLimitController.currentUsage() == 0; }));
+    client.close();
+}
+
 INSTANTIATE_TEST_CASE_P(Pulsar, ProducerTest, ::testing::Values(true, false));
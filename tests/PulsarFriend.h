@@ -147,7 +147,7 @@ class PulsarFriend {
     static std::vector<ProducerImplPtr> getProducers(const ClientConnection& cnx) {
         std::vector<ProducerImplPtr> producers;
         std::lock_guard<std::mutex> lock(cnx.mutex_);
-        for (const auto& kv : cnx.producers_) {
+        for (const auto& kv : *cnx.producers_) {
             producers.emplace_back(kv.second.lock());
         }
         return producers;
@@ -156,7 +156,7 @@ class PulsarFriend {
     static std::vector<ConsumerImplPtr> getConsumers(const ClientConnection& cnx) {
         std::vector<ConsumerImplPtr> consumers;
         std::lock_guard<std::mutex> lock(cnx.mutex_);
-        for (const auto& kv : cnx.consumers_) {
+        for (const auto& kv : *cnx.consumers_) {
             consumers.emplace_back(kv.second.lock());
         }
         return consumers;
@@ -166,6 +166,15 @@ class PulsarFriend {
         consumer.impl_->setNegativeAcknowledgeEnabledForTesting(enabled);
     }
 
+    static Message newBatchedMessage(const MessageId& messageId, const SharedBuffer& payload,
+                                     int32_t batchSize) {
+        auto impl = std::make_shared<MessageImpl>();
+        impl->messageId = messageId;
+        impl->payload = payload;
+        impl->metadata.set_num_messages_in_batch(batchSize);
+        return Message(impl);
+    }
+
     static ClientConnectionWeakPtr getClientConnection(HandlerBase& handler) { return handler.connection_; }
 
     static std::string getConnectionPhysicalAddress(HandlerBase& handler) {
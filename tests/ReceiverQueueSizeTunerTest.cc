@@ -0,0 +1,129 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "lib/ReceiverQueueSizeTuner.h"
+
+using namespace pulsar;
+
+static constexpr std::chrono::seconds maxRoundTrip{30};
+
+TEST(ReceiverQueueSizeTunerTest, testGrowWhenStarved) {
+    ReceiverQueueSizeTuner tuner(1, 100, 0, maxRoundTrip, nullptr);
+    ASSERT_EQ(tuner.size(), 1);
+    ASSERT_EQ(tuner.onConnected(), 1);
+
+    int size = 1;
+    for (int i = 0; i < 6; i++) {
+        ASSERT_EQ(tuner.refillThreshold(), (size + 1) / 2);
+        // The consumed permits are refilled along with the growth of the window
+        ASSERT_EQ(tuner.onRefill(size, true), 2 * size);
+        size *= 2;
+        ASSERT_EQ(tuner.size(), size);
+    }
+    ASSERT_EQ(tuner.onRefill(64, true), 64 + 36);
+    ASSERT_EQ(tuner.size(), 100);
+    ASSERT_EQ(tuner.onRefill(100, true), 100);
+    ASSERT_EQ(tuner.size(), 100);
+}
+
+TEST(ReceiverQueueSizeTunerTest, testShrinkForSlowConsumer) {
+    ReceiverQueueSizeTuner tuner(2, 1000, 0, maxRoundTrip, nullptr);
+    tuner.onConnected();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    tuner.onMessageReceived(1, 100);
+    ASSERT_GT(tuner.roundTripNanos(), 0);
+    while (tuner.size() < 128) {
+        tuner.onRefill(tuner.size(), true);
+    }
+    // The last refill restarted the measurement of the round trip
+    tuner.onMessageReceived(1, 100);
+
+    // A few messages are consumed during a round trip, so the window halves at each refill
+    for (int i = 0; i < 10; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const int size = tuner.size();
+        const int consumed = tuner.refillThreshold();
+        const int permits = tuner.onRefill(consumed, false);
+        ASSERT_GE(permits, 0);
+        ASSERT_EQ(permits, consumed + tuner.size() - size);
+        ASSERT_LE(tuner.size(), size);
+    }
+    ASSERT_LT(tuner.size(), 128);
+    ASSERT_GE(tuner.size(), 2);
+}
+
+TEST(ReceiverQueueSizeTunerTest, testIdleTopic) {
+    ReceiverQueueSizeTuner tuner(1, 100, 0, std::chrono::milliseconds(100), nullptr);
+    // No message is published within the max round trip after the initial permits
+    tuner.onConnected();
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    tuner.onMessageReceived(1, 100);
+    ASSERT_EQ(tuner.roundTripNanos(), 0);
+
+    tuner.onRefill(1, true);
+    tuner.onMessageReceived(1, 100);
+    const auto roundTripNanos = tuner.roundTripNanos();
+    ASSERT_GT(roundTripNanos, 0);
+
+    // The next message is published long after the permits are sent
+    tuner.onRefill(1, true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    tuner.onMessageReceived(1, 100);
+    ASSERT_LE(tuner.roundTripNanos(), roundTripNanos * 9 / 8);
+}
+
+TEST(ReceiverQueueSizeTunerTest, testMaxBytes) {
+    ReceiverQueueSizeTuner tuner(1, 1000, 1000, maxRoundTrip, nullptr);
+    tuner.onConnected();
+    // 100 bytes per message on average
+    tuner.onMessageReceived(10, 1000);
+    for (int i = 0; i < 10; i++) {
+        tuner.onRefill(tuner.size(), true);
+    }
+    ASSERT_EQ(tuner.size(), 10);
+}
+
+TEST(ReceiverQueueSizeTunerTest, testSharedBudget) {
+    auto budget = std::make_shared<ReceiverQueueSizeTuner::Budget>(10);
+    std::unique_ptr<ReceiverQueueSizeTuner> tuner1(
+        new ReceiverQueueSizeTuner(1, 100, 0, maxRoundTrip, budget));
+    ReceiverQueueSizeTuner tuner2(1, 100, 0, maxRoundTrip, budget);
+    ASSERT_EQ(budget->load(), 8);
+
+    for (int i = 0; i < 10; i++) {
+        tuner1->onRefill(tuner1->size(), true);
+    }
+    ASSERT_EQ(tuner1->size(), 9);
+    ASSERT_EQ(budget->load(), 0);
+
+    // The min size is always granted, but the window can't grow without the budget
+    ASSERT_EQ(tuner2.onRefill(1, true), 1);
+    ASSERT_EQ(tuner2.size(), 1);
+
+    tuner1.reset();
+    ASSERT_EQ(budget->load(), 9);
+    ASSERT_EQ(tuner2.onRefill(1, true), 2);
+    ASSERT_EQ(tuner2.size(), 2);
+    ASSERT_EQ(budget->load(), 8);
+}
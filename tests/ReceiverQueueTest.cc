@@ -0,0 +1,166 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+#include <pulsar/MessageBuilder.h>
+#include <pulsar/MessageIdBuilder.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PulsarFriend.h"
+#include "lib/BatchMessageAcker.h"
+#include "lib/Commands.h"
+#include "lib/ReceiverQueue.h"
+
+using namespace pulsar;
+
+static Message newBatchedMessage(int32_t batchSize) {
+    std::vector<Message> messages;
+    for (int32_t i = 0; i < batchSize; i++) {
+        messages.emplace_back(MessageBuilder().setContent("msg-" + std::to_string(i)).build());
+    }
+    SharedBuffer payload;
+    Commands::serializeSingleMessagesToBatchPayload(payload, messages);
+    auto messageId = MessageIdBuilder().ledgerId(1L).entryId(2L).build();
+    return PulsarFriend::newBatchedMessage(messageId, payload, batchSize);
+}
+
+static std::unique_ptr<BatchEntry> newBatchEntry(const Message& batchedMessage, int32_t batchSize,
+                                                 BitSet deliverable) {
+    return std::unique_ptr<BatchEntry>{new BatchEntry(batchedMessage, std::move(deliverable), 0, SchemaInfo{},
+                                                      BatchMessageAckerImpl::create(batchSize))};
+}
+
+TEST(ReceiverQueueTest, testSkipUndeliverableMessages) {
+    constexpr int32_t batchSize = 5;
+    auto batchedMessage = newBatchedMessage(batchSize);
+    BitSet deliverable(batchSize);
+    deliverable.set(0, batchSize);
+    deliverable.clear(1);
+    deliverable.clear(3);
+
+    ReceiverQueue queue;
+    queue.push(newBatchEntry(batchedMessage, batchSize, deliverable));
+    ASSERT_EQ(queue.size(), 3);
+    ASSERT_EQ(queue.bytes(), batchedMessage.getLength());
+
+    // The batch payload of the batched message must not be consumed by the queue
+    for (int i = 0; i < 2; i++) {
+        std::vector<int32_t> batchIndexes;
+        std::vector<std::string> values;
+        auto entry = newBatchEntry(batchedMessage, batchSize, deliverable);
+        while (!entry->empty()) {
+            auto msg = entry->pop();
+            batchIndexes.emplace_back(msg.getMessageId().batchIndex());
+            values.emplace_back(msg.getDataAsString());
+        }
+        ASSERT_EQ(batchIndexes, (std::vector<int32_t>{0, 2, 4}));
+        ASSERT_EQ(values, (std::vector<std::string>{"msg-0", "msg-2", "msg-4"}));
+    }
+
+    Message msg;
+    for (int32_t batchIndex : {0, 2, 4}) {
+        ASSERT_TRUE(queue.pop(msg, std::chrono::milliseconds(0)));
+        ASSERT_EQ(msg.getMessageId().batchIndex(), batchIndex);
+        ASSERT_EQ(msg.getMessageId().batchSize(), batchSize);
+        ASSERT_EQ(msg.getDataAsString(), "msg-" + std::to_string(batchIndex));
+    }
+    ASSERT_TRUE(queue.empty());
+    ASSERT_EQ(queue.size(), 0);
+    ASSERT_EQ(queue.bytes(), 0);
+    ASSERT_FALSE(queue.pop(msg, std::chrono::milliseconds(0)));
+}
+
+TEST(ReceiverQueueTest, testBatchEntriesAndSingleMessages) {
+    constexpr int32_t batchSize = 3;
+    auto batchedMessage = newBatchedMessage(batchSize);
+    BitSet deliverable(batchSize);
+    deliverable.set(0, batchSize);
+
+    ReceiverQueue queue;
+    queue.push(MessageBuilder().setContent("single").build());
+    queue.push(newBatchEntry(batchedMessage, batchSize, deliverable));
+    ASSERT_EQ(queue.size(), 4);
+
+    Message msg;
+    ASSERT_TRUE(queue.pop(msg));
+    ASSERT_EQ(msg.getDataAsString(), "single");
+
+    // The message peeked by popIf is kept at the front if it's not popped
+    auto isFirstMessage = [](const Message& peekMsg) { return peekMsg.getDataAsString() == "msg-0"; };
+    ASSERT_FALSE(queue.popIf(msg, [&](const Message& peekMsg) { return !isFirstMessage(peekMsg); }));
+    ASSERT_EQ(queue.size(), 3);
+    ASSERT_TRUE(queue.popIf(msg, isFirstMessage));
+    ASSERT_EQ(msg.getDataAsString(), "msg-0");
+
+    ASSERT_TRUE(queue.peekAndClear(msg));
+    ASSERT_EQ(msg.getMessageId().batchIndex(), 1);
+    ASSERT_EQ(queue.size(), 0);
+    ASSERT_EQ(queue.bytes(), 0);
+    ASSERT_FALSE(queue.peekAndClear(msg));
+}
+
+TEST(ReceiverQueueTest, testClose) {
+    ReceiverQueue queue;
+    Message msg;
+    ASSERT_FALSE(queue.pop(msg, std::chrono::milliseconds(10)));
+
+    queue.push(MessageBuilder().setContent("msg").build());
+    queue.close();
+    ASSERT_FALSE(queue.pop(msg));
+}
+
+TEST(ReceiverQueueTest, testSpinAndPark) {
+    constexpr int numMessages = 10000;
+    for (auto spinTime : {std::chrono::microseconds(0), std::chrono::microseconds(100)}) {
+        ReceiverQueue queue(spinTime);
+        std::thread producer([&queue] {
+            for (int i = 0; i < numMessages; i++) {
+                queue.push(MessageBuilder().setContent(std::to_string(i)).build());
+                if (i % 100 == 0) {
+                    // Let the receiver park on the empty queue
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        });
+
+        Message msg;
+        for (int i = 0; i < numMessages; i++) {
+            ASSERT_TRUE(queue.pop(msg, std::chrono::seconds(3)));
+            ASSERT_EQ(msg.getDataAsString(), std::to_string(i));
+        }
+        producer.join();
+        ASSERT_TRUE(queue.empty());
+        ASSERT_EQ(queue.bytes(), 0);
+    }
+}
+
+TEST(ReceiverQueueTest, testCloseWakeUpParkedReceiver) {
+    ReceiverQueue queue;
+    Message msg;
+    std::thread closer([&queue] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        queue.close();
+    });
+    ASSERT_FALSE(queue.pop(msg));
+    closer.join();
+}
@@ -129,6 +129,38 @@ TEST(SemaphoreTest, testSingleRelease) {
     t3.join();
 }
 
+TEST(SemaphoreTest, testSingleReleaseWithBulkWaiter) {
+    Semaphore s(100);
+    s.acquire(100);
+
+    Latch bulkLatch(1);
+    std::thread bulkThread([&]() {
+        s.acquire(10);
+        bulkLatch.countdown();
+    });
+    ASSERT_FALSE(bulkLatch.wait(std::chrono::milliseconds(100)));
+
+    Latch singleLatch(1);
+    std::thread singleThread([&]() {
+        s.acquire();
+        singleLatch.countdown();
+    });
+    ASSERT_FALSE(singleLatch.wait(std::chrono::milliseconds(100)));
+
+    // The released permit is not enough for the bulk waiter, which must not swallow the notification
+    s.release(1);
+    ASSERT_TRUE(singleLatch.wait(std::chrono::seconds(1)));
+    ASSERT_FALSE(bulkLatch.wait(std::chrono::milliseconds(100)));
+    ASSERT_EQ(s.currentUsage(), 100);
+
+    s.release(10);
+    ASSERT_TRUE(bulkLatch.wait(std::chrono::seconds(1)));
+    ASSERT_EQ(s.currentUsage(), 100);
+
+    bulkThread.join();
+    singleThread.join();
+}
+
 TEST(SemaphoreTest, testCloseInterruptOnFull) {
     Semaphore s(100);
     s.acquire(100);
@@ -70,6 +70,20 @@ TEST(ServiceURITest, testMultipleHostsWithoutPulsarPorts) {
                      {"https://host1:8081", "https://host2:8081", "https://host3:8081"});
 }
 
+TEST(ServiceURITest, testUnixSocketPaths) {
+    verifyServiceURI("pulsar+unix:///var/run/pulsar.sock", PulsarScheme::PULSAR_UNIX,
+                     {"pulsar+unix:///var/run/pulsar.sock"});
+    verifyServiceURI("pulsar+unix:///tmp/a.sock,/tmp/b.sock", PulsarScheme::PULSAR_UNIX,
+                     {"pulsar+unix:///tmp/a.sock", "pulsar+unix:///tmp/b.sock"});
+    verifyServiceURIFailure("pulsar+unix://", "No service url is provided yet");
+    verifyServiceURIFailure("pulsar+unix://localhost:6650", "invalid unix socket path: localhost:6650");
+    verifyServiceURIFailure("pulsar+unix:///", "invalid unix socket path: /");
+
+    ASSERT_TRUE(scheme::isUnixSocketAddress("pulsar+unix:///tmp/a.sock"));
+    ASSERT_FALSE(scheme::isUnixSocketAddress("pulsar://localhost:6650"));
+    ASSERT_EQ(scheme::getUnixSocketPath("pulsar+unix:///tmp/a.sock"), "/tmp/a.sock");
+}
+
 TEST(ServiceURITest, testMultipleHostsMixed) {
     verifyServiceURI("pulsar://host1:6640,host2,host3:6660/path/to/namespace", PulsarScheme::PULSAR,
                      {"pulsar://host1:6640", "pulsar://host2:6650", "pulsar://host3:6660"});
@@ -0,0 +1,123 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "lib/SharedBufferPool.h"
+
+using namespace pulsar;
+
+TEST(SharedBufferPoolTest, testReleaseLastSlice) {
+    auto pool = SharedBufferPool::create(1024, 1024, 2048);
+    auto buffer = pool->acquire();
+    ASSERT_EQ(buffer.writableBytes(), 1024);
+    const char* memory = buffer.data();
+
+    const std::string value = "hello world";
+    buffer.write(value.c_str(), value.size());
+    auto slice1 = buffer.slice(0, 5);
+    auto slice2 = buffer.slice(6);
+    buffer = SharedBuffer();
+    ASSERT_EQ(pool->numIdleBuffers(), 0);
+
+    slice1 = SharedBuffer();
+    ASSERT_EQ(pool->numIdleBuffers(), 0);
+    ASSERT_EQ(std::string(slice2.data(), slice2.readableBytes()), "world");
+
+    slice2 = SharedBuffer();
+    ASSERT_EQ(pool->numIdleBuffers(), 1);
+
+    // The same memory is reused
+    buffer = pool->acquire();
+    ASSERT_EQ(buffer.data(), memory);
+    ASSERT_EQ(buffer.readableBytes(), 0);
+    ASSERT_EQ(buffer.writableBytes(), 1024);
+    ASSERT_EQ(pool->numIdleBuffers(), 0);
+
+    const auto stats = pool->getStats();
+    ASSERT_EQ(stats.hits, 1);
+    ASSERT_EQ(stats.misses, 1);
+    ASSERT_EQ(stats.oversized, 0);
+}
+
+TEST(SharedBufferPoolTest, testSizeClasses) {
+    // Size classes: 1024, 2048, 4096
+    auto pool = SharedBufferPool::create(1024, 4096, 2048);
+    ASSERT_EQ(pool->acquire(0).capacity(), 1024);
+    ASSERT_EQ(pool->acquire(1024).capacity(), 1024);
+    ASSERT_EQ(pool->acquire(1025).capacity(), 2048);
+    ASSERT_EQ(pool->acquire(4000).capacity(), 4096);
+    ASSERT_EQ(pool->acquire(5000).capacity(), 5000);
+
+    // At most 2048 bytes per size class are kept, but at least one buffer
+    ASSERT_EQ(pool->numIdleBuffers(), 3);
+    {
+        auto buffer1 = pool->acquire(1024);
+        auto buffer2 = pool->acquire(1024);
+        auto buffer3 = pool->acquire(1024);
+        auto buffer4 = pool->acquire(4096);
+        auto buffer5 = pool->acquire(4096);
+    }
+    ASSERT_EQ(pool->numIdleBuffers(), 2 + 1 + 1);
+
+    const auto stats = pool->getStats();
+    ASSERT_EQ(stats.hits, 3);
+    ASSERT_EQ(stats.misses, 6);
+    ASSERT_EQ(stats.oversized, 1);
+
+    auto copied = pool->copyFrom(SharedBuffer::copy("abc", 3), 2000);
+    ASSERT_EQ(std::string(copied.data(), copied.readableBytes()), "abc");
+    ASSERT_EQ(copied.writableBytes(), 2048 - 3);
+}
+
+TEST(SharedBufferPoolTest, testReleaseAfterPoolDestroyed) {
+    auto pool = SharedBufferPool::create(1024, 1024, 1024);
+    auto buffer = pool->copyFrom(SharedBuffer::copy("abc", 3), 3);
+    pool.reset();
+    ASSERT_EQ(std::string(buffer.data(), buffer.readableBytes()), "abc");
+    buffer = SharedBuffer();
+}
+
+TEST(SharedBufferPoolTest, testAdaptiveReadSize) {
+    AdaptiveReadSize readSize(1024, 8192);
+    ASSERT_EQ(readSize.next(), 1024);
+
+    // Grow as soon as a read fills the buffer
+    readSize.record(1024, 1024);
+    ASSERT_EQ(readSize.next(), 2048);
+    readSize.record(2048, 2048);
+    readSize.record(4096, 4096);
+    ASSERT_EQ(readSize.next(), 8192);
+    readSize.record(8192, 8192);
+    ASSERT_EQ(readSize.next(), 8192);
+
+    // Shrink after two consecutive small reads
+    readSize.record(100, 8192);
+    ASSERT_EQ(readSize.next(), 8192);
+    readSize.record(5000, 8192);
+    readSize.record(100, 8192);
+    ASSERT_EQ(readSize.next(), 8192);
+    readSize.record(100, 8192);
+    ASSERT_EQ(readSize.next(), 4096);
+    for (int i = 0; i < 10; i++) {
+        readSize.record(10, 1024);
+    }
+    ASSERT_EQ(readSize.next(), 1024);
+}
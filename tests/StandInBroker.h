@@ -0,0 +1,362 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#pragma once
+
+#ifdef USE_ASIO
+#include <asio.hpp>
+#else
+#include <boost/asio.hpp>
+#endif
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lib/AsioDefines.h"
+#include "lib/PulsarApi.pb.h"
+
+namespace pulsar {
+
+/**
+ * A stand-in for the broker (or the proxy) that only answers the commands needed to exercise the
+ * connection, the producer and the consumer: CONNECT, PING, PARTITIONED_METADATA, LOOKUP, PRODUCER, SEND,
+ * CLOSE_PRODUCER, SUBSCRIBE, FLOW and CLOSE_CONSUMER. Each topic is reported with the same number of
+ * partitions, the lookups redirect to the service URL and the messages are acknowledged without being stored.
+ * Each message is dispatched to the consumers subscribed to its topic at the time it's sent, regardless of
+ * the flow permits and the acknowledgments. The flow permits are only recorded. An ack set could be attached
+ * to the dispatched messages, as the broker does for the batches that are partially acknowledged.
+ *
+ * The reads of all the connections can be paused so that the frames pile up on the client side, the type of
+ * each command received is recorded to check the order the frames are written by the client.
+ *
+ * The Protocol could be ASIO::ip::tcp or ASIO::local::stream_protocol, so that the transports can be
+ * compared without a real broker.
+ */
+template <typename Protocol>
+class StandInBroker {
+   public:
+    using Endpoint = typename Protocol::endpoint;
+
+    StandInBroker(const Endpoint& endpoint, int numPartitions)
+        : acceptor_(io_, endpoint), numPartitions_(numPartitions) {
+        accept();
+        thread_ = std::thread([this] { io_.run(); });
+    }
+
+    ~StandInBroker() {
+        io_.stop();
+        thread_.join();
+    }
+
+    Endpoint endpoint() const { return acceptor_.local_endpoint(); }
+
+    uint64_t numSentMessages() const noexcept { return numSentMessages_; }
+
+    // Whether the sequence ids of each producer have been received in the increasing order
+    bool isSequenceIdOrdered() const noexcept { return sequenceIdOrdered_; }
+
+    // The ack set attached to the messages dispatched from now on, where the set bits are the indexes of the
+    // single messages of a batch that are not acknowledged yet
+    void setAckSet(std::vector<int64_t> ackSet) {
+        std::lock_guard<std::mutex> lock(ackSetMutex_);
+        ackSet_ = std::move(ackSet);
+    }
+
+    // The receive buffer size of the sockets accepted from now on, a small buffer makes the client's writes
+    // block soon after the reads are paused
+    void setReceiveBufferSize(int receiveBufferSize) { receiveBufferSize_ = receiveBufferSize; }
+
+    // Stop reading the frames of all the connections, the frame being read is still handled
+    void pauseReading() {
+        runInIoThread([this] { readingPaused_ = true; });
+    }
+
+    void resumeReading() {
+        runInIoThread([this] {
+            readingPaused_ = false;
+            for (auto& session : pausedSessions_) {
+                session->readFrameSize();
+            }
+            pausedSessions_.clear();
+        });
+    }
+
+    // The type of each command received, with the producer id of the SEND commands, in order
+    std::vector<std::pair<proto::BaseCommand::Type, uint64_t>> receivedCommands() const {
+        std::lock_guard<std::mutex> lock(commandsMutex_);
+        return receivedCommands_;
+    }
+
+    // The permits of each FLOW command received, in order
+    std::vector<uint32_t> flowPermits() const {
+        std::lock_guard<std::mutex> lock(flowMutex_);
+        return flowPermits_;
+    }
+
+   private:
+    using Socket = typename Protocol::socket;
+
+    class Session : public std::enable_shared_from_this<Session> {
+       public:
+        Session(Socket&& socket, StandInBroker& broker) : socket_(std::move(socket)), broker_(broker) {}
+
+        void readFrameSize() {
+            auto self = this->shared_from_this();
+            if (broker_.readingPaused_) {
+                broker_.pausedSessions_.emplace_back(std::move(self));
+                return;
+            }
+            ASIO::async_read(socket_, ASIO::buffer(sizeBuffer_), [self](const ASIO_ERROR& err, size_t) {
+                if (!err) {
+                    self->frame_.resize(decodeUnsignedInt(self->sizeBuffer_.data()));
+                    self->readFrame();
+                }
+            });
+        }
+
+       private:
+        Socket socket_;
+        StandInBroker& broker_;
+        std::array<char, 4> sizeBuffer_;
+        std::vector<char> frame_;
+        std::unordered_map<uint64_t, int64_t> lastSequenceIds_;
+        std::unordered_map<uint64_t, std::string> producerTopics_;
+        uint64_t nextEntryId_ = 0;
+
+        static uint32_t decodeUnsignedInt(const char* data) {
+            const auto bytes = reinterpret_cast<const unsigned char*>(data);
+            return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+                   (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+        }
+
+        static void encodeUnsignedInt(std::string& buffer, uint32_t value) {
+            buffer.push_back(static_cast<char>(value >> 24));
+            buffer.push_back(static_cast<char>(value >> 16));
+            buffer.push_back(static_cast<char>(value >> 8));
+            buffer.push_back(static_cast<char>(value));
+        }
+
+        void readFrame() {
+            auto self = this->shared_from_this();
+            ASIO::async_read(socket_, ASIO::buffer(frame_), [self](const ASIO_ERROR& err, size_t) {
+                if (!err && self->handleFrame()) {
+                    self->readFrameSize();
+                }
+            });
+        }
+
+        bool handleFrame() {
+            if (frame_.size() < 4) {
+                return false;
+            }
+            const auto cmdSize = decodeUnsignedInt(frame_.data());
+            proto::BaseCommand cmd;
+            if (cmdSize > frame_.size() - 4 || !cmd.ParseFromArray(frame_.data() + 4, cmdSize)) {
+                return false;
+            }
+            {
+                std::lock_guard<std::mutex> lock(broker_.commandsMutex_);
+                broker_.receivedCommands_.emplace_back(
+                    cmd.type(), (cmd.type() == proto::BaseCommand::SEND) ? cmd.send().producer_id() : 0);
+            }
+
+            proto::BaseCommand response;
+            switch (cmd.type()) {
+                case proto::BaseCommand::CONNECT: {
+                    response.set_type(proto::BaseCommand::CONNECTED);
+                    auto connected = response.mutable_connected();
+                    connected->set_server_version("stand-in");
+                    connected->set_protocol_version(cmd.connect().protocol_version());
+                    break;
+                }
+                case proto::BaseCommand::PING:
+                    response.set_type(proto::BaseCommand::PONG);
+                    response.mutable_pong();
+                    break;
+                case proto::BaseCommand::PARTITIONED_METADATA: {
+                    response.set_type(proto::BaseCommand::PARTITIONED_METADATA_RESPONSE);
+                    auto metadata = response.mutable_partitionmetadataresponse();
+                    metadata->set_request_id(cmd.partitionmetadata().request_id());
+                    metadata->set_partitions(broker_.numPartitions_);
+                    metadata->set_response(proto::CommandPartitionedTopicMetadataResponse::Success);
+                    break;
+                }
+                case proto::BaseCommand::LOOKUP: {
+                    response.set_type(proto::BaseCommand::LOOKUP_RESPONSE);
+                    auto lookup = response.mutable_lookuptopicresponse();
+                    lookup->set_request_id(cmd.lookuptopic().request_id());
+                    lookup->set_response(proto::CommandLookupTopicResponse::Connect);
+                    lookup->set_brokerserviceurl("pulsar://stand-in:6650");
+                    lookup->set_authoritative(true);
+                    lookup->set_proxy_through_service_url(true);
+                    break;
+                }
+                case proto::BaseCommand::PRODUCER: {
+                    response.set_type(proto::BaseCommand::PRODUCER_SUCCESS);
+                    auto success = response.mutable_producer_success();
+                    success->set_request_id(cmd.producer().request_id());
+                    success->set_producer_name("stand-in-" + std::to_string(cmd.producer().producer_id()));
+                    success->set_last_sequence_id(-1);
+                    producerTopics_[cmd.producer().producer_id()] = cmd.producer().topic();
+                    break;
+                }
+                case proto::BaseCommand::SUBSCRIBE: {
+                    const auto& subscribe = cmd.subscribe();
+                    broker_.subscriptions_[subscribe.topic()].emplace_back(this->shared_from_this(),
+                                                                           subscribe.consumer_id());
+                    response.set_type(proto::BaseCommand::SUCCESS);
+                    response.mutable_success()->set_request_id(subscribe.request_id());
+                    break;
+                }
+                case proto::BaseCommand::FLOW: {
+                    std::lock_guard<std::mutex> lock(broker_.flowMutex_);
+                    broker_.flowPermits_.emplace_back(cmd.flow().messagepermits());
+                    // No response is expected
+                    return true;
+                }
+                case proto::BaseCommand::CLOSE_CONSUMER:
+                    response.set_type(proto::BaseCommand::SUCCESS);
+                    response.mutable_success()->set_request_id(cmd.close_consumer().request_id());
+                    break;
+                case proto::BaseCommand::SEND: {
+                    const auto& send = cmd.send();
+                    auto& lastSequenceId = lastSequenceIds_.emplace(send.producer_id(), -1).first->second;
+                    if (static_cast<int64_t>(send.sequence_id()) <= lastSequenceId) {
+                        broker_.sequenceIdOrdered_ = false;
+                    }
+                    lastSequenceId = send.has_highest_sequence_id() ? send.highest_sequence_id()
+                                                                    : send.sequence_id();
+                    broker_.numSentMessages_ += send.num_messages();
+
+                    response.set_type(proto::BaseCommand::SEND_RECEIPT);
+                    auto receipt = response.mutable_send_receipt();
+                    receipt->set_producer_id(send.producer_id());
+                    receipt->set_sequence_id(send.sequence_id());
+                    if (send.has_highest_sequence_id()) {
+                        receipt->set_highest_sequence_id(send.highest_sequence_id());
+                    }
+                    receipt->mutable_message_id()->set_ledgerid(0);
+                    receipt->mutable_message_id()->set_entryid(nextEntryId_);
+
+                    // The checksum, the metadata and the payload that follow the command are the same
+                    const std::string entry(frame_.data() + 4 + cmdSize, frame_.size() - 4 - cmdSize);
+                    broker_.dispatch(producerTopics_[send.producer_id()], nextEntryId_++, entry);
+                    break;
+                }
+                case proto::BaseCommand::CLOSE_PRODUCER:
+                    response.set_type(proto::BaseCommand::SUCCESS);
+                    response.mutable_success()->set_request_id(cmd.close_producer().request_id());
+                    break;
+                default:
+                    // Other commands are not expected on the connection, just ignore them
+                    return true;
+            }
+
+            return write(response);
+        }
+
+       public:
+        bool write(const proto::BaseCommand& command, const std::string& entry = "") {
+            const auto commandSize = static_cast<uint32_t>(command.ByteSizeLong());
+            std::string buffer;
+            encodeUnsignedInt(buffer, 4 + commandSize + static_cast<uint32_t>(entry.size()));
+            encodeUnsignedInt(buffer, commandSize);
+            command.AppendToString(&buffer);
+            buffer.append(entry);
+            ASIO_ERROR err;
+            ASIO::write(socket_, ASIO::buffer(buffer), err);
+            return !err;
+        }
+    };
+
+    ASIO::io_service io_;
+    typename Protocol::acceptor acceptor_;
+    const int numPartitions_;
+    std::atomic<uint64_t> numSentMessages_{0};
+    std::atomic_bool sequenceIdOrdered_{true};
+    mutable std::mutex flowMutex_;
+    std::vector<uint32_t> flowPermits_;
+    std::mutex ackSetMutex_;
+    std::vector<int64_t> ackSet_;
+    std::atomic_int receiveBufferSize_{0};
+    mutable std::mutex commandsMutex_;
+    std::vector<std::pair<proto::BaseCommand::Type, uint64_t>> receivedCommands_;
+    // They are only accessed in the I/O thread
+    bool readingPaused_ = false;
+    std::vector<std::shared_ptr<Session>> pausedSessions_;
+    // The sessions and the consumer ids of the consumers of each topic
+    std::unordered_map<std::string, std::vector<std::pair<std::weak_ptr<Session>, uint64_t>>> subscriptions_;
+    std::thread thread_;
+
+    // All the sessions run in the same thread, so a session can write to the sockets of the others
+    void dispatch(const std::string& topic, uint64_t entryId, const std::string& entry) {
+        std::unique_lock<std::mutex> lock(ackSetMutex_);
+        const auto ackSet = ackSet_;
+        lock.unlock();
+        for (const auto& subscription : subscriptions_[topic]) {
+            auto session = subscription.first.lock();
+            if (!session) {
+                continue;
+            }
+            proto::BaseCommand command;
+            command.set_type(proto::BaseCommand::MESSAGE);
+            auto message = command.mutable_message();
+            message->set_consumer_id(subscription.second);
+            message->mutable_message_id()->set_ledgerid(0);
+            message->mutable_message_id()->set_entryid(entryId);
+            for (auto word : ackSet) {
+                message->add_ack_set(word);
+            }
+            session->write(command, entry);
+        }
+    }
+
+    template <typename Task>
+    void runInIoThread(Task task) {
+        std::promise<void> promise;
+        ASIO::post(io_, [&promise, &task] {
+            task();
+            promise.set_value();
+        });
+        promise.get_future().wait();
+    }
+
+    void accept() {
+        auto socket = std::make_shared<Socket>(io_);
+        acceptor_.async_accept(*socket, [this, socket](const ASIO_ERROR& err) {
+            if (err) {
+                return;
+            }
+            if (receiveBufferSize_ > 0) {
+                socket->set_option(typename Socket::receive_buffer_size(receiveBufferSize_));
+            }
+            std::make_shared<Session>(std::move(*socket), *this)->readFrameSize();
+            accept();
+        });
+    }
+};
+
+}  // namespace pulsar
@@ -0,0 +1,56 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#pragma once
+
+#include <filesystem>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace pulsar {
+
+// A directory with a unique name under the system's temporary directory, removed with its content when it
+// goes out of scope
+class TemporaryDirectory {
+   public:
+    TemporaryDirectory() {
+        std::random_device random;
+        std::ostringstream oss;
+        oss << "pulsar-test-" << std::hex << random() << random();
+        path_ = std::filesystem::temp_directory_path() / oss.str();
+        std::filesystem::create_directories(path_);
+    }
+
+    ~TemporaryDirectory() {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+    }
+
+    TemporaryDirectory(const TemporaryDirectory&) = delete;
+    TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+    std::string path() const { return path_.string(); }
+
+    bool empty() const { return std::filesystem::is_empty(path_); }
+
+   private:
+    std::filesystem::path path_;
+};
+
+}  // namespace pulsar
@@ -0,0 +1,163 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "lib/ExecutorService.h"
+#include "lib/Latch.h"
+#include "lib/TimingWheel.h"
+
+using namespace pulsar;
+using namespace std::chrono;
+
+TEST(TimingWheelTest, testExpiryOrder) {
+    auto executor = ExecutorService::create();
+
+    // The delays cover the first levels of the wheel and their boundaries
+    const std::vector<int> delaysMs{300, 1, 64, 10, 4200, 63, 65, 1000, 0, 4096};
+    std::vector<std::unique_ptr<WheelTimer>> timers;
+    struct Context {
+        std::mutex mutex;
+        std::vector<int> expiredDelays;
+        Latch latch;
+        const steady_clock::time_point start = steady_clock::now();
+    } context{{}, {}, Latch(static_cast<int>(delaysMs.size()))};
+    for (int delayMs : delaysMs) {
+        timers.emplace_back(new WheelTimer(executor));
+        timers.back()->expiresAt(context.start + milliseconds(delayMs), [&context, delayMs] {
+            // The callback must not be called before the deadline
+            EXPECT_GE(steady_clock::now(), context.start + milliseconds(delayMs));
+            std::lock_guard<std::mutex> lock(context.mutex);
+            context.expiredDelays.emplace_back(delayMs);
+            context.latch.countdown();
+        });
+    }
+    ASSERT_EQ(executor->getTimingWheel().size(), delaysMs.size());
+
+    ASSERT_TRUE(context.latch.wait(seconds(10)));
+    const std::vector<int> expectedDelays{0, 1, 10, 63, 64, 65, 300, 1000, 4096, 4200};
+    ASSERT_EQ(context.expiredDelays, expectedDelays);
+    ASSERT_EQ(executor->getTimingWheel().size(), 0);
+    for (auto&& timer : timers) {
+        ASSERT_FALSE(timer->isWaiting());
+    }
+    executor->close();
+}
+
+TEST(TimingWheelTest, testCancelAndRestart) {
+    auto executor = ExecutorService::create();
+    std::atomic_int numCancelledCalls{0};
+    std::atomic_int numRestartedCalls{0};
+    Latch latch(1);
+
+    WheelTimer cancelled(executor);
+    ASSERT_FALSE(cancelled.cancel());
+    cancelled.expiresAfter(milliseconds(100), [&numCancelledCalls] { numCancelledCalls++; });
+    ASSERT_TRUE(cancelled.isWaiting());
+    ASSERT_TRUE(cancelled.cancel());
+    ASSERT_FALSE(cancelled.isWaiting());
+    ASSERT_FALSE(cancelled.cancel());
+
+    // Only the callback of the last wait is called
+    WheelTimer restarted(executor);
+    restarted.expiresAfter(seconds(10), [&numCancelledCalls] { numCancelledCalls++; });
+    restarted.expiresAfter(milliseconds(200), [&numCancelledCalls] { numCancelledCalls++; });
+    const auto deadline = steady_clock::now() + milliseconds(50);
+    restarted.expiresAt(deadline, [&numRestartedCalls, &latch] {
+        numRestartedCalls++;
+        latch.countdown();
+    });
+
+    {
+        // The timer is destroyed before its deadline
+        WheelTimer destroyed(executor);
+        destroyed.expiresAfter(milliseconds(100), [&numCancelledCalls] { numCancelledCalls++; });
+    }
+
+    ASSERT_TRUE(latch.wait(seconds(3)));
+    ASSERT_GE(steady_clock::now(), deadline);
+    std::this_thread::sleep_for(milliseconds(500));
+    ASSERT_EQ(numCancelledCalls, 0);
+    ASSERT_EQ(numRestartedCalls, 1);
+    ASSERT_EQ(executor->getTimingWheel().size(), 0);
+
+    // The timer can be restarted in its callback
+    std::atomic_int count{0};
+    Latch periodicLatch(1);
+    std::function<void()> restart;
+    restart = [&] {
+        if (++count == 5) {
+            periodicLatch.countdown();
+        } else {
+            restarted.expiresAfter(milliseconds(10), [&restart] { restart(); });
+        }
+    };
+    restarted.expiresAfter(milliseconds(10), [&restart] { restart(); });
+    ASSERT_TRUE(periodicLatch.wait(seconds(3)));
+    ASSERT_EQ(count, 5);
+    executor->close();
+}
+
+TEST(TimingWheelTest, testManyTimers) {
+    auto executor = ExecutorService::create();
+    constexpr int numTimers = 10000;
+
+    std::vector<std::unique_ptr<WheelTimer>> timers;
+    struct Context {
+        std::atomic_int numEarlyCalls{0};
+        std::atomic_int numCancelledCalls{0};
+        Latch latch{numTimers / 2};
+    } context;
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> delayDistribution(200, 500);
+    for (int i = 0; i < numTimers; i++) {
+        timers.emplace_back(new WheelTimer(executor));
+        const auto deadline = steady_clock::now() + milliseconds(delayDistribution(random));
+        timers.back()->expiresAt(deadline, [&context, i, deadline] {
+            if (steady_clock::now() < deadline) {
+                context.numEarlyCalls++;
+            }
+            if (i % 2 == 0) {
+                context.numCancelledCalls++;
+            } else {
+                context.latch.countdown();
+            }
+        });
+    }
+    // Cancel a half of the timers from another thread
+    std::thread thread{[&timers] {
+        for (size_t i = 0; i < timers.size(); i += 2) {
+            timers[i]->cancel();
+        }
+    }};
+    thread.join();
+
+    ASSERT_TRUE(context.latch.wait(seconds(10)));
+    ASSERT_EQ(context.numEarlyCalls, 0);
+    ASSERT_EQ(context.numCancelledCalls, 0);
+    ASSERT_EQ(executor->getTimingWheel().size(), 0);
+    executor->close();
+}
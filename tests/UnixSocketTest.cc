@@ -0,0 +1,66 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+#include <pulsar/Client.h>
+
+#include "StandInBroker.h"
+
+#ifdef PULSAR_HAS_UNIX_SOCKETS
+#include <unistd.h>
+
+#include <cstdio>
+
+using namespace pulsar;
+
+using UnixStandInBroker = StandInBroker<ASIO::local::stream_protocol>;
+
+static std::string unixSocketPath(const std::string& name) {
+    return "/tmp/pulsar-" + name + "-" + std::to_string(::getpid()) + ".sock";
+}
+
+TEST(UnixSocketTest, testGetPartitions) {
+    const auto path = unixSocketPath("testGetPartitions");
+    std::remove(path.c_str());
+    UnixStandInBroker broker(ASIO::local::stream_protocol::endpoint(path), 3);
+
+    Client client("pulsar+unix://" + path);
+    for (int i = 0; i < 3; i++) {
+        // The following lookups reuse the same connection
+        std::vector<std::string> partitions;
+        ASSERT_EQ(ResultOk, client.getPartitionsForTopic("topic-" + std::to_string(i), partitions));
+        ASSERT_EQ(partitions.size(), 3);
+        ASSERT_EQ(partitions[0], "persistent://public/default/topic-" + std::to_string(i) + "-partition-0");
+    }
+    client.close();
+    std::remove(path.c_str());
+}
+
+TEST(UnixSocketTest, testConnectFailure) {
+    const auto path = unixSocketPath("testConnectFailure");
+    std::remove(path.c_str());
+
+    ClientConfiguration conf;
+    conf.setOperationTimeoutSeconds(1);
+    Client client("pulsar+unix://" + path, conf);
+    std::vector<std::string> partitions;
+    ASSERT_NE(ResultOk, client.getPartitionsForTopic("topic", partitions));
+    client.close();
+}
+
+#endif
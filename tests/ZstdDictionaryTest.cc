@@ -0,0 +1,99 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+#include <pulsar/ConsumerConfiguration.h>
+#include <pulsar/ZstdDictionary.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "lib/CompressionCodecZstd.h"
+
+using namespace pulsar;
+
+#if HAS_ZSTD
+
+static std::string createEvent(int i) {
+    static const std::vector<std::string> types{"page_view", "click", "purchase"};
+    return R"({"event_id":")" + std::to_string(i * 7919) + R"(","type":")" + types[i % types.size()] +
+           R"(","country":"US","device":{"platform":"android","app_version":"5.)" + std::to_string(i % 10) +
+           R"("},"page":"/products/)" + std::to_string(i % 1000) + R"("})";
+}
+
+static ZstdDictionaryPtr trainDictionary() {
+    std::vector<std::string> samples;
+    for (int i = 0; i < 10000; i++) {
+        samples.emplace_back(createEvent(i));
+    }
+    return ZstdDictionary::train(samples, 4096);
+}
+
+TEST(ZstdDictionaryTest, testCreate) {
+    auto dictionary = trainDictionary();
+    ASSERT_NE(dictionary->getId(), 0);
+    ASSERT_LE(dictionary->getContent().size(), 4096);
+
+    auto copied = ZstdDictionary::create(dictionary->getContent());
+    ASSERT_EQ(copied->getId(), dictionary->getId());
+
+    ASSERT_THROW(ZstdDictionary::create("not a dictionary"), std::invalid_argument);
+    ASSERT_THROW(ZstdDictionary::load("/path/to/not-existing-dictionary"), std::invalid_argument);
+    ASSERT_THROW(ZstdDictionary::train({"a", "b"}), std::invalid_argument);
+}
+
+TEST(ZstdDictionaryTest, testCompression) {
+    auto dictionary = trainDictionary();
+    const auto content = createEvent(12345);
+    const auto raw = SharedBuffer::copy(content.data(), content.size());
+
+    CompressionCodecZstd codec;
+    auto compressed = codec.encode(raw);
+    auto compressedWithDictionary = CompressionCodecZstd::encodeWithDictionary(raw, *dictionary);
+    ASSERT_LT(compressedWithDictionary.readableBytes() * 2, compressed.readableBytes());
+
+    SharedBuffer decoded;
+    ASSERT_TRUE(CompressionCodecZstd::decodeWithDictionary(compressedWithDictionary, raw.readableBytes(),
+                                                           decoded, *dictionary));
+    ASSERT_EQ(std::string(decoded.data(), decoded.readableBytes()), content);
+    // The payload compressed with a dictionary cannot be decompressed without the dictionary
+    ASSERT_FALSE(codec.decode(compressedWithDictionary, raw.readableBytes(), decoded));
+
+    ASSERT_TRUE(codec.decode(compressed, raw.readableBytes(), decoded));
+    ASSERT_EQ(std::string(decoded.data(), decoded.readableBytes()), content);
+}
+
+TEST(ZstdDictionaryTest, testConsumerConfiguration) {
+    auto dictionary = trainDictionary();
+    ConsumerConfiguration conf;
+    ASSERT_EQ(conf.getZstdDictionary(dictionary->getId()), nullptr);
+    conf.addZstdDictionary(dictionary);
+    ASSERT_EQ(conf.getZstdDictionary(dictionary->getId()), dictionary);
+    ASSERT_THROW(conf.addZstdDictionary(nullptr), std::invalid_argument);
+}
+
+#else  // No ZSTD
+
+TEST(ZstdDictionaryTest, testNotSupported) {
+    ASSERT_THROW(ZstdDictionary::train({"a", "b"}), std::runtime_error);
+    ASSERT_THROW(ZstdDictionary::create("content"), std::runtime_error);
+    ASSERT_THROW(ConsumerConfiguration().addZstdDictionary(nullptr), std::invalid_argument);
+}
+
+#endif  // HAS_ZSTD
@@ -0,0 +1,110 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+#include <pulsar/Client.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../StandInBroker.h"
+
+// The global operator new is replaced to count the allocations of the current thread, that's why this test
+// runs in its own executable
+
+static thread_local bool countAllocations = false;
+static std::atomic<size_t> numAllocations{0};
+
+static void* allocate(size_t size) {
+    if (countAllocations) {
+        numAllocations++;
+    }
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+using namespace pulsar;
+
+// The pools are filled by the first rounds, a round without any allocation must follow
+static constexpr int MaxRounds = 20;
+static constexpr int NumMessagesPerRound = 20000;
+
+TEST(ProducerAllocationTest, testBatchedSendAsync) {
+    StandInBroker<ASIO::ip::tcp> broker(ASIO::ip::tcp::endpoint(ASIO::ip::address_v4::loopback(), 0), 0);
+    Client client("pulsar://127.0.0.1:" + std::to_string(broker.endpoint().port()));
+
+    ProducerConfiguration conf;
+    conf.setBatchingMaxMessages(100);
+    conf.setBatchingMaxPublishDelayMs(3600 * 1000);
+    conf.setMaxPendingMessages(10000);
+    conf.setBlockIfQueueFull(true);
+    Producer producer;
+    ASSERT_EQ(ResultOk, client.createProducer("producer-allocation-test", conf, producer));
+
+    std::atomic<int> numFailed{0};
+    // The capture is small enough to be stored inline by std::function
+    const SendCallback callback = [&numFailed](Result result, const MessageId&) {
+        if (result != ResultOk) {
+            numFailed++;
+        }
+    };
+
+    size_t numAllocationsOfLastRound = 0;
+    for (int round = 0; round < MaxRounds; round++) {
+        std::vector<Message> messages;
+        messages.reserve(NumMessagesPerRound);
+        for (int i = 0; i < NumMessagesPerRound; i++) {
+            messages.emplace_back(MessageBuilder().setContent(std::string(100, 'a')).build());
+        }
+
+        numAllocations = 0;
+        countAllocations = true;
+        for (const auto& msg : messages) {
+            producer.sendAsync(msg, callback);
+        }
+        countAllocations = false;
+        numAllocationsOfLastRound = numAllocations;
+
+        ASSERT_EQ(ResultOk, producer.flush());
+        if (numAllocationsOfLastRound == 0) {
+            break;
+        }
+    }
+    ASSERT_EQ(numAllocationsOfLastRound, 0);
+    ASSERT_EQ(numFailed, 0);
+    ASSERT_TRUE(broker.isSequenceIdOrdered());
+
+    client.close();
+}
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
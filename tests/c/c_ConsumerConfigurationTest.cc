@@ -34,6 +34,11 @@ TEST(C_ConsumerConfigurationTest, testCApiConfig) {
     ASSERT_EQ(pulsar_consumer_configuration_is_auto_ack_oldest_chunked_message_on_queue_full(consumer_conf),
               1);
 
+    ASSERT_EQ(pulsar_consumer_configuration_get_receive_spin_time_us(consumer_conf), 0);
+    ASSERT_EQ(0, pulsar_consumer_configuration_set_receive_spin_time_us(consumer_conf, 50));
+    ASSERT_EQ(-1, pulsar_consumer_configuration_set_receive_spin_time_us(consumer_conf, -1));
+    ASSERT_EQ(pulsar_consumer_configuration_get_receive_spin_time_us(consumer_conf), 50);
+
     pulsar_consumer_configuration_set_start_message_id_inclusive(consumer_conf, 1);
     ASSERT_EQ(pulsar_consumer_configuration_is_start_message_id_inclusive(consumer_conf), 1);
 